@@ -0,0 +1,411 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        binary_logger.cpp
+*
+*****************************************************************************/
+
+#include "binary_logger.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+using namespace hi;
+
+namespace helper
+{
+/// File starts with magic, followed by timestamp of logger's creation
+constexpr char fileMagic[8] = { 'H', 'I', 'L', 'O', 'G', 'v', '1', '\n' };
+
+/// Tags of file entries
+enum EntryTag : uint8_t
+{
+    /// String table entry: uint32 id, uint32 length, data
+    STRING_ENTRY = 'S',
+    /// Record: uint32 thread id, Record
+    RECORD_ENTRY = 'R',
+    /// Dropped records: uint32 thread id, uint64 count
+    DROPPED_ENTRY = 'D',
+};
+
+std::atomic<uint64_t> nextInstanceId = 1;
+
+template <typename T>
+void writeRaw(std::ostream& output, const T& value)
+{
+    output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readRaw(std::istream& input, T& value)
+{
+    return static_cast<bool>(input.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+} // namespace helper
+
+//-----------------------------------------------------------------------------
+// Encoder
+//-----------------------------------------------------------------------------
+bool BinaryLogger::Encoder::reserve(size_t slots)
+{
+    if (m_Record.slotCount + slots > maxSlots)
+    {
+        m_Record.isTruncated = true;
+        return false;
+    }
+    return true;
+}
+
+void BinaryLogger::Encoder::addInt(int64_t value)
+{
+    if (!reserve(1))
+        return;
+    m_Record.types[m_Record.slotCount] = ArgumentType::INT;
+    std::memcpy(&m_Record.values[m_Record.slotCount++], &value, sizeof(value));
+}
+
+void BinaryLogger::Encoder::addUInt(uint64_t value)
+{
+    if (!reserve(1))
+        return;
+    m_Record.types[m_Record.slotCount] = ArgumentType::UINT;
+    m_Record.values[m_Record.slotCount++] = value;
+}
+
+void BinaryLogger::Encoder::addDouble(double value)
+{
+    if (!reserve(1))
+        return;
+    m_Record.types[m_Record.slotCount] = ArgumentType::DOUBLE;
+    std::memcpy(&m_Record.values[m_Record.slotCount++], &value, sizeof(value));
+}
+
+void BinaryLogger::Encoder::addPointer(const void* pointer)
+{
+    if (!reserve(1))
+        return;
+    m_Record.types[m_Record.slotCount] = ArgumentType::POINTER;
+    m_Record.values[m_Record.slotCount++] = reinterpret_cast<uintptr_t>(pointer);
+}
+
+void BinaryLogger::Encoder::addLiteral(const char* literal)
+{
+    if (!reserve(1))
+        return;
+    m_Record.types[m_Record.slotCount] = ArgumentType::LITERAL;
+    m_Record.values[m_Record.slotCount++] = reinterpret_cast<uintptr_t>(literal);
+}
+
+void BinaryLogger::Encoder::addPosition(const char* file, int line)
+{
+    if (!reserve(2))
+        return;
+    m_Record.types[m_Record.slotCount] = ArgumentType::POSITION;
+    m_Record.values[m_Record.slotCount++] = reinterpret_cast<uintptr_t>(file);
+    m_Record.types[m_Record.slotCount] = ArgumentType::STRING_DATA;
+    m_Record.values[m_Record.slotCount++] = line;
+}
+
+void BinaryLogger::Encoder::addString(const char* str, size_t length)
+{
+    if (!reserve(1))
+        return;
+    // Truncate string to remaining slots
+    const size_t freeBytes = (maxSlots - m_Record.slotCount - 1) * sizeof(uint64_t);
+    if (length > freeBytes)
+    {
+        length = freeBytes;
+        m_Record.isTruncated = true;
+    }
+    m_Record.types[m_Record.slotCount] = ArgumentType::STRING;
+    m_Record.values[m_Record.slotCount++] = length;
+
+    const size_t dataSlots = (length + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    std::memcpy(&m_Record.values[m_Record.slotCount], str, length);
+    for (size_t i = 0; i < dataSlots; i++)
+    {
+        m_Record.types[m_Record.slotCount++] = ArgumentType::STRING_DATA;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// RingBuffer
+//-----------------------------------------------------------------------------
+BinaryLogger::RingBuffer::RingBuffer()
+    : m_Records(bufferCapacity)
+{
+    static_assert((bufferCapacity & (bufferCapacity - 1)) == 0, "Capacity must be power of 2");
+}
+
+bool BinaryLogger::RingBuffer::read(Record& record)
+{
+    const auto tail = m_Tail.load(std::memory_order_relaxed);
+    if (tail == m_Head.load(std::memory_order_acquire))
+        return false;
+    record = m_Records[tail & (bufferCapacity - 1)];
+    m_Tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool BinaryLogger::RingBuffer::isEmpty() const
+{
+    return m_Tail.load(std::memory_order_relaxed) == m_Head.load(std::memory_order_acquire);
+}
+
+uint64_t BinaryLogger::RingBuffer::takeDropped()
+{
+    return m_Dropped.exchange(0, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+// BinaryLogger
+//-----------------------------------------------------------------------------
+BinaryLogger::BinaryLogger(const std::string& outputPath)
+    : m_InstanceId(helper::nextInstanceId++)
+    , m_Output(outputPath, std::ios::binary | std::ios::trunc)
+{
+    if (!m_Output.is_open())
+        return;
+    m_Output.write(helper::fileMagic, sizeof(helper::fileMagic));
+    helper::writeRaw(m_Output, getTimestamp());
+    m_DrainThread = std::thread([this]() { drainLoop(); });
+}
+
+BinaryLogger::~BinaryLogger()
+{
+    m_ShouldStop = true;
+    if (m_DrainThread.joinable())
+        m_DrainThread.join();
+    flush();
+}
+
+bool BinaryLogger::isOpen() const
+{
+    return m_Output.is_open();
+}
+
+void BinaryLogger::flush()
+{
+    drain();
+}
+
+BinaryLogger::RingBuffer& BinaryLogger::getThreadBuffer()
+{
+    struct ThreadBuffer
+    {
+        uint64_t ownerId = 0;
+        std::shared_ptr<RingBuffer> buffer;
+        ~ThreadBuffer()
+        {
+            if (buffer)
+                buffer->m_IsOrphaned = true;
+        }
+    };
+    thread_local ThreadBuffer threadBuffer;
+    if (threadBuffer.ownerId != m_InstanceId)
+    {
+        if (threadBuffer.buffer)
+            threadBuffer.buffer->m_IsOrphaned = true;
+        threadBuffer.buffer = registerThreadBuffer();
+        threadBuffer.ownerId = m_InstanceId;
+    }
+    return *threadBuffer.buffer;
+}
+
+std::shared_ptr<BinaryLogger::RingBuffer> BinaryLogger::registerThreadBuffer()
+{
+    auto buffer = std::make_shared<RingBuffer>();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Buffers.emplace_back(m_NextThreadId++, buffer);
+    return buffer;
+}
+
+void BinaryLogger::drainLoop()
+{
+    while (!m_ShouldStop)
+    {
+        if (!drain())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool BinaryLogger::drain()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_Output.is_open())
+        return false;
+
+    bool hasWritten = false;
+    Record record;
+    for (auto& [threadId, buffer] : m_Buffers)
+    {
+        if (const auto dropped = buffer->takeDropped())
+        {
+            helper::writeRaw(m_Output, helper::DROPPED_ENTRY);
+            helper::writeRaw(m_Output, threadId);
+            helper::writeRaw(m_Output, dropped);
+            hasWritten = true;
+        }
+        while (buffer->read(record))
+        {
+            writeRecord(threadId, record);
+            hasWritten = true;
+        }
+    }
+    // Release buffers of terminated threads once these are drained
+    m_Buffers.erase(std::remove_if(m_Buffers.begin(), m_Buffers.end(), [](const auto& entry) {
+        return entry.second->m_IsOrphaned.load() && entry.second->isEmpty();
+    }),
+        m_Buffers.end());
+
+    if (hasWritten)
+        m_Output.flush();
+    return hasWritten;
+}
+
+void BinaryLogger::writeRecord(uint32_t threadId, Record& record)
+{
+    // Replace pointers to literals by string table ids
+    for (size_t slot = 0; slot < record.slotCount; slot++)
+    {
+        if (record.types[slot] == ArgumentType::LITERAL || record.types[slot] == ArgumentType::POSITION)
+        {
+            record.values[slot] = getLiteralId(reinterpret_cast<const char*>(record.values[slot]));
+        }
+    }
+    helper::writeRaw(m_Output, helper::RECORD_ENTRY);
+    helper::writeRaw(m_Output, threadId);
+    helper::writeRaw(m_Output, record);
+}
+
+uint32_t BinaryLogger::getLiteralId(const char* literal)
+{
+    auto it = m_Literals.find(literal);
+    if (it != m_Literals.end())
+        return it->second;
+
+    const uint32_t id = m_Literals.size();
+    const uint32_t length = std::strlen(literal);
+    helper::writeRaw(m_Output, helper::STRING_ENTRY);
+    helper::writeRaw(m_Output, id);
+    helper::writeRaw(m_Output, length);
+    m_Output.write(literal, length);
+    m_Literals[literal] = id;
+    return id;
+}
+
+bool BinaryLogger::decode(std::istream& input, std::ostream& output)
+{
+    char magic[sizeof(helper::fileMagic)];
+    uint64_t startTimestamp = 0;
+    if (!input.read(magic, sizeof(magic)) || std::memcmp(magic, helper::fileMagic, sizeof(magic)) != 0)
+        return false;
+    if (!helper::readRaw(input, startTimestamp))
+        return false;
+
+    std::unordered_map<uint32_t, std::string> strings;
+    const auto getString = [&](uint64_t id) -> std::string {
+        auto it = strings.find(id);
+        return (it != strings.end()) ? it->second : "<unknown string " + std::to_string(id) + ">";
+    };
+
+    uint8_t tag = 0;
+    while (helper::readRaw(input, tag))
+    {
+        switch (tag)
+        {
+        case helper::STRING_ENTRY:
+        {
+            uint32_t id = 0, length = 0;
+            if (!helper::readRaw(input, id) || !helper::readRaw(input, length))
+                return false;
+            std::string str(length, '\0');
+            if (!input.read(str.data(), length))
+                return false;
+            strings[id] = std::move(str);
+            break;
+        }
+        case helper::DROPPED_ENTRY:
+        {
+            uint32_t threadId = 0;
+            uint64_t dropped = 0;
+            if (!helper::readRaw(input, threadId) || !helper::readRaw(input, dropped))
+                return false;
+            output << "[Repeater][T" << threadId << "] " << dropped << " log records dropped\n";
+            break;
+        }
+        case helper::RECORD_ENTRY:
+        {
+            uint32_t threadId = 0;
+            Record record;
+            if (!helper::readRaw(input, threadId) || !helper::readRaw(input, record))
+                return false;
+            if (record.slotCount > maxSlots)
+                return false;
+
+            const auto elapsed = record.timestamp - startTimestamp;
+            output << "[Repeater][T" << threadId << "][" << elapsed / 1000000000 << "."
+                   << std::setw(6) << std::setfill('0') << (elapsed % 1000000000) / 1000 << "]";
+            if (record.level >= Logger::DEBUG_LOG)
+                output << "Debug: ";
+
+            for (size_t slot = 0; slot < record.slotCount; slot++)
+            {
+                const auto value = record.values[slot];
+                switch (record.types[slot])
+                {
+                case ArgumentType::INT:
+                {
+                    int64_t signedValue;
+                    std::memcpy(&signedValue, &value, sizeof(value));
+                    output << std::to_string(signedValue) << " ";
+                    break;
+                }
+                case ArgumentType::UINT:
+                    output << std::to_string(value) << " ";
+                    break;
+                case ArgumentType::DOUBLE:
+                {
+                    double doubleValue;
+                    std::memcpy(&doubleValue, &value, sizeof(value));
+                    output << std::to_string(doubleValue) << " ";
+                    break;
+                }
+                case ArgumentType::POINTER:
+                    output << reinterpret_cast<void*>(value) << " ";
+                    break;
+                case ArgumentType::LITERAL:
+                    output << getString(value) << " ";
+                    break;
+                case ArgumentType::POSITION:
+                    if (slot + 1 < record.slotCount)
+                        output << getString(value) << ":" << record.values[++slot] << " ";
+                    break;
+                case ArgumentType::STRING:
+                {
+                    const auto length = std::min<uint64_t>(value, (record.slotCount - slot - 1) * sizeof(uint64_t));
+                    output << std::string(reinterpret_cast<const char*>(&record.values[slot + 1]), length) << " ";
+                    slot += (length + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+                    break;
+                }
+                default:
+                    break;
+                }
+            }
+            if (record.isTruncated)
+                output << "...";
+            output << "\n";
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
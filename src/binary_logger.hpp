@@ -0,0 +1,204 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        binary_logger.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_BINARY_LOGGER_HPP
+#define HI_BINARY_LOGGER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace hi
+{
+/**
+ * @brief Asynchronous logging backend, writing binary records into file
+ *
+ * Each thread appends fixed-size records (timestamp, level and raw arguments) into its own
+ * single-producer single-consumer ring buffer, thus no lock or formatting is involved on
+ * logging thread. A background thread drains the buffers periodically and writes records
+ * into file, where string literals are replaced by ids of a string table, emitted on their first
+ * use. Text is reconstructed offline by decode() (see hi-log-decoder tool).
+ *
+ * When a ring buffer is full, records are dropped and the count of dropped records is logged.
+ *
+ * Note: only string literals, marked by HI_LITERAL, are stored as pointers. Other strings
+ * (including char arrays) are copied into record and truncated when they don't fit.
+ */
+class BinaryLogger
+{
+public:
+    /// Count of 8-byte argument slots per record
+    static constexpr size_t maxSlots = 13;
+    /// Count of records per thread's ring buffer (power of 2)
+    static constexpr size_t bufferCapacity = 4096;
+
+    enum class ArgumentType : uint8_t
+    {
+        NONE,
+        INT,
+        UINT,
+        DOUBLE,
+        POINTER,
+        /// Pointer to string literal (replaced by string table id in file)
+        LITERAL,
+        /// Literal file name, followed by line in next slot
+        POSITION,
+        /// Inline string of length 'value', followed by string's data slots
+        STRING,
+        STRING_DATA
+    };
+
+    /// Fixed-size log record
+    struct Record
+    {
+        uint64_t timestamp;
+        uint8_t level;
+        uint8_t slotCount;
+        uint8_t isTruncated;
+        ArgumentType types[maxSlots];
+        uint64_t values[maxSlots];
+    };
+    static_assert(sizeof(Record) == 128, "Record is expected to fit two cache lines");
+
+    /**
+     * @brief Appends arguments into record's slots
+     */
+    class Encoder
+    {
+    public:
+        explicit Encoder(Record& record)
+            : m_Record(record)
+        {
+        }
+        void addInt(int64_t value);
+        void addUInt(uint64_t value);
+        void addDouble(double value);
+        void addPointer(const void* pointer);
+        void addLiteral(const char* literal);
+        void addPosition(const char* file, int line);
+        void addString(const char* str, size_t length);
+
+    private:
+        bool reserve(size_t slots);
+        Record& m_Record;
+    };
+
+    /**
+     * @brief Lock-free single-producer single-consumer queue of records
+     */
+    class RingBuffer
+    {
+    public:
+        RingBuffer();
+
+        /// Producer: get free record or nullptr when buffer is full (record is dropped)
+        inline Record* beginWrite()
+        {
+            const auto head = m_Head.load(std::memory_order_relaxed);
+            if (head - m_Tail.load(std::memory_order_acquire) == bufferCapacity)
+            {
+                m_Dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            return &m_Records[head & (bufferCapacity - 1)];
+        }
+        /// Producer: publish record, obtained by beginWrite()
+        inline void commitWrite()
+        {
+            m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /// Consumer: pop a record, returns false if buffer is empty
+        bool read(Record& record);
+        /// Consumer: true if all published records were read
+        bool isEmpty() const;
+        /// Consumer: get & reset count of dropped records
+        uint64_t takeDropped();
+
+        /// Set when producing thread has terminated
+        std::atomic<bool> m_IsOrphaned = false;
+
+    private:
+        std::vector<Record> m_Records;
+        alignas(64) std::atomic<uint64_t> m_Head = 0;
+        alignas(64) std::atomic<uint64_t> m_Tail = 0;
+        std::atomic<uint64_t> m_Dropped = 0;
+    };
+
+    /// Open output file and start draining thread
+    explicit BinaryLogger(const std::string& outputPath);
+    /// Stop draining thread and write remaining records
+    ~BinaryLogger();
+
+    BinaryLogger(const BinaryLogger&) = delete;
+    BinaryLogger& operator=(const BinaryLogger&) = delete;
+
+    bool isOpen() const;
+
+    /**
+     * @brief Append record of level, whose arguments are filled by encodeArguments(Encoder&)
+     */
+    template <typename F>
+    inline void write(uint8_t level, const F& encodeArguments)
+    {
+        auto& buffer = getThreadBuffer();
+        auto record = buffer.beginWrite();
+        if (!record)
+            return;
+        record->timestamp = getTimestamp();
+        record->level = level;
+        record->slotCount = 0;
+        record->isTruncated = false;
+        Encoder encoder(*record);
+        encodeArguments(encoder);
+        buffer.commitWrite();
+    }
+
+    /// Synchronously write all pending records into file
+    void flush();
+
+    /// Reconstruct text log from binary log. Returns false on malformed input
+    static bool decode(std::istream& input, std::ostream& output);
+
+private:
+    static uint64_t getTimestamp()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    RingBuffer& getThreadBuffer();
+    std::shared_ptr<RingBuffer> registerThreadBuffer();
+
+    /// Write pending records of all threads, returns true if any record was written
+    bool drain();
+    void drainLoop();
+    void writeRecord(uint32_t threadId, Record& record);
+    uint32_t getLiteralId(const char* literal);
+
+    /// Unique id of instance, used to detect stale thread-local buffers
+    const uint64_t m_InstanceId;
+
+    std::ofstream m_Output;
+    /// Guards m_Buffers, m_Output and m_Literals
+    std::mutex m_Mutex;
+    std::vector<std::pair<uint32_t, std::shared_ptr<RingBuffer>>> m_Buffers;
+    uint32_t m_NextThreadId = 0;
+    std::unordered_map<const char*, uint32_t> m_Literals;
+
+    std::atomic<bool> m_ShouldStop = false;
+    std::thread m_DrainThread;
+};
+} // namespace hi
+#endif
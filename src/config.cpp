@@ -152,6 +152,12 @@ void Config::loadFromEnvironment(ConfigDict& dict)
         { "HI_RUNINBG", "runInBg" },
         { "HI_RECORDFPS", "recordFPS" },
         { "HI_VERTEX", "vertex" },
+        { "HI_NO_INSTANCED_LAYERS", "noInstancedLayers" },
+        { "HI_OVR_MULTIVIEW", "ovrMultiview" },
+        { "HI_DEFERRED_REPLAY", "deferredReplay" },
+        { "HI_EMULATE_FIXED_PIPELINE", "emulateFixedPipeline" },
+        { "HI_VALIDATE_STATE", "validateState" },
+        { "HI_NO_SHADER_CACHE", "noShaderCache" },
     };
     for (const auto& entry : enviromentVariables)
     {
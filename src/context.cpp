@@ -9,17 +9,25 @@
 #include "context.hpp"
 
 #include "trackers/framebuffer_tracker.hpp"
+#include "trackers/immediate_mode_tracker.hpp"
 #include "trackers/legacy_tracker.hpp"
 #include "trackers/renderbuffer_tracker.hpp"
 #include "trackers/shader_tracker.hpp"
+#include "trackers/state_tracker.hpp"
 #include "trackers/texture_tracker.hpp"
 #include "trackers/uniform_block_tracing.hpp"
 
 #include "pipeline/camera_parameters.hpp"
+#include "pipeline/immediate_mode_buffer.hpp"
+#include "pipeline/injector_parameters.hpp"
 #include "pipeline/output_fbo.hpp"
 #include "pipeline/viewport_area.hpp"
 #include "pipeline/virtual_cameras.hpp"
 #include "pipeline/shader_profile.hpp"
+#include "pipeline/pipeline_cache.hpp"
+#include "pipeline/program_binary_cache.hpp"
+
+#include "utils/context_capabilities.hpp"
 
 #include "diagnostics.hpp"
 #include "imgui_adapter.hpp"
@@ -49,6 +57,11 @@ public:
     /// User-defined shader profiles
     hi::pipeline::ShaderProfile m_profiles;
 
+    /// Persistent cache of injected programs
+    hi::pipeline::PipelineCache m_PipelineCache;
+    /// Persistent cache of driver's binaries of injected programs
+    hi::pipeline::ProgramBinaryCache m_ProgramBinaryCache;
+
     /// Dear ImGUI Adapter
     ImguiAdapter m_gui;
 
@@ -71,6 +84,12 @@ public:
     hi::trackers::RenderbufferTracker m_RenderbufferTracker;
     /// Store metadata and bindings for UBO
     hi::trackers::UniformBlockTracing m_UniformBlocksTracker;
+    /// Mirror of buffer bindings & capabilities
+    hi::trackers::StateTracker m_StateTracker;
+    /// Captures glBegin()/glEnd() primitives
+    hi::trackers::ImmediateModeTracker m_ImmediateModeTracker;
+    /// Version, profile & extensions, queried when context is initialized
+    hi::utils::ContextCapabilities m_Capabilities;
 
     /* ------------------------------------------------------------------------
          *  HELPER STRUCTURES
@@ -86,6 +105,12 @@ public:
 
     /// FBO with all raw virtual cameras
     hi::pipeline::OutputFBO m_OutputFBO;
+
+    /// Uniform buffer with per-frame parameters of injected programs
+    hi::pipeline::InjectorParameters m_InjectorParameters;
+
+    /// Ring buffer, streaming captured glBegin()/glEnd() primitives
+    hi::pipeline::ImmediateModeBuffer m_ImmediateModeBuffer;
 };
 
 Context::Context()
@@ -100,6 +125,19 @@ void Context::reset()
     pimpl = std::make_unique<ContextPimpl>();
 }
 
+void Context::shareObjectsWith(Context& other)
+{
+    pimpl->m_Manager.shareWith(other.pimpl->m_Manager);
+    pimpl->m_Manager.shaders.shareWith(other.pimpl->m_Manager.shaders);
+    pimpl->m_TextureTracker.shareWith(other.pimpl->m_TextureTracker);
+    pimpl->m_RenderbufferTracker.shareWith(other.pimpl->m_RenderbufferTracker);
+}
+
+bool Context::hasSharedObjects() const
+{
+    return pimpl->m_TextureTracker.isShared();
+}
+
 hi::pipeline::CameraParameters& Context::getCameraParameters()
 {
     return pimpl->m_cameraParameters;
@@ -119,6 +157,16 @@ hi::pipeline::ShaderProfile& Context::getProfiles()
     return pimpl->m_profiles;
 }
 
+hi::pipeline::PipelineCache& Context::getPipelineCache()
+{
+    return pimpl->m_PipelineCache;
+}
+
+hi::pipeline::ProgramBinaryCache& Context::getProgramBinaryCache()
+{
+    return pimpl->m_ProgramBinaryCache;
+}
+
 ImguiAdapter& Context::getGui()
 {
     return pimpl->m_gui;
@@ -161,6 +209,21 @@ hi::trackers::UniformBlockTracing& Context::getUniformBlocksTracker()
     return pimpl->m_UniformBlocksTracker;
 }
 
+hi::trackers::StateTracker& Context::getStateTracker()
+{
+    return pimpl->m_StateTracker;
+}
+
+hi::utils::ContextCapabilities& Context::getCapabilities()
+{
+    return pimpl->m_Capabilities;
+}
+
+hi::trackers::ImmediateModeTracker& Context::getImmediateModeTracker()
+{
+    return pimpl->m_ImmediateModeTracker;
+}
+
 hi::pipeline::ViewportArea& Context::getCurrentViewport()
 {
     return pimpl->currentViewport;
@@ -175,4 +238,14 @@ hi::pipeline::OutputFBO& Context::getOutputFBO()
 {
     return pimpl->m_OutputFBO;
 }
+
+hi::pipeline::InjectorParameters& Context::getInjectorParameters()
+{
+    return pimpl->m_InjectorParameters;
+}
+
+hi::pipeline::ImmediateModeBuffer& Context::getImmediateModeBuffer()
+{
+    return pimpl->m_ImmediateModeBuffer;
+}
 }
@@ -17,7 +17,11 @@ namespace pipeline
     class VirtualCameras;
     class ViewportArea;
     class OutputFBO;
+    class InjectorParameters;
+    class ImmediateModeBuffer;
     class ShaderProfile;
+    class PipelineCache;
+    class ProgramBinaryCache;
 }
 
 class Diagnostics;
@@ -33,6 +37,13 @@ namespace trackers
     class TextureTracker;
     class RenderbufferTracker;
     class UniformBlockTracing;
+    class StateTracker;
+    class ImmediateModeTracker;
+}
+
+namespace utils
+{
+    class ContextCapabilities;
 }
 
 class ContextPimpl;
@@ -45,11 +56,22 @@ public:
     explicit Context();
     ~Context();
     void reset();
+    /**
+     * @brief Track sharable objects in common with other context of the same share group
+     *
+     * Shaders, programs, textures and renderbuffers are shared between GLX contexts,
+     * whereas container objects (FBOs) and bindings are kept per context.
+     */
+    void shareObjectsWith(Context& other);
+    /// Are sharable objects tracked by another (alive) context too?
+    bool hasSharedObjects() const;
     /* ------------------------------------------------------------------------
      * OPTIONS
      * ----------------------------------------------------------------------*/
     /// Is repeater rendering scene into multiple virtual screens
     bool m_IsMultiviewActivated = false;
+    /// Are multiview-only calls passed to driver (see Dispatcher::updatePassThrough)
+    bool m_IsPassThroughActive = false;
     /// Determines how virtual views are placed in view-space
     hi::pipeline::CameraParameters& getCameraParameters();
     /// Store's repeating setup
@@ -58,6 +80,10 @@ public:
     Diagnostics& getDiagnostics();
     /// User-defined shader profiles
     hi::pipeline::ShaderProfile& getProfiles();
+    /// Persistent cache of injected programs
+    hi::pipeline::PipelineCache& getPipelineCache();
+    /// Persistent cache of driver's binaries of injected programs
+    hi::pipeline::ProgramBinaryCache& getProgramBinaryCache();
 
     /* ------------------------------------------------------------------------
      *  UI
@@ -86,6 +112,15 @@ public:
     /// Store metadata and bindings for UBO
     hi::trackers::UniformBlockTracing& getUniformBlocksTracker();
 
+    /// Mirror of buffer bindings & capabilities
+    hi::trackers::StateTracker& getStateTracker();
+
+    /// Version, profile & extensions, queried when context is initialized
+    hi::utils::ContextCapabilities& getCapabilities();
+
+    /// Captures glBegin()/glEnd() primitives
+    hi::trackers::ImmediateModeTracker& getImmediateModeTracker();
+
     /* ------------------------------------------------------------------------
      *  HELPER STRUCTURES
      * ----------------------------------------------------------------------*/
@@ -102,12 +137,36 @@ public:
     /// FBO with all raw virtual cameras
     hi::pipeline::OutputFBO& getOutputFBO();
 
+    /// Uniform buffer with per-frame parameters of injected programs
+    hi::pipeline::InjectorParameters& getInjectorParameters();
+
+    /// Ring buffer, streaming captured glBegin()/glEnd() primitives
+    hi::pipeline::ImmediateModeBuffer& getImmediateModeBuffer();
+
     /// Determines if newly create GL window should be put to background
     bool keepWindowInBackgroundFlag = false;
 
     /// Use Vertex Shader instead of Geometry Shader
     bool dontInsertGeometryShader = false;
 
+    /// Vertex Shader: replicate draw calls by instancing & gl_Layer (ARB_shader_viewport_layer_array)
+    bool useInstancedLayersFlag = false;
+
+    /// Render views natively by GL_OVR_multiview (programs without Geometry Shader)
+    bool useMultiviewExtensionFlag = false;
+
+    /// Record draw calls into command list and replay them view-major (see DeferredReplay)
+    bool deferredReplayFlag = false;
+
+    /// Draw shaderless draw calls by injected fixed-pipeline emulation program (compatibility profile only)
+    bool emulateFixedPipelineFlag = false;
+
+    /// Debug: cross-check mirrored OpenGL state with real state before each draw call
+    bool validateStateFlag = false;
+
+    /// Driver compiles & links on its own threads (KHR/ARB_parallel_shader_compile)
+    bool parallelShaderCompileFlag = false;
+
 private:
     std::unique_ptr<ContextPimpl> pimpl;
 };
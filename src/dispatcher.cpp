@@ -7,32 +7,43 @@
 *****************************************************************************/
 
 #include "dispatcher.hpp"
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <regex>
 #include <sstream>
+#include <tuple>
 #include <unordered_set>
 
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/transform.hpp>
 
 #include "pipeline/camera_parameters.hpp"
+#include "pipeline/immediate_mode_buffer.hpp"
+#include "pipeline/injector_parameters.hpp"
 #include "pipeline/output_fbo.hpp"
+#include "pipeline/pipeline_cache.hpp"
+#include "pipeline/program_binary_cache.hpp"
 #include "pipeline/projection_estimator.hpp"
 #include "pipeline/shader_inspector.hpp"
 #include "pipeline/virtual_cameras.hpp"
 
 #include "trackers/framebuffer_tracker.hpp"
+#include "trackers/immediate_mode_tracker.hpp"
 #include "trackers/legacy_tracker.hpp"
 #include "trackers/renderbuffer_tracker.hpp"
 #include "trackers/shader_tracker.hpp"
+#include "trackers/state_tracker.hpp"
+#include "trackers/texture_tracker.hpp"
 #include "trackers/uniform_block_tracing.hpp"
 
 #include "ui/x11_sniffer.hpp"
 
 #include "imgui_adapter.hpp"
 
+#include "utils/context_capabilities.hpp"
 #include "utils/enviroment.hpp"
+#include "utils/opengl_objects.hpp"
 #include "utils/opengl_state.hpp"
 #include "utils/opengl_utils.hpp"
 
@@ -46,12 +57,60 @@
 
 using namespace hi;
 
+namespace helper
+{
+/// Handlers, which are only needed to render multiple views (see Dispatcher::updatePassThrough)
+const std::vector<std::string> multiviewOnlyHandlers = {
+    "glClear",
+    "glDrawArrays",
+    "glDrawArraysInstanced",
+    "glDrawElements",
+    "glDrawElementsInstanced",
+    "glDrawRangeElements",
+    "glDrawElementsBaseVertex",
+    "glDrawRangeElementsBaseVertex",
+    "glDrawElementsInstancedBaseVertex",
+    "glMultiDrawElementsBaseVertex",
+    "glCallList",
+    "glCallLists",
+    "glBegin",
+    "glEnd",
+};
+
+/// Immediate-mode vertex & attribute entry points (glVertex3f, glColor4ubv, ...)
+#define HI_IMMEDIATE_MODE_HANDLER_NAMES(NAME, ...) #NAME, #NAME "v",
+const std::vector<std::string> immediateModeHandlers = {
+    HI_IMMEDIATE_MODE_VERTEX_ENTRY_POINTS(HI_IMMEDIATE_MODE_HANDLER_NAMES)
+        HI_IMMEDIATE_MODE_ATTRIBUTE_ENTRY_POINTS(HI_IMMEDIATE_MODE_HANDLER_NAMES)
+};
+#undef HI_IMMEDIATE_MODE_HANDLER_NAMES
+
+/// Convert normal/color component as OpenGL does
+template <typename T>
+float normalized(T value)
+{
+    return hi::trackers::ImmediateModeTracker::normalize(value);
+}
+} // namespace helper
+
+thread_local GLXContext Dispatcher::m_CurrentContext = nullptr;
+thread_local Context* Dispatcher::m_Context = &Dispatcher::getPlaceholderState().context;
+thread_local hi::managers::DrawManager* Dispatcher::m_DrawManager = &Dispatcher::getPlaceholderState().drawManager;
+
+Dispatcher::Dispatcher()
+{
+}
+
 void Dispatcher::initialize()
 {
-    m_IsInitialized = true;
+    getContextState(m_CurrentContext).isInitialized = true;
 
     Logger::log("Dispatcher::initialize");
 
+    // Query version & extensions once, helpers decide their paths from cached capabilities
+    m_Context->getCapabilities().query();
+    const auto& capabilities = m_Context->getCapabilities();
+
     // Load config
     Config cfg;
     const auto settings = cfg.load();
@@ -59,41 +118,41 @@ void Dispatcher::initialize()
     // Override default angle
     if (settings.hasKey("xmultiplier"))
     {
-        m_Context.getCameraParameters().m_XShiftMultiplier = settings.getAsFloat("xmultiplier");
+        m_Context->getCameraParameters().m_XShiftMultiplier = settings.getAsFloat("xmultiplier");
     }
     // Override default center of rotation
     if (settings.hasKey("distance"))
     {
-        m_Context.getCameraParameters().m_frontOpticalAxisCentreDistance = settings.getAsFloat("distance");
+        m_Context->getCameraParameters().m_frontOpticalAxisCentreDistance = settings.getAsFloat("distance");
     }
     // if HI_NOW is provided, then start with multiple views right now
     if (settings.hasKey("now"))
     {
-        m_Context.m_IsMultiviewActivated = true;
+        m_Context->m_IsMultiviewActivated = true;
     }
 
     // Preset shift/near-plane position for quilt
     if (settings.hasKey("wide"))
     {
-        m_Context.m_IsMultiviewActivated = true;
-        m_Context.getCameraParameters().m_XShiftMultiplier = 4.0;
-        m_Context.getCameraParameters().m_frontOpticalAxisCentreDistance = 4.0;
+        m_Context->m_IsMultiviewActivated = true;
+        m_Context->getCameraParameters().m_XShiftMultiplier = 4.0;
+        m_Context->getCameraParameters().m_frontOpticalAxisCentreDistance = 4.0;
     }
 
     // Prevent application displaying Window (useful for scripts)
     if (settings.hasKey("runInBg"))
     {
-        m_Context.keepWindowInBackgroundFlag = true;
+        m_Context->keepWindowInBackgroundFlag = true;
     }
 
     if (settings.hasKey("quilt"))
     {
-        m_Context.getOutputFBO().toggleGridView();
+        m_Context->getOutputFBO().toggleGridView();
     }
 
     if (settings.hasKey("exitAfter"))
     {
-        m_Context.getDiagnostics().setTerminationAfterFrame(settings.getAsSizet("exitAfter"));
+        m_Context->getDiagnostics().setTerminationAfterFrame(settings.getAsSizet("exitAfter"));
     }
 
     /*
@@ -101,22 +160,22 @@ void Dispatcher::initialize()
      */
     if (settings.hasKey("cameraID"))
     {
-        m_Context.getDiagnostics().setOnlyVirtualCamera(settings.getAsSizet("cameraID"));
+        m_Context->getDiagnostics().setOnlyVirtualCamera(settings.getAsSizet("cameraID"));
     }
 
     if (settings.hasKey("screenshot"))
     {
-        m_Context.getDiagnostics().setScreenshotFormat(settings.getAsString("screenshot"));
+        m_Context->getDiagnostics().setScreenshotFormat(settings.getAsString("screenshot"));
     }
 
     if (settings.hasKey("nonIntrusive"))
     {
-        m_Context.getDiagnostics().setNonIntrusiveness(true);
+        m_Context->getDiagnostics().setNonIntrusiveness(true);
     }
 
     if (settings.hasKey("recordFPS"))
     {
-        m_Context.getDiagnostics().setFPSMeasuringState(true);
+        m_Context->getDiagnostics().setFPSMeasuringState(true);
     }
 
     // Initialize oputput FBO
@@ -143,102 +202,283 @@ void Dispatcher::initialize()
 
     if (settings.hasKey("vertex"))
     {
-        m_Context.dontInsertGeometryShader = true;
+        m_Context->dontInsertGeometryShader = true;
+        // Replicate draw calls in a single pass when VS can select output layer
+        m_Context->useInstancedLayersFlag = !settings.hasKey("noInstancedLayers") && capabilities.hasExtension("GL_ARB_shader_viewport_layer_array");
+        Logger::log("Vertex shader: instanced layers enabled:", m_Context->useInstancedLayersFlag);
+    }
+
+    if (settings.hasKey("validateState"))
+    {
+        m_Context->validateStateFlag = true;
+    }
+
+    // Link status of injected programs is queried lazily, thus driver may compile them on its threads
+    m_Context->parallelShaderCompileFlag = capabilities.hasExtension("GL_KHR_parallel_shader_compile") || capabilities.hasExtension("GL_ARB_parallel_shader_compile");
+    Logger::log("Parallel shader compilation:", m_Context->parallelShaderCompileFlag);
+
+    if (settings.hasKey("ovrMultiview"))
+    {
+        GLint maxViews = 0;
+        if (capabilities.hasExtension("GL_OVR_multiview2"))
+            OpenglRedirectorBase::glGetIntegerv(GL_MAX_VIEWS_OVR, &maxViews);
+        m_Context->useMultiviewExtensionFlag = (static_cast<size_t>(maxViews) >= outParameters.getLayers());
+        if (!m_Context->useMultiviewExtensionFlag)
+        {
+            Logger::logError("GL_OVR_multiview2 can't render ", outParameters.getLayers(), " views (max views: ", maxViews, ")");
+        }
+        else
+        {
+            // Programs, injected with multiview, can only render into multiview FBOs
+            m_Context->m_IsMultiviewActivated = true;
+        }
+    }
+
+    if (settings.hasKey("deferredReplay"))
+    {
+        m_Context->deferredReplayFlag = true;
+    }
+
+    if (settings.hasKey("emulateFixedPipeline"))
+    {
+        m_Context->emulateFixedPipelineFlag = capabilities.isCompatibilityProfile();
+        if (!m_Context->emulateFixedPipelineFlag)
+        {
+            Logger::logError("Fixed-pipeline emulation requires compatibility profile");
+        }
+    }
+
+    // Reuse injected programs of previous runs (see PipelineCache)
+    if (!settings.hasKey("noShaderCache"))
+    {
+        const auto cacheDirectory = hi::pipeline::PipelineCache::getDefaultDirectory();
+        m_Context->getPipelineCache() = hi::pipeline::PipelineCache(cacheDirectory);
+        m_Context->getProgramBinaryCache().initialize(cacheDirectory / "binaries");
     }
 
     // Initialize hidden FBO for redirecting draws to back-buffer
-    m_Context.getOutputFBO().initialize(outParameters);
+    m_Context->getOutputFBO().initialize(outParameters);
     assert(OpenglRedirectorBase::glGetError() == GL_NO_ERROR);
 
-    const auto layers = m_Context.getOutputFBO().getParams().getLayers();
-    const auto gridXSize = m_Context.getOutputFBO().getParams().getGridSizeX();
+    const auto layers = m_Context->getOutputFBO().getParams().getLayers();
+    const auto gridXSize = m_Context->getOutputFBO().getParams().getGridSizeX();
     // Fill viewports
-    OpenglRedirectorBase::glGetIntegerv(GL_VIEWPORT, m_Context.getCurrentViewport().getDataPtr());
-    OpenglRedirectorBase::glGetIntegerv(GL_SCISSOR_BOX, m_Context.getCurrentScissorArea().getDataPtr());
+    OpenglRedirectorBase::glGetIntegerv(GL_VIEWPORT, m_Context->getCurrentViewport().getDataPtr());
+    OpenglRedirectorBase::glGetIntegerv(GL_SCISSOR_BOX, m_Context->getCurrentScissorArea().getDataPtr());
     // Initialize a cache of windows's subviews
-    m_Context.getCameras().setupWindows(layers, gridXSize);
-    m_Context.getCameras().updateViewports(m_Context.getCurrentViewport());
-    m_Context.getCameras().updateParamaters(m_Context.getCameraParameters());
+    m_Context->getCameras().setupWindows(layers, gridXSize);
+    m_Context->getCameras().updateViewports(m_Context->getCurrentViewport());
+    m_Context->getCameras().updateParamaters(m_Context->getCameraParameters());
+
+    // Fetch bindings & capabilities once, later these are mirrored from intercepted calls
+    m_Context->getStateTracker().synchronize();
+
+    // Initialize per-frame parameters of injected programs
+    m_Context->getInjectorParameters().initialize(capabilities, m_Context->getStateTracker());
+    m_Context->getInjectorParameters().update(m_Context->getCameraParameters(), m_Context->getCameras());
+    m_Context->getInjectorParameters().bind();
+
+    // Ring buffer of glBegin()/glEnd() vertices is allocated on first use
+    m_Context->getImmediateModeBuffer().initialize(capabilities, m_Context->getStateTracker());
 
     // Initialize GUI
-    m_Context.getGui().initialize();
+    m_Context->getGui().initialize();
 
     /* 
      * Register input callbacks 
      */
-    m_Context.getX11Sniffer().registerOnKeyCallback([&](size_t keySym, bool isDown) -> bool {
+    m_Context->getX11Sniffer().registerOnKeyCallback([&](size_t keySym, bool isDown) -> bool {
         bool shouldBlockInput = false;
         if (isDown)
         {
-            m_UIManager.onKeyPressed(m_Context, keySym);
+            m_UIManager.onKeyPressed(*m_Context, keySym);
         }
         // If GUI is active, propagate input to GUI and block
-        if (m_Context.getGui().isVisible())
+        if (m_Context->getGui().isVisible())
         {
-            m_Context.getGui().onKey(keySym, isDown);
+            m_Context->getGui().onKey(keySym, isDown);
             shouldBlockInput = true;
         }
         return shouldBlockInput;
     });
-    m_Context.getX11Sniffer().registerOnMouseMoveCallback([&](float dx, float dy) {
-        if (m_Context.getGui().isVisible())
+    m_Context->getX11Sniffer().registerOnMouseMoveCallback([&](float dx, float dy) {
+        if (m_Context->getGui().isVisible())
         {
-            m_Context.getGui().onMousePosition(dx, dy);
+            m_Context->getGui().onMousePosition(dx, dy);
             return true;
         }
         return false;
     });
 
-    m_Context.getX11Sniffer().registerOnButtonCallback([&](size_t buttonID, bool isPressed) {
-        if (m_Context.getGui().isVisible())
+    m_Context->getX11Sniffer().registerOnButtonCallback([&](size_t buttonID, bool isPressed) {
+        if (m_Context->getGui().isVisible())
         {
-            m_Context.getGui().onButton(buttonID, isPressed);
+            m_Context->getGui().onButton(buttonID, isPressed);
             return true;
         }
         return false;
     });
 
-    m_UIManager.initialize(m_Context);
+    m_UIManager.initialize(*m_Context);
+
+    updatePassThrough();
 
     Logger::log("Initialized with settings: ", settings.toString());
 }
 
 void Dispatcher::deinitialize()
 {
+    // Replay pending draw calls & delete display list while context is still current
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    m_DrawManager->deinitialize(*m_Context);
     // Clean up layered FBO & shaders
-    m_Context.getOutputFBO().deinitialize();
-    // Clean up texture views & etc
-    m_Context.getTextureTracker().deinitialize();
+    m_Context->getOutputFBO().deinitialize();
+    // Clean up texture views & etc, unless textures are still used by shared context
+    if (!m_Context->hasSharedObjects())
+    {
+        m_Context->getTextureTracker().deinitialize();
+    }
+    // Clean up per-frame parameters' buffer
+    m_Context->getInjectorParameters().deinitialize();
+    // Clean up immediate-mode ring buffer
+    m_Context->getImmediateModeBuffer().deinitialize();
 
-    m_UIManager.deinitialize(m_Context);
-    m_Context.getGui().destroy();
+    m_UIManager.deinitialize(*m_Context);
+    m_Context->getGui().destroy();
 
-    m_Context.reset();
-    m_IsInitialized = false;
+    getContextState(m_CurrentContext).isInitialized = false;
 }
 
-GLint Dispatcher::getCurrentID(GLenum target)
+void Dispatcher::registerContext(GLXContext context, GLXContext shareList)
 {
-    GLint id;
-    OpenglRedirectorBase::glGetIntegerv(target, &id);
-    return id;
+    if (context == nullptr)
+        return;
+    Logger::log("Created context: ", static_cast<void*>(context), " sharing with: ", static_cast<void*>(shareList));
+    auto& state = getContextState(context);
+    // Share list's state carries objects of whole share group
+    if (shareList != nullptr)
+    {
+        state.context.shareObjectsWith(getContextState(shareList).context);
+    }
+}
+
+Dispatcher::ContextState& Dispatcher::getContextState(GLXContext context)
+{
+    if (context == nullptr)
+        return getPlaceholderState();
+    // References stay valid when other contexts are added
+    std::lock_guard<std::mutex> lock(m_ContextsMutex);
+    return m_Contexts[context];
+}
+
+Dispatcher::ContextState& Dispatcher::getPlaceholderState()
+{
+    static ContextState placeholder;
+    return placeholder;
+}
+
+void Dispatcher::switchContext(GLXContext context)
+{
+    auto& state = getContextState(context);
+    {
+        std::lock_guard<std::mutex> lock(m_ContextsMutex);
+        auto previous = m_Contexts.find(m_CurrentContext);
+        if (previous != m_Contexts.end())
+            previous->second.isCurrent = false;
+        if (context != nullptr)
+            state.isCurrent = true;
+    }
+    m_CurrentContext = context;
+    m_Context = &state.context;
+    m_DrawManager = &state.drawManager;
+}
+
+void Dispatcher::releaseContext(GLXContext context)
+{
+    const bool isCurrent = (context == m_CurrentContext);
+    if (isCurrent)
+    {
+        // Tracked objects must be released while their context is current
+        if (getContextState(context).isInitialized)
+            deinitialize();
+        switchContext(nullptr);
+    }
+
+    std::unique_lock<std::mutex> lock(m_ContextsMutex);
+    auto node = m_Contexts.extract(context);
+    lock.unlock();
+    if (node.empty() || isCurrent)
+        return;
+
+    // Driver releases objects of context, which isn't current, together with the context
+    Logger::log("Context is not current, its objects are released by driver: ", static_cast<void*>(context));
+    m_UIManager.deinitialize(node.mapped().context);
+    utils::AbandonOpenGLObjectsRAII abandon;
+    node = {};
+}
+
+void Dispatcher::updatePassThrough()
+{
+    const bool shouldPassThrough = !m_Context->m_IsMultiviewActivated;
+    // Hooks of calling thread follow its current context only
+    setThreadPassThrough(shouldPassThrough);
+    if (shouldPassThrough == m_Context->m_IsPassThroughActive)
+        return;
+    if (shouldPassThrough)
+    {
+        m_DrawManager->preparePassThrough(*m_Context);
+    }
+    else
+    {
+        // Current attributes have been set by driver directly
+        m_Context->getImmediateModeTracker().invalidate();
+    }
+    m_Context->m_IsPassThroughActive = shouldPassThrough;
+    Logger::log("Multiview-only API calls are ", (shouldPassThrough ? "passed to driver" : "redirected"));
+}
+
+std::shared_ptr<hi::trackers::TextureMetadata> Dispatcher::getBoundTexture(GLenum target)
+{
+    auto texture = m_Context->getTextureTracker().getTextureUnits().getBoundTexture(target);
+    if (!texture)
+    {
+        Logger::logDebug("No tracked texture is bound to ", hi::trackers::TextureMetadata::getTypeAsString(target), HI_POS);
+    }
+    return texture;
+}
+
+std::shared_ptr<hi::trackers::RenderbufferMetadata> Dispatcher::getBoundRenderbuffer()
+{
+    auto& tracker = m_Context->getRenderbufferTracker();
+    if (!tracker.has(tracker.getBoundId()))
+    {
+        Logger::logDebug("No tracked renderbuffer is bound", HI_POS);
+        return nullptr;
+    }
+    return tracker.getBound();
 }
 
 void Dispatcher::glClear(GLbitfield mask)
 {
-    m_FramebufferManager.clear(m_Context, mask);
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    m_FramebufferManager.clear(*m_Context, mask);
 }
 
 void Dispatcher::registerCallbacks()
 {
     registerOpenGLSymbols();
+    // Threads, whose current context has multiview off, pass these to driver (see updatePassThrough)
+    setThreadSwitchable(helper::multiviewOnlyHandlers);
+    setThreadSwitchable(helper::immediateModeHandlers);
 }
 
 GLXContext Dispatcher::glXCreateContext(Display* dpy, XVisualInfo* vis, GLXContext shareList, Bool direct)
 {
     // TODO: code below does not work as expected in practices
     // Hint: XVisualInfo needs to be converted into corresponding visual_attribs
-    return OpenglRedirectorBase::glXCreateContext(dpy, vis, shareList, direct);
+    auto context = OpenglRedirectorBase::glXCreateContext(dpy, vis, shareList, direct);
+    registerContext(context, shareList);
+    return context;
 
     /*
      * See https://www.khronos.org/opengl/wiki/Tutorial:_OpenGL_3.0_Context_Creation_(GLX)
@@ -292,38 +532,47 @@ GLXContext Dispatcher::glXCreateContext(Display* dpy, XVisualInfo* vis, GLXConte
 
 void Dispatcher::glXSwapBuffers(Display* dpy, GLXDrawable drawable)
 {
+    // Finish views of recorded draw calls
+    m_DrawManager->flushDeferredDraws(*m_Context);
     // Render content of OutputFBO
-    m_FramebufferManager.renderFromOutputFBO(m_Context);
+    m_FramebufferManager.renderFromOutputFBO(*m_Context);
     // Render overlay
     {
         // Draw GUI overlay if GUI is visible
-        if (m_Context.getGui().isVisible())
+        if (m_Context->getGui().isVisible())
         {
-            m_Context.getGui().beginFrame(m_Context);
-            m_UIManager.onDraw(m_Context);
-            m_Context.getGui().endFrame();
-            m_Context.getGui().renderCurrentFrame();
+            m_Context->getGui().beginFrame(*m_Context);
+            m_UIManager.onDraw(*m_Context);
+            m_Context->getGui().endFrame();
+            m_Context->getGui().renderCurrentFrame();
         }
     }
 
     // Update diagnosis
     {
-        if (m_Context.getDiagnostics().hasReachedLastFrame())
+        if (m_Context->getDiagnostics().hasReachedLastFrame())
         {
             // Note: this is debug only, leaves mem. leaks and uncleaned objects
-            const auto& viewport = m_Context.getCurrentViewport();
-            opengl_utils::takeScreenshot(std::string(m_Context.getDiagnostics().getScreenshotName()), viewport.getWidth(), viewport.getHeight());
+            const auto& viewport = m_Context->getCurrentViewport();
+            opengl_utils::takeScreenshot(std::string(m_Context->getDiagnostics().getScreenshotName()), viewport.getWidth(), viewport.getHeight());
             exit(5);
         }
-        m_Context.getDiagnostics().incrementFrameCount();
+        m_Context->getDiagnostics().incrementFrameCount();
         Logger::getInstance().incrementFrameNumber();
     }
 
     // Swap buffers
-    m_FramebufferManager.swapBuffers(m_Context,
+    m_FramebufferManager.swapBuffers(*m_Context,
         [&]() {
             ::glXSwapBuffers(dpy, drawable);
         });
+
+    // Upload per-frame parameters for the next frame (once for all programs)
+    m_Context->getInjectorParameters().update(m_Context->getCameraParameters(), m_Context->getCameras());
+    m_Context->getInjectorParameters().bind();
+
+    // Apply multiview toggle (e.g. by hotkey) for the next frame
+    updatePassThrough();
 }
 
 Bool Dispatcher::glXMakeCurrent(Display* dpy, GLXDrawable drawable, GLXContext context)
@@ -333,23 +582,94 @@ Bool Dispatcher::glXMakeCurrent(Display* dpy, GLXDrawable drawable, GLXContext c
 
 Bool Dispatcher::glXMakeContextCurrent(Display* dpy, GLXDrawable draw, GLXDrawable read, GLXContext context)
 {
-    if (m_IsInitialized)
+    const auto previousContext = m_CurrentContext;
+    bool isPreviousDestroyed = false;
+    if (context != previousContext)
     {
-        Logger::log("Deinitializing for context: ", static_cast<void*>(context));
-        deinitialize();
+        // Replay pending draw calls while previous context is still current
+        if (getContextState(previousContext).isInitialized)
+        {
+            m_DrawManager->flushDeferredDraws(*m_Context);
+        }
+        std::lock_guard<std::mutex> lock(m_ContextsMutex);
+        auto previous = m_Contexts.find(previousContext);
+        isPreviousDestroyed = (previous != m_Contexts.end() && previous->second.isDestroyed);
+    }
+    if (isPreviousDestroyed)
+    {
+        // Context has been destroyed by another thread, release its objects while it is still current
+        Logger::log("Deinitializing for destroyed context: ", static_cast<void*>(previousContext));
+        m_ShaderManager.waitForBackgroundWork();
+        releaseContext(previousContext);
     }
 
-    if (draw == None && context == nullptr)
+    auto result = OpenglRedirectorBase::glXMakeContextCurrent(dpy, draw, read, context);
+    if (!result)
     {
-        return OpenglRedirectorBase::glXMakeContextCurrent(dpy, draw, read, context);
+        return result;
     }
-    else
+
+    switchContext(context);
+    if (context == nullptr)
     {
-        auto result = OpenglRedirectorBase::glXMakeContextCurrent(dpy, draw, read, context);
+        return result;
+    }
+
+    auto& state = getContextState(context);
+    if (!state.isInitialized)
+    {
+        Logger::log("Initializing for context: ", static_cast<void*>(context));
         glGetError();
         initialize();
-        return result;
     }
+    else
+    {
+        // Multiview may be toggled differently in each context
+        updatePassThrough();
+    }
+    return result;
+}
+
+GLXContext Dispatcher::glXCreateNewContext(Display* dpy, GLXFBConfig config, int renderType, GLXContext shareList, Bool direct)
+{
+    auto context = OpenglRedirectorBase::glXCreateNewContext(dpy, config, renderType, shareList, direct);
+    registerContext(context, shareList);
+    return context;
+}
+
+GLXContext Dispatcher::glXCreateContextAttribsARB(Display* dpy, GLXFBConfig config, GLXContext shareList, Bool direct, const int* attribList)
+{
+    auto context = OpenglRedirectorBase::glXCreateContextAttribsARB(dpy, config, shareList, direct, attribList);
+    registerContext(context, shareList);
+    return context;
+}
+
+void Dispatcher::glXDestroyContext(Display* dpy, GLXContext ctx)
+{
+    std::unique_lock<std::mutex> lock(m_ContextsMutex);
+    auto it = m_Contexts.find(ctx);
+    if (ctx == nullptr || it == m_Contexts.end())
+    {
+        lock.unlock();
+        OpenglRedirectorBase::glXDestroyContext(dpy, ctx);
+        return;
+    }
+    if (ctx != m_CurrentContext && it->second.isCurrent)
+    {
+        // GLX keeps context alive until it is made non-current by its thread (see glXMakeContextCurrent)
+        Logger::log("Context is current on another thread, it is released once made non-current: ", static_cast<void*>(ctx));
+        it->second.isDestroyed = true;
+        lock.unlock();
+        OpenglRedirectorBase::glXDestroyContext(dpy, ctx);
+        return;
+    }
+    lock.unlock();
+
+    Logger::log("Deinitializing for context: ", static_cast<void*>(ctx));
+    // Worker threads may still inject programs using context's profiles
+    m_ShaderManager.waitForBackgroundWork();
+    releaseContext(ctx);
+    OpenglRedirectorBase::glXDestroyContext(dpy, ctx);
 }
 
 void Dispatcher::glGenTextures(GLsizei n, GLuint* textures)
@@ -359,7 +679,7 @@ void Dispatcher::glGenTextures(GLsizei n, GLuint* textures)
     for (size_t i = 0; i < n; i++)
     {
         auto texture = std::make_shared<hi::trackers::TextureMetadata>(textures[i]);
-        m_Context.getTextureTracker().add(textures[i], texture);
+        m_Context->getTextureTracker().add(textures[i], texture);
     }
 }
 
@@ -369,32 +689,39 @@ void Dispatcher::glDeleteTextures(GLsizei n, const GLuint* textures)
 
     for (size_t i = 0; i < n; i++)
     {
-        m_Context.getTextureTracker().remove(textures[i]);
+        m_Context->getTextureTracker().remove(textures[i]);
     }
 }
 
 void Dispatcher::glTexImage1D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLint border, GLenum format, GLenum type, const GLvoid* pixels)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTexImage1D(target, level, internalFormat, width, border, format, type, pixels);
     auto finalFormat = hi::trackers::TextureTracker::isSizedFormat(internalFormat) ? hi::trackers::TextureTracker::convertToSizedFormat(format, type) : internalFormat;
-    m_Context.getTextureTracker().get(getCurrentID(hi::trackers::TextureTracker::getParameterForType(target)))->setStorage(target, width, 0, level, 0, finalFormat);
+    if (auto texture = getBoundTexture(target))
+        texture->setStorage(target, width, 0, level, 0, finalFormat);
 }
 void Dispatcher::glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
     auto finalFormat = hi::trackers::TextureTracker::isSizedFormat(internalFormat) ? hi::trackers::TextureTracker::convertToSizedFormat(format, type) : internalFormat;
-    m_Context.getTextureTracker().get(getCurrentID(hi::trackers::TextureTracker::getParameterForType(target)))->setStorage(target, width, height, level, 0, finalFormat);
+    if (auto texture = getBoundTexture(target))
+        texture->setStorage(target, width, height, level, 0, finalFormat);
 }
 
 void Dispatcher::glTexImage3D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
     auto finalFormat = hi::trackers::TextureTracker::isSizedFormat(internalformat) ? hi::trackers::TextureTracker::convertToSizedFormat(format, type) : internalformat;
-    m_Context.getTextureTracker().get(getCurrentID(hi::trackers::TextureTracker::getParameterForType(target)))->setStorage(target, width, height, level, 0, finalFormat);
+    if (auto texture = getBoundTexture(target))
+        texture->setStorage(target, width, height, level, 0, finalFormat);
 }
 
 void Dispatcher::glTexSubImage1D(GLenum target, GLint level, GLint xoffset, GLsizei width, GLenum format, GLenum type, const GLvoid* pixels)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTexSubImage1D(target, level, xoffset, width, format, type, pixels);
     if (xoffset > 0)
     {
@@ -402,11 +729,13 @@ void Dispatcher::glTexSubImage1D(GLenum target, GLint level, GLint xoffset, GLsi
         return;
     }
     auto finalFormat = hi::trackers::TextureTracker::convertToSizedFormat(format, type);
-    m_Context.getTextureTracker().get(getCurrentID(hi::trackers::TextureTracker::getParameterForType(target)))->setStorage(target, width, 0, level, 0, finalFormat);
+    if (auto texture = getBoundTexture(target))
+        texture->setStorage(target, width, 0, level, 0, finalFormat);
 }
 
 void Dispatcher::glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
     if (xoffset > 0 || yoffset > 0)
     {
@@ -414,11 +743,13 @@ void Dispatcher::glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLin
         return;
     }
     auto finalFormat = hi::trackers::TextureTracker::convertToSizedFormat(format, type);
-    m_Context.getTextureTracker().get(getCurrentID(hi::trackers::TextureTracker::getParameterForType(target)))->setStorage(target, width, height, level, 0, finalFormat);
+    if (auto texture = getBoundTexture(target))
+        texture->setStorage(target, width, height, level, 0, finalFormat);
 }
 
 void Dispatcher::glTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
     if (xoffset > 0 || yoffset > 0 || zoffset > 0)
     {
@@ -426,39 +757,49 @@ void Dispatcher::glTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLin
         return;
     }
     auto finalFormat = hi::trackers::TextureTracker::convertToSizedFormat(format, type);
-    m_Context.getTextureTracker().get(getCurrentID(hi::trackers::TextureTracker::getParameterForType(target)))->setStorage(target, width, height, level, depth, finalFormat);
+    if (auto texture = getBoundTexture(target))
+        texture->setStorage(target, width, height, level, depth, finalFormat);
 }
 
 void Dispatcher::glTexStorage1D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTexStorage1D(target, levels, internalformat, width);
-    m_Context.getTextureTracker().get(getCurrentID(hi::trackers::TextureTracker::getParameterForType(target)))->setStorage(target, width, 0, levels, 0, internalformat);
+    if (auto texture = getBoundTexture(target))
+        texture->setStorage(target, width, 0, levels, 0, internalformat);
 }
 void Dispatcher::glTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTexStorage2D(target, levels, internalformat, width, height);
-    m_Context.getTextureTracker().get(getCurrentID(hi::trackers::TextureTracker::getParameterForType(target)))->setStorage(target, width, height, levels, 0, internalformat);
+    if (auto texture = getBoundTexture(target))
+        texture->setStorage(target, width, height, levels, 0, internalformat);
 }
 void Dispatcher::glTexStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTexStorage3D(target, levels, internalformat, width, height, depth);
-    m_Context.getTextureTracker().get(getCurrentID(hi::trackers::TextureTracker::getParameterForType(target)))->setStorage(target, width, height, levels, depth, internalformat);
+    if (auto texture = getBoundTexture(target))
+        texture->setStorage(target, width, height, levels, depth, internalformat);
 }
 
 void Dispatcher::glTextureStorage1D(GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTextureStorage1D(texture, levels, internalformat, width);
-    m_Context.getTextureTracker().get(texture)->setStorage(GL_TEXTURE_1D, width, 0, levels, 0, internalformat);
+    m_Context->getTextureTracker().get(texture)->setStorage(GL_TEXTURE_1D, width, 0, levels, 0, internalformat);
 }
 void Dispatcher::glTextureStorage2D(GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTextureStorage2D(texture, levels, internalformat, width, height);
-    m_Context.getTextureTracker().get(texture)->setStorage(GL_TEXTURE_2D, width, height, levels, 0, internalformat);
+    m_Context->getTextureTracker().get(texture)->setStorage(GL_TEXTURE_2D, width, height, levels, 0, internalformat);
 }
 void Dispatcher::glTextureStorage3D(GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glTextureStorage3D(texture, levels, internalformat, width, height, depth);
-    m_Context.getTextureTracker().get(texture)->setStorage(GL_TEXTURE_3D, width, height, levels, depth, internalformat);
+    m_Context->getTextureTracker().get(texture)->setStorage(GL_TEXTURE_3D, width, height, levels, depth, internalformat);
 }
 
 void Dispatcher::glGenRenderbuffers(GLsizei n, GLuint* renderbuffers)
@@ -467,7 +808,7 @@ void Dispatcher::glGenRenderbuffers(GLsizei n, GLuint* renderbuffers)
 
     for (size_t i = 0; i < n; i++)
     {
-        m_Context.getRenderbufferTracker().add(renderbuffers[i], std::make_shared<hi::trackers::RenderbufferMetadata>(renderbuffers[i]));
+        m_Context->getRenderbufferTracker().add(renderbuffers[i], std::make_shared<hi::trackers::RenderbufferMetadata>(renderbuffers[i]));
     }
 }
 
@@ -476,16 +817,23 @@ void Dispatcher::glDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers)
     OpenglRedirectorBase::glDeleteRenderbuffers(n, renderbuffers);
     for (size_t i = 0; i < n; i++)
     {
-        m_Context.getRenderbufferTracker().remove(renderbuffers[i]);
+        m_Context->getRenderbufferTracker().remove(renderbuffers[i]);
     }
 }
 
+void Dispatcher::glBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    OpenglRedirectorBase::glBindRenderbuffer(target, renderbuffer);
+    m_Context->getRenderbufferTracker().bind(renderbuffer);
+}
+
 void Dispatcher::glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
 {
     OpenglRedirectorBase::glRenderbufferStorage(target, internalformat, width, height);
     // Fix internal format when transfering renderbuffer to texture
     //internalformat = (internalformat == GL_DEPTH_COMPONENT?GL_DEPTH_COMPONENT32:internalformat);
-    m_Context.getRenderbufferTracker().get(getCurrentID(GL_RENDERBUFFER_BINDING))->setStorage(target, width, height, 0, 0, internalformat);
+    if (auto renderbuffer = getBoundRenderbuffer())
+        renderbuffer->setStorage(target, width, height, 0, 0, internalformat);
 }
 
 void Dispatcher::glRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
@@ -493,19 +841,22 @@ void Dispatcher::glRenderbufferStorageMultisample(GLenum target, GLsizei samples
     OpenglRedirectorBase::glRenderbufferStorage(target, internalformat, width, height);
     // Fix internal format when transfering renderbuffer to texture
     //internalformat = (internalformat == GL_DEPTH_COMPONENT?GL_DEPTH_COMPONENT32:internalformat);
-    m_Context.getRenderbufferTracker().get(getCurrentID(GL_RENDERBUFFER_BINDING))->setStorage(target, width, height, 0, 0, internalformat);
+    if (auto renderbuffer = getBoundRenderbuffer())
+        renderbuffer->setStorage(target, width, height, 0, 0, internalformat);
 }
 
 void Dispatcher::glBindTexture(GLenum target, GLuint texture)
 {
-    m_Context.getTextureTracker().bind(target, texture);
+    // Recorded draw calls sample textures, which are bound when they are replayed
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    m_Context->getTextureTracker().bind(target, texture);
     auto fakeTextureId = texture;
 
-    if (m_Context.m_IsMultiviewActivated)
+    if (m_Context->m_IsMultiviewActivated)
     {
-        if (m_Context.getTextureTracker().has(texture) && m_Context.getTextureTracker().get(texture)->hasShadowTexture())
+        if (m_Context->getTextureTracker().has(texture) && m_Context->getTextureTracker().get(texture)->hasShadowTexture())
         {
-            fakeTextureId = m_Context.getTextureTracker().get(texture)->getTextureViewIdOfShadowedTexture();
+            fakeTextureId = m_Context->getTextureTracker().get(texture)->getTextureViewIdOfShadowedTexture();
         }
     }
     OpenglRedirectorBase::glBindTexture(target, fakeTextureId);
@@ -514,65 +865,214 @@ void Dispatcher::glBindTexture(GLenum target, GLuint texture)
 void Dispatcher::glActiveTexture(GLenum texture)
 {
     OpenglRedirectorBase::glActiveTexture(texture);
-    m_Context.getTextureTracker().activate(texture - GL_TEXTURE0);
+    m_Context->getTextureTracker().activate(texture - GL_TEXTURE0);
+}
+
+void Dispatcher::glBindTextures(GLuint first, GLsizei count, const GLuint* textures)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    auto& tracker = m_Context->getTextureTracker();
+    tracker.bindMultiple(first, count, textures);
+    if (!m_Context->m_IsMultiviewActivated || textures == nullptr)
+    {
+        OpenglRedirectorBase::glBindTextures(first, count, textures);
+        return;
+    }
+
+    // Replace shadowed textures with views, same as glBindTexture does
+    std::vector<GLuint> fakeTextures(textures, textures + count);
+    for (auto& texture : fakeTextures)
+    {
+        if (tracker.has(texture) && tracker.get(texture)->hasShadowTexture())
+        {
+            texture = tracker.get(texture)->getTextureViewIdOfShadowedTexture();
+        }
+    }
+    OpenglRedirectorBase::glBindTextures(first, count, fakeTextures.data());
 }
 
 GLuint Dispatcher::glCreateShader(GLenum shaderType)
 {
-    return m_ShaderManager.createShader(m_Context, shaderType);
+    return m_ShaderManager.createShader(*m_Context, shaderType);
 }
 
 void Dispatcher::glDeleteShader(GLuint shader)
 {
-    m_ShaderManager.deleteShader(m_Context, shader);
+    m_ShaderManager.deleteShader(*m_Context, shader);
 }
 
 void Dispatcher::glShaderSource(GLuint shaderId, GLsizei count, const GLchar* const* string, const GLint* length)
 {
-    m_ShaderManager.shaderSource(m_Context, shaderId, count, string, length);
+    m_ShaderManager.shaderSource(*m_Context, shaderId, count, string, length);
 }
 
 void Dispatcher::glLinkProgram(GLuint programId)
 {
-    m_ShaderManager.linkProgram(m_Context, programId);
+    m_ShaderManager.linkProgram(*m_Context, programId);
+    // Relinking bound program changes current rendering state => result is needed now
+    if (m_Context->getManager().hasBounded() && m_Context->getManager().getBoundId() == programId)
+    {
+        resolveProgramLink(programId);
+    }
+}
+
+void Dispatcher::resolveProgramLink(GLuint programId)
+{
+    if (!m_ShaderManager.resolveLink(*m_Context, programId))
+        return;
+    if (m_Context->m_IsPassThroughActive)
+    {
+        m_DrawManager->preparePassThroughProgram(*m_Context, programId);
+    }
+}
+
+void Dispatcher::glGetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+    // Don't block application, which polls for completion (KHR_parallel_shader_compile)
+    if (pname == GL_COMPLETION_STATUS_KHR && !m_ShaderManager.isLinkCompleted(*m_Context, program))
+    {
+        *params = GL_FALSE;
+        return;
+    }
+    resolveProgramLink(program);
+    OpenglRedirectorBase::glGetProgramiv(program, pname, params);
+}
+
+#define HI_DEFINE_PROGRAM_ENTRY_POINT(RETURN_TYPE, NAME, PARAMETERS, ARGUMENTS) \
+    RETURN_TYPE Dispatcher::NAME PARAMETERS                                      \
+    {                                                                            \
+        resolveProgramLink(program);                                             \
+        return OpenglRedirectorBase::NAME ARGUMENTS;                             \
+    }
+HI_PROGRAM_QUERY_ENTRY_POINTS(HI_DEFINE_PROGRAM_ENTRY_POINT)
+#undef HI_DEFINE_PROGRAM_ENTRY_POINT
+
+#define HI_DEFINE_PROGRAM_UNIFORM_ENTRY_POINT(RETURN_TYPE, NAME, PARAMETERS, ARGUMENTS) \
+    RETURN_TYPE Dispatcher::NAME PARAMETERS                                              \
+    {                                                                                    \
+        resolveProgramLink(program);                                                     \
+        OpenglRedirectorBase::NAME ARGUMENTS;                                            \
+        trackUniform ARGUMENTS;                                                          \
+    }
+HI_PROGRAM_UNIFORM_ENTRY_POINTS(HI_DEFINE_PROGRAM_UNIFORM_ENTRY_POINT)
+#undef HI_DEFINE_PROGRAM_UNIFORM_ENTRY_POINT
+
+// Prepend bound program to arguments of glUniform*
+#define HI_BOUND_PROGRAM_ARGUMENTS(...) (m_Context->getManager().getBoundId(), __VA_ARGS__)
+#define HI_DEFINE_UNIFORM_ENTRY_POINT(RETURN_TYPE, NAME, PARAMETERS, ARGUMENTS) \
+    RETURN_TYPE Dispatcher::NAME PARAMETERS                                      \
+    {                                                                            \
+        OpenglRedirectorBase::NAME ARGUMENTS;                                    \
+        trackUniform HI_BOUND_PROGRAM_ARGUMENTS ARGUMENTS;                       \
+    }
+HI_UNIFORM_ENTRY_POINTS(HI_DEFINE_UNIFORM_ENTRY_POINT)
+#undef HI_DEFINE_UNIFORM_ENTRY_POINT
+#undef HI_BOUND_PROGRAM_ARGUMENTS
+
+void Dispatcher::trackUniform(GLuint program, GLint location, GLint v0)
+{
+    trackUniform(program, location, 1, &v0);
+}
+
+void Dispatcher::trackUniform(GLuint program, GLint location, GLsizei count, const GLint* value)
+{
+    // Note: ivec2-4 uniforms share signature, but never share location with sampler
+    if (!m_Context->getManager().has(program))
+        return;
+    auto record = m_Context->getManager().get(program);
+    record->m_UniformEpoch++;
+    if (value != nullptr)
+        record->setSamplerUnits(location, count, value);
+}
+
+void Dispatcher::touchUniforms(GLuint program)
+{
+    if (m_Context->getManager().has(program))
+        m_Context->getManager().get(program)->m_UniformEpoch++;
+}
+
+void Dispatcher::glBindAttribLocation(GLuint program, GLuint index, const GLchar* name)
+{
+    OpenglRedirectorBase::glBindAttribLocation(program, index, name);
+    if (!m_Context->getManager().has(program) || name == nullptr)
+        return;
+    m_Context->getManager().get(program)->m_PreLinkState.attributeLocations[name] = index;
+}
+
+void Dispatcher::glBindFragDataLocation(GLuint program, GLuint color, const GLchar* name)
+{
+    OpenglRedirectorBase::glBindFragDataLocation(program, color, name);
+    if (!m_Context->getManager().has(program) || name == nullptr)
+        return;
+    m_Context->getManager().get(program)->m_PreLinkState.fragmentDataLocations[name] = { color, 0 };
+}
+
+void Dispatcher::glBindFragDataLocationIndexed(GLuint program, GLuint colorNumber, GLuint index, const GLchar* name)
+{
+    OpenglRedirectorBase::glBindFragDataLocationIndexed(program, colorNumber, index, name);
+    if (!m_Context->getManager().has(program) || name == nullptr)
+        return;
+    m_Context->getManager().get(program)->m_PreLinkState.fragmentDataLocations[name] = { colorNumber, index };
+}
+
+void Dispatcher::glTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum bufferMode)
+{
+    OpenglRedirectorBase::glTransformFeedbackVaryings(program, count, varyings, bufferMode);
+    if (!m_Context->getManager().has(program))
+        return;
+    auto& state = m_Context->getManager().get(program)->m_PreLinkState;
+    state.feedbackVaryings.assign(varyings, varyings + std::max(count, 0));
+    state.feedbackBufferMode = bufferMode;
+}
+
+void Dispatcher::glProgramParameteri(GLuint program, GLenum pname, GLint value)
+{
+    OpenglRedirectorBase::glProgramParameteri(program, pname, value);
+    if (pname != GL_PROGRAM_SEPARABLE || !m_Context->getManager().has(program))
+        return;
+    m_Context->getManager().get(program)->m_PreLinkState.isSeparable = (value != GL_FALSE);
 }
 
 void Dispatcher::glCompileShader(GLuint shader)
 {
-    m_ShaderManager.compileShader(m_Context, shader);
+    m_ShaderManager.compileShader(*m_Context, shader);
 }
 
 void Dispatcher::glAttachShader(GLuint program, GLuint shader)
 {
-    m_ShaderManager.attachShader(m_Context, program, shader);
+    m_ShaderManager.attachShader(*m_Context, program, shader);
 }
 
 GLuint Dispatcher::glCreateProgram(void)
 {
-    return m_ShaderManager.createProgram(m_Context);
+    return m_ShaderManager.createProgram(*m_Context);
 }
 
 void Dispatcher::glDeleteProgram(GLuint program)
 {
-    return m_ShaderManager.deleteProgram(m_Context, program);
+    // Recorded draw calls may use program
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    return m_ShaderManager.deleteProgram(*m_Context, program);
 }
 
 void Dispatcher::glUseProgram(GLuint program)
 {
-    m_ShaderManager.useProgram(m_Context, program);
+    resolveProgramLink(program);
+    m_ShaderManager.useProgram(*m_Context, program);
 }
 
 void Dispatcher::glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
 {
     OpenglRedirectorBase::glUniformMatrix4fv(location, count, transpose, value);
+    touchUniforms(m_Context->getManager().getBoundId());
 
     // get current's program transformation matrix name
-    if (!m_Context.getManager().hasBounded())
+    if (!m_Context->getManager().hasBounded())
     {
-        Logger::logDebugPerFrame("glUniformMatrix4fv called without bound program!", HI_POS);
+        Logger::logDebugPerFrame(HI_LITERAL("glUniformMatrix4fv called without bound program!"), HI_POS);
         return;
     }
-    auto program = m_Context.getManager().getBound();
+    auto program = m_Context->getManager().getBound();
     if (!program->isInjected())
         return;
     auto metaData = program->m_Metadata.get();
@@ -580,12 +1080,12 @@ void Dispatcher::glUniformMatrix4fv(GLint location, GLsizei count, GLboolean tra
     if (!metaData->hasDetectedTransformation())
         return;
 
-    auto programID = m_Context.getManager().getBoundId();
-    // get original MVP matrix location
-    auto originalLocation = OpenglRedirectorBase::glGetUniformLocation(programID, metaData->m_TransformationMatrixName.c_str());
+    auto programID = m_Context->getManager().getBoundId();
+    // get original MVP matrix location (cached after link)
+    auto originalLocation = program->m_InjectorUniforms.transformationMatrix;
 
     // if the matrix being uploaded isn't detected MVP, then continue
-    if (originalLocation != location)
+    if (originalLocation == -1 || originalLocation != location)
         return;
 
     // estimate projection matrix from value
@@ -593,23 +1093,26 @@ void Dispatcher::glUniformMatrix4fv(GLint location, GLsizei count, GLboolean tra
     auto estimatedParameters = hi::pipeline::estimatePerspectiveProjection(mat);
 
     auto& ep = estimatedParameters;
-    Logger::logDebugPerFrame("estimating parameters from uniform matrix");
+    Logger::logDebugPerFrame(HI_LITERAL("estimating parameters from uniform matrix"));
     Logger::logDebugPerFrame("parameters: fx(", ep.fx, ") fy(", ep.fy, ") near (", ep.nearPlane, ") far (", ep.farPlane, ") isPerspective (", ep.isPerspective, ")");
 
-    m_DrawManager.setInjectorDecodedProjection(m_Context, programID, estimatedParameters);
+    m_DrawManager->setInjectorDecodedProjection(*m_Context, programID, estimatedParameters);
 }
 
 void Dispatcher::glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
 {
+    // Viewport & scissor are not recorded (see DeferredReplay)
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glViewport(x, y, width, height);
-    m_Context.getCurrentViewport().set(x, y, width, height);
-    m_Context.getCameras().updateViewports(m_Context.getCurrentViewport());
+    m_Context->getCurrentViewport().set(x, y, width, height);
+    m_Context->getCameras().updateViewports(m_Context->getCurrentViewport());
 }
 
 void Dispatcher::glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glScissor(x, y, width, height);
-    m_Context.getCurrentScissorArea().set(x, y, width, height);
+    m_Context->getCurrentScissorArea().set(x, y, width, height);
 }
 
 //-----------------------------------------------------------------------------
@@ -618,45 +1121,55 @@ void Dispatcher::glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
 
 void Dispatcher::glDrawArrays(GLenum mode, GLint first, GLsizei count)
 {
-    m_DrawManager.draw(m_Context, [&]() { OpenglRedirectorBase::glDrawArrays(mode, first, count); });
+    m_DrawManager->draw(*m_Context, [=]() { OpenglRedirectorBase::glDrawArrays(mode, first, count); },
+        [=](GLsizei views) { OpenglRedirectorBase::glDrawArraysInstanced(mode, first, count, views); }, mode);
 }
 
 void Dispatcher::glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
 {
-    m_DrawManager.draw(m_Context, [&]() { OpenglRedirectorBase::glDrawArraysInstanced(mode, first, count, instancecount); });
+    m_DrawManager->draw(*m_Context, [=]() { OpenglRedirectorBase::glDrawArraysInstanced(mode, first, count, instancecount); },
+        [=](GLsizei views) { OpenglRedirectorBase::glDrawArraysInstanced(mode, first, count, instancecount * views); }, mode);
 }
 
 void Dispatcher::glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
 {
-    m_DrawManager.draw(m_Context, [&]() { OpenglRedirectorBase::glDrawElements(mode, count, type, indices); });
+    m_DrawManager->draw(*m_Context, [=]() { OpenglRedirectorBase::glDrawElements(mode, count, type, indices); },
+        [=](GLsizei views) { OpenglRedirectorBase::glDrawElementsInstanced(mode, count, type, indices, views); }, mode);
 }
 
 void Dispatcher::glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount)
 {
-    m_DrawManager.draw(m_Context, [&]() { OpenglRedirectorBase::glDrawElementsInstanced(mode, count, type, indices, instancecount); });
+    m_DrawManager->draw(*m_Context, [=]() { OpenglRedirectorBase::glDrawElementsInstanced(mode, count, type, indices, instancecount); },
+        [=](GLsizei views) { OpenglRedirectorBase::glDrawElementsInstanced(mode, count, type, indices, instancecount * views); }, mode);
 }
 
 void Dispatcher::glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void* indices)
 {
-    m_DrawManager.draw(m_Context, [&]() { OpenglRedirectorBase::glDrawRangeElements(mode, start, end, count, type, indices); });
+    m_DrawManager->draw(*m_Context, [=]() { OpenglRedirectorBase::glDrawRangeElements(mode, start, end, count, type, indices); },
+        [=](GLsizei views) { OpenglRedirectorBase::glDrawElementsInstanced(mode, count, type, indices, views); }, mode);
 }
 
 void Dispatcher::glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex)
 {
-    m_DrawManager.draw(m_Context, [&]() { OpenglRedirectorBase::glDrawElementsBaseVertex(mode, count, type, indices, basevertex); });
+    m_DrawManager->draw(*m_Context, [=]() { OpenglRedirectorBase::glDrawElementsBaseVertex(mode, count, type, indices, basevertex); },
+        [=](GLsizei views) { OpenglRedirectorBase::glDrawElementsInstancedBaseVertex(mode, count, type, indices, views, basevertex); }, mode);
 }
 void Dispatcher::glDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void* indices, GLint basevertex)
 {
-    m_DrawManager.draw(m_Context, [&]() { OpenglRedirectorBase::glDrawRangeElementsBaseVertex(mode, start, end, count, type, indices, basevertex); });
+    m_DrawManager->draw(*m_Context, [=]() { OpenglRedirectorBase::glDrawRangeElementsBaseVertex(mode, start, end, count, type, indices, basevertex); },
+        [=](GLsizei views) { OpenglRedirectorBase::glDrawElementsInstancedBaseVertex(mode, count, type, indices, views, basevertex); }, mode);
 }
 void Dispatcher::glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex)
 {
-    m_DrawManager.draw(m_Context, [&]() { OpenglRedirectorBase::glDrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex); });
+    m_DrawManager->draw(*m_Context, [=]() { OpenglRedirectorBase::glDrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex); },
+        [=](GLsizei views) { OpenglRedirectorBase::glDrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount * views, basevertex); }, mode);
 }
 
 void Dispatcher::glMultiDrawElementsBaseVertex(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei drawcount, const GLint* basevertex)
 {
-    m_DrawManager.draw(m_Context, [&]() { OpenglRedirectorBase::glMultiDrawElementsBaseVertex(mode, count, type, indices, drawcount, basevertex); });
+    m_DrawManager->draw(*m_Context, [=]() { OpenglRedirectorBase::glMultiDrawElementsBaseVertex(mode, count, type, indices, drawcount, basevertex); }, nullptr, mode);
+    // Arrays of draw call are only valid during the call
+    m_DrawManager->flushDeferredDraws(*m_Context);
 }
 
 // ----------------------------------------------------------------------------
@@ -667,60 +1180,64 @@ void Dispatcher::glGenFramebuffers(GLsizei n, GLuint* framebuffers)
     for (size_t i = 0; i < n; i++)
     {
         auto fbo = std::make_shared<hi::trackers::FramebufferMetadata>(framebuffers[i]);
-        m_Context.getFBOTracker().add(framebuffers[i], fbo);
+        m_Context->getFBOTracker().add(framebuffers[i], fbo);
     }
 }
 
 void Dispatcher::glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glDeleteFramebuffers(n, framebuffers);
     for (size_t i = 0; i < n; i++)
     {
-        m_Context.getFBOTracker().remove(framebuffers[i]);
+        m_Context->getFBOTracker().remove(framebuffers[i]);
     }
 }
 
 void Dispatcher::glBindFramebuffer(GLenum target, GLuint framebuffer)
 {
-    m_FramebufferManager.bindFramebuffer(m_Context, target, framebuffer);
+    // Recorded draw calls target previously bound FBO
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    m_FramebufferManager.bindFramebuffer(*m_Context, target, framebuffer);
 }
 
 void Dispatcher::glFramebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level)
 {
     OpenglRedirectorBase::glFramebufferTexture(target, attachment, texture, level);
 
-    assert(m_Context.getTextureTracker().has(texture));
-    m_Context.getFBOTracker().getBound()->attach(attachment, m_Context.getTextureTracker().get(texture));
+    assert(m_Context->getTextureTracker().has(texture));
+    m_Context->getFBOTracker().getBound()->attach(attachment, m_Context->getTextureTracker().get(texture));
 }
 
 void Dispatcher::glFramebufferTexture1D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
 {
     OpenglRedirectorBase::glFramebufferTexture1D(target, attachment, textarget, texture, level);
-    m_Context.getFBOTracker().getBound()->attach(attachment, m_Context.getTextureTracker().get(texture), attachment);
+    m_Context->getFBOTracker().getBound()->attach(attachment, m_Context->getTextureTracker().get(texture), attachment);
 }
 void Dispatcher::glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
 {
     OpenglRedirectorBase::glFramebufferTexture2D(target, attachment, textarget, texture, level);
-    m_Context.getFBOTracker().getBound()->attach(attachment, m_Context.getTextureTracker().get(texture), attachment);
+    m_Context->getFBOTracker().getBound()->attach(attachment, m_Context->getTextureTracker().get(texture), attachment);
 }
 void Dispatcher::glFramebufferTexture3D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLint zoffset)
 {
     OpenglRedirectorBase::glFramebufferTexture3D(target, attachment, textarget, texture, level, zoffset);
-    m_Context.getFBOTracker().getBound()->attach(attachment, m_Context.getTextureTracker().get(texture), attachment);
+    m_Context->getFBOTracker().getBound()->attach(attachment, m_Context->getTextureTracker().get(texture), attachment);
 }
 
 void Dispatcher::glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
 {
     OpenglRedirectorBase::glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
-    m_Context.getFBOTracker().getBound()->attach(attachment, m_Context.getRenderbufferTracker().get(renderbuffer), attachment);
+    m_Context->getFBOTracker().getBound()->attach(attachment, m_Context->getRenderbufferTracker().get(renderbuffer), attachment);
 }
 // ----------------------------------------------------------------------------
 GLuint Dispatcher::glGetUniformBlockIndex(GLuint program, const GLchar* uniformBlockName)
 {
+    resolveProgramLink(program);
     auto result = OpenglRedirectorBase::glGetUniformBlockIndex(program, uniformBlockName);
-    if (!m_Context.getManager().has(program))
+    if (!m_Context->getManager().has(program))
         return result;
-    auto record = m_Context.getManager().get(program);
+    auto record = m_Context->getManager().get(program);
     if (record->m_UniformBlocks.count(uniformBlockName) == 0)
     {
         hi::trackers::ShaderProgram::UniformBlock block;
@@ -732,10 +1249,11 @@ GLuint Dispatcher::glGetUniformBlockIndex(GLuint program, const GLchar* uniformB
 
 void Dispatcher::glDrawBuffers(GLsizei n, const GLenum* bufs)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glDrawBuffers(n, bufs);
-    if (m_Context.getFBOTracker().hasBounded())
+    if (m_Context->getFBOTracker().hasBounded())
     {
-        auto fbo = m_Context.getFBOTracker().getBound();
+        auto fbo = m_Context->getFBOTracker().getBound();
         std::vector<GLenum> buffers;
         buffers.assign(bufs, bufs + n);
         fbo->setDrawBuffers(buffers);
@@ -745,11 +1263,12 @@ void Dispatcher::glDrawBuffers(GLsizei n, const GLenum* bufs)
 void Dispatcher::glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
 {
     OpenglRedirectorBase::glUniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding);
-    if (!m_Context.getManager().has(program))
+    if (!m_Context->getManager().has(program))
         return;
 
-    auto record = m_Context.getManager().get(program);
+    auto record = m_Context->getManager().get(program);
     record->updateUniformBlock(uniformBlockIndex, uniformBlockBinding);
+    record->m_UniformEpoch++;
 
     // Add binding index's transformation metadata
     if (record->m_Metadata)
@@ -760,7 +1279,7 @@ void Dispatcher::glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex,
             auto& block = record->m_UniformBlocks[desc->m_InterfaceBlockName];
             if (OpenglRedirectorBase::glGetUniformBlockIndex(program, desc->m_InterfaceBlockName.c_str()) == uniformBlockIndex)
             {
-                auto& index = m_Context.getUniformBlocksTracker().getBindingIndex(block.bindingIndex);
+                auto& index = m_Context->getUniformBlocksTracker().getBindingIndex(block.bindingIndex);
 
                 std::array<const GLchar*, 1> uniformList = { desc->m_TransformationMatrixName.c_str() };
                 std::array<GLuint, 1> resultIndex;
@@ -775,61 +1294,85 @@ void Dispatcher::glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex,
     }
 }
 
+void Dispatcher::glBindBuffer(GLenum target, GLuint buffer)
+{
+    OpenglRedirectorBase::glBindBuffer(target, buffer);
+    m_Context->getStateTracker().bindBuffer(target, buffer);
+}
+
+void Dispatcher::glDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    OpenglRedirectorBase::glDeleteBuffers(n, buffers);
+    for (GLsizei i = 0; i < n; i++)
+    {
+        m_Context->getStateTracker().deleteBuffer(buffers[i]);
+    }
+}
+
 void Dispatcher::glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
 {
+    // Indexed bindings (e.g. application's uniform blocks) are not recorded
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glBindBufferRange(target, index, buffer, offset, size);
+    // Indexed binding also binds buffer to generic binding point
+    m_Context->getStateTracker().bindBuffer(target, buffer);
     if (target == GL_UNIFORM_BUFFER)
-        m_Context.getUniformBlocksTracker().setUniformBinding(buffer, index);
+        m_Context->getUniformBlocksTracker().setUniformBinding(buffer, index);
 }
 void Dispatcher::glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glBindBufferBase(target, index, buffer);
+    m_Context->getStateTracker().bindBuffer(target, buffer);
     if (target == GL_UNIFORM_BUFFER)
-        m_Context.getUniformBlocksTracker().setUniformBinding(buffer, index);
+        m_Context->getUniformBlocksTracker().setUniformBinding(buffer, index);
 }
 
 void Dispatcher::glBindBuffersBase(GLenum target, GLuint first, GLsizei count, const GLuint* buffers)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glBindBuffersBase(target, first, count, buffers);
 
     if (target == GL_UNIFORM_BUFFER)
     {
         for (size_t i = 0; i < count; i++)
         {
-            m_Context.getUniformBlocksTracker().setUniformBinding(buffers[i], first + i);
+            m_Context->getUniformBlocksTracker().setUniformBinding(buffers[i], first + i);
         }
     }
 }
 
 void Dispatcher::glBindBuffersRange(GLenum target, GLuint first, GLsizei count, const GLuint* buffers, const GLintptr* offsets, const GLsizeiptr* sizes)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glBindBuffersRange(target, first, count, buffers, offsets, sizes);
 
     if (target == GL_UNIFORM_BUFFER)
     {
         for (size_t i = 0; i < count; i++)
         {
-            m_Context.getUniformBlocksTracker().setUniformBinding(buffers[i], first + i);
+            m_Context->getUniformBlocksTracker().setUniformBinding(buffers[i], first + i);
         }
     }
 }
 
 void Dispatcher::glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glBufferData(target, size, data, usage);
 
     if (target != GL_UNIFORM_BUFFER)
         return;
 
-    GLint bufferID = getCurrentID(GL_UNIFORM_BUFFER_BINDING);
-    if (!m_Context.getUniformBlocksTracker().hasBufferBindingIndex(bufferID))
+    const auto bufferID = m_Context->getStateTracker().getBoundBuffer(GL_UNIFORM_BUFFER);
+    if (!m_Context->getUniformBlocksTracker().hasBufferBindingIndex(bufferID))
         return;
-    auto index = m_Context.getUniformBlocksTracker().getBufferBindingIndex(bufferID);
-    auto& metadata = m_Context.getUniformBlocksTracker().getBindingIndex(index);
+    auto index = m_Context->getUniformBlocksTracker().getBufferBindingIndex(bufferID);
+    auto& metadata = m_Context->getUniformBlocksTracker().getBindingIndex(index);
     if (metadata.transformationOffset == -1)
     {
         // Find a program whose uniform iterface contains transformation matrix
-        for (auto& [programID, program] : m_Context.getManager().getMap())
+        for (auto& [programID, program] : m_Context->getManager().getMap())
         {
             auto& blocks = program->m_UniformBlocks;
 
@@ -868,7 +1411,7 @@ void Dispatcher::glBufferData(GLenum target, GLsizeiptr size, const void* data,
             std::memcpy(glm::value_ptr(metadata.transformation), static_cast<const std::byte*>(data) + metadata.transformationOffset, sizeof(float) * 16);
             auto estimatedParameters = hi::pipeline::estimatePerspectiveProjection(metadata.transformation);
 
-            Logger::logDebugPerFrame("estimating parameters from UBO");
+            Logger::logDebugPerFrame(HI_LITERAL("estimating parameters from UBO"));
 
             auto& ep = estimatedParameters;
             Logger::logDebugPerFrame("parameters: fx(", ep.fx, ") fy(", ep.fy, ") near (", ep.nearPlane, ") far (", ep.farPlane, ") isPerspective (", ep.isPerspective, ")");
@@ -881,24 +1424,24 @@ void Dispatcher::glBufferData(GLenum target, GLsizeiptr size, const void* data,
 }
 void Dispatcher::glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
 {
+    m_DrawManager->flushDeferredDraws(*m_Context);
     OpenglRedirectorBase::glBufferSubData(target, offset, size, data);
 
     if (target != GL_UNIFORM_BUFFER)
         return;
 
-    GLint bufferID = 0;
-    OpenglRedirectorBase::glGetIntegerv(GL_UNIFORM_BUFFER_BINDING, &bufferID);
-    if (!m_Context.getUniformBlocksTracker().hasBufferBindingIndex(bufferID))
+    const auto bufferID = m_Context->getStateTracker().getBoundBuffer(GL_UNIFORM_BUFFER);
+    if (!m_Context->getUniformBlocksTracker().hasBufferBindingIndex(bufferID))
         return;
-    auto index = m_Context.getUniformBlocksTracker().getBufferBindingIndex(bufferID);
-    auto& metadata = m_Context.getUniformBlocksTracker().getBindingIndex(index);
+    auto index = m_Context->getUniformBlocksTracker().getBufferBindingIndex(bufferID);
+    auto& metadata = m_Context->getUniformBlocksTracker().getBindingIndex(index);
     if (metadata.transformationOffset != -1 && offset <= metadata.transformationOffset)
     {
         if (offset + size >= metadata.transformationOffset + sizeof(float) * 16)
         {
             std::memcpy(glm::value_ptr(metadata.transformation), static_cast<const std::byte*>(data) + metadata.transformationOffset, sizeof(float) * 16);
             auto estimatedParameters = hi::pipeline::estimatePerspectiveProjection(metadata.transformation);
-            Logger::logDebugPerFrame("estimating parameters from UBO");
+            Logger::logDebugPerFrame(HI_LITERAL("estimating parameters from UBO"));
             auto& ep = estimatedParameters;
             Logger::logDebugPerFrame("parameters: fx(", ep.fx, ") fy(", ep.fy, ") near (", ep.nearPlane, ") near(", ep.farPlane, ")");
 
@@ -908,30 +1451,171 @@ void Dispatcher::glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size
     }
 }
 
+void* Dispatcher::glMapBuffer(GLenum target, GLenum access)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    return OpenglRedirectorBase::glMapBuffer(target, access);
+}
+
+void* Dispatcher::glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    return OpenglRedirectorBase::glMapBufferRange(target, offset, length, access);
+}
+
+void* Dispatcher::glMapNamedBuffer(GLuint buffer, GLenum access)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    return OpenglRedirectorBase::glMapNamedBuffer(buffer, access);
+}
+
+void* Dispatcher::glMapNamedBufferRange(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    return OpenglRedirectorBase::glMapNamedBufferRange(buffer, offset, length, access);
+}
+
+void Dispatcher::glNamedBufferData(GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glNamedBufferData(buffer, size, data, usage);
+}
+
+void Dispatcher::glNamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glNamedBufferSubData(buffer, offset, size, data);
+}
+
+void Dispatcher::glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+}
+
+void Dispatcher::glCopyNamedBufferSubData(GLuint readBuffer, GLuint writeBuffer, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glCopyNamedBufferSubData(readBuffer, writeBuffer, readOffset, writeOffset, size);
+}
+
+void Dispatcher::glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+}
+
+void Dispatcher::glBlitNamedFramebuffer(GLuint readFramebuffer, GLuint drawFramebuffer, GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glBlitNamedFramebuffer(readFramebuffer, drawFramebuffer, srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+}
+
+void Dispatcher::glGenerateMipmap(GLenum target)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glGenerateMipmap(target);
+}
+
+void Dispatcher::glGenerateTextureMipmap(GLuint texture)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glGenerateTextureMipmap(texture);
+}
+
+void Dispatcher::glEnable(GLenum cap)
+{
+    // Capabilities are not recorded (see DeferredReplay)
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glEnable(cap);
+    m_Context->getStateTracker().setCapability(cap, true);
+    m_Context->getLegacyTracker().setCapability(cap, true, m_Context->getTextureTracker().getTextureUnits().getActiveUnit());
+}
+
+void Dispatcher::glDisable(GLenum cap)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glDisable(cap);
+    m_Context->getStateTracker().setCapability(cap, false);
+    m_Context->getLegacyTracker().setCapability(cap, false, m_Context->getTextureTracker().getTextureUnits().getActiveUnit());
+}
+
+void Dispatcher::glEnablei(GLenum target, GLuint index)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glEnablei(target, index);
+    m_Context->getStateTracker().setCapability(target, index, true);
+}
+
+void Dispatcher::glDisablei(GLenum target, GLuint index)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glDisablei(target, index);
+    m_Context->getStateTracker().setCapability(target, index, false);
+}
+
+void Dispatcher::glBindVertexArray(GLuint array)
+{
+    OpenglRedirectorBase::glBindVertexArray(array);
+    m_Context->getStateTracker().bindVertexArray(array);
+}
+
+void Dispatcher::glDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    // Recorded draw calls may use VAO
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glDeleteVertexArrays(n, arrays);
+    for (GLsizei i = 0; i < n; i++)
+    {
+        m_Context->getStateTracker().deleteVertexArray(arrays[i]);
+    }
+}
+
+void Dispatcher::glVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    OpenglRedirectorBase::glVertexAttribDivisor(index, divisor);
+    // Attribute divisor also sets divisor of binding with the same index
+    auto& state = m_Context->getStateTracker();
+    state.setBindingDivisor(state.getBoundVertexArray(), index, divisor);
+}
+
+void Dispatcher::glVertexBindingDivisor(GLuint bindingindex, GLuint divisor)
+{
+    OpenglRedirectorBase::glVertexBindingDivisor(bindingindex, divisor);
+    auto& state = m_Context->getStateTracker();
+    state.setBindingDivisor(state.getBoundVertexArray(), bindingindex, divisor);
+}
+
+void Dispatcher::glVertexArrayBindingDivisor(GLuint vaobj, GLuint bindingindex, GLuint divisor)
+{
+    OpenglRedirectorBase::glVertexArrayBindingDivisor(vaobj, bindingindex, divisor);
+    m_Context->getStateTracker().setBindingDivisor(vaobj, bindingindex, divisor);
+}
+
 // ----------------------------------------------------------------------------
 void Dispatcher::glMatrixMode(GLenum mode)
 {
     OpenglRedirectorBase::glMatrixMode(mode);
-    m_Context.getLegacyTracker().matrixMode(mode);
+    m_Context->getLegacyTracker().matrixMode(mode);
     //Logger::log("glMatrixMode ", hi::opengl_utils::getEnumStringRepresentation(mode).c_str());
 }
 void Dispatcher::glLoadMatrixd(const GLdouble* m)
 {
     OpenglRedirectorBase::glLoadMatrixd(m);
-    if (m_Context.getLegacyTracker().getMatrixMode() == GL_PROJECTION)
+    if (m_Context->getLegacyTracker().getMatrixMode() == GL_PROJECTION)
     {
         const auto result = opengl_utils::createMatrixFromRawGL(m);
-        m_Context.getLegacyTracker().loadMatrix(std::move(result));
+        m_Context->getLegacyTracker().loadMatrix(std::move(result));
     }
     //helper::dumpOpenglMatrix(m);
 }
 void Dispatcher::glLoadMatrixf(const GLfloat* m)
 {
     OpenglRedirectorBase::glLoadMatrixf(m);
-    if (m_Context.getLegacyTracker().getMatrixMode() == GL_PROJECTION)
+    if (m_Context->getLegacyTracker().getMatrixMode() == GL_PROJECTION)
     {
         const auto result = opengl_utils::createMatrixFromRawGL(m);
-        m_Context.getLegacyTracker().loadMatrix(std::move(result));
+        m_Context->getLegacyTracker().loadMatrix(std::move(result));
     }
     //helper::dumpOpenglMatrix(m);
 }
@@ -939,76 +1623,357 @@ void Dispatcher::glLoadMatrixf(const GLfloat* m)
 void Dispatcher::glLoadIdentity(void)
 {
     OpenglRedirectorBase::glLoadIdentity();
-    if (m_Context.getLegacyTracker().getMatrixMode() == GL_PROJECTION)
+    if (m_Context->getLegacyTracker().getMatrixMode() == GL_PROJECTION)
     {
         glm::mat4 identity = glm::mat4(1.0);
-        m_Context.getLegacyTracker().loadMatrix(std::move(identity));
+        m_Context->getLegacyTracker().loadMatrix(std::move(identity));
     }
 }
 
 void Dispatcher::glMultMatrixd(const GLdouble* m)
 {
     OpenglRedirectorBase::glMultMatrixd(m);
-    if (m_Context.getLegacyTracker().getMatrixMode() == GL_PROJECTION)
+    if (m_Context->getLegacyTracker().getMatrixMode() == GL_PROJECTION)
     {
         const auto result = opengl_utils::createMatrixFromRawGL(m);
-        m_Context.getLegacyTracker().loadMatrix(std::move(result));
+        m_Context->getLegacyTracker().loadMatrix(std::move(result));
     }
 }
 
 void Dispatcher::glMultMatrixf(const GLfloat* m)
 {
     OpenglRedirectorBase::glMultMatrixf(m);
-    if (m_Context.getLegacyTracker().getMatrixMode() == GL_PROJECTION)
+    if (m_Context->getLegacyTracker().getMatrixMode() == GL_PROJECTION)
     {
         const auto result = opengl_utils::createMatrixFromRawGL(m);
-        m_Context.getLegacyTracker().loadMatrix(std::move(result));
+        m_Context->getLegacyTracker().loadMatrix(std::move(result));
     }
 }
 
 void Dispatcher::glOrtho(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble near_val, GLdouble far_val)
 {
     OpenglRedirectorBase::glOrtho(left, right, bottom, top, near_val, far_val);
-    m_Context.getLegacyTracker().multMatrix(glm::ortho(left, right, bottom, top, near_val, far_val));
+    m_Context->getLegacyTracker().multMatrix(glm::ortho(left, right, bottom, top, near_val, far_val));
 }
 
 void Dispatcher::glFrustum(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble near_val, GLdouble far_val)
 {
     OpenglRedirectorBase::glFrustum(left, right, bottom, top, near_val, far_val);
-    m_Context.getLegacyTracker().multMatrix(glm::frustum(left, right, bottom, top, near_val, far_val));
+    m_Context->getLegacyTracker().multMatrix(glm::frustum(left, right, bottom, top, near_val, far_val));
+}
+
+void Dispatcher::glAlphaFunc(GLenum func, GLclampf ref)
+{
+    OpenglRedirectorBase::glAlphaFunc(func, ref);
+    m_Context->getLegacyTracker().alphaFunc(func, ref);
+}
+
+void Dispatcher::glFogf(GLenum pname, GLfloat param)
+{
+    OpenglRedirectorBase::glFogf(pname, param);
+    if (pname == GL_FOG_MODE)
+        m_Context->getLegacyTracker().fogMode(static_cast<GLenum>(param));
+}
+
+void Dispatcher::glFogi(GLenum pname, GLint param)
+{
+    OpenglRedirectorBase::glFogi(pname, param);
+    if (pname == GL_FOG_MODE)
+        m_Context->getLegacyTracker().fogMode(static_cast<GLenum>(param));
+}
+
+void Dispatcher::glFogfv(GLenum pname, const GLfloat* params)
+{
+    OpenglRedirectorBase::glFogfv(pname, params);
+    if (pname == GL_FOG_MODE)
+        m_Context->getLegacyTracker().fogMode(static_cast<GLenum>(params[0]));
+}
+
+void Dispatcher::glFogiv(GLenum pname, const GLint* params)
+{
+    OpenglRedirectorBase::glFogiv(pname, params);
+    if (pname == GL_FOG_MODE)
+        m_Context->getLegacyTracker().fogMode(static_cast<GLenum>(params[0]));
+}
+
+void Dispatcher::glTexEnvf(GLenum target, GLenum pname, GLfloat param)
+{
+    OpenglRedirectorBase::glTexEnvf(target, pname, param);
+    if (target == GL_TEXTURE_ENV && pname == GL_TEXTURE_ENV_MODE)
+        m_Context->getLegacyTracker().textureEnvMode(static_cast<GLenum>(param), m_Context->getTextureTracker().getTextureUnits().getActiveUnit());
+}
+
+void Dispatcher::glTexEnvi(GLenum target, GLenum pname, GLint param)
+{
+    OpenglRedirectorBase::glTexEnvi(target, pname, param);
+    if (target == GL_TEXTURE_ENV && pname == GL_TEXTURE_ENV_MODE)
+        m_Context->getLegacyTracker().textureEnvMode(static_cast<GLenum>(param), m_Context->getTextureTracker().getTextureUnits().getActiveUnit());
+}
+
+void Dispatcher::glTexEnvfv(GLenum target, GLenum pname, const GLfloat* params)
+{
+    OpenglRedirectorBase::glTexEnvfv(target, pname, params);
+    if (target == GL_TEXTURE_ENV && pname == GL_TEXTURE_ENV_MODE)
+        m_Context->getLegacyTracker().textureEnvMode(static_cast<GLenum>(params[0]), m_Context->getTextureTracker().getTextureUnits().getActiveUnit());
+}
+
+void Dispatcher::glTexEnviv(GLenum target, GLenum pname, const GLint* params)
+{
+    OpenglRedirectorBase::glTexEnviv(target, pname, params);
+    if (target == GL_TEXTURE_ENV && pname == GL_TEXTURE_ENV_MODE)
+        m_Context->getLegacyTracker().textureEnvMode(static_cast<GLenum>(params[0]), m_Context->getTextureTracker().getTextureUnits().getActiveUnit());
+}
+
+void Dispatcher::glColorMaterial(GLenum face, GLenum mode)
+{
+    OpenglRedirectorBase::glColorMaterial(face, mode);
+    m_Context->getLegacyTracker().colorMaterial(face, mode);
+}
+
+void Dispatcher::glLightModelf(GLenum pname, GLfloat param)
+{
+    OpenglRedirectorBase::glLightModelf(pname, param);
+    m_Context->getLegacyTracker().lightModel(pname, static_cast<GLint>(param));
+}
+
+void Dispatcher::glLightModeli(GLenum pname, GLint param)
+{
+    OpenglRedirectorBase::glLightModeli(pname, param);
+    m_Context->getLegacyTracker().lightModel(pname, param);
+}
+
+void Dispatcher::glLightModelfv(GLenum pname, const GLfloat* params)
+{
+    OpenglRedirectorBase::glLightModelfv(pname, params);
+    m_Context->getLegacyTracker().lightModel(pname, static_cast<GLint>(params[0]));
+}
+
+void Dispatcher::glLightModeliv(GLenum pname, const GLint* params)
+{
+    OpenglRedirectorBase::glLightModeliv(pname, params);
+    m_Context->getLegacyTracker().lightModel(pname, params[0]);
+}
+
+void Dispatcher::glPushAttrib(GLbitfield mask)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glPushAttrib(mask);
+    m_Context->getStateTracker().pushAttributes(mask);
+    m_Context->getLegacyTracker().pushAttributes(mask);
+}
+
+void Dispatcher::glPopAttrib(void)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glPopAttrib();
+    m_Context->getStateTracker().popAttributes();
+    m_Context->getLegacyTracker().popAttributes();
+    // GL_CURRENT_BIT restores current attributes
+    m_Context->getImmediateModeTracker().invalidate();
 }
 
 void Dispatcher::glBegin(GLenum mode)
 {
-    if (m_Context.m_callList == 0)
+    if (!m_Context->getImmediateModeTracker().begin(mode))
     {
-        m_Context.m_callList = OpenglRedirectorBase::glGenLists(1);
+        OpenglRedirectorBase::glBegin(mode);
     }
-    OpenglRedirectorBase::glNewList(m_Context.m_callList, GL_COMPILE);
-    OpenglRedirectorBase::glBegin(mode);
 }
 
 void Dispatcher::glEnd()
 {
-    OpenglRedirectorBase::glEnd();
-    OpenglRedirectorBase::glEndList();
+    auto& immediateMode = m_Context->getImmediateModeTracker();
+    if (!immediateMode.isInsideBatch())
+    {
+        OpenglRedirectorBase::glEnd();
+        return;
+    }
+    immediateMode.end();
+
+    // Vertices, emitted before attribute was set, use value of OpenGL's current state
+    using Attribute = hi::trackers::ImmediateModeTracker::Attribute;
+    const std::pair<Attribute, GLenum> currentAttributes[] = {
+        { hi::trackers::ImmediateModeTracker::NORMAL_ATTRIBUTE, GL_CURRENT_NORMAL },
+        { hi::trackers::ImmediateModeTracker::COLOR_ATTRIBUTE, GL_CURRENT_COLOR },
+        { hi::trackers::ImmediateModeTracker::TEXCOORD_ATTRIBUTE, GL_CURRENT_TEXTURE_COORDS },
+    };
+    const auto unresolvedAttributes = immediateMode.getUnresolvedAttributes();
+    for (const auto& [attribute, query] : currentAttributes)
+    {
+        if (!(unresolvedAttributes & attribute))
+            continue;
+        GLfloat value[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        OpenglRedirectorBase::glGetFloatv(query, value);
+        immediateMode.resolve(attribute, value);
+    }
 
-    m_DrawManager.draw(m_Context, [&]() {
-        OpenglRedirectorBase::glCallList(m_Context.m_callList);
-    });
-}
+    const auto& vertices = immediateMode.getVertices();
+    const auto mode = immediateMode.getMode();
+    const auto attributes = immediateMode.getBatchAttributes();
+    const GLsizei count = vertices.size();
+
+    // Stream batch through ring buffer, vertex arrays are shared by all batches
+    const auto first = m_Context->getImmediateModeBuffer().push(vertices.data(), vertices.size());
+    if (first >= 0)
+    {
+        m_Context->getImmediateModeBuffer().setAttributes(attributes);
+        const auto vertexArray = m_Context->getImmediateModeBuffer().getVertexArray();
+        const auto applicationVertexArray = m_Context->getStateTracker().getBoundVertexArray();
+        m_DrawManager->draw(
+            *m_Context, [=]() {
+                OpenglRedirectorBase::glBindVertexArray(vertexArray);
+                OpenglRedirectorBase::glDrawArrays(mode, first, count);
+                OpenglRedirectorBase::glBindVertexArray(applicationVertexArray);
+            },
+            [=](GLsizei instanceMultiplier) {
+                OpenglRedirectorBase::glBindVertexArray(vertexArray);
+                OpenglRedirectorBase::glDrawArraysInstanced(mode, first, count, instanceMultiplier);
+                OpenglRedirectorBase::glBindVertexArray(applicationVertexArray);
+            },
+            mode);
+        // Batch is overwritten once ring buffer wraps around
+        m_DrawManager->flushDeferredDraws(*m_Context);
+    }
+    else if (count > 0)
+    {
+        // Ring buffer is not available or batch is too large => repeat batch from display list
+        // Lists can't be nested, and recorded glCallList() refers to m_callList, which is recompiled below
+        m_DrawManager->flushDeferredDraws(*m_Context);
+        if (m_Context->m_callList == 0)
+        {
+            m_Context->m_callList = OpenglRedirectorBase::glGenLists(1);
+        }
+        OpenglRedirectorBase::glNewList(m_Context->m_callList, GL_COMPILE);
+        OpenglRedirectorBase::glBegin(mode);
+        for (const auto& vertex : vertices)
+        {
+            if (attributes & hi::trackers::ImmediateModeTracker::NORMAL_ATTRIBUTE)
+                OpenglRedirectorBase::glNormal3fv(vertex.normal);
+            if (attributes & hi::trackers::ImmediateModeTracker::COLOR_ATTRIBUTE)
+                OpenglRedirectorBase::glColor4fv(vertex.color);
+            if (attributes & hi::trackers::ImmediateModeTracker::TEXCOORD_ATTRIBUTE)
+                OpenglRedirectorBase::glTexCoord4fv(vertex.texCoord);
+            OpenglRedirectorBase::glVertex4fv(vertex.position);
+        }
+        OpenglRedirectorBase::glEnd();
+        OpenglRedirectorBase::glEndList();
+
+        m_DrawManager->draw(
+            *m_Context, [this, list = m_Context->m_callList]() {
+                OpenglRedirectorBase::glCallList(list);
+            },
+            nullptr, mode);
+    }
+
+    // Attributes, sourced from arrays, are undefined after draw call, others haven't changed
+    const auto& current = immediateMode.getCurrent();
+    if (attributes & hi::trackers::ImmediateModeTracker::NORMAL_ATTRIBUTE)
+        OpenglRedirectorBase::glNormal3fv(current.normal);
+    if (attributes & hi::trackers::ImmediateModeTracker::COLOR_ATTRIBUTE)
+        OpenglRedirectorBase::glColor4fv(current.color);
+    if (attributes & hi::trackers::ImmediateModeTracker::TEXCOORD_ATTRIBUTE)
+        OpenglRedirectorBase::glTexCoord4fv(current.texCoord);
+}
+
+#define HI_DEFINE_IMMEDIATE_MODE_VERTEX(NAME, TYPE, COUNT)                                        \
+    void Dispatcher::NAME(HI_IMMEDIATE_MODE_PARAMETERS_##COUNT(TYPE))                             \
+    {                                                                                             \
+        auto& immediateMode = m_Context->getImmediateModeTracker();                               \
+        if (!immediateMode.isInsideBatch())                                                       \
+        {                                                                                         \
+            OpenglRedirectorBase::NAME(HI_IMMEDIATE_MODE_ARGUMENTS_##COUNT(HI_IMMEDIATE_MODE_RAW)); \
+            return;                                                                               \
+        }                                                                                         \
+        immediateMode.vertex(HI_IMMEDIATE_MODE_ARGUMENTS_##COUNT(HI_IMMEDIATE_MODE_RAW));          \
+    }                                                                                             \
+    void Dispatcher::NAME##v(const TYPE* v)                                                       \
+    {                                                                                             \
+        auto& immediateMode = m_Context->getImmediateModeTracker();                               \
+        if (!immediateMode.isInsideBatch())                                                       \
+        {                                                                                         \
+            OpenglRedirectorBase::NAME##v(v);                                                     \
+            return;                                                                               \
+        }                                                                                         \
+        immediateMode.vertex(HI_IMMEDIATE_MODE_COMPONENTS_##COUNT(HI_IMMEDIATE_MODE_RAW));         \
+    }
+HI_IMMEDIATE_MODE_VERTEX_ENTRY_POINTS(HI_DEFINE_IMMEDIATE_MODE_VERTEX)
+#undef HI_DEFINE_IMMEDIATE_MODE_VERTEX
+
+// Current attributes are tracked always, but reach driver only outside of batch
+#define HI_DEFINE_IMMEDIATE_MODE_ATTRIBUTE(NAME, TYPE, COUNT, SETTER, CONVERT)                 \
+    void Dispatcher::NAME(HI_IMMEDIATE_MODE_PARAMETERS_##COUNT(TYPE))                         \
+    {                                                                                         \
+        auto& immediateMode = m_Context->getImmediateModeTracker();                           \
+        immediateMode.SETTER(HI_IMMEDIATE_MODE_ARGUMENTS_##COUNT(CONVERT));                   \
+        if (!immediateMode.isInsideBatch())                                                   \
+            OpenglRedirectorBase::NAME(HI_IMMEDIATE_MODE_ARGUMENTS_##COUNT(HI_IMMEDIATE_MODE_RAW)); \
+    }                                                                                         \
+    void Dispatcher::NAME##v(const TYPE* v)                                                   \
+    {                                                                                         \
+        auto& immediateMode = m_Context->getImmediateModeTracker();                           \
+        immediateMode.SETTER(HI_IMMEDIATE_MODE_COMPONENTS_##COUNT(CONVERT));                  \
+        if (!immediateMode.isInsideBatch())                                                   \
+            OpenglRedirectorBase::NAME##v(v);                                                 \
+    }
+HI_IMMEDIATE_MODE_ATTRIBUTE_ENTRY_POINTS(HI_DEFINE_IMMEDIATE_MODE_ATTRIBUTE)
+#undef HI_DEFINE_IMMEDIATE_MODE_ATTRIBUTE
 
 void Dispatcher::glCallList(GLuint list)
 {
-    m_DrawManager.draw(m_Context, [&]() {
+    m_DrawManager->draw(*m_Context, [=]() {
         OpenglRedirectorBase::glCallList(list);
     });
+    // List may set current attributes (glColor, ...)
+    m_Context->getImmediateModeTracker().invalidate();
 }
 void Dispatcher::glCallLists(GLsizei n, GLenum type, const GLvoid* lists)
 {
-    m_DrawManager.draw(m_Context, [&]() {
+    m_DrawManager->draw(*m_Context, [=]() {
         OpenglRedirectorBase::glCallLists(n, type, lists);
     });
+    // Array of lists is only valid during the call
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    m_Context->getImmediateModeTracker().invalidate();
+}
+
+void Dispatcher::glClientActiveTexture(GLenum texture)
+{
+    OpenglRedirectorBase::glClientActiveTexture(texture);
+    m_Context->getStateTracker().setClientActiveTexture(texture);
+}
+
+void Dispatcher::glPushClientAttrib(GLbitfield mask)
+{
+    OpenglRedirectorBase::glPushClientAttrib(mask);
+    m_Context->getStateTracker().pushClientAttributes(mask);
+}
+
+void Dispatcher::glPopClientAttrib(void)
+{
+    OpenglRedirectorBase::glPopClientAttrib();
+    m_Context->getStateTracker().popClientAttributes();
+}
+
+void Dispatcher::glNewList(GLuint list, GLenum mode)
+{
+    // Application's list can't be compiled while draw calls are recorded
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glNewList(list, mode);
+    m_Context->getStateTracker().beginList(list);
+    m_Context->getImmediateModeTracker().beginList(mode);
+}
+
+void Dispatcher::glEndList(void)
+{
+    OpenglRedirectorBase::glEndList();
+    m_Context->getStateTracker().endList();
+    m_Context->getImmediateModeTracker().endList();
+}
+
+void Dispatcher::glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels)
+{
+    m_DrawManager->flushDeferredDraws(*m_Context);
+    OpenglRedirectorBase::glReadPixels(x, y, width, height, format, type, pixels);
 }
 
 //-----------------------------------------------------------------------------
@@ -1017,7 +1982,7 @@ void Dispatcher::glCallLists(GLsizei n, GLenum type, const GLvoid* lists)
 int Dispatcher::XNextEvent(Display* display, XEvent* event_return)
 {
     //return OpenglRedirectorBase::XNextEvent(display, event_return);
-    return m_Context.getX11Sniffer().onXNextEvent(display, event_return);
+    return m_Context->getX11Sniffer().onXNextEvent(display, event_return);
 }
 
 int Dispatcher::XWarpPointer(Display* display, Window src_w, Window dest_w, int src_x, int src_y, unsigned int src_width, unsigned int src_height, int dest_x, int dest_y)
@@ -1046,7 +2011,7 @@ Window Dispatcher::XCreateWindow(Display* display, Window parent, int x, int y,
 
 int Dispatcher::XMapWindow(Display* display, Window win)
 {
-    if (!m_Context.keepWindowInBackgroundFlag)
+    if (!m_Context->keepWindowInBackgroundFlag)
     {
         return OpenglRedirectorBase::XMapWindow(display, win);
     }
@@ -7,12 +7,16 @@
 *****************************************************************************/
 
 #include <functional>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include <GL/gl.h>
 #include <glm/glm.hpp>
 
 #include "context.hpp"
+#include "hooking/immediate_mode_entry_points.hpp"
+#include "hooking/program_entry_points.hpp"
 #include "hooking/opengl_redirector_base.hpp"
 #include "managers/draw_manager.hpp"
 #include "managers/framebuffer_manager.hpp"
@@ -21,6 +25,12 @@
 
 namespace hi
 {
+namespace trackers
+{
+    class TextureMetadata;
+    class RenderbufferMetadata;
+}
+
 /**
      * @brief Reroutes hooked OpenGL calls to submodules
      *
@@ -33,6 +43,7 @@ namespace hi
 class Dispatcher : public hi::hooking::OpenglRedirectorBase
 {
 public:
+    Dispatcher();
     virtual void registerCallbacks() override;
 
     ///////////////////////////////////////////////////////////////////////
@@ -43,6 +54,9 @@ public:
 
     // X11 library & GLX extension handlers
     virtual GLXContext glXCreateContext(Display* dpy, XVisualInfo* vis, GLXContext shareList, Bool direct) override;
+    virtual GLXContext glXCreateNewContext(Display* dpy, GLXFBConfig config, int renderType, GLXContext shareList, Bool direct) override;
+    virtual GLXContext glXCreateContextAttribsARB(Display* dpy, GLXFBConfig config, GLXContext shareList, Bool direct, const int* attribList) override;
+    virtual void glXDestroyContext(Display* dpy, GLXContext ctx) override;
     virtual void glXSwapBuffers(Display* dpy, GLXDrawable drawable) override;
     virtual Bool glXMakeCurrent(Display* dpy, GLXDrawable drawable, GLXContext ctx) override;
     virtual Bool glXMakeContextCurrent(Display* display, GLXDrawable draw, GLXDrawable read, GLXContext ctx) override;
@@ -74,10 +88,12 @@ public:
 
     virtual void glBindTexture(GLenum target, GLuint texture) override;
     virtual void glActiveTexture(GLenum texture) override;
+    virtual void glBindTextures(GLuint first, GLsizei count, const GLuint* textures) override;
 
     // Renderbuffers
     virtual void glGenRenderbuffers(GLsizei n, GLuint* renderbuffers) override;
     virtual void glDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) override;
+    virtual void glBindRenderbuffer(GLenum target, GLuint renderbuffer) override;
     virtual void glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) override;
     virtual void glRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
 
@@ -96,6 +112,27 @@ public:
     virtual void glDeleteProgram(GLuint program);
     virtual void glUseProgram(GLuint program) override;
     virtual void glLinkProgram(GLuint program) override;
+    virtual void glGetProgramiv(GLuint program, GLenum pname, GLint* params) override;
+
+    // Wait for pending link, then forward (see resolveProgramLink())
+#define HI_DECLARE_PROGRAM_ENTRY_POINT(RETURN_TYPE, NAME, PARAMETERS, ARGUMENTS) \
+    virtual RETURN_TYPE NAME PARAMETERS override;
+    HI_PROGRAM_QUERY_ENTRY_POINTS(HI_DECLARE_PROGRAM_ENTRY_POINT)
+    HI_PROGRAM_UNIFORM_ENTRY_POINTS(HI_DECLARE_PROGRAM_ENTRY_POINT)
+#undef HI_DECLARE_PROGRAM_ENTRY_POINT
+
+    // Uniforms of bound program, forwarded and mirrored (see trackUniform())
+#define HI_DECLARE_UNIFORM_ENTRY_POINT(RETURN_TYPE, NAME, PARAMETERS, ARGUMENTS) \
+    virtual RETURN_TYPE NAME PARAMETERS override;
+    HI_UNIFORM_ENTRY_POINTS(HI_DECLARE_UNIFORM_ENTRY_POINT)
+#undef HI_DECLARE_UNIFORM_ENTRY_POINT
+
+    // Pre-link state (part of program binary cache's key)
+    virtual void glBindAttribLocation(GLuint program, GLuint index, const GLchar* name) override;
+    virtual void glBindFragDataLocation(GLuint program, GLuint color, const GLchar* name) override;
+    virtual void glBindFragDataLocationIndexed(GLuint program, GLuint colorNumber, GLuint index, const GLchar* name) override;
+    virtual void glTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum bufferMode) override;
+    virtual void glProgramParameteri(GLuint program, GLenum pname, GLint value) override;
 
     // Framebuffers
     virtual void glGenFramebuffers(GLsizei n, GLuint* framebuffers) override;
@@ -116,6 +153,8 @@ public:
     // Get binding slot for given block location
     virtual void glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding) override;
 
+    virtual void glBindBuffer(GLenum target, GLuint buffer) override;
+    virtual void glDeleteBuffers(GLsizei n, const GLuint* buffers) override;
     virtual void glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) override;
     virtual void glBindBufferBase(GLenum target, GLuint index, GLuint buffer) override;
 
@@ -126,8 +165,38 @@ public:
 
     virtual void glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override;
     virtual void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override;
+
+    // Buffer & framebuffer accesses, which must observe deferred draws (see DeferredReplay)
+    virtual void* glMapBuffer(GLenum target, GLenum access) override;
+    virtual void* glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) override;
+    virtual void* glMapNamedBuffer(GLuint buffer, GLenum access) override;
+    virtual void* glMapNamedBufferRange(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access) override;
+    virtual void glNamedBufferData(GLuint buffer, GLsizeiptr size, const void* data, GLenum usage) override;
+    virtual void glNamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data) override;
+    virtual void glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) override;
+    virtual void glCopyNamedBufferSubData(GLuint readBuffer, GLuint writeBuffer, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) override;
+    virtual void glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) override;
+    virtual void glBlitNamedFramebuffer(GLuint readFramebuffer, GLuint drawFramebuffer, GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) override;
+    virtual void glGenerateMipmap(GLenum target) override;
+    virtual void glGenerateTextureMipmap(GLuint texture) override;
     // Binding end
 
+    // Capabilities
+    virtual void glEnable(GLenum cap) override;
+    virtual void glDisable(GLenum cap) override;
+    virtual void glEnablei(GLenum target, GLuint index) override;
+    virtual void glDisablei(GLenum target, GLuint index) override;
+
+    // Vertex arrays (instanced attributes)
+    virtual void glBindVertexArray(GLuint array) override;
+    virtual void glDeleteVertexArrays(GLsizei n, const GLuint* arrays) override;
+    virtual void glVertexAttribDivisor(GLuint index, GLuint divisor) override;
+    virtual void glVertexBindingDivisor(GLuint bindingindex, GLuint divisor) override;
+    virtual void glVertexArrayBindingDivisor(GLuint vaobj, GLuint bindingindex, GLuint divisor) override;
+    virtual void glClientActiveTexture(GLenum texture) override;
+    virtual void glPushClientAttrib(GLbitfield mask) override;
+    virtual void glPopClientAttrib(void) override;
+
     // Draw calls start
     virtual void glDrawArrays(GLenum mode, GLint first, GLsizei count) override;
     virtual void glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount) override;
@@ -157,32 +226,112 @@ public:
     virtual void glMultMatrixf(const GLfloat* m) override;
     virtual void glOrtho(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble near_val, GLdouble far_val) override;
     virtual void glFrustum(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble near_val, GLdouble far_val) override;
+    virtual void glAlphaFunc(GLenum func, GLclampf ref) override;
+    virtual void glFogf(GLenum pname, GLfloat param) override;
+    virtual void glFogi(GLenum pname, GLint param) override;
+    virtual void glFogfv(GLenum pname, const GLfloat* params) override;
+    virtual void glFogiv(GLenum pname, const GLint* params) override;
+    virtual void glTexEnvf(GLenum target, GLenum pname, GLfloat param) override;
+    virtual void glTexEnvi(GLenum target, GLenum pname, GLint param) override;
+    virtual void glTexEnvfv(GLenum target, GLenum pname, const GLfloat* params) override;
+    virtual void glTexEnviv(GLenum target, GLenum pname, const GLint* params) override;
+    virtual void glColorMaterial(GLenum face, GLenum mode) override;
+    virtual void glLightModelf(GLenum pname, GLfloat param) override;
+    virtual void glLightModeli(GLenum pname, GLint param) override;
+    virtual void glLightModelfv(GLenum pname, const GLfloat* params) override;
+    virtual void glLightModeliv(GLenum pname, const GLint* params) override;
+    virtual void glPushAttrib(GLbitfield mask) override;
+    virtual void glPopAttrib(void) override;
     virtual void glCallList(GLuint list) override;
     virtual void glCallLists(GLsizei n, GLenum type, const GLvoid* lists) override;
+    virtual void glNewList(GLuint list, GLenum mode) override;
+    virtual void glEndList(void) override;
+    virtual void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels) override;
 
     // Legacy OpenGL fixed-pipeline wihout VBO and VAO
     virtual void glBegin(GLenum mode) override;
     virtual void glEnd() override;
+
+    // Immediate-mode vertices & attributes, captured between glBegin()/glEnd()
+#define HI_DECLARE_IMMEDIATE_MODE_ENTRY_POINT(NAME, TYPE, COUNT, ...)        \
+    virtual void NAME(HI_IMMEDIATE_MODE_PARAMETERS_##COUNT(TYPE)) override; \
+    virtual void NAME##v(const TYPE* v) override;
+    HI_IMMEDIATE_MODE_VERTEX_ENTRY_POINTS(HI_DECLARE_IMMEDIATE_MODE_ENTRY_POINT)
+    HI_IMMEDIATE_MODE_ATTRIBUTE_ENTRY_POINTS(HI_DECLARE_IMMEDIATE_MODE_ENTRY_POINT)
+#undef HI_DECLARE_IMMEDIATE_MODE_ENTRY_POINT
     // Legacy end
 
     ///////////////////////////////////////////////////////////////////////
     // Internal routines
     ///////////////////////////////////////////////////////////////////////
 private:
-    bool m_IsInitialized = false;
-    GLint getCurrentID(GLenum target);
+    /// Per-GLXContext state, kept alive until glXDestroyContext()
+    struct ContextState
+    {
+        Context context;
+        hi::managers::DrawManager drawManager;
+        /// Has been initialized when made current for the first time
+        bool isInitialized = false;
+        /// Is current on some thread (guarded by m_ContextsMutex)
+        bool isCurrent = false;
+        /// Destroyed by application while current on another thread, released once made non-current
+        bool isDestroyed = false;
+    };
+
+    /// Start tracking context, created by application, in share group of shareList
+    void registerContext(GLXContext context, GLXContext shareList);
+    /// Get (or create) state of context, placeholder state for no context
+    ContextState& getContextState(GLXContext context);
+    /// State for calls, made while no context is current
+    static ContextState& getPlaceholderState();
+    /// Route hooked calls of calling thread to context's state
+    void switchContext(GLXContext context);
+    /// Stop tracking context, destroyed by application (releases its objects if it is current)
+    void releaseContext(GLXContext context);
+    /// Get texture bound to target of active unit (from tracked state, target can be cube face or proxy)
+    std::shared_ptr<hi::trackers::TextureMetadata> getBoundTexture(GLenum target);
+    /// Get currently bound renderbuffer (from tracked state)
+    std::shared_ptr<hi::trackers::RenderbufferMetadata> getBoundRenderbuffer();
     /// Initialize parameters, caches etc
     void initialize();
     void deinitialize();
 
     void drawMultiviewed(const std::function<void(void)>& code);
 
+    /**
+     * @brief Switch multiview-only handlers (draw calls, glClear) to driver when multiview is off
+     *
+     * Bookkeeping handlers (trackers) stay redirected, thus multiview can be re-activated anytime.
+     * Applied to calling thread at frame boundaries (initialization and glXSwapBuffers) and
+     * whenever thread makes another context current.
+     */
+    void updatePassThrough();
+    /// Wait for pending link of injected program (see ShaderManager::resolveLink)
+    void resolveProgramLink(GLuint program);
+    /// Mirror uniform update of program: texture units, assigned to samplers by glUniform1i(v)
+    void trackUniform(GLuint program, GLint location, GLint v0);
+    void trackUniform(GLuint program, GLint location, GLsizei count, const GLint* value);
+    /// Values of other uniforms aren't mirrored, only their change is
+    template <typename... ARGUMENTS>
+    void trackUniform(GLuint program, GLint location, ARGUMENTS...)
+    {
+        touchUniforms(program);
+    }
+    /// Increment program's uniform epoch (see ShaderProgram::m_UniformEpoch)
+    void touchUniforms(GLuint program);
+
     ///////////////////////////////////////////////////////////////////////
     // OpenGL structures
     ///////////////////////////////////////////////////////////////////////
-    Context m_Context;
-
-    hi::managers::DrawManager m_DrawManager;
+    std::unordered_map<GLXContext, ContextState> m_Contexts;
+    /// Guards m_Contexts (contexts can be created / made current by multiple threads)
+    std::mutex m_ContextsMutex;
+
+    /// Context, current on calling thread (each thread may have its own context current)
+    static thread_local GLXContext m_CurrentContext;
+    /// State of current context (or a placeholder state when no context is current)
+    static thread_local Context* m_Context;
+    static thread_local hi::managers::DrawManager* m_DrawManager;
     hi::managers::ShaderManager m_ShaderManager;
     hi::managers::FramebufferManager m_FramebufferManager;
     hi::managers::UIManager m_UIManager;
@@ -0,0 +1,69 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        hooking/immediate_mode_entry_points.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_IMMEDIATE_MODE_ENTRY_POINTS_HPP
+#define HI_IMMEDIATE_MODE_ENTRY_POINTS_HPP
+
+/**
+ * X-macro lists of immediate-mode entry points (glVertex3f, glColor4ubv, ...)
+ *
+ * Each entry expands F(NAME, TYPE, COUNT, ...) for scalar entry point NAME with COUNT
+ * parameters of TYPE. Its vector variant is NAME##v(const TYPE* v).
+ * Attribute entries carry tracker's setter and conversion of components to float.
+ */
+//-----------------------------------------------------------------------------
+
+// Parameter & argument lists of scalar entry points
+#define HI_IMMEDIATE_MODE_PARAMETERS_1(TYPE) TYPE x
+#define HI_IMMEDIATE_MODE_PARAMETERS_2(TYPE) TYPE x, TYPE y
+#define HI_IMMEDIATE_MODE_PARAMETERS_3(TYPE) TYPE x, TYPE y, TYPE z
+#define HI_IMMEDIATE_MODE_PARAMETERS_4(TYPE) TYPE x, TYPE y, TYPE z, TYPE w
+#define HI_IMMEDIATE_MODE_ARGUMENTS_1(CONVERT) CONVERT(x)
+#define HI_IMMEDIATE_MODE_ARGUMENTS_2(CONVERT) CONVERT(x), CONVERT(y)
+#define HI_IMMEDIATE_MODE_ARGUMENTS_3(CONVERT) CONVERT(x), CONVERT(y), CONVERT(z)
+#define HI_IMMEDIATE_MODE_ARGUMENTS_4(CONVERT) CONVERT(x), CONVERT(y), CONVERT(z), CONVERT(w)
+// Components of vector entry points
+#define HI_IMMEDIATE_MODE_COMPONENTS_1(CONVERT) CONVERT(v[0])
+#define HI_IMMEDIATE_MODE_COMPONENTS_2(CONVERT) CONVERT(v[0]), CONVERT(v[1])
+#define HI_IMMEDIATE_MODE_COMPONENTS_3(CONVERT) CONVERT(v[0]), CONVERT(v[1]), CONVERT(v[2])
+#define HI_IMMEDIATE_MODE_COMPONENTS_4(CONVERT) CONVERT(v[0]), CONVERT(v[1]), CONVERT(v[2]), CONVERT(v[3])
+// Pass argument unchanged
+#define HI_IMMEDIATE_MODE_RAW(value) value
+
+// Type suffixes of entry point families
+#define HI_IMMEDIATE_MODE_TYPES_DFIS(F, NAME, ...) \
+    F(NAME##d, GLdouble, __VA_ARGS__)              \
+    F(NAME##f, GLfloat, __VA_ARGS__)               \
+    F(NAME##i, GLint, __VA_ARGS__)                 \
+    F(NAME##s, GLshort, __VA_ARGS__)
+#define HI_IMMEDIATE_MODE_TYPES_BDFIS(F, NAME, ...) \
+    F(NAME##b, GLbyte, __VA_ARGS__)                 \
+    HI_IMMEDIATE_MODE_TYPES_DFIS(F, NAME, __VA_ARGS__)
+#define HI_IMMEDIATE_MODE_TYPES_ALL(F, NAME, ...)    \
+    HI_IMMEDIATE_MODE_TYPES_BDFIS(F, NAME, __VA_ARGS__) \
+    F(NAME##ub, GLubyte, __VA_ARGS__)                \
+    F(NAME##ui, GLuint, __VA_ARGS__)                 \
+    F(NAME##us, GLushort, __VA_ARGS__)
+
+/// Vertices: F(NAME, TYPE, COUNT)
+#define HI_IMMEDIATE_MODE_VERTEX_ENTRY_POINTS(F)   \
+    HI_IMMEDIATE_MODE_TYPES_DFIS(F, glVertex2, 2) \
+    HI_IMMEDIATE_MODE_TYPES_DFIS(F, glVertex3, 3) \
+    HI_IMMEDIATE_MODE_TYPES_DFIS(F, glVertex4, 4)
+
+/// Current attributes: F(NAME, TYPE, COUNT, SETTER, CONVERT), normals & colors are normalized as OpenGL does
+#define HI_IMMEDIATE_MODE_ATTRIBUTE_ENTRY_POINTS(F)                                        \
+    HI_IMMEDIATE_MODE_TYPES_BDFIS(F, glNormal3, 3, normal, helper::normalized)             \
+    HI_IMMEDIATE_MODE_TYPES_ALL(F, glColor3, 3, color, helper::normalized)                 \
+    HI_IMMEDIATE_MODE_TYPES_ALL(F, glColor4, 4, color, helper::normalized)                 \
+    HI_IMMEDIATE_MODE_TYPES_DFIS(F, glTexCoord1, 1, texCoord, static_cast<float>)          \
+    HI_IMMEDIATE_MODE_TYPES_DFIS(F, glTexCoord2, 2, texCoord, static_cast<float>)          \
+    HI_IMMEDIATE_MODE_TYPES_DFIS(F, glTexCoord3, 3, texCoord, static_cast<float>)          \
+    HI_IMMEDIATE_MODE_TYPES_DFIS(F, glTexCoord4, 4, texCoord, static_cast<float>)
+
+#endif
@@ -16,6 +16,8 @@
  * g++ -E opengl_redirector_base.cpp | clang-format 
  */
 
+#include <algorithm>
+#include <atomic>
 #include <sstream>
 #include <type_traits>
 #include <unordered_map>
@@ -35,6 +37,8 @@ using namespace hi::hooking;
 
 static OpenglRedirectorBase* g_OpenGLRedirector = nullptr;
 thread_local bool g_IsAlreadyInsideWrapper = false;
+/// Calls of calling thread skip overrides of switchable functions (see setThreadPassThrough())
+thread_local bool g_IsThreadPassThrough = false;
 
 OpenglRedirectorBase::OpenglRedirectorBase()
 {
@@ -59,21 +63,79 @@ bool shouldLogApiMessages()
     return shouldLogApiCall;
 }
 
-void log_api_call(const std::string apiName, const std::string serializedArguments = "")
+/// Print API call (callers check shouldLogApiMessages() prior to serializing arguments)
+void log_api_call(const char* apiName, const std::string& serializedArguments = "")
 {
-    if (shouldLogApiMessages())
-    {
-        printf("[Injector API CALL: %s] %s\n", apiName.c_str(), serializedArguments.c_str());
-    }
+    printf("[Injector API CALL: %s] %s\n", apiName, serializedArguments.c_str());
 }
 
-static std::unordered_map<std::string, void*> definedAPIFunctions;
+/// Redirector with no overrides, used to obtain addresses of OpenglRedirectorBase's methods
+class PassThroughRedirector : public OpenglRedirectorBase
+{
+public:
+    void registerCallbacks() override {}
+};
+
+const OpenglRedirectorBase* getPassThroughRedirector()
+{
+    static const OpenglRedirectorBase* passThrough = []() {
+        // Note: constructor of redirector replaces the global instance
+        auto currentRedirector = g_OpenGLRedirector;
+        // Intentionally leaked, as it would reset global instance when destroyed
+        auto instance = new PassThroughRedirector();
+        g_OpenGLRedirector = currentRedirector;
+        return instance;
+    }();
+    return passThrough;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpmf-conversions"
+/**
+ * @brief Determine if redirector overrides method of OpenglRedirectorBase
+ *
+ * Uses GCC's extension for extracting function address from bound pointer to member.
+ */
+template <typename METHOD>
+bool isOverridden(METHOD method)
+{
+    const auto passThrough = getPassThroughRedirector();
+    return reinterpret_cast<void*>(g_OpenGLRedirector->*method) != reinterpret_cast<void*>(passThrough->*method);
+}
+#pragma GCC diagnostic pop
+#else
+/// Without GCC's extension, all methods are considered to be overridden
+template <typename METHOD>
+bool isOverridden(METHOD)
+{
+    return true;
+}
+#endif
+
+/// Defined API function, see RegisterAPIFunction
+struct APIFunction
+{
+    /// Name of OpenglRedirectorBase's method, handling the function
+    std::string handler;
+    void* address;
+    /// Set to true when calls should skip the redirector
+    std::atomic<bool>* isPassThrough;
+    /// Set to true when calls should skip the redirector on threads with pass-through
+    std::atomic<bool>* isThreadSwitchable;
+    bool (*isOverridden)();
+    /// Overridden by redirector (only these can be switched by setThreadPassThrough())
+    bool isRedirected = false;
+};
+
+static std::unordered_map<std::string, APIFunction> definedAPIFunctions;
 /// Register corresponding OpenGL API rediction into definedAPIFunctions
 class RegisterAPIFunction
 {
 public:
-    RegisterAPIFunction(const std::string& name, void* address)
+    RegisterAPIFunction(const std::string& name, const char* handler, void* address, std::atomic<bool>& isPassThrough, std::atomic<bool>& isThreadSwitchable, bool (*isOverridden)())
     {
+        definedAPIFunctions[name] = APIFunction { handler, address, &isPassThrough, &isThreadSwitchable, isOverridden };
         if (!g_OpenGLRedirector)
         {
             if (shouldLogApiMessages())
@@ -82,12 +144,25 @@ public:
             }
             return;
         }
+        registerFunction(*g_OpenGLRedirector, name, definedAPIFunctions[name]);
+    }
+
+    /// Redirect function if it is overridden by redirector, or mark it as pass-through
+    static void registerFunction(OpenglRedirectorBase& instance, const std::string& name, APIFunction& function)
+    {
+        function.isRedirected = function.isOverridden();
+        *function.isPassThrough = !function.isRedirected;
+        if (!function.isRedirected)
+        {
+            // Known symbol without redirection, so that lookups cache its original address
+            instance.redirector.addSymbol(name);
+            return;
+        }
         if (shouldLogApiMessages())
         {
             printf("[Injector] Registering redirection for %s\n", name.c_str());
         }
-        g_OpenGLRedirector->redirector.addRedirection(name, address);
-        //definedAPIFunctions[name] = address;
+        instance.redirector.addRedirection(name, function.address);
     }
 };
 
@@ -196,14 +271,6 @@ std::string packArgs(FIRST head, T... args)
 
 using ReturnFunctionType = void (*)();
 
-std::string convertGLString(const GLubyte* name)
-{
-    size_t i = 0;
-    while (name[i] != '\0')
-        i++;
-    return std::string(reinterpret_cast<const char*>(name), i);
-}
-
 /**
      * @brief Simple RAII lock mechanism
      */
@@ -226,6 +293,9 @@ public:
 }
 
 OPENGL_FORWARD(GLXContext, glXCreateContext, Display*, dpy, XVisualInfo*, vis, GLXContext, shareList, Bool, direct);
+OPENGL_FORWARD(GLXContext, glXCreateNewContext, Display*, dpy, GLXFBConfig, config, int, renderType, GLXContext, shareList, Bool, direct);
+OPENGL_FORWARD(GLXContext, glXCreateContextAttribsARB, Display*, dpy, GLXFBConfig, config, GLXContext, shareList, Bool, direct, const int*, attribList);
+OPENGL_FORWARD(void, glXDestroyContext, Display*, dpy, GLXContext, ctx);
 OPENGL_FORWARD(void, glXSwapBuffers, Display*, dpy, GLXDrawable, drawable);
 OPENGL_FORWARD(Bool, glXMakeCurrent, Display*, dpy, GLXDrawable, drawable, GLXContext, ctx);
 OPENGL_FORWARD(Bool, glXMakeContextCurrent, Display*, dpy, GLXDrawable, draw, GLXDrawable, read, GLXContext, ctx);
@@ -234,11 +304,11 @@ OPENGL_FORWARD(void, XSetWMNormalHints, Display*, display, Window, w, XSizeHints
 OPENGL_FORWARD_LOADER_ONLY(helper::ReturnFunctionType, glXGetProcAddress, const GLubyte*, procName);
 void (*OpenglRedirectorBase::glXGetProcAddress(const GLubyte* procName))(void)
 {
-    helper::log_api_call("glXGetProcAddress", helper::packArgs(procName));
-    const std::string name = helper::convertGLString(procName);
-    if (redirector.hasRedirection(name))
+    if (helper::shouldLogApiMessages())
+        helper::log_api_call("glXGetProcAddress", helper::packArgs(procName));
+    if (auto target = redirector.getTarget(reinterpret_cast<const char*>(procName)))
     {
-        return reinterpret_cast<helper::ReturnFunctionType>(redirector.getTarget(name));
+        return reinterpret_cast<helper::ReturnFunctionType>(target);
     }
     auto originalAddress = reinterpret_cast<decltype(&::glXGetProcAddress)>(getOriginalSymbolAddress("glXGetProcAddress"));
     return originalAddress(procName);
@@ -247,11 +317,11 @@ void (*OpenglRedirectorBase::glXGetProcAddress(const GLubyte* procName))(void)
 OPENGL_FORWARD_LOADER_ONLY(helper::ReturnFunctionType, glXGetProcAddressARB, const GLubyte*, procName);
 void (*OpenglRedirectorBase::glXGetProcAddressARB(const GLubyte* procName))(void)
 {
-    helper::log_api_call("glXGetProcAddressARB", helper::packArgs(procName));
-    const std::string name = helper::convertGLString(procName);
-    if (redirector.hasRedirection(name))
+    if (helper::shouldLogApiMessages())
+        helper::log_api_call("glXGetProcAddressARB", helper::packArgs(procName));
+    if (auto target = redirector.getTarget(reinterpret_cast<const char*>(procName)))
     {
-        return reinterpret_cast<helper::ReturnFunctionType>(redirector.getTarget(name));
+        return reinterpret_cast<helper::ReturnFunctionType>(target);
     }
     auto originalAddress = reinterpret_cast<decltype(&::glXGetProcAddress)>(getOriginalSymbolAddress("glXGetProcAddressARB"));
     return originalAddress(procName);
@@ -345,7 +415,6 @@ OPENGL_FORWARD(void, glCallLists, GLsizei, n, GLenum, type, const GLvoid*, lists
 OPENGL_FORWARD(void, glListBase, GLuint, base);
 OPENGL_FORWARD(void, glBegin, GLenum, mode);
 OPENGL_FORWARD(void, glEnd, void, );
-/*
 OPENGL_FORWARD(void,glVertex2d,GLdouble,x,GLdouble,y);
 OPENGL_FORWARD(void,glVertex2f,GLfloat,x,GLfloat,y);
 OPENGL_FORWARD(void,glVertex2i,GLint,x,GLint,y);
@@ -454,6 +523,7 @@ OPENGL_FORWARD(void,glTexCoord4dv,const GLdouble*,v);
 OPENGL_FORWARD(void,glTexCoord4fv,const GLfloat*,v);
 OPENGL_FORWARD(void,glTexCoord4iv,const GLint*,v);
 OPENGL_FORWARD(void,glTexCoord4sv,const GLshort*,v);
+/*
 OPENGL_FORWARD(void,glRasterPos2d,GLdouble,x,GLdouble,y);
 OPENGL_FORWARD(void,glRasterPos2f,GLfloat,x,GLfloat,y);
 OPENGL_FORWARD(void,glRasterPos2i,GLint,x,GLint,y);
@@ -3245,17 +3315,25 @@ OPENGL_FORWARD(void,glReplacementCodeuiTexCoord2fColor4fNormal3fVertex3fvSUN ,co
 /// Register all OpenGLAPI calls, defined above
 void OpenglRedirectorBase::registerOpenGLSymbols()
 {
-    /*
-    for(const auto& symbol: symbols)
+    for (auto& pair : helper::definedAPIFunctions)
     {
-        if(helper::definedAPIFunctions.count(symbol) > 0)
-        {
-            redirector.addRedirection(symbol, helper::definedAPIFunctions[symbol]);
-        }
-    }*/
+        helper::RegisterAPIFunction::registerFunction(*this, pair.first, pair.second);
+    }
+}
 
-    for (auto& pair : helper::definedAPIFunctions)
+void OpenglRedirectorBase::setThreadSwitchable(const std::vector<std::string>& handlers)
+{
+    for (auto& [name, function] : helper::definedAPIFunctions)
     {
-        redirector.addRedirection(pair.first, pair.second);
+        if (!function.isRedirected)
+            continue;
+        if (std::find(handlers.begin(), handlers.end(), function.handler) == handlers.end())
+            continue;
+        function.isThreadSwitchable->store(true);
     }
 }
+
+void OpenglRedirectorBase::setThreadPassThrough(bool isPassThrough)
+{
+    g_IsThreadPassThrough = isPassThrough;
+}
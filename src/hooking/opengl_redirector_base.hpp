@@ -27,8 +27,8 @@ namespace hooking
      *
      * This base class attempts to define whole OpenGL API. If you want 
      * to redirect specific subclass of functions, use subclass of this
-     * class, define your own overrides, and call registerOpenGLSymbols()
-     * with redirection-desired API names.
+     * class, define your own overrides, and call registerOpenGLSymbols(),
+     * which redirects only the overridden API functions.
      *
      * Call OpenglRedirectorBase's method with corresponding name in order
      * to invoke original function.
@@ -39,14 +39,34 @@ namespace hooking
     protected:
         OpenglRedirectorBase();
         ~OpenglRedirectorBase();
-        /// Register subset of OpenGL API, specified in 'symbols'
+        /// Register redirection of API functions, overridden by subclass (others call driver directly)
         void registerOpenGLSymbols();
+        /**
+         * @brief Allow switching redirected API functions of handlers to driver's implementation
+         *
+         * @param handlers names of methods, whose API functions (incl. extension aliases) become switchable
+         * See setThreadPassThrough().
+         */
+        void setThreadSwitchable(const std::vector<std::string>& handlers);
+        /**
+         * @brief Switch switchable API functions between override and driver's implementation
+         *
+         * @param isPassThrough if true, calls of calling thread skip overrides and reach the driver directly
+         *
+         * Note: the switch is thread-local, thus each thread follows its own current context.
+         * dlsym()/glXGetProcAddress() keep returning redirected addresses, thus switching
+         * applies to already resolved pointers as well.
+         */
+        static void setThreadPassThrough(bool isPassThrough);
 
     public:
         /*
          * X Window methods
          */
         virtual GLXContext glXCreateContext(Display* dpy, XVisualInfo* vis, GLXContext shareList, Bool direct);
+        virtual GLXContext glXCreateNewContext(Display* dpy, GLXFBConfig config, int renderType, GLXContext shareList, Bool direct);
+        virtual GLXContext glXCreateContextAttribsARB(Display* dpy, GLXFBConfig config, GLXContext shareList, Bool direct, const int* attribList);
+        virtual void glXDestroyContext(Display* dpy, GLXContext ctx);
         virtual void glXSwapBuffers(Display* dpy, GLXDrawable drawable);
         virtual Bool glXMakeCurrent(Display* dpy, GLXDrawable drawable, GLXContext ctx);
         virtual Bool glXMakeContextCurrent(Display* display, GLXDrawable draw, GLXDrawable read, GLXContext ctx);
@@ -142,7 +162,6 @@ namespace hooking
         virtual void glListBase(GLuint base);
         virtual void glBegin(GLenum mode);
         virtual void glEnd(void);
-        /*
         virtual void glVertex2d(GLdouble x,GLdouble y);
         virtual void glVertex2f(GLfloat x,GLfloat y);
         virtual void glVertex2i(GLint x,GLint y);
@@ -251,6 +270,7 @@ namespace hooking
         virtual void glTexCoord4fv(const GLfloat* v);
         virtual void glTexCoord4iv(const GLint* v);
         virtual void glTexCoord4sv(const GLshort* v);
+        /*
         virtual void glRasterPos2d(GLdouble x,GLdouble y);
         virtual void glRasterPos2f(GLfloat x,GLfloat y);
         virtual void glRasterPos2i(GLint x,GLint y);
@@ -235,12 +235,20 @@
  *=================================================*/
 #define EMPTY_FUNC(...)
 
-#define OPENGL_LOG_API_CALL helper::log_api_call
-#define OPENGL_PACK_ARGS helper::packArgs
-
-#undef OPENGL_LOG_API_CALL
+/*
+ * Logging of each intercepted call (HI_LOG_LOAD) is compiled in only with HI_LOG_API_CALLS,
+ * as it would otherwise cost a branch per call. Arguments are serialized only when enabled.
+ */
+#ifdef HI_LOG_API_CALLS
+#define OPENGL_LOG_API_CALL(_name, ...)               \
+    if (helper::shouldLogApiMessages())               \
+    {                                                 \
+        helper::log_api_call(_name, __VA_ARGS__);     \
+    }
+#else
 #define OPENGL_LOG_API_CALL EMPTY_FUNC
-//#define OPENGL_PACK_ARGS EMPTY_FUNC
+#endif
+#define OPENGL_PACK_ARGS helper::packArgs
 
 /// Expands 'type, name' to ', type name '
 #define OPENGL_EXPAND_PAIR(a, b) , a b
@@ -259,19 +267,37 @@
 #define OPENGL_EXPAND_ARGUMENTS(a, b, ...) \
     b EXPANDB(OPENGL_EXPAND_NAME, __VA_ARGS__)
 
-/// Redirect glXYZ to OpenglRedirectorBase's method
-#define OPENGL_REDIRECTOR_API(_retType, _name, _handler, ...)                                            \
-    _retType HI_API_EXPORT _name(OPENGL_EXPAND_PROTOTYPE(__VA_ARGS__))                                   \
-    {                                                                                                    \
-        OPENGL_LOG_API_CALL("" #_name, OPENGL_PACK_ARGS(OPENGL_EXPAND_ARGUMENTS(__VA_ARGS__)));          \
-        if (!g_IsAlreadyInsideWrapper)                                                                   \
-        {                                                                                                \
-            auto lock = helper::ThreadLocalLock(g_IsAlreadyInsideWrapper);                               \
-            return g_OpenGLRedirector->_handler(OPENGL_EXPAND_ARGUMENTS(__VA_ARGS__));                   \
-        }                                                                                                \
-        return g_OpenGLRedirector->OpenglRedirectorBase::_handler(OPENGL_EXPAND_ARGUMENTS(__VA_ARGS__)); \
-    }                                                                                                    \
-    static helper::RegisterAPIFunction register_impl##_name("" #_name, reinterpret_cast<void*>(&_name));
+/*
+ * Redirect glXYZ to OpenglRedirectorBase's method
+ *
+ * Calls of functions, which are not overridden by redirector (see RegisterAPIFunction),
+ * skip thread-local guard and virtual dispatch. Such functions are also not registered for
+ * redirection, thus dlsym()/glXGetProcAddress() return driver's address for them.
+ * Redirected functions can be switched to pass-through for calling thread, see setThreadPassThrough().
+ *
+ * _isOverridden is a callable returning true if call must reach redirector's override.
+ */
+#define OPENGL_REDIRECTOR_API_IMPL(_retType, _name, _handler, _isOverridden, ...)                                   \
+    static std::atomic<bool> isPassThrough_##_name = false;                                                         \
+    static std::atomic<bool> isThreadSwitchable_##_name = false;                                                    \
+    _retType HI_API_EXPORT _name(OPENGL_EXPAND_PROTOTYPE(__VA_ARGS__))                                              \
+    {                                                                                                               \
+        OPENGL_LOG_API_CALL("" #_name, OPENGL_PACK_ARGS(OPENGL_EXPAND_ARGUMENTS(__VA_ARGS__)));                     \
+        if (!isPassThrough_##_name.load(std::memory_order_relaxed) && !g_IsAlreadyInsideWrapper                     \
+            && !(g_IsThreadPassThrough && isThreadSwitchable_##_name.load(std::memory_order_relaxed)))              \
+        {                                                                                                           \
+            auto lock = helper::ThreadLocalLock(g_IsAlreadyInsideWrapper);                                          \
+            return g_OpenGLRedirector->_handler(OPENGL_EXPAND_ARGUMENTS(__VA_ARGS__));                              \
+        }                                                                                                           \
+        return g_OpenGLRedirector->OpenglRedirectorBase::_handler(OPENGL_EXPAND_ARGUMENTS(__VA_ARGS__));            \
+    }                                                                                                               \
+    static helper::RegisterAPIFunction register_impl##_name("" #_name, "" #_handler,                              \
+        reinterpret_cast<void*>(&_name), isPassThrough_##_name, isThreadSwitchable_##_name, _isOverridden);
+
+/// Redirect glXYZ to OpenglRedirectorBase's method, unless the method is not overridden
+#define OPENGL_REDIRECTOR_API(_retType, _name, _handler, ...) \
+    OPENGL_REDIRECTOR_API_IMPL(_retType, _name, _handler,     \
+        []() { return helper::isOverridden(&OpenglRedirectorBase::_handler); }, __VA_ARGS__)
 
 #define OPENGL_REDIRECTOR_METHOD(_retType, _name, ...)                                      \
     _retType OpenglRedirectorBase ::_name(OPENGL_EXPAND_PROTOTYPE(__VA_ARGS__))             \
@@ -309,9 +335,11 @@
 
 /*
  * @brief Only forwards system API call, left virtual method undefined
+ *
+ * Loader functions (glXGetProcAddress) are always redirected, as these resolve other redirections.
  */
 #define OPENGL_FORWARD_LOADER_ONLY(_retType, _name, ...) \
-    OPENGL_REDIRECTOR_API(_retType, _name, _name, __VA_ARGS__)
+    OPENGL_REDIRECTOR_API_IMPL(_retType, _name, _name, []() { return true; }, __VA_ARGS__)
 
 /*
  * @brief Define own handler
@@ -0,0 +1,130 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        hooking/program_entry_points.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_PROGRAM_ENTRY_POINTS_HPP
+#define HI_PROGRAM_ENTRY_POINTS_HPP
+
+/**
+ * X-macro lists of entry points, which depend on result of program's link (reflection,
+ * binaries, glProgramUniform*), and of uniforms of bound program (glUniform*)
+ *
+ * Each entry expands F(RETURN_TYPE, NAME, PARAMETERS, ARGUMENTS), where PARAMETERS is
+ * parenthesized parameter list (containing GLuint program, except of glUniform*) and
+ * ARGUMENTS is parenthesized list of forwarded arguments.
+ */
+//-----------------------------------------------------------------------------
+
+/// Reflection & binaries of linked program
+#define HI_PROGRAM_QUERY_ENTRY_POINTS(F)                                                                                                                                                                       \
+    F(void, glGetProgramInfoLog, (GLuint program, GLsizei bufSize, GLsizei * length, GLchar * infoLog), (program, bufSize, length, infoLog))                                                                  \
+    F(GLint, glGetUniformLocation, (GLuint program, const GLchar* name), (program, name))                                                                                                                     \
+    F(GLint, glGetAttribLocation, (GLuint program, const GLchar* name), (program, name))                                                                                                                      \
+    F(void, glGetActiveAttrib, (GLuint program, GLuint index, GLsizei bufSize, GLsizei * length, GLint * size, GLenum * type, GLchar * name), (program, index, bufSize, length, size, type, name))             \
+    F(void, glGetActiveUniform, (GLuint program, GLuint index, GLsizei bufSize, GLsizei * length, GLint * size, GLenum * type, GLchar * name), (program, index, bufSize, length, size, type, name))            \
+    F(void, glGetActiveUniformsiv, (GLuint program, GLsizei uniformCount, const GLuint* uniformIndices, GLenum pname, GLint* params), (program, uniformCount, uniformIndices, pname, params))                  \
+    F(void, glGetActiveUniformName, (GLuint program, GLuint uniformIndex, GLsizei bufSize, GLsizei * length, GLchar * uniformName), (program, uniformIndex, bufSize, length, uniformName))                     \
+    F(void, glGetActiveUniformBlockiv, (GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint * params), (program, uniformBlockIndex, pname, params))                                                  \
+    F(void, glGetActiveUniformBlockName, (GLuint program, GLuint uniformBlockIndex, GLsizei bufSize, GLsizei * length, GLchar * uniformBlockName), (program, uniformBlockIndex, bufSize, length, uniformBlockName)) \
+    F(void, glGetUniformIndices, (GLuint program, GLsizei uniformCount, const GLchar* const* uniformNames, GLuint* uniformIndices), (program, uniformCount, uniformNames, uniformIndices))                    \
+    F(void, glGetUniformfv, (GLuint program, GLint location, GLfloat * params), (program, location, params))                                                                                                  \
+    F(void, glGetUniformiv, (GLuint program, GLint location, GLint * params), (program, location, params))                                                                                                    \
+    F(void, glGetUniformuiv, (GLuint program, GLint location, GLuint * params), (program, location, params))                                                                                                  \
+    F(void, glGetUniformdv, (GLuint program, GLint location, GLdouble * params), (program, location, params))                                                                                                 \
+    F(GLint, glGetFragDataLocation, (GLuint program, const GLchar* name), (program, name))                                                                                                                     \
+    F(GLint, glGetFragDataIndex, (GLuint program, const GLchar* name), (program, name))                                                                                                                       \
+    F(void, glGetProgramInterfaceiv, (GLuint program, GLenum programInterface, GLenum pname, GLint * params), (program, programInterface, pname, params))                                                     \
+    F(GLuint, glGetProgramResourceIndex, (GLuint program, GLenum programInterface, const GLchar* name), (program, programInterface, name))                                                                    \
+    F(void, glGetProgramResourceName, (GLuint program, GLenum programInterface, GLuint index, GLsizei bufSize, GLsizei * length, GLchar * name), (program, programInterface, index, bufSize, length, name))    \
+    F(void, glGetProgramResourceiv, (GLuint program, GLenum programInterface, GLuint index, GLsizei propCount, const GLenum* props, GLsizei bufSize, GLsizei* length, GLint* params),                         \
+        (program, programInterface, index, propCount, props, bufSize, length, params))                                                                                                                        \
+    F(GLint, glGetProgramResourceLocation, (GLuint program, GLenum programInterface, const GLchar* name), (program, programInterface, name))                                                                  \
+    F(GLint, glGetProgramResourceLocationIndex, (GLuint program, GLenum programInterface, const GLchar* name), (program, programInterface, name))                                                              \
+    F(void, glGetProgramBinary, (GLuint program, GLsizei bufSize, GLsizei * length, GLenum * binaryFormat, void* binary), (program, bufSize, length, binaryFormat, binary))
+
+// Values of scalar glProgramUniform*
+#define HI_PROGRAM_UNIFORM_PARAMETERS_1(TYPE) TYPE v0
+#define HI_PROGRAM_UNIFORM_PARAMETERS_2(TYPE) TYPE v0, TYPE v1
+#define HI_PROGRAM_UNIFORM_PARAMETERS_3(TYPE) TYPE v0, TYPE v1, TYPE v2
+#define HI_PROGRAM_UNIFORM_PARAMETERS_4(TYPE) TYPE v0, TYPE v1, TYPE v2, TYPE v3
+#define HI_PROGRAM_UNIFORM_ARGUMENTS_1 v0
+#define HI_PROGRAM_UNIFORM_ARGUMENTS_2 v0, v1
+#define HI_PROGRAM_UNIFORM_ARGUMENTS_3 v0, v1, v2
+#define HI_PROGRAM_UNIFORM_ARGUMENTS_4 v0, v1, v2, v3
+
+// glProgramUniform{COUNT}{SUFFIX} and glProgramUniform{COUNT}{SUFFIX}v
+#define HI_PROGRAM_UNIFORM_VECTOR(F, COUNT, SUFFIX, TYPE)                                                                                                                       \
+    F(void, glProgramUniform##COUNT##SUFFIX, (GLuint program, GLint location, HI_PROGRAM_UNIFORM_PARAMETERS_##COUNT(TYPE)), (program, location, HI_PROGRAM_UNIFORM_ARGUMENTS_##COUNT)) \
+    F(void, glProgramUniform##COUNT##SUFFIX##v, (GLuint program, GLint location, GLsizei count, const TYPE* value), (program, location, count, value))
+#define HI_PROGRAM_UNIFORM_VECTORS(F, SUFFIX, TYPE) \
+    HI_PROGRAM_UNIFORM_VECTOR(F, 1, SUFFIX, TYPE)   \
+    HI_PROGRAM_UNIFORM_VECTOR(F, 2, SUFFIX, TYPE)   \
+    HI_PROGRAM_UNIFORM_VECTOR(F, 3, SUFFIX, TYPE)   \
+    HI_PROGRAM_UNIFORM_VECTOR(F, 4, SUFFIX, TYPE)
+
+// glProgramUniformMatrix{DIMENSIONS}{SUFFIX}v
+#define HI_PROGRAM_UNIFORM_MATRIX(F, DIMENSIONS, SUFFIX, TYPE) \
+    F(void, glProgramUniformMatrix##DIMENSIONS##SUFFIX##v, (GLuint program, GLint location, GLsizei count, GLboolean transpose, const TYPE* value), (program, location, count, transpose, value))
+#define HI_PROGRAM_UNIFORM_MATRICES(F, SUFFIX, TYPE) \
+    HI_PROGRAM_UNIFORM_MATRIX(F, 2, SUFFIX, TYPE)    \
+    HI_PROGRAM_UNIFORM_MATRIX(F, 3, SUFFIX, TYPE)    \
+    HI_PROGRAM_UNIFORM_MATRIX(F, 4, SUFFIX, TYPE)    \
+    HI_PROGRAM_UNIFORM_MATRIX(F, 2x3, SUFFIX, TYPE)  \
+    HI_PROGRAM_UNIFORM_MATRIX(F, 3x2, SUFFIX, TYPE)  \
+    HI_PROGRAM_UNIFORM_MATRIX(F, 2x4, SUFFIX, TYPE)  \
+    HI_PROGRAM_UNIFORM_MATRIX(F, 4x2, SUFFIX, TYPE)  \
+    HI_PROGRAM_UNIFORM_MATRIX(F, 3x4, SUFFIX, TYPE)  \
+    HI_PROGRAM_UNIFORM_MATRIX(F, 4x3, SUFFIX, TYPE)
+
+/// Uniforms of (possibly not bound) program: glProgramUniform1i, ..., glProgramUniformMatrix4x3dv
+#define HI_PROGRAM_UNIFORM_ENTRY_POINTS(F)     \
+    HI_PROGRAM_UNIFORM_VECTORS(F, i, GLint)    \
+    HI_PROGRAM_UNIFORM_VECTORS(F, f, GLfloat)  \
+    HI_PROGRAM_UNIFORM_VECTORS(F, d, GLdouble) \
+    HI_PROGRAM_UNIFORM_VECTORS(F, ui, GLuint)  \
+    HI_PROGRAM_UNIFORM_MATRICES(F, f, GLfloat) \
+    HI_PROGRAM_UNIFORM_MATRICES(F, d, GLdouble)
+
+// glUniform{COUNT}{SUFFIX} and glUniform{COUNT}{SUFFIX}v
+#define HI_UNIFORM_VECTOR(F, COUNT, SUFFIX, TYPE)                                                                                              \
+    F(void, glUniform##COUNT##SUFFIX, (GLint location, HI_PROGRAM_UNIFORM_PARAMETERS_##COUNT(TYPE)), (location, HI_PROGRAM_UNIFORM_ARGUMENTS_##COUNT)) \
+    F(void, glUniform##COUNT##SUFFIX##v, (GLint location, GLsizei count, const TYPE* value), (location, count, value))
+#define HI_UNIFORM_VECTORS(F, SUFFIX, TYPE) \
+    HI_UNIFORM_VECTOR(F, 1, SUFFIX, TYPE)   \
+    HI_UNIFORM_VECTOR(F, 2, SUFFIX, TYPE)   \
+    HI_UNIFORM_VECTOR(F, 3, SUFFIX, TYPE)   \
+    HI_UNIFORM_VECTOR(F, 4, SUFFIX, TYPE)
+
+// glUniformMatrix{DIMENSIONS}{SUFFIX}v
+#define HI_UNIFORM_MATRIX(F, DIMENSIONS, SUFFIX, TYPE) \
+    F(void, glUniformMatrix##DIMENSIONS##SUFFIX##v, (GLint location, GLsizei count, GLboolean transpose, const TYPE* value), (location, count, transpose, value))
+
+/// Uniforms of bound program: glUniform1i, ..., glUniformMatrix4x3dv (except of glUniformMatrix4fv, which has own handler)
+#define HI_UNIFORM_ENTRY_POINTS(F)           \
+    HI_UNIFORM_VECTORS(F, i, GLint)          \
+    HI_UNIFORM_VECTORS(F, f, GLfloat)        \
+    HI_UNIFORM_VECTORS(F, d, GLdouble)       \
+    HI_UNIFORM_VECTORS(F, ui, GLuint)        \
+    HI_UNIFORM_MATRIX(F, 2, f, GLfloat)      \
+    HI_UNIFORM_MATRIX(F, 3, f, GLfloat)      \
+    HI_UNIFORM_MATRIX(F, 2x3, f, GLfloat)    \
+    HI_UNIFORM_MATRIX(F, 3x2, f, GLfloat)    \
+    HI_UNIFORM_MATRIX(F, 2x4, f, GLfloat)    \
+    HI_UNIFORM_MATRIX(F, 4x2, f, GLfloat)    \
+    HI_UNIFORM_MATRIX(F, 3x4, f, GLfloat)    \
+    HI_UNIFORM_MATRIX(F, 4x3, f, GLfloat)    \
+    HI_UNIFORM_MATRIX(F, 2, d, GLdouble)     \
+    HI_UNIFORM_MATRIX(F, 3, d, GLdouble)     \
+    HI_UNIFORM_MATRIX(F, 4, d, GLdouble)     \
+    HI_UNIFORM_MATRIX(F, 2x3, d, GLdouble)   \
+    HI_UNIFORM_MATRIX(F, 3x2, d, GLdouble)   \
+    HI_UNIFORM_MATRIX(F, 2x4, d, GLdouble)   \
+    HI_UNIFORM_MATRIX(F, 4x2, d, GLdouble)   \
+    HI_UNIFORM_MATRIX(F, 3x4, d, GLdouble)   \
+    HI_UNIFORM_MATRIX(F, 4x3, d, GLdouble)
+
+#endif
@@ -6,41 +6,232 @@
 *
 *****************************************************************************/
 
+#ifndef HI_SYMBOL_REDIRECTION_HPP
+#define HI_SYMBOL_REDIRECTION_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
 namespace hi
 {
 namespace hooking
 {
     /**
-     * @brief 
+     * @brief Table of known symbols and their redirections
+     *
+     * Symbols are added during library initialization. The first lookup afterwards builds a
+     * read-only perfect-hash table (hash & displace), thus lookups (dlsym, glXGetProcAddress)
+     * take no lock, do no allocation and compare a single string.
+     *
+     * Besides the redirected symbols, table may contain known symbols without redirection.
+     * For all symbols, the address of original implementation is cached on first resolution.
      */
     class SymbolRedirection
     {
+    public:
+        struct Symbol
+        {
+            explicit Symbol(const std::string& symbolName)
+                : name(symbolName)
+            {
+            }
+            std::string name;
+            /// Redirection target, or nullptr for known symbol without redirection
+            void* target = nullptr;
+            /// Original (driver's) address as resolved with RTLD_NEXT, cached on first call through redirector
+            mutable std::atomic<void*> original = nullptr;
+        };
+
     private:
-        using dictType = std::unordered_map<std::string, void*>;
-        dictType mapping;
+        /// Perfect-hash index over m_Symbols
+        struct Table
+        {
+            uint64_t seed = 0;
+            std::vector<uint32_t> displacements;
+            std::vector<const Symbol*> slots;
+        };
+
+        std::deque<Symbol> m_Symbols;
+        std::unordered_map<std::string, Symbol*> m_SymbolsByName;
+
+        mutable std::atomic<const Table*> m_Table = nullptr;
+        mutable std::atomic<bool> m_IsDirty = false;
+        /// Guards (re)building of table
+        mutable std::mutex m_BuildMutex;
+        /// Tables are never released before destruction, as they may be used by concurrent lookups
+        mutable std::vector<std::unique_ptr<Table>> m_Tables;
+
+        static uint64_t hash(const char* name, uint64_t seed)
+        {
+            // FNV-1a
+            uint64_t result = 14695981039346656037ull ^ seed;
+            for (; *name; name++)
+            {
+                result ^= static_cast<uint8_t>(*name);
+                result *= 1099511628211ull;
+            }
+            return result;
+        }
+
+        static uint64_t mix(uint64_t value)
+        {
+            // splitmix64 finalizer
+            value ^= value >> 30;
+            value *= 0xbf58476d1ce4e5b9ull;
+            value ^= value >> 27;
+            value *= 0x94d049bb133111ebull;
+            return value ^ (value >> 31);
+        }
+
+        static size_t getBucket(const Table& table, uint64_t hashValue)
+        {
+            return (hashValue >> 32) % table.displacements.size();
+        }
+
+        static size_t getSlot(const Table& table, uint64_t hashValue, uint32_t displacement)
+        {
+            return mix(hashValue + displacement * 0x9e3779b97f4a7c15ull) & (table.slots.size() - 1);
+        }
+
+        /// Try to place all symbols into slots using hash & displace, returns false on failure
+        bool tryBuild(Table& table) const
+        {
+            std::vector<std::vector<const Symbol*>> buckets(table.displacements.size());
+            for (const auto& symbol : m_Symbols)
+            {
+                buckets[getBucket(table, hash(symbol.name.c_str(), table.seed))].push_back(&symbol);
+            }
+            std::vector<size_t> order(buckets.size());
+            for (size_t i = 0; i < order.size(); i++)
+                order[i] = i;
+            // Place largest buckets first, while there are many free slots
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+            constexpr uint32_t maxDisplacement = 1u << 16;
+            std::vector<size_t> candidateSlots;
+            for (auto bucketID : order)
+            {
+                const auto& bucket = buckets[bucketID];
+                if (bucket.empty())
+                    break;
+                bool isPlaced = false;
+                for (uint32_t displacement = 0; displacement < maxDisplacement && !isPlaced; displacement++)
+                {
+                    candidateSlots.clear();
+                    isPlaced = true;
+                    for (const auto* symbol : bucket)
+                    {
+                        const auto slot = getSlot(table, hash(symbol->name.c_str(), table.seed), displacement);
+                        if (table.slots[slot] || std::find(candidateSlots.begin(), candidateSlots.end(), slot) != candidateSlots.end())
+                        {
+                            isPlaced = false;
+                            break;
+                        }
+                        candidateSlots.push_back(slot);
+                    }
+                    if (isPlaced)
+                    {
+                        for (size_t i = 0; i < bucket.size(); i++)
+                            table.slots[candidateSlots[i]] = bucket[i];
+                        table.displacements[bucketID] = displacement;
+                    }
+                }
+                if (!isPlaced)
+                    return false;
+            }
+            return true;
+        }
+
+        const Table* rebuild() const
+        {
+            std::lock_guard<std::mutex> lock(m_BuildMutex);
+            if (!m_IsDirty.load(std::memory_order_acquire))
+                return m_Table.load(std::memory_order_acquire);
+
+            size_t slotCount = 1;
+            while (slotCount < 2 * m_Symbols.size())
+                slotCount *= 2;
+            auto table = std::make_unique<Table>();
+            for (uint64_t seed = 0;; seed++)
+            {
+                table->seed = seed;
+                table->displacements.assign(std::max<size_t>(1, m_Symbols.size() / 4), 0);
+                table->slots.assign(slotCount, nullptr);
+                if (tryBuild(*table))
+                    break;
+            }
+            m_Tables.push_back(std::move(table));
+            m_Table.store(m_Tables.back().get(), std::memory_order_release);
+            m_IsDirty.store(false, std::memory_order_release);
+            return m_Tables.back().get();
+        }
 
     public:
         SymbolRedirection() = default;
-        bool hasRedirection(const std::string& symbolName) const
+
+        /// Add known symbol, optionally with redirection target (initialization only)
+        void addSymbol(const std::string& symbolName, void* target = nullptr)
         {
-            return mapping.count(symbolName) > 0;
+            auto it = m_SymbolsByName.find(symbolName);
+            auto symbol = (it != m_SymbolsByName.end()) ? it->second : &m_Symbols.emplace_back(symbolName);
+            m_SymbolsByName[symbolName] = symbol;
+            if (target)
+                symbol->target = target;
+            m_IsDirty.store(true, std::memory_order_release);
         }
-        void* getTarget(const std::string& symbolName) const
+
+        void addRedirection(const std::string& symbol, void* address)
         {
-            return mapping.at(symbolName);
+            addSymbol(symbol, address);
         }
 
-        void addRedirection(const std::string& symbol, void* address)
+        /// Find known symbol, returns nullptr if unknown (lock-free once table is built)
+        const Symbol* find(const char* symbolName) const
+        {
+            auto table = m_Table.load(std::memory_order_acquire);
+            if (m_IsDirty.load(std::memory_order_acquire))
+                table = rebuild();
+            if (!table || table->slots.empty())
+                return nullptr;
+            const auto hashValue = hash(symbolName, table->seed);
+            const auto symbol = table->slots[getSlot(*table, hashValue, table->displacements[getBucket(*table, hashValue)])];
+            if (!symbol || std::strcmp(symbol->name.c_str(), symbolName) != 0)
+                return nullptr;
+            return symbol;
+        }
+
+        bool hasRedirection(const char* symbolName) const
+        {
+            auto symbol = find(symbolName);
+            return symbol && symbol->target;
+        }
+
+        void* getTarget(const char* symbolName) const
         {
-            mapping[symbol] = address;
+            auto symbol = find(symbolName);
+            return symbol ? symbol->target : nullptr;
         }
 
-        const dictType& getMapping() const
+        /// Get names of redirected symbols
+        std::vector<std::string> getRedirectedSymbols() const
         {
-            return mapping;
+            std::vector<std::string> result;
+            for (const auto& symbol : m_Symbols)
+            {
+                if (symbol.target)
+                    result.push_back(symbol.name);
+            }
+            return result;
         }
     };
 } //namespace hooking
 } //namespace hi
+#endif
@@ -0,0 +1,35 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        log_decoder.cpp
+*
+*****************************************************************************/
+
+#include "binary_logger.hpp"
+#include <fstream>
+#include <iostream>
+
+/// Converts binary log (produced with HI_BINARY_LOG=<file>) into text
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <binary log>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input.is_open())
+    {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    if (!hi::BinaryLogger::decode(input, std::cout))
+    {
+        std::cerr << "Malformed or truncated log: " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
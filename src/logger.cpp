@@ -7,6 +7,7 @@
 *****************************************************************************/
 
 #include "logger.hpp"
+#include "utils/enviroment.hpp"
 #include <memory>
 
 hi::Logger& hi::Logger::getInstance()
@@ -15,6 +16,10 @@ hi::Logger& hi::Logger::getInstance()
     if (!m_singleton)
     {
         m_singleton.reset(new hi::Logger());
+        if (hi::enviroment::hasEnviromentalVariable("HI_BINARY_LOG"))
+        {
+            m_singleton->setBinaryOutput(hi::enviroment::getEnviromentValueStr("HI_BINARY_LOG"));
+        }
     }
     return *m_singleton;
 }
@@ -44,9 +49,24 @@ void hi::Logger::printLog(const std::string& msg, LogLevel level)
 
 void hi::Logger::flush()
 {
+    if (m_BinaryLogger)
+        m_BinaryLogger->flush();
     fflush(stdout);
 }
 
+void hi::Logger::setBinaryOutput(const std::string& path)
+{
+    m_BinaryLogger.reset();
+    if (path.empty())
+        return;
+    m_BinaryLogger = std::make_unique<hi::BinaryLogger>(path);
+    if (!m_BinaryLogger->isOpen())
+    {
+        m_BinaryLogger.reset();
+        logError("Failed to open binary log: ", path);
+    }
+}
+
 void hi::Logger::printLogBanner(LogLevel level)
 {
     printf("[Repeater]");
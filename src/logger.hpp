@@ -9,13 +9,43 @@
 #ifndef HI_LOGGER_HPP
 #define HI_LOGGER_HPP
 
+#include "binary_logger.hpp"
+#include <cstring>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <type_traits>
+
+/**
+ * Compile-time log threshold: messages with a level above the threshold compile to nothing.
+ * Configured by CMake's HOLOINJECTOR_LOG_LEVEL, defaults to keeping all levels
+ * (3 = DEBUG_PER_FRAME_LOG).
+ */
+#ifndef HI_LOG_LEVEL_THRESHOLD
+#define HI_LOG_LEVEL_THRESHOLD 3
+#endif
+
+/// Source position of log message (formatted only when message is printed)
+#define HI_POS (hi::LogPosition { __FILE__, __LINE__ })
 
-#define HI_POS (__FILE__ ":" + std::to_string(__LINE__))
+/// String literal, which binary log stores as pointer (concatenation rejects non-literals)
+#define HI_LITERAL(str) (hi::LogLiteral { "" str })
 
 namespace hi
 {
+/// Lightweight source position, see HI_POS
+struct LogPosition
+{
+    const char* file;
+    int line;
+};
+
+/// String with static storage duration, see HI_LITERAL
+struct LogLiteral
+{
+    const char* str;
+};
+
 class Logger
 {
     Logger() = default;
@@ -45,6 +75,12 @@ public:
     /// Get currently set maximum
     LogLevel getMaximumLevel() const;
 
+    /// Determine if message of level would be printed (checked before formatting)
+    inline static bool isLevelEnabled(LogLevel level)
+    {
+        return level <= HI_LOG_LEVEL_THRESHOLD && level <= getInstance().m_maximalLogLevel;
+    }
+
     /// Debug Per-Frame: Increment current frame number
     void incrementFrameNumber();
 
@@ -58,68 +94,138 @@ public:
          * message has a level, which is then used by logger to prevent 
          * logging excessive amount of messages. This is can controlled 
          * by setMaximumLevel(). By default, INFO logs are dumped at least.
+         *
+         * The level is checked by log*() helpers prior to formatting, thus disabled messages
+         * cost neither allocation nor formatting. Arguments, which are expensive to evaluate, can
+         * be passed as callables (e.g. [&] { return dump(); }), evaluated only when printed.
          */
     void printLog(const std::string& msg, LogLevel level = LogLevel::INFO_LOG);
 
     /// Force flush
     void flush();
 
+    /**
+     * @brief Redirect messages into binary log file (see BinaryLogger)
+     *
+     * @param path Output file, empty path restores printing to stdout
+     *
+     * Enabled at startup when HI_BINARY_LOG=<path> is set. The file is decoded
+     * by hi-log-decoder.
+     */
+    void setBinaryOutput(const std::string& path);
+
     inline static const std::string ToString() { return ""; }
     inline static const std::string ToString(const char* str) { return str; }
-    inline static const std::string ToString(const std::string str) { return str; }
+    inline static const std::string ToString(const std::string& str) { return str; }
     inline static const std::string ToString(int arg) { return std::to_string(arg); }
     inline static const std::string ToString(unsigned int arg) { return std::to_string(arg); }
     inline static const std::string ToString(unsigned long int arg) { return std::to_string(arg); }
     inline static const std::string ToString(double arg) { return std::to_string(arg); }
+    inline static const std::string ToString(const LogLiteral& literal) { return literal.str; }
+    inline static const std::string ToString(const LogPosition& pos) { return std::string(pos.file) + ":" + std::to_string(pos.line); }
     inline static const std::string ToString(void* ptr)
     {
         std::ostringstream out;
         out << ptr;
         return out.str();
     }
+    /// Lazy argument: callable, evaluated only when message is printed
+    template <typename T, typename = std::enable_if_t<std::is_invocable_v<const T&>>>
+    inline static const std::string ToString(const T& lazyArg)
+    {
+        return ToString(lazyArg());
+    }
+
+    /// Store argument into binary record, mirrors ToString()
+    template <typename T>
+    inline static void Encode(BinaryLogger::Encoder& encoder, const T& arg)
+    {
+        using Type = std::remove_cv_t<T>;
+        if constexpr (std::is_same_v<Type, LogPosition>)
+            encoder.addPosition(arg.file, arg.line);
+        else if constexpr (std::is_same_v<Type, LogLiteral>)
+            encoder.addLiteral(arg.str);
+        else if constexpr (std::is_array_v<Type> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<Type>>, char>)
+            encoder.addString(arg, strnlen(arg, std::extent_v<Type>));
+        else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>)
+            encoder.addString(arg, std::strlen(arg));
+        else if constexpr (std::is_same_v<Type, std::string>)
+            encoder.addString(arg.data(), arg.size());
+        else if constexpr (std::is_invocable_v<const T&>)
+            Encode(encoder, arg());
+        else if constexpr (std::is_floating_point_v<Type>)
+            encoder.addDouble(arg);
+        else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>)
+            encoder.addInt(arg);
+        else if constexpr (std::is_integral_v<Type>)
+            encoder.addUInt(arg);
+        else if constexpr (std::is_enum_v<Type>)
+            encoder.addInt(static_cast<int64_t>(arg));
+        else if constexpr (std::is_pointer_v<Type>)
+            encoder.addPointer(arg);
+        else
+        {
+            const auto str = ToString(arg);
+            encoder.addString(str.data(), str.size());
+        }
+    }
 
     inline static const std::string ToStringVariadic() { return ""; };
 
     template <typename T, typename... ARGS>
-    inline static const std::string ToStringVariadic(T arg, ARGS... args)
+    inline static const std::string ToStringVariadic(const T& arg, const ARGS&... args)
     {
         return ToString(arg) + " " + ToStringVariadic(args...);
     }
 
     template <typename... ARGS, unsigned _Level = LogLevel::INFO_LOG>
-    inline static void log(ARGS... msgParts)
+    inline static void log(const ARGS&... msgParts)
     {
-        const auto logResult = ToStringVariadic(msgParts...) + "\n";
-        getInstance().printLog(logResult, static_cast<LogLevel>(_Level));
+        logWithLevel<static_cast<LogLevel>(_Level)>("", msgParts...);
     }
 
     template <typename... ARGS>
-    inline static void logError(ARGS... msgParts)
+    inline static void logError(const ARGS&... msgParts)
     {
-        const auto logResult = ToStringVariadic(msgParts...) + "\n";
-        getInstance().printLog(logResult, static_cast<LogLevel>(LogLevel::ERROR_LOG));
+        logWithLevel<LogLevel::ERROR_LOG>("", msgParts...);
         getInstance().flush();
     }
 
     template <typename... ARGS>
-    inline static void logDebug(ARGS... msgParts)
+    inline static void logDebug(const ARGS&... msgParts)
     {
-        const auto logResult = "Debug: " + ToStringVariadic(msgParts...) + "\n";
-        getInstance().printLog(logResult, static_cast<LogLevel>(LogLevel::DEBUG_LOG));
+        logWithLevel<LogLevel::DEBUG_LOG>("Debug: ", msgParts...);
     }
     template <typename... ARGS>
-    inline static void logDebugPerFrame(ARGS... msgParts)
+    inline static void logDebugPerFrame(const ARGS&... msgParts)
     {
-        const auto logResult = "Debug: " + ToStringVariadic(msgParts...) + "\n";
-        getInstance().printLog(logResult, static_cast<LogLevel>(LogLevel::DEBUG_PER_FRAME_LOG));
+        logWithLevel<LogLevel::DEBUG_PER_FRAME_LOG>("Debug: ", msgParts...);
     }
 
 private:
+    template <LogLevel _Level, typename... ARGS>
+    inline static void logWithLevel(const char* prefix, const ARGS&... msgParts)
+    {
+        if constexpr (_Level <= HI_LOG_LEVEL_THRESHOLD)
+        {
+            if (!isLevelEnabled(_Level))
+                return;
+            if (auto binaryLogger = getInstance().m_BinaryLogger.get())
+            {
+                binaryLogger->write(_Level, [&](BinaryLogger::Encoder& encoder) { (Encode(encoder, msgParts), ...); });
+                return;
+            }
+            getInstance().printLog(prefix + ToStringVariadic(msgParts...) + "\n", _Level);
+        }
+    }
+
     void printLogBanner(LogLevel level);
 
-    LogLevel m_maximalLogLevel = DEBUG_PER_FRAME_LOG;
+    LogLevel m_maximalLogLevel = INFO_LOG;
 
     size_t m_currentFrameID = 0;
+
+    std::unique_ptr<BinaryLogger> m_BinaryLogger;
 };
 } //namespace hi
 
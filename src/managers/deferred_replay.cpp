@@ -0,0 +1,126 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        managers/deferred_replay.cpp
+*
+*****************************************************************************/
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GL/gl.h>
+
+#include "context.hpp"
+#include "logger.hpp"
+#include "managers/deferred_replay.hpp"
+#include "pipeline/injector_parameters.hpp"
+#include "pipeline/output_fbo.hpp"
+#include "pipeline/virtual_cameras.hpp"
+#include "trackers/framebuffer_tracker.hpp"
+#include "trackers/shader_tracker.hpp"
+#include "trackers/state_tracker.hpp"
+
+using namespace hi;
+using namespace hi::managers;
+
+bool DeferredReplay::begin(Context& context)
+{
+    // Draw call would be missing in application's display list
+    // Vertex data of VAO 0 may reside in client memory, which is only valid during draw call
+    const auto& state = context.getStateTracker();
+    if (state.isCompilingList() || state.getBoundVertexArray() == 0)
+    {
+        flush(context);
+        return false;
+    }
+
+    const auto& fbo = context.getFBOTracker().hasBounded() ? context.getFBOTracker().getBound() : nullptr;
+    if (m_IsRecording)
+    {
+        // Recording must only contain draw calls into a single FBO, and draw calls of each
+        // program must share uniforms
+        const auto program = context.getManager().getBoundId();
+        auto epoch = m_UniformEpochs.find(program);
+        const bool haveUniformsChanged = (epoch != m_UniformEpochs.end() && epoch->second != context.getManager().getBound()->m_UniformEpoch);
+        if (fbo == m_TargetFBO && !haveUniformsChanged)
+            return true;
+        flush(context);
+    }
+
+    m_IsRecording = true;
+    m_TargetFBO = fbo;
+    return true;
+}
+
+bool DeferredReplay::isRecording() const
+{
+    return m_IsRecording;
+}
+
+void DeferredReplay::record(Context& context, const std::function<void(void)>& code)
+{
+    Command command;
+    command.drawCall = code;
+    command.program = context.getManager().getBoundId();
+    command.vertexArray = context.getStateTracker().getBoundVertexArray();
+    m_UniformEpochs[command.program] = context.getManager().getBound()->m_UniformEpoch;
+    m_Commands.push_back(std::move(command));
+}
+
+void DeferredReplay::flush(Context& context)
+{
+    if (!m_IsRecording)
+        return;
+    m_IsRecording = false;
+
+    auto target = std::move(m_TargetFBO);
+    m_TargetFBO = nullptr;
+    auto commands = std::move(m_Commands);
+    m_Commands.clear();
+    m_UniformEpochs.clear();
+    if (commands.empty())
+        return;
+
+    auto& parameters = context.getInjectorParameters();
+    const auto applicationProgram = context.getManager().getBoundId();
+    const auto applicationVertexArray = context.getStateTracker().getBoundVertexArray();
+    GLuint program = applicationProgram, vertexArray = applicationVertexArray;
+    const auto countOfViews = context.getCameras().getCameras().size();
+    for (size_t view = 0; view < countOfViews; view++)
+    {
+        const auto proxyFBO = (target ? target->createProxyFBO(view) : context.getOutputFBO().createProxyFBO(view));
+        glBindFramebuffer(GL_FRAMEBUFFER, proxyFBO);
+        parameters.setReplayView(view);
+        for (const auto& command : commands)
+        {
+            if (command.program != program)
+            {
+                program = command.program;
+                glUseProgram(program);
+            }
+            if (command.vertexArray != vertexArray)
+            {
+                vertexArray = command.vertexArray;
+                glBindVertexArray(vertexArray);
+            }
+            command.drawCall();
+        }
+    }
+    parameters.setReplayView(-1);
+    Logger::logDebugPerFrame(HI_LITERAL("Replayed"), commands.size(), HI_LITERAL("draw calls into"), countOfViews, HI_LITERAL("views"), HI_POS);
+
+    // Restore application's bindings, draw calls, which follow, expect layered FBO to be bound
+    if (program != applicationProgram)
+        glUseProgram(applicationProgram);
+    if (vertexArray != applicationVertexArray)
+        glBindVertexArray(applicationVertexArray);
+    glBindFramebuffer(GL_FRAMEBUFFER, (target ? target->getShadowFBO() : context.getOutputFBO().getFBOId()));
+}
+
+void DeferredReplay::deinitialize()
+{
+    // Recording of destroyed context can't be replayed anymore
+    m_IsRecording = false;
+    m_TargetFBO = nullptr;
+    m_Commands.clear();
+    m_UniformEpochs.clear();
+}
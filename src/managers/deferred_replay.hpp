@@ -0,0 +1,80 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        managers/deferred_replay.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_DEFERRED_REPLAY_HPP
+#define HI_DEFERRED_REPLAY_HPP
+
+#include <GL/gl.h>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace hi
+{
+class Context;
+namespace trackers
+{
+    class FramebufferMetadata;
+}
+namespace managers
+{
+    /**
+     * @brief Records draw calls into a command list and replays them view-major
+     *
+     * Repeating each draw call per view switches single-view FBO for every (draw, view)
+     * pair. Instead, consecutive draw calls into the same FBO are recorded as commands,
+     * which hold the draw call along with bound program and VAO. When the recording is
+     * flushed, the commands are issued once per view into its single-view FBO, thus FBOs
+     * are switched only once per view. Injected vertex shaders select the view from
+     * 'injector_replayViewID' (see InjectorParameters::setReplayView()).
+     *
+     * Other state is not recorded, thus any command, which changes state of recorded draws
+     * (textures, capabilities, viewport, buffer bindings), modifies their data, or consumes
+     * their result (FBO binding, clear, buffer & texture uploads, swap), must flush first.
+     * Program's uniforms can't be restored either, thus program, whose uniforms have been
+     * updated since its last recorded draw call, flushes the recording (see ShaderProgram::m_UniformEpoch).
+     */
+    class DeferredReplay
+    {
+    public:
+        DeferredReplay() = default;
+
+        /**
+         * @brief Start recording into currently bound FBO, or continue current recording
+         *
+         * @return false if draw call can't be recorded (e.g. application is compiling
+         * its own display list), in which case draw call must be issued immediately
+         */
+        bool begin(Context& context);
+        /// Is there an open recording?
+        bool isRecording() const;
+        /// Record draw call of bound program & VAO (code must not reference caller's stack)
+        void record(Context& context, const std::function<void(void)>& code);
+        /// Close recording and replay it into all views, restores layered FBO binding
+        void flush(Context& context);
+        /// Clean up (drop recording of destroyed context)
+        void deinitialize();
+
+    private:
+        struct Command
+        {
+            std::function<void(void)> drawCall;
+            GLuint program = 0;
+            GLuint vertexArray = 0;
+        };
+        std::vector<Command> m_Commands;
+        /// Uniform epoch of programs, whose draw calls have been recorded
+        std::unordered_map<GLuint, size_t> m_UniformEpochs;
+        bool m_IsRecording = false;
+        /// Application's FBO, which recorded draw calls target (nullptr = default framebuffer)
+        std::shared_ptr<hi::trackers::FramebufferMetadata> m_TargetFBO;
+    };
+} // namespace managers
+} // namespace hi
+#endif
@@ -0,0 +1,79 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        managers/draw_decision_cache.cpp
+*
+*****************************************************************************/
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GL/gl.h>
+
+#include "context.hpp"
+#include "managers/draw_decision_cache.hpp"
+#include "trackers/framebuffer_tracker.hpp"
+#include "trackers/shader_tracker.hpp"
+
+using namespace hi;
+using namespace hi::managers;
+
+const DrawDecision& DrawDecisionCache::get(Context& context)
+{
+    const auto linkEpoch = trackers::ShaderProgram::getLinkEpoch();
+    const auto framebufferEpoch = trackers::FramebufferMetadata::getStateEpoch();
+    if (linkEpoch != m_LinkEpoch || framebufferEpoch != m_FramebufferEpoch)
+    {
+        m_Decisions.clear();
+        m_LinkEpoch = linkEpoch;
+        m_FramebufferEpoch = framebufferEpoch;
+    }
+
+    const auto key = (static_cast<uint64_t>(context.getManager().getBoundId()) << 32) | static_cast<uint32_t>(context.getFBOTracker().getBoundId());
+    auto it = m_Decisions.find(key);
+    if (it == m_Decisions.end())
+    {
+        it = m_Decisions.emplace(key, evaluate(context)).first;
+    }
+    return it->second;
+}
+
+void DrawDecisionCache::clear()
+{
+    m_Decisions.clear();
+}
+
+DrawDecision DrawDecisionCache::evaluate(Context& context)
+{
+    DrawDecision decision;
+
+    auto& fbos = context.getFBOTracker();
+    if (fbos.hasBounded())
+    {
+        decision.isRepeatingSuitable = fbos.isSuitableForRepeating();
+        decision.isSingleViewPossible = fbos.getBound()->hasShadowFBO();
+    }
+
+    const auto& programs = context.getManager();
+    if (!programs.hasBounded())
+        return decision;
+    const auto& program = programs.getBoundConst();
+    if (!program->hasMetadata())
+        return decision;
+    const auto& metadata = *program->m_Metadata;
+    decision.shouldSkip = metadata.m_IsInvisible;
+    decision.isUBOused = metadata.isUBOused();
+    if (!program->isInjected())
+        return decision;
+
+    if (metadata.usesMultiviewExtension())
+        decision.method = DrawDecision::Method::MULTIVIEW_EXTENSION;
+    else if (metadata.usesGeometryShader())
+        decision.method = DrawDecision::Method::GEOMETRY_SHADER;
+    else
+        decision.method = DrawDecision::Method::VERTEX_SHADER;
+
+    decision.usesInstancedLayering = metadata.usesInstancedLayering();
+    decision.usesLayeredSamplers = metadata.usesLayeredSamplers();
+    decision.isReplayable = (decision.method == DrawDecision::Method::VERTEX_SHADER && program->m_InjectorUniforms.hasParametersBlock());
+    return decision;
+}
@@ -0,0 +1,81 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        managers/draw_decision_cache.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_DRAW_DECISION_CACHE_HPP
+#define HI_DRAW_DECISION_CACHE_HPP
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace hi
+{
+class Context;
+
+namespace managers
+{
+    /**
+     * @brief How draw call should be replicated into views, given bound program & FBO
+     *
+     * Only answers, which depend on program's metadata and FBO's attachments, are stored.
+     * Bindings, which change between draw calls (e.g. textures), are still tested per draw.
+     */
+    struct DrawDecision
+    {
+        enum class Method : uint8_t
+        {
+            /// No program or program without injection => repeat draw call
+            LEGACY,
+            GEOMETRY_SHADER,
+            VERTEX_SHADER,
+            MULTIVIEW_EXTENSION,
+        };
+        Method method = Method::LEGACY;
+
+        /// Program has been made invisible by profile
+        bool shouldSkip = false;
+        /// FBO is not a shadow map / environment map (or default FBO is bound)
+        bool isRepeatingSuitable = true;
+        /// FBO has shadow FBO (or default FBO is bound)
+        bool isSingleViewPossible = true;
+
+        /// Program's transformation is stored in uniform block
+        bool isUBOused = false;
+        /// Injected VS can replicate draw call by instancing
+        bool usesInstancedLayering = false;
+        /// Injected FS can sample layered shadow textures
+        bool usesLayeredSamplers = false;
+        /// Injected VS reads view of replayed draw call from parameters block
+        bool isReplayable = false;
+    };
+
+    /**
+     * @brief Caches DrawDecision per (program, FBO) pair
+     *
+     * Decisions are dropped whenever a program is linked or any FBO's attachments or shadow
+     * FBO change (see ShaderProgram::getLinkEpoch(), FramebufferMetadata::getStateEpoch()),
+     * thus draw calls with unchanged bindings only pay a lookup.
+     */
+    class DrawDecisionCache
+    {
+    public:
+        /// Get decision for currently bound program & FBO
+        const DrawDecision& get(Context& context);
+        /// Drop all decisions
+        void clear();
+
+    private:
+        static DrawDecision evaluate(Context& context);
+
+        std::unordered_map<uint64_t, DrawDecision> m_Decisions;
+        size_t m_LinkEpoch = 0;
+        size_t m_FramebufferEpoch = 0;
+    };
+} // namespace managers
+} // namespace hi
+
+#endif
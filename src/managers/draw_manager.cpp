@@ -10,6 +10,7 @@
 #include <GL/gl.h>
 
 #include <glm/gtc/type_ptr.hpp>
+#include <vector>
 
 #include "context.hpp"
 #include "draw_manager.hpp"
@@ -20,7 +21,9 @@
 #include "pipeline/virtual_cameras.hpp"
 #include "trackers/framebuffer_tracker.hpp"
 #include "trackers/legacy_tracker.hpp"
+#include "trackers/renderbuffer_tracker.hpp"
 #include "trackers/shader_tracker.hpp"
+#include "trackers/state_tracker.hpp"
 #include "trackers/texture_tracker.hpp"
 #include "trackers/uniform_block_tracing.hpp"
 
@@ -37,41 +40,119 @@ namespace uniforms
          * \brief Injector internal: don't repeat draw calls and render to a single output layer of
          * bounded FBO
          */
-    void renderToSingleLayer(size_t shaderId, size_t layerID)
+    void renderToSingleLayer(Context& context, size_t layerID)
     {
-        if(shaderId == 0)
+        if (!context.getManager().hasBounded())
             return;
+        const auto& locations = context.getManager().getBound()->m_InjectorUniforms;
         CLEAR_GL_ERROR();
-        auto loc = glGetUniformLocation(shaderId, "injector_isSingleViewActivated");
-        glUniform1i(loc, true);
+        glUniform1i(locations.isSingleViewActivated, true);
         ASSERT_GL_ERROR();
 
-        loc = glGetUniformLocation(shaderId, "injector_singleViewID");
-        glUniform1i(loc, layerID);
+        glUniform1i(locations.singleViewID, layerID);
         ASSERT_GL_ERROR();
+
+        glUniform1i(locations.instancedViews, 1);
     }
     /*
          * \brief Injector internal: replicate transformed geometry to all output layers of bound FBO
          */
-    void renderToAllLayers(size_t shaderId)
+    void renderToAllLayers(Context& context)
     {
-        auto loc = glGetUniformLocation(shaderId, "injector_isSingleViewActivated");
-        glUniform1i(loc, false);
+        if (!context.getManager().hasBounded())
+            return;
+        const auto& locations = context.getManager().getBound()->m_InjectorUniforms;
+        glUniform1i(locations.isSingleViewActivated, false);
+        ASSERT_GL_ERROR();
+    }
+    /*
+         * \brief Injector internal: derive view from gl_InstanceID (draw call must be amplified by views)
+         */
+    void renderToAllLayersInstanced(Context& context, size_t views)
+    {
+        if (!context.getManager().hasBounded())
+            return;
+        const auto& locations = context.getManager().getBound()->m_InjectorUniforms;
+        glUniform1i(locations.isSingleViewActivated, false);
+        glUniform1i(locations.instancedViews, views);
         ASSERT_GL_ERROR();
     }
 }
+namespace samplers
+{
+    /*
+         * \brief Injector internal: sample shadowed textures of bound program by layered samplers
+         *
+         * Returns texture units of redirected samplers (-1 = sampler was not redirected), or
+         * empty vector if no sampler samples a shadowed texture.
+         */
+    std::vector<GLint> redirectToLayeredTextures(Context& context)
+    {
+        const auto& program = context.getManager().getBound();
+        const auto& locations = program->m_InjectorUniforms.layeredSamplers;
+        const auto& textureUnits = context.getTextureTracker().getTextureUnits();
+
+        std::vector<GLint> units(locations.size(), -1);
+        bool hasRedirectedSampler = false;
+        for (size_t i = 0; i < locations.size(); i++)
+        {
+            if (locations[i].sampler == -1 || locations[i].isLayered == -1 || locations[i].layeredSampler == -1)
+                continue;
+            // Application's unit is mirrored from glUniform1i(v) (see ShaderProgram::setSamplerUnits)
+            const auto unit = (i < program->m_LayeredSamplerUnits.size() ? program->m_LayeredSamplerUnits[i] : 0);
+            if (unit < 0 || !textureUnits.isUnitShadowed(unit))
+                continue;
+            // Original sampler must not share unit with layered sampler of different type
+            glUniform1i(locations[i].sampler, trackers::TextureUnitTracker::getReservedUnit(GL_TEXTURE_2D));
+            glUniform1i(locations[i].layeredSampler, unit);
+            glUniform1i(locations[i].isLayered, true);
+            units[i] = unit;
+            hasRedirectedSampler = true;
+        }
+        return (hasRedirectedSampler ? units : std::vector<GLint> {});
+    }
+
+    /*
+         * \brief Injector internal: restore application's samplers after redirectToLayeredTextures()
+         */
+    void restoreOriginalTextures(Context& context, const std::vector<GLint>& units)
+    {
+        const auto& locations = context.getManager().getBound()->m_InjectorUniforms.layeredSamplers;
+        for (size_t i = 0; i < units.size(); i++)
+        {
+            if (units[i] == -1)
+                continue;
+            glUniform1i(locations[i].sampler, units[i]);
+            glUniform1i(locations[i].layeredSampler, trackers::TextureUnitTracker::getReservedUnit(GL_TEXTURE_2D_ARRAY));
+            glUniform1i(locations[i].isLayered, false);
+        }
+    }
+}
 }
 
-void DrawManager::draw(Context& context, const std::function<void(void)>& drawCallLambda)
+void DrawManager::draw(Context& context, const std::function<void(void)>& drawCallLambda, const InstancedDrawCall& instancedDrawCallLambda, std::optional<GLenum> primitiveMode)
 {
+    if (context.validateStateFlag)
+        validateState(context);
+
+    // Replication only depends on bound program & FBO => decided once per pair
+    auto decision = m_DrawDecisions.get(context);
+
     // Determine if shader is bound, if FBO is correctly bound, etc
-    if (shouldSkipDrawCall(context))
+    if (shouldSkipDrawCall(context, decision))
         return;
 
-    if (!context.m_IsMultiviewActivated || (context.getFBOTracker().hasBounded() && !context.getFBOTracker().isSuitableForRepeating()))
+    // Draw calls, which are not recorded, must not overtake recorded ones
+    const bool shouldRecordDrawCall = shouldRecord(context, decision, instancedDrawCallLambda != nullptr);
+    if (!shouldRecordDrawCall)
+    {
+        m_DeferredReplay.flush(context);
+    }
+
+    if (!context.m_IsMultiviewActivated || !decision.isRepeatingSuitable)
     {
         setInjectorIdentity(context);
-        drawGeneric(context, drawCallLambda);
+        drawGeneric(context, decision, drawCallLambda, instancedDrawCallLambda);
         return;
     }
 
@@ -85,6 +166,12 @@ void DrawManager::draw(Context& context, const std::function<void(void)>& drawCa
         glBindFramebuffer(GL_FRAMEBUFFER, context.getOutputFBO().getFBOId());
         glViewport(0, 0, context.getOutputFBO().getParams().getTextureWidth(), context.getOutputFBO().getParams().getTextureHeight());
     }
+
+    // Record draw call with its program & VAO, views are rendered once recording is flushed
+    if (shouldRecordDrawCall)
+    {
+        m_DeferredReplay.begin(context);
+    }
     /*else {
         auto fbo = context.getFBOTracker().getBound();
         auto fboId = context.getFBOTracker().getBoundId();
@@ -98,8 +185,17 @@ void DrawManager::draw(Context& context, const std::function<void(void)>& drawCa
         }
     }*/
 
+    // Shaderless draw call: substitute fixed-pipeline by injected emulation program
+    const bool isFixedPipelineEmulated = shouldEmulateFixedPipeline(context) && m_FixedPipeline.bind(context, primitiveMode);
+    if (isFixedPipelineEmulated)
+    {
+        decision = m_DrawDecisions.get(context);
+        const auto projection = hi::pipeline::estimatePerspectiveProjection(context.getLegacyTracker().getProjection());
+        setInjectorDecodedProjection(context, context.getManager().getBoundId(), projection);
+    }
+
     /// If Uniform Buffer Object (UBO) is used, then load values to uniforms
-    if (context.getManager().hasBounded() && context.getManager().getBound()->m_Metadata && context.getManager().getBound()->m_Metadata->isUBOused())
+    if (decision.isUBOused)
     {
         const auto& blockName = context.getManager().getBound()->m_Metadata->m_InterfaceBlockName;
         auto index = context.getManager().getBound()->m_UniformBlocks[blockName].bindingIndex;
@@ -122,19 +218,110 @@ void DrawManager::draw(Context& context, const std::function<void(void)>& drawCa
         const auto shaderID = context.getManager().getBoundId();
         setInjectorUniforms(shaderID, context);
     }
-    drawGeneric(context, drawCallLambda);
-    return;
+    drawGeneric(context, decision, drawCallLambda, instancedDrawCallLambda);
+
+    if (isFixedPipelineEmulated)
+    {
+        m_FixedPipeline.unbind(context);
+    }
 }
 
-bool DrawManager::shouldSkipDrawCall(Context& context)
+void DrawManager::flushDeferredDraws(Context& context)
 {
-    if (context.getManager().hasBounded())
+    m_DeferredReplay.flush(context);
+}
+
+void DrawManager::deinitialize(Context& context)
+{
+    m_DeferredReplay.deinitialize();
+    m_FixedPipeline.deinitialize(context);
+    m_SingleViewVariants.deinitialize(context);
+    m_DrawDecisions.clear();
+}
+
+void DrawManager::preparePassThrough(Context& context)
+{
+    for (auto& [programID, program] : context.getManager().getMap())
     {
-        const auto& program = context.getManager().getBound();
-        if (program->hasMetadata() && program->m_Metadata->m_IsInvisible)
-            return true;
+        preparePassThroughProgram(context, programID);
     }
-    if (context.m_IsMultiviewActivated && isRepeatingSuitable(context) && (!isSingleViewPossible(context)))
+}
+
+void DrawManager::preparePassThroughProgram(Context& context, GLuint program)
+{
+    auto& programs = context.getManager();
+    if (!programs.has(program) || !programs.get(program)->isInjected())
+        return;
+
+    // Program binding would be recorded otherwise
+    m_DeferredReplay.flush(context);
+
+    // Equivalent of draw()'s uniforms when multiview is off
+    const auto& locations = programs.get(program)->m_InjectorUniforms;
+    glUseProgram(program);
+    glUniform1i(locations.identity, GL_TRUE);
+    glUniform1i(locations.maxViews, 1);
+    glUniform1i(locations.maxInvocations, 1);
+    glUniform1i(locations.isSingleViewActivated, GL_TRUE);
+    glUniform1i(locations.singleViewID, 0);
+    glUniform1i(locations.instancedViews, 1);
+    glUseProgram(programs.getBoundId());
+}
+
+void DrawManager::validateState(Context& context)
+{
+    context.getStateTracker().validate();
+
+    const auto compare = [](const char* name, GLenum query, GLint mirrored) {
+        GLint value = 0;
+        glGetIntegerv(query, &value);
+        if (value != mirrored)
+        {
+            Logger::logError("State mirror: ", name, " is ", value, ", mirrored ", mirrored, HI_POS);
+        }
+    };
+    compare("GL_ACTIVE_TEXTURE", GL_ACTIVE_TEXTURE, GL_TEXTURE0 + context.getTextureTracker().getTextureUnits().getActiveUnit());
+    compare("GL_CURRENT_PROGRAM", GL_CURRENT_PROGRAM, context.getManager().getBoundId());
+    compare("GL_RENDERBUFFER_BINDING", GL_RENDERBUFFER_BINDING, context.getRenderbufferTracker().getBoundId());
+
+    // FBOs and textures are substituted with their shadows when multiview is active
+    if (context.m_IsMultiviewActivated)
+        return;
+    compare("GL_DRAW_FRAMEBUFFER_BINDING", GL_DRAW_FRAMEBUFFER_BINDING, context.getFBOTracker().getBoundId());
+    const auto texture = context.getTextureTracker().getTextureUnits().getBoundTexture(GL_TEXTURE_2D);
+    compare("GL_TEXTURE_BINDING_2D", GL_TEXTURE_BINDING_2D, texture ? texture->getID() : 0);
+}
+
+bool DrawManager::shouldRecord(Context& context, const DrawDecision& decision, bool hasInstancedDrawCall)
+{
+    if (!context.deferredReplayFlag || !context.m_IsMultiviewActivated)
+        return false;
+    if (!decision.isRepeatingSuitable || !decision.isSingleViewPossible)
+        return false;
+
+    // Only injected Vertex Shader reads view of replayed draw call
+    if (!decision.isReplayable)
+        return false;
+    // Shadowed textures must be bound to layer of each view
+    if (context.getTextureTracker().getTextureUnits().hasShadowedTextureBinded())
+        return false;
+    // Instanced layering renders all views by a single draw call already
+    return !(hasInstancedDrawCall && isInstancedLayeringPossible(context, decision));
+}
+
+bool DrawManager::shouldEmulateFixedPipeline(Context& context)
+{
+    if (!context.emulateFixedPipelineFlag || context.getManager().hasBounded())
+        return false;
+    // Emulation program would be compiled into application's display list
+    return !context.getStateTracker().isCompilingList();
+}
+
+bool DrawManager::shouldSkipDrawCall(Context& context, const DrawDecision& decision)
+{
+    if (decision.shouldSkip)
+        return true;
+    if (context.m_IsMultiviewActivated && decision.isRepeatingSuitable && (!decision.isSingleViewPossible))
     {
         Logger::logDebug("Shadowing not possible -> terminating draw call");
         //return true;
@@ -142,80 +329,118 @@ bool DrawManager::shouldSkipDrawCall(Context& context)
     return false;
 }
 
-void DrawManager::drawGeneric(Context& context, const std::function<void(void)>& drawCallLambda)
+void DrawManager::drawGeneric(Context& context, const DrawDecision& decision, const std::function<void(void)>& drawCallLambda, const InstancedDrawCall& instancedDrawCallLambda)
 {
-    const auto& programs = context.getManager();
     /// If application is using shaders and shader program has enhancer's GS capabilities
-    if (programs.hasBounded() && programs.getBoundConst()->isInjected())
-    {
-        const auto& metadata = *programs.getBoundConst()->m_Metadata;
-        if (metadata.usesGeometryShader())
-        {
-            drawWithGeometryShader(context, drawCallLambda);
-        }
-        else
-        {
-            drawWithVertexShader(context, drawCallLambda);
-        }
-    }
-    else
+    switch (decision.method)
     {
-        drawLegacy(context, drawCallLambda);
+    case DrawDecision::Method::MULTIVIEW_EXTENSION:
+        drawWithMultiviewExtension(context, drawCallLambda);
+        break;
+    case DrawDecision::Method::GEOMETRY_SHADER:
+        drawWithGeometryShader(context, decision, drawCallLambda);
+        break;
+    case DrawDecision::Method::VERTEX_SHADER:
+        drawWithVertexShader(context, decision, drawCallLambda, instancedDrawCallLambda);
+        break;
+    case DrawDecision::Method::LEGACY:
+    default:
+        drawLegacy(context, decision, drawCallLambda);
+        break;
     }
 }
 
-void DrawManager::drawWithGeometryShader(Context& context, const std::function<void(void)>& drawCallLambda)
+void DrawManager::drawWithGeometryShader(Context& context, const DrawDecision& decision, const std::function<void(void)>& drawCallLambda)
 {
     debug::logTrace("drawWithGeometryShader");
-    if (!context.m_IsMultiviewActivated || !isSingleViewPossible(context))
+    if (!context.m_IsMultiviewActivated || !decision.isSingleViewPossible)
     {
-        helpers::uniforms::renderToSingleLayer(context.getManager().getBoundId(), 0);
+        helpers::uniforms::renderToSingleLayer(context, 0);
         drawCallLambda();
-        Logger::logDebugPerFrame(dumpDrawContext(context), "drawGS: multiview off", HI_POS);
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawGS: multiview off", HI_POS);
         return;
     }
 
     if (!context.getTextureTracker().getTextureUnits().hasShadowedTextureBinded())
     {
-        helpers::uniforms::renderToAllLayers(context.getManager().getBoundId());
+        helpers::uniforms::renderToAllLayers(context);
         drawCallLambda();
-        Logger::logDebugPerFrame(dumpDrawContext(context), "drawGS: single view", HI_POS);
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawGS: single view", HI_POS);
         return;
     }
 
+    // Fragment Shader samples layer of its view from shadowed textures => single pass
+    if (decision.usesLayeredSamplers)
+    {
+        const auto redirectedUnits = helpers::samplers::redirectToLayeredTextures(context);
+        if (!redirectedUnits.empty())
+        {
+            auto& textureUnits = context.getTextureTracker().getTextureUnits();
+            textureUnits.bindShadowedTexturesAsArrays();
+            helpers::uniforms::renderToAllLayers(context);
+            drawCallLambda();
+            Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawGS: layered samplers", HI_POS);
+            helpers::samplers::restoreOriginalTextures(context, redirectedUnits);
+            textureUnits.unbindShadowedTextureArrays();
+            return;
+        }
+    }
+
     const auto numOfLayers = context.getOutputFBO().getParams().getLayers();
     for (size_t l = 0; l < numOfLayers; l++)
     {
         context.getTextureTracker().getTextureUnits().bindShadowedTexturesToLayer(l);
 
-        helpers::uniforms::renderToSingleLayer(context.getManager().getBoundId(), l);
+        helpers::uniforms::renderToSingleLayer(context, l);
         drawCallLambda();
-        Logger::logDebugPerFrame(dumpDrawContext(context), "drawGS: layer ", l, HI_POS);
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawGS: layer ", l, HI_POS);
     }
     context.getTextureTracker().getTextureUnits().unbindShadowedTextures();
 }
 
-void DrawManager::drawWithVertexShader(Context& context, const std::function<void(void)>& drawCallLambda)
+void DrawManager::drawWithVertexShader(Context& context, const DrawDecision& decision, const std::function<void(void)>& drawCallLambda, const InstancedDrawCall& instancedDrawCallLambda)
 {
     debug::logTrace("drawWithVertexShader");
     const auto middleCamera = (context.getCameras().getCameras().size() / 2);
-    if (!context.m_IsMultiviewActivated || !isSingleViewPossible(context))
+    if (!context.m_IsMultiviewActivated || !decision.isSingleViewPossible)
     {
-        helpers::uniforms::renderToSingleLayer(context.getManager().getBoundId(), 0);
+        helpers::uniforms::renderToSingleLayer(context, 0);
         drawCallLambda();
-        Logger::logDebugPerFrame(dumpDrawContext(context), "drawVS: non-multiview", HI_POS);
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawVS: non-multiview", HI_POS);
         return;
     }
 
-    if (context.getFBOTracker().hasBounded() && !context.getFBOTracker().isSuitableForRepeating())
+    if (!decision.isRepeatingSuitable)
     {
         context.getTextureTracker().getTextureUnits().bindShadowedTexturesToLayer(middleCamera);
 
-        helpers::uniforms::renderToSingleLayer(context.getManager().getBoundId(), 0);
+        helpers::uniforms::renderToSingleLayer(context, 0);
         drawCallLambda();
-        Logger::logDebugPerFrame(dumpDrawContext(context), "drawVS: single", HI_POS);
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawVS: single", HI_POS);
+        return;
+    }
+
+    // Render all views at once: view = gl_InstanceID % views, routed by gl_Layer
+    if (instancedDrawCallLambda && isInstancedLayeringPossible(context, decision))
+    {
+        const auto numOfLayers = context.getOutputFBO().getParams().getLayers();
+        glBindFramebuffer(GL_FRAMEBUFFER, getLayeredFBO(context));
+
+        helpers::uniforms::renderToAllLayersInstanced(context, numOfLayers);
+        instancedDrawCallLambda(numOfLayers);
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawVS: instanced layers: ", numOfLayers, HI_POS);
+        return;
+    }
+
+    // View is selected by DeferredReplay::flush()
+    if (m_DeferredReplay.isRecording())
+    {
+        helpers::uniforms::renderToSingleLayer(context, 0);
+        m_DeferredReplay.record(context, drawCallLambda);
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawVS: recorded", HI_POS);
         return;
     }
+
     for (size_t cameraID = 0; cameraID < context.getCameras().getCameras().size(); cameraID++)
     {
         // Bind correct layered texture
@@ -227,31 +452,75 @@ void DrawManager::drawWithVertexShader(Context& context, const std::function<voi
         glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
 
         // Single-view FBO only contains a single layer => 0
-        helpers::uniforms::renderToSingleLayer(context.getManager().getBoundId(), cameraID);
+        helpers::uniforms::renderToSingleLayer(context, cameraID);
 
         drawCallLambda();
-        Logger::logDebugPerFrame(dumpDrawContext(context), "drawVS: layer: ", cameraID,
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawVS: layer: ", cameraID,
             "shadowFBO: ", shadowFBO, HI_POS);
     }
     context.getTextureTracker().getTextureUnits().unbindShadowedTextures();
 }
 
-void DrawManager::drawLegacy(Context& context, const std::function<void(void)>& drawCallLambda)
+void DrawManager::drawWithMultiviewExtension(Context& context, const std::function<void(void)>& drawCallLambda)
+{
+    debug::logTrace("drawWithMultiviewExtension");
+    // Program declares all views, thus it can't render into single-view FBO
+    const auto multiviewFBO = (context.m_IsMultiviewActivated ? getMultiviewFBO(context) : 0);
+    if (multiviewFBO == 0)
+    {
+        // Draw by single-view variant of program instead, or at least issue draw call as is
+        const auto program = context.getManager().getBoundId();
+        if (!m_SingleViewVariants.bind(context))
+        {
+            drawCallLambda();
+            Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawOVR: no multiview FBO & no single-view variant", HI_POS);
+            return;
+        }
+        setInjectorIdentity(context);
+        const auto decision = m_DrawDecisions.get(context);
+        drawGeneric(context, decision, drawCallLambda, nullptr);
+        m_SingleViewVariants.unbind(context, program);
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawOVR: no multiview FBO -> single-view variant", HI_POS);
+        return;
+    }
+
+    // Views can't sample their own layer of shadowed textures => use middle camera's layer
+    auto& textureUnits = context.getTextureTracker().getTextureUnits();
+    const bool hasShadowedTextures = textureUnits.hasShadowedTextureBinded();
+    if (hasShadowedTextures)
+    {
+        textureUnits.bindShadowedTexturesToLayer(context.getCameras().getCameras().size() / 2);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, multiviewFBO);
+    helpers::uniforms::renderToAllLayers(context);
+    drawCallLambda();
+    Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawOVR: multiview FBO: ", multiviewFBO, HI_POS);
+
+    // Keep layered FBO bound for programs without multiview
+    glBindFramebuffer(GL_FRAMEBUFFER, getLayeredFBO(context));
+    if (hasShadowedTextures)
+    {
+        textureUnits.unbindShadowedTextures();
+    }
+}
+
+void DrawManager::drawLegacy(Context& context, const DrawDecision& decision, const std::function<void(void)>& drawCallLambda)
 {
     const auto middleCamera = (context.getCameras().getCameras().size() / 2);
-    if (!context.m_IsMultiviewActivated || !isSingleViewPossible(context))
+    if (!context.m_IsMultiviewActivated || !decision.isSingleViewPossible)
     {
-        helpers::uniforms::renderToSingleLayer(context.getManager().getBoundId(), 0);
+        helpers::uniforms::renderToSingleLayer(context, 0);
         drawCallLambda();
-        Logger::logDebugPerFrame(dumpDrawContext(context), "drawLegacy: non-multiview", HI_POS);
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawLegacy: non-multiview", HI_POS);
         return;
     }
-    if ((context.getFBOTracker().hasBounded() && !context.getFBOTracker().isSuitableForRepeating()))
+    if (!decision.isRepeatingSuitable)
     {
         context.getTextureTracker().getTextureUnits().bindShadowedTexturesToLayer(0);
-        helpers::uniforms::renderToSingleLayer(context.getManager().getBoundId(), 0);
+        helpers::uniforms::renderToSingleLayer(context, 0);
         drawCallLambda();
-        Logger::logDebugPerFrame(dumpDrawContext(context), "drawLegacy: single", HI_POS);
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawLegacy: single", HI_POS);
         return;
     }
 
@@ -264,12 +533,12 @@ void DrawManager::drawLegacy(Context& context, const std::function<void(void)>&
         assert(shadowFBO != 0);
         glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
 
-        helpers::uniforms::renderToSingleLayer(context.getManager().getBoundId(), 0);
+        helpers::uniforms::renderToSingleLayer(context, 0);
 
         const auto& t = camera.getViewMatrix();
         setInjectorShift(context, t, camera.getAngle() * context.getCameraParameters().m_XShiftMultiplier / context.getCameraParameters().m_frontOpticalAxisCentreDistance);
         drawCallLambda();
-        Logger::logDebugPerFrame(dumpDrawContext(context), "drawLegacy: layer", cameraID,
+        Logger::logDebugPerFrame([&] { return dumpDrawContext(context); }, "drawLegacy: layer", cameraID,
             "shadowFBO: ", shadowFBO, HI_POS);
         resetInjectorShift(context);
     }
@@ -290,13 +559,12 @@ std::string DrawManager::dumpDrawContext(Context& context) const
 void DrawManager::setInjectorShift(Context& context, const glm::mat4& viewSpaceTransform, float projectionAdjust)
 {
     const auto& resultMat = viewSpaceTransform;
-    auto program = context.getManager().getBoundId();
-    if (program)
+    auto& programs = context.getManager();
+    if (programs.hasBounded() && programs.has(programs.getBoundId()))
     {
-        //helpers::uniforms::renderToSingleLayer(context.getManager().getBoundId(), 0);
+        //helpers::uniforms::renderToSingleLayer(context, 0);
 
-        auto location = glGetUniformLocation(program, "injector_identity");
-        glUniform1i(location, GL_TRUE);
+        glUniform1i(programs.getBound()->m_InjectorUniforms.identity, GL_TRUE);
     }
 
     // Legacy support
@@ -324,31 +592,27 @@ void DrawManager::resetInjectorShift(Context& context)
 
 void DrawManager::setInjectorIdentity(Context& context)
 {
-    const auto identity = glm::mat4(1.0);
-    auto program = context.getManager().getBoundId();
-    if (program == 0)
+    if (!context.getManager().hasBounded())
         return;
-    auto location = glGetUniformLocation(program, "injector_identity");
-    glUniform1i(location, GL_TRUE);
-
-    location = glGetUniformLocation(program, "injector_max_views");
-    glUniform1i(location, 1);
-    location = glGetUniformLocation(program, "injector_max_invocations");
-    glUniform1i(location, 1);
+    const auto& locations = context.getManager().getBound()->m_InjectorUniforms;
+    glUniform1i(locations.identity, GL_TRUE);
+    glUniform1i(locations.maxViews, 1);
+    glUniform1i(locations.maxInvocations, 1);
 }
 
 void DrawManager::setInjectorDecodedProjection(Context& context, GLuint program, const hi::pipeline::PerspectiveProjectionParameters& projection)
 {
+    if (!context.getManager().has(program))
+        return;
+    const auto& locations = context.getManager().get(program)->m_InjectorUniforms;
+
     // upload parameters to GPU's program
-    auto parametersLocation = glGetUniformLocation(program, "injector_deprojection");
-    glUniform4fv(parametersLocation, 1, glm::value_ptr(projection.asVector()));
+    glUniform4fv(locations.deprojection, 1, glm::value_ptr(projection.asVector()));
 
-    parametersLocation = glGetUniformLocation(program, "injector_deprojection_inv");
     glm::vec4 inverted = glm::vec4(1.0) / projection.asVector();
-    glUniform4fv(parametersLocation, 1, glm::value_ptr(inverted));
+    glUniform4fv(locations.deprojectionInv, 1, glm::value_ptr(inverted));
 
-    auto typeLocation = glGetUniformLocation(program, "injector_isOrthogonal");
-    glUniform1i(typeLocation, !projection.isPerspective);
+    glUniform1i(locations.isOrthogonal, !projection.isPerspective);
 }
 
 void DrawManager::pushFixedPipelineProjection(Context& context, const glm::mat4& viewSpaceTransform, float projectionAdjust)
@@ -397,49 +661,56 @@ GLuint DrawManager::createSingleViewFBO(Context& context, size_t layer)
     }
 }
 
-bool DrawManager::isSingleViewPossible(Context& context)
+bool DrawManager::isInstancedLayeringPossible(Context& context, const DrawDecision& decision)
+{
+    if (!decision.usesInstancedLayering)
+        return false;
+    // Per-instance attributes would be fetched for amplified instance ID
+    if (context.getStateTracker().hasInstancedAttributes())
+        return false;
+    // Shadowed textures must be bound to layer of each view
+    return !context.getTextureTracker().getTextureUnits().hasShadowedTextureBinded();
+}
+
+GLuint DrawManager::getLayeredFBO(Context& context)
 {
     if (context.getFBOTracker().hasBounded())
     {
-        auto& fbo = context.getFBOTracker().getBound();
-        if (fbo->hasShadowFBO())
-        {
-            return true;
-        }
-        return false;
+        return context.getFBOTracker().getBound()->getShadowFBO();
     }
-    // For OutputFBO, it's always true
-    return true;
+    return context.getOutputFBO().getFBOId();
 }
 
-bool DrawManager::isRepeatingSuitable(Context& context)
+GLuint DrawManager::getMultiviewFBO(Context& context)
 {
     if (context.getFBOTracker().hasBounded())
     {
-        return context.getFBOTracker().isSuitableForRepeating();
+        const auto& fbo = context.getFBOTracker().getBound();
+        if (!context.getFBOTracker().isSuitableForRepeating() || !fbo->hasShadowFBO())
+            return 0;
+        return fbo->getMultiviewFBO();
     }
-    return true;
+    return context.getOutputFBO().getMultiviewFBOId();
 }
 
 void DrawManager::setInjectorUniforms(size_t shaderID, Context& context)
 {
     assert(context.getManager().hasBounded());
 
-    auto loc = glGetUniformLocation(context.getManager().getBoundId(), "injector_XShiftMultiplier");
-    glUniform1f(loc, context.getCameraParameters().m_XShiftMultiplier);
+    const auto& program = context.getManager().getBound();
+    const auto& locations = program->m_InjectorUniforms;
 
-    loc = glGetUniformLocation(context.getManager().getBoundId(), "injector_FrontalDistance");
-    glUniform1f(loc, context.getCameraParameters().m_frontOpticalAxisCentreDistance);
+    // Per-frame parameters are already stored in bound uniform block
+    if (!locations.hasParametersBlock())
+    {
+        glUniform1f(locations.xShiftMultiplier, context.getCameraParameters().m_XShiftMultiplier);
+        glUniform1f(locations.frontalDistance, context.getCameraParameters().m_frontOpticalAxisCentreDistance);
+    }
 
     const auto maxViews = context.getOutputFBO().getParams().getLayers();
-    auto location = glGetUniformLocation(context.getManager().getBoundId(), "injector_max_views");
-    glUniform1i(location, maxViews);
-
-    location = glGetUniformLocation(context.getManager().getBoundId(), "injector_max_invocations");
-    glUniform1i(location, maxViews);
-
-    loc = glGetUniformLocation(context.getManager().getBoundId(), "injector_identity");
+    glUniform1i(locations.maxViews, maxViews);
+    glUniform1i(locations.maxInvocations, maxViews);
 
-    bool shouldNotUseIdentity = (context.getManager().getBound()->isInjected());
-    glUniform1i(loc, !shouldNotUseIdentity);
+    bool shouldNotUseIdentity = (program->isInjected());
+    glUniform1i(locations.identity, !shouldNotUseIdentity);
 }
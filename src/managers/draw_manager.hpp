@@ -10,6 +10,12 @@
 #define HI_DRAW_MANAGER_HPP
 
 #include <functional>
+#include <optional>
+
+#include "managers/deferred_replay.hpp"
+#include "managers/draw_decision_cache.hpp"
+#include "managers/fixed_pipeline_manager.hpp"
+#include "managers/single_view_variant_manager.hpp"
 
 namespace hi
 {
@@ -25,21 +31,62 @@ namespace managers
     class DrawManager
     {
     public:
-        void draw(Context& context, const std::function<void(void)>& code);
+        /// Issue application's draw call with instance count multiplied by given factor
+        using InstancedDrawCall = std::function<void(GLsizei instanceMultiplier)>;
+
+        /**
+         * @brief Draw application's draw call into all views
+         *
+         * @param code Original draw call. May be recorded and called later (see DeferredReplay),
+         * thus it must capture arguments by value
+         * @param instancedCode Optional: same draw call, amplified by instancing. When provided,
+         * VS-injected programs render all views in a single pass (see PipelineParams::shouldUseInstancedLayers)
+         * @param primitiveMode Optional: mode of draw call, selects emulation program of shaderless draw calls
+         */
+        void draw(Context& context, const std::function<void(void)>& code, const InstancedDrawCall& instancedCode = nullptr, std::optional<GLenum> primitiveMode = std::nullopt);
         void setInjectorDecodedProjection(Context& context, GLuint program, const hi::pipeline::PerspectiveProjectionParameters& projection);
 
+        /**
+         * @brief Store single-view uniforms into injected programs, so that these can be drawn without draw()
+         *
+         * Used when draw calls are passed to driver directly (multiview is off). draw() sets per-draw
+         * uniforms again once multiview is activated.
+         */
+        void preparePassThrough(Context& context);
+        /// Same as preparePassThrough(), but for a single (e.g. newly linked) program
+        void preparePassThroughProgram(Context& context, GLuint program);
+
+        /**
+         * @brief Replay recorded draw calls into all views (see DeferredReplay)
+         *
+         * Must precede any call, which is executed immediately and affects recorded draw calls
+         * or reads their result. No-op if nothing is recorded.
+         */
+        void flushDeferredDraws(Context& context);
+        /// Clean up per-context resources
+        void deinitialize(Context& context);
+
     private:
         /// Decide if current draw call is dispached in suitable settings
-        bool shouldSkipDrawCall(Context& context);
+        bool shouldSkipDrawCall(Context& context, const DrawDecision& decision);
+        /// Debug: cross-check trackers' mirror of bindings with OpenGL (see Context::validateStateFlag)
+        void validateState(Context& context);
+        /// Decide if draw call can be recorded & replayed view-major instead of being repeated now
+        bool shouldRecord(Context& context, const DrawDecision& decision, bool hasInstancedDrawCall);
+        /// Decide if shaderless draw call should be drawn by fixed-pipeline emulation program
+        bool shouldEmulateFixedPipeline(Context& context);
         /// Decide which draw methods should be used
-        void drawGeneric(Context& context, const std::function<void(void)>& code);
+        void drawGeneric(Context& context, const DrawDecision& decision, const std::function<void(void)>& code, const InstancedDrawCall& instancedCode);
         /// Draw without support of GS, or when shaderless fixed-pipeline is used
-        void drawLegacy(Context& context, const std::function<void(void)>& code);
+        void drawLegacy(Context& context, const DrawDecision& decision, const std::function<void(void)>& code);
         /// Draw when Geometry Shader has been injected into program
-        void drawWithGeometryShader(Context& context, const std::function<void(void)>& code);
+        void drawWithGeometryShader(Context& context, const DrawDecision& decision, const std::function<void(void)>& code);
         /// Draw without, just using Vertex Shader + repeating
-        void drawWithVertexShader(Context& context, const std::function<void(void)>& code);
+        void drawWithVertexShader(Context& context, const DrawDecision& decision, const std::function<void(void)>& code, const InstancedDrawCall& instancedCode);
+        /// Draw once into multiview FBO, views are fanned out by driver (GL_OVR_multiview)
+        void drawWithMultiviewExtension(Context& context, const std::function<void(void)>& code);
 
+        /// Debug: describe bound FBO & program (pass lazily to Logger, i.e. wrapped in lambda)
         std::string dumpDrawContext(Context& context) const;
 
         // TODO: Replace setters with separate class, devoted for intershader communication
@@ -54,10 +101,19 @@ namespace managers
         GLuint createSingleViewFBO(Context& contex, size_t layer);
 
         /* Context queries */
-        bool isSingleViewPossible(Context& context);
-        bool isRepeatingSuitable(Context& context);
+        /// Can bound program render all views by a single instanced draw call
+        bool isInstancedLayeringPossible(Context& context, const DrawDecision& decision);
+        /// Get layered FBO (shadow FBO or OutputFBO), which substitutes application's FBO
+        GLuint getLayeredFBO(Context& context);
+        /// Get multiview FBO, which substitutes application's FBO, or 0 if there is none
+        GLuint getMultiviewFBO(Context& context);
 
         void setInjectorUniforms(size_t shaderID, Context& context);
+
+        DeferredReplay m_DeferredReplay;
+        FixedPipelineManager m_FixedPipeline;
+        SingleViewVariantManager m_SingleViewVariants;
+        DrawDecisionCache m_DrawDecisions;
     };
 } // namespace managers
 } // namespace hi
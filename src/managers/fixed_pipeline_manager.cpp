@@ -0,0 +1,120 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        managers/fixed_pipeline_manager.cpp
+*
+*****************************************************************************/
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GL/gl.h>
+
+#include <glm/gtc/type_ptr.hpp>
+#include <vector>
+
+#include "context.hpp"
+#include "logger.hpp"
+#include "managers/fixed_pipeline_manager.hpp"
+#include "pipeline/fixed_pipeline_emulation.hpp"
+#include "pipeline/pipeline_injector.hpp"
+#include "trackers/legacy_tracker.hpp"
+#include "trackers/shader_tracker.hpp"
+
+using namespace hi;
+using namespace hi::managers;
+using namespace hi::pipeline;
+
+namespace helper
+{
+/// Can primitives of given mode be consumed by inserted Geometry Shader (layout (triangles) in)?
+bool isTriangleMode(GLenum mode)
+{
+    return mode == GL_TRIANGLES || mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN;
+}
+} // namespace helper
+
+bool FixedPipelineManager::bind(Context& context, std::optional<GLenum> primitiveMode)
+{
+    const auto& legacy = context.getLegacyTracker();
+    if (!legacy.isFixedPipelineEmulable())
+        return false;
+
+    // Programs, which would get Geometry Shader inserted, are Vertex Shader-injected for other primitives
+    const auto& parameters = m_ShaderManager.getPipelineParams(context);
+    const bool isGeometryShaderInserted = !parameters.shouldPreventGeometryShaderInsertion && !parameters.shouldUseMultiviewExtension;
+    const bool shouldUseGeometryShader = isGeometryShaderInserted && primitiveMode.has_value() && helper::isTriangleMode(primitiveMode.value());
+
+    const auto& state = legacy.getFixedPipelineState();
+    const uint64_t key = (static_cast<uint64_t>(state.getKey()) << 1) | shouldUseGeometryShader;
+    auto it = m_Programs.find(key);
+    if (it == m_Programs.end())
+    {
+        it = m_Programs.emplace(key, createProgram(context, state, shouldUseGeometryShader)).first;
+    }
+    const auto& program = it->second;
+    if (program.id == 0)
+        return false;
+
+    m_ShaderManager.useProgram(context, program.id);
+    const auto& locations = context.getManager().getBound()->m_InjectorUniforms;
+    glUniformMatrix4fv(locations.transformationMatrix, 1, GL_FALSE, glm::value_ptr(legacy.getProjection()));
+    if (program.alphaReference != -1)
+    {
+        glUniform1f(program.alphaReference, legacy.getAlphaReference());
+    }
+    return true;
+}
+
+void FixedPipelineManager::unbind(Context& context)
+{
+    m_ShaderManager.useProgram(context, 0);
+}
+
+void FixedPipelineManager::deinitialize(Context& context)
+{
+    for (const auto& [key, program] : m_Programs)
+    {
+        if (program.id != 0)
+            m_ShaderManager.deleteProgram(context, program.id);
+    }
+    m_Programs.clear();
+}
+
+FixedPipelineManager::Program FixedPipelineManager::createProgram(Context& context, const FixedPipelineState& state, bool shouldUseGeometryShader)
+{
+    // Register program & its shaders as if application has created them
+    const auto programId = m_ShaderManager.createProgram(context);
+    std::vector<GLuint> shaders;
+    for (const auto& [type, sourceCode] : FixedPipelineEmulation::generate(state))
+    {
+        const auto shader = m_ShaderManager.createShader(context, type);
+        const GLchar* sources[1] = { sourceCode.c_str() };
+        m_ShaderManager.shaderSource(context, shader, 1, sources, nullptr);
+        m_ShaderManager.attachShader(context, programId, shader);
+        shaders.push_back(shader);
+    }
+
+    auto parameters = m_ShaderManager.getPipelineParams(context);
+    parameters.shouldPreventGeometryShaderInsertion = parameters.shouldPreventGeometryShaderInsertion || !shouldUseGeometryShader;
+    m_ShaderManager.linkProgram(context, programId, parameters);
+    // Program is used immediately
+    m_ShaderManager.resolveLink(context, programId);
+    for (const auto shader : shaders)
+    {
+        m_ShaderManager.deleteShader(context, shader);
+    }
+
+    const auto& program = context.getManager().get(programId);
+    if (!program->isLinked() || !program->isInjected())
+    {
+        Logger::logError("Failed to create fixed-pipeline emulation program for state ", state.getKey(), HI_POS);
+        m_ShaderManager.deleteProgram(context, programId);
+        return {};
+    }
+    Logger::logDebug("Created fixed-pipeline emulation program ", programId, " for state ", state.getKey());
+
+    Program result;
+    result.id = programId;
+    result.alphaReference = glGetUniformLocation(programId, FixedPipelineEmulation::alphaReferenceUniform);
+    return result;
+}
@@ -0,0 +1,69 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        managers/fixed_pipeline_manager.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_FIXED_PIPELINE_MANAGER_HPP
+#define HI_FIXED_PIPELINE_MANAGER_HPP
+
+#include <GL/gl.h>
+#include <optional>
+#include <unordered_map>
+
+#include "managers/shader_manager.hpp"
+
+namespace hi
+{
+class Context;
+
+namespace pipeline
+{
+    struct FixedPipelineState;
+}
+namespace managers
+{
+    /**
+     * @brief Substitutes fixed-pipeline by generated emulation program for shaderless draw calls
+     *
+     * Variants of emulation program (see FixedPipelineEmulation) are created on first use for
+     * each tracked fixed-pipeline state, and are injected by PipelineInjector as application's
+     * programs. Thus, shaderless draw calls render all views by the injected Geometry Shader
+     * (or injected Vertex Shader), instead of repeating draw call with altered GL_PROJECTION.
+     */
+    class FixedPipelineManager
+    {
+    public:
+        /**
+         * @brief Bind emulation program, which matches current fixed-pipeline state
+         *
+         * @param primitiveMode Mode of draw call, if known. Inserted Geometry Shader only
+         * accepts triangles, thus other (or unknown) modes use Vertex Shader injection.
+         * @return false if state can't be emulated, no program is bound then
+         */
+        bool bind(Context& context, std::optional<GLenum> primitiveMode);
+        /// Restore application's binding (no program)
+        void unbind(Context& context);
+        /// Delete created programs
+        void deinitialize(Context& context);
+
+    private:
+        struct Program
+        {
+            /// 0 when emulation program has failed to link
+            GLuint id = 0;
+            GLint alphaReference = -1;
+        };
+
+        Program createProgram(Context& context, const hi::pipeline::FixedPipelineState& state, bool shouldUseGeometryShader);
+
+        /// Cache: variant (state key & shader stage) => program
+        std::unordered_map<uint64_t, Program> m_Programs;
+        ShaderManager m_ShaderManager;
+    };
+} // namespace managers
+} // namespace hi
+
+#endif
@@ -69,7 +69,7 @@ void FramebufferManager::bindFramebuffer(Context& context, GLenum target, GLuint
             {
                 if (!fbo->hasShadowFBO() && context.getFBOTracker().isSuitableForRepeating())
                 {
-                    fbo->createShadowedFBO(context.getOutputFBO().getParams().getLayers());
+                    fbo->createShadowedFBO(context.getOutputFBO().getParams().getLayers(), context.useMultiviewExtensionFlag);
                     if (!fbo->hasShadowFBO())
                     {
                         Logger::logError("Failed to create shadow FBO for FBO: ", id, HI_POS);
@@ -107,7 +107,7 @@ void FramebufferManager::swapBuffers(Context& context, std::function<void(void)>
 
 void FramebufferManager::renderFromOutputFBO(Context& context)
 {
-    hi::utils::restoreStateFunctor({ GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST }, [this, &context]() {
+    hi::utils::restoreStateFunctor(context.getStateTracker(), { GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_STENCIL_TEST }, [this, &context]() {
         glDisable(GL_CULL_FACE);
         glDisable(GL_DEPTH_TEST);
         glDisable(GL_SCISSOR_TEST);
@@ -15,9 +15,13 @@
 
 #include "managers/shader_manager.hpp"
 #include "trackers/shader_tracker.hpp"
+#include "trackers/texture_tracker.hpp"
 
+#include "pipeline/injector_parameters.hpp"
 #include "pipeline/output_fbo.hpp"
+#include "pipeline/pipeline_cache.hpp"
 #include "pipeline/pipeline_injector.hpp"
+#include "pipeline/program_binary_cache.hpp"
 #include "utils/glsl_preprocess.hpp"
 #include "utils/opengl_utils.hpp"
 #include <cmath>
@@ -77,56 +81,72 @@ void dumpCompilationResult(const CompilationResult& result)
     Logger::logDebug("========================================================================");
 }
 
-CompilationResult tryCompilingShaderProgram(const PipelineInjector::PipelineType pipeline, GLuint programId)
+/// Create & compile shaders without waiting for result (driver may compile them in parallel)
+std::vector<GLuint> compileShaders(const PipelineInjector::PipelineType& pipeline)
 {
-    helper::CompilationResult output;
-    std::vector<GLuint> newShaderIDs;
-    bool hasError = false;
+    std::vector<GLuint> shaders;
     for (auto& [type, sourceCode] : pipeline)
     {
-        ShaderCompilationResult result;
         auto newShader = glCreateShader(type);
         const GLchar* sources[1] = { reinterpret_cast<const GLchar*>(sourceCode.data()) };
         glShaderSource(newShader, 1, sources, nullptr);
-        fflush(stdout);
         glCompileShader(newShader);
-        GLint status;
-        glGetShaderiv(newShader, GL_COMPILE_STATUS, &status);
-
-        if (status == GL_FALSE)
-        {
-            const auto message = getShaderLogMessage(newShader);
-            result.errorMessage = message;
-            hasError = true;
-        }
+        shaders.push_back(newShader);
+    }
+    return shaders;
+}
 
-        result.hasCompiledSuccessfully = status;
-        result.sourceCode = sourceCode;
-        output.shaders.push_back(result);
+/// Attach shaders & submit link without waiting for result
+void submitLink(GLuint programId, const std::vector<GLuint>& shaders)
+{
+    for (auto shader : shaders)
+    {
+        glAttachShader(programId, shader);
+    }
+    glLinkProgram(programId);
+}
 
-        glAttachShader(programId, newShader);
-        newShaderIDs.push_back(newShader);
+void deleteShaders(GLuint programId, const std::vector<GLuint>& shaders)
+{
+    for (auto id : shaders)
+    {
+        // Detach shaders from program (linked program doesn't need them)
+        glDetachShader(programId, id);
+        glDeleteShader(id);
     }
+}
 
-    GLint linkStatus = 0;
-    if (!hasError)
+/// Query (i.e. wait for) results of submitted compilation & link, and release shaders
+CompilationResult getCompilationResult(const PipelineInjector::PipelineType& pipeline, const std::vector<GLuint>& shaders, GLuint programId)
+{
+    helper::CompilationResult output;
+    bool hasError = false;
+    for (auto shader : shaders)
     {
-        glLinkProgram(programId);
-        glGetProgramiv(programId, GL_LINK_STATUS, &linkStatus);
-        if (linkStatus == GL_FALSE)
+        ShaderCompilationResult result;
+        GLint status = GL_FALSE, type = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+        glGetShaderiv(shader, GL_SHADER_TYPE, &type);
+        if (status == GL_FALSE)
         {
-            auto optionalLog = getProgramLogMessage(programId);
-            output.linkErrorMessage = optionalLog.value_or("Unable to get log");
+            result.errorMessage = getShaderLogMessage(shader);
             hasError = true;
         }
+        result.hasCompiledSuccessfully = status;
+        if (pipeline.count(type))
+            result.sourceCode = pipeline.at(type);
+        output.shaders.push_back(result);
     }
-    for (auto id : newShaderIDs)
+
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(programId, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE && !hasError)
     {
-        // Detach shaders from program when linking/compilation fails
-        glDetachShader(programId, id);
-        // Delete shader
-        glDeleteShader(id);
+        auto optionalLog = getProgramLogMessage(programId);
+        output.linkErrorMessage = optionalLog.value_or("Unable to get log");
+        hasError = true;
     }
+    deleteShaders(programId, shaders);
     output.hasLinkedSuccessfully = (linkStatus != GL_FALSE && hasError == false);
     return output;
 }
@@ -152,9 +172,10 @@ void ShaderManager::shaderSource(Context& context, GLuint shaderId, GLsizei coun
     Logger::log("glShaderSource: [", shaderId, "] SOURCE END");
     if (context.getManager().shaders.has(shaderId))
     {
+        // Preprocess on worker thread, linkProgram() waits for result
         auto shader = context.getManager().shaders.get(shaderId);
-        auto preprocessedShader = glsl_preprocess::preprocessGLSLCode(concatenatedShader);
-        shader->preprocessedSourceCode = preprocessedShader;
+        auto preprocess = [concatenatedShader] { return glsl_preprocess::preprocessGLSLCode(concatenatedShader); };
+        shader->preprocessedSourceCode = m_Workers.submit(preprocess).share();
     }
     std::vector<const char*> shaders = {
         concatenatedShader.c_str(),
@@ -179,17 +200,18 @@ void ShaderManager::linkProgram(Context& context, GLuint programId)
     if (!context.getManager().has(programId))
         return;
 
-    auto program = context.getManager().get(programId);
+    linkProgram(context, programId, getPipelineParams(context));
+}
 
-    /*
-     *  Create pipeline injector with correct parameters (number of vies)
-     */
-    hi::pipeline::PipelineInjector plInjector(context.getProfiles());
-    hi::pipeline::PipelineInjector::PipelineType pipeline;
+hi::pipeline::PipelineParams ShaderManager::getPipelineParams(Context& context)
+{
     hi::pipeline::PipelineParams parameters;
 
     // Propagate prevention of Geometry Shader insertion flag
     parameters.shouldPreventGeometryShaderInsertion = context.dontInsertGeometryShader;
+    parameters.shouldUseInstancedLayers = context.useInstancedLayersFlag;
+    parameters.shouldUseMultiviewExtension = context.useMultiviewExtensionFlag;
+    parameters.countOfViews = context.getOutputFBO().getParams().getLayers();
     // TODO: detect if number of invocations is supported
     parameters.countOfInvocations = context.getOutputFBO().getParams().getLayers();
     if (parameters.countOfInvocations > defaultMaximumGSInvocations)
@@ -197,6 +219,23 @@ void ShaderManager::linkProgram(Context& context, GLuint programId)
         parameters.countOfPrimitivesDuplicates = floor(parameters.countOfInvocations / defaultMaximumGSInvocations) + 1;
         parameters.countOfInvocations = defaultMaximumGSInvocations;
     }
+    // Read per-frame parameters from shared uniform block if it is supported and can hold all views
+    parameters.shouldUseParametersBlock = context.getInjectorParameters().isEnabled() && (context.getOutputFBO().getParams().getLayers() <= InjectorParameters::maxViews);
+    return parameters;
+}
+
+void ShaderManager::linkProgram(Context& context, GLuint programId, const hi::pipeline::PipelineParams& parameters)
+{
+    if (!context.getManager().has(programId))
+        return;
+
+    auto program = context.getManager().get(programId);
+
+    /*
+     *  Create pipeline injector with correct parameters (number of vies)
+     */
+    hi::pipeline::PipelineInjector plInjector(context.getProfiles());
+    hi::pipeline::PipelineInjector::PipelineType pipeline;
 
     /*
      * Deregister all attached shaders (they're going to be changed in any case)
@@ -207,14 +246,40 @@ void ShaderManager::linkProgram(Context& context, GLuint programId)
         // detach shader from program
         glDetachShader(programId, shader->m_Id);
         // store source code for given shader type
-        pipeline[shader->m_Type] = shader->preprocessedSourceCode;
+        pipeline[shader->m_Type] = shader->getPreprocessedSourceCode();
         Logger::log("Detaching:", shader->m_Type, shader->m_Id);
     }
 
     /*
-     * Inject pipeline
+     * Inject pipeline (or reuse result of previous run / worker thread)
      */
-    auto resultPipeline = plInjector.process(pipeline, parameters);
+    auto& cache = context.getPipelineCache();
+    const auto cacheKey = plInjector.getCacheKey(pipeline, parameters);
+    auto pendingInjection = std::move(program->m_PendingInjection);
+    PipelineInjector::PipelineProcessResult resultPipeline;
+    if (auto cachedPipeline = cache.load(cacheKey))
+    {
+        resultPipeline = std::move(cachedPipeline.value());
+    }
+    else
+    {
+        // Speculative injection is valid only for the same sources & parameters
+        bool hasInjectedInBackground = false;
+        if (pendingInjection.valid())
+        {
+            auto pending = pendingInjection.get();
+            hasInjectedInBackground = (pending.cacheKey == cacheKey);
+            if (hasInjectedInBackground)
+            {
+                resultPipeline = std::move(pending.result);
+            }
+        }
+        if (!hasInjectedInBackground)
+        {
+            resultPipeline = plInjector.process(pipeline, parameters);
+        }
+        cache.store(cacheKey, resultPipeline);
+    }
 
     // Use application's original program when in non-intrusive mode
     if (context.getDiagnostics().shouldNotBeIntrusive())
@@ -225,17 +290,126 @@ void ShaderManager::linkProgram(Context& context, GLuint programId)
     program->m_Metadata = std::move(resultPipeline.metadata);
     Logger::log("Pipeline process succeeded?: ", resultPipeline.wasSuccessfull);
 
-    auto status = helper::tryCompilingShaderProgram(resultPipeline.pipeline, programId);
-    if (!status.hasLinkedSuccessfully)
+    // Programs with GL_OVR_multiview can't render single-view FBOs, keep sources for their single-view variant
+    program->m_OriginalPipeline.clear();
+    if (program->m_Metadata && program->m_Metadata->usesMultiviewExtension())
+    {
+        program->m_OriginalPipeline = pipeline;
+    }
+
+    // Link from driver's binary if injected pipeline has been linked by previous run
+    releasePendingLink(*program, programId);
+    auto& binaryCache = context.getProgramBinaryCache();
+    const auto binaryKey = (binaryCache.isEnabled() ? binaryCache.getKey(resultPipeline.pipeline, program->m_PreLinkState.toString()) : std::string());
+    if (binaryCache.load(binaryKey, programId))
+    {
+        finishLink(context, *program, programId, true, true);
+        return;
+    }
+
+    /*
+     * Submit compilation & link, but don't wait for result (see resolveLink())
+     * - when driver compiles in parallel, application's original pipeline is compiled meanwhile
+     *   as a fallback
+     */
+    binaryCache.prepareForLinking(programId);
+    trackers::ShaderProgram::PendingLink pendingLink;
+    pendingLink.shaders = helper::compileShaders(resultPipeline.pipeline);
+    helper::submitLink(programId, pendingLink.shaders);
+    if (context.parallelShaderCompileFlag)
+    {
+        pendingLink.fallbackShaders = helper::compileShaders(pipeline);
+    }
+    pendingLink.injectedPipeline = std::move(resultPipeline.pipeline);
+    pendingLink.originalPipeline = std::move(pipeline);
+    pendingLink.binaryKey = binaryKey;
+    program->m_PendingLink = std::move(pendingLink);
+}
+
+bool ShaderManager::resolveLink(Context& context, GLuint programId)
+{
+    if (!context.getManager().has(programId))
+        return false;
+    auto program = context.getManager().get(programId);
+    if (!program->hasPendingLink())
+        return false;
+    auto pendingLink = std::move(program->m_PendingLink.value());
+    program->m_PendingLink.reset();
+
+    auto status = helper::getCompilationResult(pendingLink.injectedPipeline, pendingLink.shaders, programId);
+    bool isLinked = true;
+    if (status.hasLinkedSuccessfully)
+    {
+        context.getProgramBinaryCache().store(pendingLink.binaryKey, programId);
+        helper::deleteShaders(programId, pendingLink.fallbackShaders);
+    }
+    else
     {
         dumpCompilationResult(status);
-        // At least compile original pipeline
-        auto statusOriginal = helper::tryCompilingShaderProgram(pipeline, programId);
+        // At least link original pipeline
+        auto fallbackShaders = pendingLink.fallbackShaders;
+        if (fallbackShaders.empty())
+        {
+            fallbackShaders = helper::compileShaders(pendingLink.originalPipeline);
+        }
+        helper::submitLink(programId, fallbackShaders);
+        helper::deleteShaders(programId, fallbackShaders);
+        // Application's own pipeline may not link either, application gets the error from its query then
+        isLinked = isProgramLinked(programId);
+        if (!isLinked)
+        {
+            Logger::logError("Failed to link original pipeline of program [", programId, "]: ", getProgramLogMessage(programId).value_or("Unable to get log"));
+        }
+    }
+    finishLink(context, *program, programId, status.hasLinkedSuccessfully, isLinked);
+    return true;
+}
+
+bool ShaderManager::isLinkCompleted(Context& context, GLuint programId)
+{
+    if (!context.getManager().has(programId) || !context.getManager().get(programId)->hasPendingLink())
+        return true;
+    if (!context.parallelShaderCompileFlag)
+        return false;
+    GLint isCompleted = GL_TRUE;
+    glGetProgramiv(programId, GL_COMPLETION_STATUS_KHR, &isCompleted);
+    return isCompleted == GL_TRUE;
+}
+
+void ShaderManager::releasePendingLink(trackers::ShaderProgram& program, GLuint programId)
+{
+    if (!program.hasPendingLink())
+        return;
+    helper::deleteShaders(programId, program.m_PendingLink->shaders);
+    helper::deleteShaders(programId, program.m_PendingLink->fallbackShaders);
+    program.m_PendingLink.reset();
+}
+
+void ShaderManager::finishLink(Context& context, trackers::ShaderProgram& program, GLuint programId, bool hasLinkedInjectedPipeline, bool isLinked)
+{
+    if (program.m_Metadata)
+    {
+        program.m_Metadata->m_IsLinkedCorrectly = hasLinkedInjectedPipeline;
+    }
+    // Program without executable has no uniforms to resolve
+    if (!isLinked)
+    {
+        program.m_InjectorUniforms = {};
+        program.m_LayeredSamplerUnits.clear();
+        return;
     }
 
-    if (program->m_Metadata)
+    // Resolve injector's uniforms once, so that draw calls can use cached locations
+    program.resolveUniformLocations(programId);
+    if (program.m_InjectorUniforms.hasParametersBlock())
+    {
+        glUniformBlockBinding(programId, program.m_InjectorUniforms.parametersBlock, context.getInjectorParameters().getBindingIndex());
+    }
+    // Layered samplers are unused until a shadowed texture is sampled (see DrawManager)
+    for (const auto& sampler : program.m_InjectorUniforms.layeredSamplers)
     {
-        program->m_Metadata->m_IsLinkedCorrectly = (status.hasLinkedSuccessfully == GL_TRUE);
+        if (sampler.layeredSampler != -1)
+            glProgramUniform1i(programId, sampler.layeredSampler, trackers::TextureUnitTracker::getReservedUnit(GL_TEXTURE_2D_ARRAY));
     }
 }
 
@@ -243,7 +417,14 @@ void ShaderManager::compileShader(Context& context, GLuint shader)
 {
     Logger::log("glCompileShader");
     glCompileShader(shader);
-    GLint status;
+    // Querying status would wait for compilation, thus only report it when it's already known
+    if (!context.parallelShaderCompileFlag)
+        return;
+    GLint isCompleted = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPLETION_STATUS_KHR, &isCompleted);
+    if (isCompleted == GL_FALSE)
+        return;
+    GLint status = GL_TRUE;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
     if (status == GL_FALSE)
     {
@@ -259,6 +440,36 @@ void ShaderManager::attachShader(Context& context, GLuint program, GLuint shader
     if (!context.getManager().has(program) || !context.getManager().shaders.has(shader))
         return;
     context.getManager().get(program)->attachShaderToProgram(context.getManager().shaders.get(shader));
+    startInjection(context, program);
+}
+
+void ShaderManager::startInjection(Context& context, GLuint programId)
+{
+    auto program = context.getManager().get(programId);
+    if (!program->shaders.has(GL_VERTEX_SHADER) || !program->shaders.has(GL_FRAGMENT_SHADER))
+        return;
+
+    // Worker captures pending sources, as shaders can be changed by application meanwhile
+    std::vector<std::pair<GLenum, std::shared_future<std::string>>> stages;
+    for (const auto& [type, shader] : program->shaders.getConstMap())
+    {
+        stages.emplace_back(shader->m_Type, shader->preprocessedSourceCode);
+    }
+    auto& profiles = context.getProfiles();
+    program->m_PendingInjection = m_Workers.submit([stages, &profiles, parameters = getPipelineParams(context)] {
+        hi::pipeline::PipelineInjector::PipelineType pipeline;
+        for (const auto& [type, sourceCode] : stages)
+        {
+            pipeline[type] = (sourceCode.valid() ? sourceCode.get() : std::string());
+        }
+        hi::pipeline::PipelineInjector plInjector(profiles);
+        return trackers::ShaderProgram::PendingInjection { plInjector.getCacheKey(pipeline, parameters), plInjector.process(pipeline, parameters) };
+    });
+}
+
+void ShaderManager::waitForBackgroundWork()
+{
+    m_Workers.wait();
 }
 
 GLuint ShaderManager::createProgram(Context& context)
@@ -272,12 +483,18 @@ GLuint ShaderManager::createProgram(Context& context)
 
 void ShaderManager::deleteProgram(Context& context, GLuint program)
 {
+    if (context.getManager().has(program))
+    {
+        releasePendingLink(*context.getManager().get(program), program);
+    }
     context.getManager().remove(program);
     glDeleteProgram(program);
 }
 
 void ShaderManager::useProgram(Context& context, GLuint program)
 {
+    // Drawing needs result of injection
+    resolveLink(context, program);
     glUseProgram(program);
     context.getManager().bind(program);
 }
@@ -11,12 +11,31 @@
 
 #include <functional>
 
+#include "utils/worker_pool.hpp"
+
 namespace hi
 {
 class Context;
 
+namespace trackers
+{
+    struct ShaderProgram;
+}
+
+namespace pipeline
+{
+    struct PipelineParams;
+}
+
 namespace managers
 {
+    /**
+     * @brief Tracks shaders & programs and injects programs when they're linked
+     *
+     * CPU-only work (preprocessing and PipelineInjector) runs speculatively on worker threads as
+     * soon as sources are provided / program has VS & FS attached, thus linkProgram() mostly waits
+     * for the result and compiles it. Result of compilation is resolved lazily (see resolveLink()).
+     */
     class ShaderManager
     {
     public:
@@ -33,6 +52,35 @@ namespace managers
         void deleteProgram(Context& context, GLuint program);
         void useProgram(Context& context, GLuint program);
         void linkProgram(Context& context, GLuint program);
+        /// Inject & link program with given parameters (instead of context's)
+        void linkProgram(Context& context, GLuint program, const hi::pipeline::PipelineParams& parameters);
+
+        /// Get parameters of PipelineInjector, derived from context's settings
+        hi::pipeline::PipelineParams getPipelineParams(Context& context);
+
+        /**
+         * @brief Wait for result of link, submitted by linkProgram(), and fall back to original pipeline on failure
+         * @return true if program had pending link
+         */
+        bool resolveLink(Context& context, GLuint program);
+        /// Determine if resolveLink() wouldn't block (GL_COMPLETION_STATUS_KHR)
+        bool isLinkCompleted(Context& context, GLuint program);
+
+        /// Wait for all background work (which references context's profiles)
+        void waitForBackgroundWork();
+
+    private:
+        /// Start injecting program on worker thread if it's drawable
+        void startInjection(Context& context, GLuint program);
+        /// Delete shaders of program's pending link
+        void releasePendingLink(hi::trackers::ShaderProgram& program, GLuint programId);
+        /**
+         * @brief Resolve injector's uniforms of linked program
+         * @param isLinked false if neither injected, nor original pipeline has linked (nothing is resolved then)
+         */
+        void finishLink(Context& context, hi::trackers::ShaderProgram& program, GLuint programId, bool hasLinkedInjectedPipeline, bool isLinked);
+
+        hi::utils::WorkerPool m_Workers;
     };
 } // namespace managers
 } // namespace hi
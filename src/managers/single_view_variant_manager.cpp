@@ -0,0 +1,348 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        managers/single_view_variant_manager.cpp
+*
+*****************************************************************************/
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GL/gl.h>
+
+#include <optional>
+
+#include "context.hpp"
+#include "logger.hpp"
+#include "managers/single_view_variant_manager.hpp"
+#include "pipeline/pipeline_injector.hpp"
+#include "trackers/shader_tracker.hpp"
+
+using namespace hi;
+using namespace hi::managers;
+
+namespace helper
+{
+/// Is uniform (or block) owned by driver or injector, i.e. not set by application
+bool isInternalName(const std::string& name)
+{
+    return name.rfind("gl_", 0) == 0 || name.rfind("injector_", 0) == 0;
+}
+
+/**
+ * @brief Copy value of application's uniform into uniform of bound program
+ * @return Value of opaque uniform (texture/image unit), which isn't a vector or matrix
+ */
+std::optional<GLint> copyUniformValue(GLuint program, GLint location, GLint variantLocation, GLenum type)
+{
+    GLfloat floats[16] = {};
+    GLint ints[4] = {};
+    GLuint uints[4] = {};
+    GLdouble doubles[16] = {};
+    switch (type)
+    {
+    case GL_FLOAT:
+        glGetUniformfv(program, location, floats);
+        glUniform1fv(variantLocation, 1, floats);
+        break;
+    case GL_FLOAT_VEC2:
+        glGetUniformfv(program, location, floats);
+        glUniform2fv(variantLocation, 1, floats);
+        break;
+    case GL_FLOAT_VEC3:
+        glGetUniformfv(program, location, floats);
+        glUniform3fv(variantLocation, 1, floats);
+        break;
+    case GL_FLOAT_VEC4:
+        glGetUniformfv(program, location, floats);
+        glUniform4fv(variantLocation, 1, floats);
+        break;
+    case GL_FLOAT_MAT2:
+        glGetUniformfv(program, location, floats);
+        glUniformMatrix2fv(variantLocation, 1, GL_FALSE, floats);
+        break;
+    case GL_FLOAT_MAT3:
+        glGetUniformfv(program, location, floats);
+        glUniformMatrix3fv(variantLocation, 1, GL_FALSE, floats);
+        break;
+    case GL_FLOAT_MAT4:
+        glGetUniformfv(program, location, floats);
+        glUniformMatrix4fv(variantLocation, 1, GL_FALSE, floats);
+        break;
+    case GL_FLOAT_MAT2x3:
+        glGetUniformfv(program, location, floats);
+        glUniformMatrix2x3fv(variantLocation, 1, GL_FALSE, floats);
+        break;
+    case GL_FLOAT_MAT2x4:
+        glGetUniformfv(program, location, floats);
+        glUniformMatrix2x4fv(variantLocation, 1, GL_FALSE, floats);
+        break;
+    case GL_FLOAT_MAT3x2:
+        glGetUniformfv(program, location, floats);
+        glUniformMatrix3x2fv(variantLocation, 1, GL_FALSE, floats);
+        break;
+    case GL_FLOAT_MAT3x4:
+        glGetUniformfv(program, location, floats);
+        glUniformMatrix3x4fv(variantLocation, 1, GL_FALSE, floats);
+        break;
+    case GL_FLOAT_MAT4x2:
+        glGetUniformfv(program, location, floats);
+        glUniformMatrix4x2fv(variantLocation, 1, GL_FALSE, floats);
+        break;
+    case GL_FLOAT_MAT4x3:
+        glGetUniformfv(program, location, floats);
+        glUniformMatrix4x3fv(variantLocation, 1, GL_FALSE, floats);
+        break;
+    case GL_INT:
+    case GL_BOOL:
+        glGetUniformiv(program, location, ints);
+        glUniform1iv(variantLocation, 1, ints);
+        break;
+    case GL_INT_VEC2:
+    case GL_BOOL_VEC2:
+        glGetUniformiv(program, location, ints);
+        glUniform2iv(variantLocation, 1, ints);
+        break;
+    case GL_INT_VEC3:
+    case GL_BOOL_VEC3:
+        glGetUniformiv(program, location, ints);
+        glUniform3iv(variantLocation, 1, ints);
+        break;
+    case GL_INT_VEC4:
+    case GL_BOOL_VEC4:
+        glGetUniformiv(program, location, ints);
+        glUniform4iv(variantLocation, 1, ints);
+        break;
+    case GL_UNSIGNED_INT:
+        glGetUniformuiv(program, location, uints);
+        glUniform1uiv(variantLocation, 1, uints);
+        break;
+    case GL_UNSIGNED_INT_VEC2:
+        glGetUniformuiv(program, location, uints);
+        glUniform2uiv(variantLocation, 1, uints);
+        break;
+    case GL_UNSIGNED_INT_VEC3:
+        glGetUniformuiv(program, location, uints);
+        glUniform3uiv(variantLocation, 1, uints);
+        break;
+    case GL_UNSIGNED_INT_VEC4:
+        glGetUniformuiv(program, location, uints);
+        glUniform4uiv(variantLocation, 1, uints);
+        break;
+    case GL_DOUBLE:
+        glGetUniformdv(program, location, doubles);
+        glUniform1dv(variantLocation, 1, doubles);
+        break;
+    case GL_DOUBLE_VEC2:
+        glGetUniformdv(program, location, doubles);
+        glUniform2dv(variantLocation, 1, doubles);
+        break;
+    case GL_DOUBLE_VEC3:
+        glGetUniformdv(program, location, doubles);
+        glUniform3dv(variantLocation, 1, doubles);
+        break;
+    case GL_DOUBLE_VEC4:
+        glGetUniformdv(program, location, doubles);
+        glUniform4dv(variantLocation, 1, doubles);
+        break;
+    case GL_DOUBLE_MAT2:
+        glGetUniformdv(program, location, doubles);
+        glUniformMatrix2dv(variantLocation, 1, GL_FALSE, doubles);
+        break;
+    case GL_DOUBLE_MAT3:
+        glGetUniformdv(program, location, doubles);
+        glUniformMatrix3dv(variantLocation, 1, GL_FALSE, doubles);
+        break;
+    case GL_DOUBLE_MAT4:
+        glGetUniformdv(program, location, doubles);
+        glUniformMatrix4dv(variantLocation, 1, GL_FALSE, doubles);
+        break;
+    default:
+        // Opaque types (samplers & images) hold unit
+        glGetUniformiv(program, location, ints);
+        glUniform1iv(variantLocation, 1, ints);
+        return ints[0];
+    }
+    return {};
+}
+} // namespace helper
+
+bool SingleViewVariantManager::bind(Context& context)
+{
+    if (!context.getManager().hasBounded())
+        return false;
+    const auto programId = context.getManager().getBoundId();
+    const auto program = context.getManager().getBound();
+    if (program->m_OriginalPipeline.empty())
+        return false;
+
+    // Application has relinked program since variant was created
+    auto it = m_Variants.find(programId);
+    if (it != m_Variants.end() && it->second.linkStamp != program->m_LinkStamp)
+    {
+        if (it->second.id != 0)
+            m_ShaderManager.deleteProgram(context, it->second.id);
+        m_Variants.erase(it);
+        it = m_Variants.end();
+    }
+    if (it == m_Variants.end())
+    {
+        it = m_Variants.emplace(programId, createVariant(context, programId)).first;
+    }
+    auto& variant = it->second;
+    if (variant.id == 0)
+        return false;
+
+    m_ShaderManager.useProgram(context, variant.id);
+    if (variant.uniformEpoch != program->m_UniformEpoch)
+    {
+        copyUniforms(context, programId, variant);
+        variant.uniformEpoch = program->m_UniformEpoch;
+    }
+    return true;
+}
+
+void SingleViewVariantManager::unbind(Context& context, GLuint program)
+{
+    m_ShaderManager.useProgram(context, program);
+}
+
+void SingleViewVariantManager::deinitialize(Context& context)
+{
+    for (const auto& [program, variant] : m_Variants)
+    {
+        if (variant.id != 0)
+            m_ShaderManager.deleteProgram(context, variant.id);
+    }
+    m_Variants.clear();
+}
+
+SingleViewVariantManager::Variant SingleViewVariantManager::createVariant(Context& context, GLuint programId)
+{
+    const auto program = context.getManager().get(programId);
+
+    // Register program & its shaders as if application has created them
+    const auto variantId = m_ShaderManager.createProgram(context);
+    std::vector<GLuint> shaders;
+    for (const auto& [type, sourceCode] : program->m_OriginalPipeline)
+    {
+        const auto shader = m_ShaderManager.createShader(context, type);
+        const GLchar* sources[1] = { sourceCode.c_str() };
+        m_ShaderManager.shaderSource(context, shader, 1, sources, nullptr);
+        m_ShaderManager.attachShader(context, variantId, shader);
+        shaders.push_back(shader);
+    }
+
+    // Variant must match application's interface (attributes, outputs & feedback)
+    const auto& state = program->m_PreLinkState;
+    context.getManager().get(variantId)->m_PreLinkState = state;
+    for (const auto& [name, index] : state.attributeLocations)
+        glBindAttribLocation(variantId, index, name.c_str());
+    for (const auto& [name, location] : state.fragmentDataLocations)
+        glBindFragDataLocationIndexed(variantId, location.first, location.second, name.c_str());
+    if (!state.feedbackVaryings.empty())
+    {
+        std::vector<const GLchar*> varyings;
+        for (const auto& varying : state.feedbackVaryings)
+            varyings.push_back(varying.c_str());
+        glTransformFeedbackVaryings(variantId, varyings.size(), varyings.data(), state.feedbackBufferMode);
+    }
+    if (state.isSeparable)
+        glProgramParameteri(variantId, GL_PROGRAM_SEPARABLE, GL_TRUE);
+
+    auto parameters = m_ShaderManager.getPipelineParams(context);
+    parameters.shouldUseMultiviewExtension = false;
+    m_ShaderManager.linkProgram(context, variantId, parameters);
+    // Variant is used immediately
+    m_ShaderManager.resolveLink(context, variantId);
+    for (const auto shader : shaders)
+    {
+        m_ShaderManager.deleteShader(context, shader);
+    }
+
+    if (!context.getManager().get(variantId)->isLinked())
+    {
+        Logger::logError("Failed to create single-view variant of program ", programId, HI_POS);
+        m_ShaderManager.deleteProgram(context, variantId);
+        Variant result;
+        result.linkStamp = program->m_LinkStamp;
+        return result;
+    }
+    Logger::logDebug("Created single-view variant ", variantId, " of program ", programId);
+
+    Variant result;
+    result.id = variantId;
+    result.linkStamp = program->m_LinkStamp;
+    // Force copy of uniforms on first use
+    result.uniformEpoch = program->m_UniformEpoch - 1;
+
+    // Map application's uniforms (array elements one by one) to variant's
+    GLint uniformsCount = 0, maxNameLength = 0;
+    glGetProgramiv(programId, GL_ACTIVE_UNIFORMS, &uniformsCount);
+    glGetProgramiv(programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::vector<GLchar> nameBuffer(maxNameLength + 1);
+    for (GLuint index = 0; index < static_cast<GLuint>(uniformsCount); index++)
+    {
+        GLsizei length = 0;
+        GLint size = 0, blockIndex = -1;
+        GLenum type = 0;
+        glGetActiveUniform(programId, index, nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+        glGetActiveUniformsiv(programId, 1, &index, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+        const std::string name(nameBuffer.data(), length);
+        // Block members are backed by application's buffers, atomic counters can't be set
+        if (blockIndex != -1 || type == GL_UNSIGNED_INT_ATOMIC_COUNTER || helper::isInternalName(name))
+            continue;
+
+        // Arrays are reported by their first element (e.g. "lights[0]")
+        const auto isArray = (size > 1 && name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0);
+        const auto baseName = (isArray ? name.substr(0, name.size() - 3) : name);
+        for (GLint element = 0; element < (isArray ? size : 1); element++)
+        {
+            const auto elementName = (isArray ? baseName + "[" + std::to_string(element) + "]" : name);
+            Uniform uniform;
+            uniform.location = glGetUniformLocation(programId, elementName.c_str());
+            uniform.variantLocation = glGetUniformLocation(variantId, elementName.c_str());
+            uniform.type = type;
+            if (uniform.location != -1 && uniform.variantLocation != -1)
+                result.uniforms.push_back(uniform);
+        }
+    }
+
+    GLint blocksCount = 0;
+    glGetProgramiv(programId, GL_ACTIVE_UNIFORM_BLOCKS, &blocksCount);
+    for (GLuint index = 0; index < static_cast<GLuint>(blocksCount); index++)
+    {
+        GLint nameLength = 0;
+        glGetActiveUniformBlockiv(programId, index, GL_UNIFORM_BLOCK_NAME_LENGTH, &nameLength);
+        std::vector<GLchar> blockName(nameLength + 1);
+        glGetActiveUniformBlockName(programId, index, blockName.size(), nullptr, blockName.data());
+        if (helper::isInternalName(blockName.data()))
+            continue;
+        UniformBlock block;
+        block.index = index;
+        block.variantIndex = glGetUniformBlockIndex(variantId, blockName.data());
+        if (block.variantIndex != GL_INVALID_INDEX)
+            result.uniformBlocks.push_back(block);
+    }
+    return result;
+}
+
+void SingleViewVariantManager::copyUniforms(Context& context, GLuint program, const Variant& variant)
+{
+    auto variantProgram = context.getManager().get(variant.id);
+    for (const auto& uniform : variant.uniforms)
+    {
+        const auto unit = helper::copyUniformValue(program, uniform.location, uniform.variantLocation, uniform.type);
+        if (unit.has_value())
+        {
+            // Variant's samplers are redirected to layered textures as well (see DrawManager)
+            variantProgram->setSamplerUnits(uniform.variantLocation, 1, &unit.value());
+        }
+    }
+    for (const auto& block : variant.uniformBlocks)
+    {
+        GLint binding = 0;
+        glGetActiveUniformBlockiv(program, block.index, GL_UNIFORM_BLOCK_BINDING, &binding);
+        glUniformBlockBinding(variant.id, block.variantIndex, binding);
+        variantProgram->updateUniformBlock(block.variantIndex, binding);
+    }
+}
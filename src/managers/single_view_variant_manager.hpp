@@ -0,0 +1,84 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        managers/single_view_variant_manager.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_SINGLE_VIEW_VARIANT_MANAGER_HPP
+#define HI_SINGLE_VIEW_VARIANT_MANAGER_HPP
+
+#include <GL/gl.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "managers/shader_manager.hpp"
+
+namespace hi
+{
+class Context;
+
+namespace managers
+{
+    /**
+     * @brief Substitutes programs, injected with GL_OVR_multiview, by their single-view variants
+     *
+     * Program, which declares all views (layout(num_views)), can only render into a multiview
+     * FBO. Draw calls into FBOs, which can't be repeated (e.g. shadow maps), are drawn by variant
+     * of the program, injected from the same sources without the extension. Variant is created
+     * on first use, and application's uniforms are copied into it whenever they change (see
+     * ShaderProgram::m_UniformEpoch).
+     */
+    class SingleViewVariantManager
+    {
+    public:
+        /**
+         * @brief Bind single-view variant of bound program
+         * @return false if variant can't be created, application's program stays bound then
+         */
+        bool bind(Context& context);
+        /// Restore application's program
+        void unbind(Context& context, GLuint program);
+        /// Delete created programs
+        void deinitialize(Context& context);
+
+    private:
+        /// Application's uniform (or element of array), copied into variant
+        struct Uniform
+        {
+            GLint location = -1;
+            GLint variantLocation = -1;
+            GLenum type = 0;
+        };
+        /// Application's uniform block, whose binding is copied into variant
+        struct UniformBlock
+        {
+            GLuint index = GL_INVALID_INDEX;
+            GLuint variantIndex = GL_INVALID_INDEX;
+        };
+        struct Variant
+        {
+            /// 0 when variant has failed to link
+            GLuint id = 0;
+            /// Link of application's program, the variant has been created for (see ShaderProgram::m_LinkStamp)
+            size_t linkStamp = 0;
+            /// Application's uniform epoch, whose values have been copied (see ShaderProgram::m_UniformEpoch)
+            size_t uniformEpoch = 0;
+            std::vector<Uniform> uniforms;
+            std::vector<UniformBlock> uniformBlocks;
+        };
+
+        Variant createVariant(Context& context, GLuint program);
+        /// Copy application's uniforms & block bindings into bound variant
+        void copyUniforms(Context& context, GLuint program, const Variant& variant);
+
+        /// Cache: application's program => variant
+        std::unordered_map<GLuint, Variant> m_Variants;
+        ShaderManager m_ShaderManager;
+    };
+} // namespace managers
+} // namespace hi
+
+#endif
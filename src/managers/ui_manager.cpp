@@ -28,12 +28,18 @@ UIManager::~UIManager() = default;
 void UIManager::initialize(Context& context)
 {
     inspectorWidget = std::make_unique<InspectorWidget>(context.getManager(), context.getFBOTracker(), context.getTextureTracker(), context.getRenderbufferTracker());
+    inspectedContext = &context;
     registerCallbacks(context);
 }
 
 void UIManager::deinitialize(Context& context)
 {
-    inspectorWidget.reset();
+    // Inspector may show trackers of another context
+    if (inspectedContext == &context)
+    {
+        inspectorWidget.reset();
+        inspectedContext = nullptr;
+    }
     context.getSettingsWidget().freeItems();
 }
 
@@ -140,6 +146,11 @@ void UIManager::onKeyPressed(Context& context, size_t keySym)
         context.getGui().setVisibility(!context.getGui().isVisible());
         break;
     case XK_F12:
+        if (context.useMultiviewExtensionFlag)
+        {
+            Logger::log("Multiview can't be deactivated when GL_OVR_multiview is used");
+            break;
+        }
         context.m_IsMultiviewActivated = !context.m_IsMultiviewActivated;
         break;
     case XK_F10:
@@ -32,6 +32,8 @@ namespace managers
     private:
         void registerCallbacks(Context& context);
         std::unique_ptr<InspectorWidget> inspectorWidget;
+        /// Context, whose trackers are shown by inspectorWidget
+        Context* inspectedContext = nullptr;
         bool shouldRenderInspector = false;
     };
 }
@@ -124,6 +124,7 @@ void hi::paralax::Mapping::initializeResources()
         GL_FRAGMENT_SHADER);
 
     m_program = std::make_unique<hi::utils::glProgram>(std::move(vs), std::move(fs));
+    m_UniformLocations.clear();
     m_VAO = std::make_shared<hi::utils::glFullscreenVAO>();
 }
 
@@ -149,7 +150,7 @@ void hi::paralax::Mapping::draw(size_t gridXSize, size_t gridYSize, float dispar
 void hi::paralax::Mapping::setUniform1i(const std::string& name, size_t value)
 {
     auto progID = m_program->getID();
-    size_t texLocation = glGetUniformLocation(progID, name.c_str());
+    auto texLocation = getUniformLocation(name);
     glUseProgram(progID);
     glUniform1i(texLocation, value);
 }
@@ -157,7 +158,17 @@ void hi::paralax::Mapping::setUniform1i(const std::string& name, size_t value)
 void hi::paralax::Mapping::setUniform1f(const std::string& name, float value)
 {
     auto progID = m_program->getID();
-    size_t texLocation = glGetUniformLocation(progID, name.c_str());
+    auto texLocation = getUniformLocation(name);
     glUseProgram(progID);
     glUniform1f(texLocation, value);
 }
+
+int hi::paralax::Mapping::getUniformLocation(const std::string& name)
+{
+    auto cached = m_UniformLocations.find(name);
+    if (cached != m_UniformLocations.end())
+        return cached->second;
+    auto location = glGetUniformLocation(m_program->getID(), name.c_str());
+    m_UniformLocations[name] = location;
+    return location;
+}
@@ -10,6 +10,8 @@
 #define HI_PARALAX_MAPPING_HPP
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 namespace hi
 {
@@ -34,6 +36,11 @@ namespace paralax
     private:
         void setUniform1i(const std::string& name, size_t value);
         void setUniform1f(const std::string& name, float value);
+        /// Get uniform's location, querying OpenGL only when not cached yet
+        int getUniformLocation(const std::string& name);
+
+        /// Cache: uniform name to location in m_program
+        std::unordered_map<std::string, int> m_UniformLocations;
         std::shared_ptr<hi::utils::glProgram> m_program;
         std::shared_ptr<hi::utils::glFullscreenVAO> m_VAO;
     };
@@ -0,0 +1,282 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        pipeline/fixed_pipeline_emulation.cpp
+*
+*****************************************************************************/
+
+#include "pipeline/fixed_pipeline_emulation.hpp"
+
+#include <sstream>
+
+using namespace hi;
+using namespace hi::pipeline;
+
+namespace helper
+{
+/// Maximal count of lights, defined by OpenGL standard (GL_LIGHT0 - GL_LIGHT7)
+constexpr size_t maxLights = 8;
+
+uint32_t getTextureEnvModeIndex(GLenum mode)
+{
+    switch (mode)
+    {
+    case GL_REPLACE:
+        return 1;
+    case GL_DECAL:
+        return 2;
+    case GL_ADD:
+        return 3;
+    case GL_BLEND:
+        return 4;
+    case GL_MODULATE:
+    default:
+        return 0;
+    }
+}
+
+uint32_t getFogModeIndex(GLenum mode)
+{
+    switch (mode)
+    {
+    case GL_LINEAR:
+        return 1;
+    case GL_EXP2:
+        return 2;
+    case GL_EXP:
+    default:
+        return 0;
+    }
+}
+
+/// Alpha test, which passes all fragments, is equal to disabled test
+bool hasAlphaTest(const FixedPipelineState& state)
+{
+    return state.isAlphaTestEnabled && state.alphaFunc != GL_ALWAYS;
+}
+
+/// Get GLSL condition, which passes fragment's alpha for given alpha function
+std::string getAlphaTestCondition(GLenum func, const std::string& alpha, const std::string& reference)
+{
+    switch (func)
+    {
+    case GL_NEVER:
+        return "false";
+    case GL_LESS:
+        return alpha + " < " + reference;
+    case GL_EQUAL:
+        return alpha + " == " + reference;
+    case GL_LEQUAL:
+        return alpha + " <= " + reference;
+    case GL_GREATER:
+        return alpha + " > " + reference;
+    case GL_NOTEQUAL:
+        return alpha + " != " + reference;
+    case GL_GEQUAL:
+        return alpha + " >= " + reference;
+    case GL_ALWAYS:
+    default:
+        return "true";
+    }
+}
+} // namespace helper
+
+uint32_t FixedPipelineState::getKey() const
+{
+    uint32_t key = 0;
+    if (isLightingEnabled)
+    {
+        key |= 1u;
+        key |= static_cast<uint32_t>(enabledLights) << 1;
+        key |= static_cast<uint32_t>(isColorMaterialEnabled) << 9;
+        key |= static_cast<uint32_t>(isNormalizeEnabled) << 10;
+    }
+    if (isTexture2DEnabled)
+    {
+        key |= 1u << 11;
+        key |= helper::getTextureEnvModeIndex(textureEnvMode) << 12;
+    }
+    if (isFogEnabled)
+    {
+        key |= 1u << 15;
+        key |= helper::getFogModeIndex(fogMode) << 16;
+    }
+    if (helper::hasAlphaTest(*this))
+    {
+        key |= 1u << 18;
+        key |= static_cast<uint32_t>(alphaFunc - GL_NEVER) << 19;
+    }
+    return key;
+}
+
+bool FixedPipelineEmulation::isTextureEnvModeSupported(GLenum mode)
+{
+    switch (mode)
+    {
+    case GL_MODULATE:
+    case GL_REPLACE:
+    case GL_DECAL:
+    case GL_ADD:
+    case GL_BLEND:
+        return true;
+    default:
+        return false;
+    }
+}
+
+PipelineInjector::PipelineType FixedPipelineEmulation::generate(const FixedPipelineState& state)
+{
+    return {
+        { GL_VERTEX_SHADER, generateVertexShader(state) },
+        { GL_FRAGMENT_SHADER, generateFragmentShader(state) },
+    };
+}
+
+std::string FixedPipelineEmulation::generateVertexShader(const FixedPipelineState& state)
+{
+    std::stringstream ss;
+    // Compatibility profile exposes fixed-pipeline state as built-in uniforms
+    ss << "#version 150 compatibility\n";
+    ss << "uniform mat4 " << projectionUniform << ";\n";
+    ss << "varying vec4 injector_ff_color;\n";
+    if (state.isTexture2DEnabled)
+        ss << "varying vec4 injector_ff_texCoord;\n";
+    if (state.isFogEnabled)
+        ss << "varying float injector_ff_fogCoord;\n";
+
+    if (state.isLightingEnabled)
+    {
+        ss << R"(
+vec4 injector_ff_light(gl_LightSourceParameters light, vec3 position, vec3 normal, vec4 ambient, vec4 diffuse)
+{
+    vec3 toLight = light.position.xyz - position * light.position.w;
+    float attenuation = 1.0;
+    if (light.position.w != 0.0)
+    {
+        float distance = length(toLight);
+        attenuation = 1.0 / (light.constantAttenuation + light.linearAttenuation * distance + light.quadraticAttenuation * distance * distance);
+        if (light.spotCutoff <= 90.0)
+        {
+            float spot = max(dot(normalize(-toLight), normalize(light.spotDirection)), 0.0);
+            attenuation *= (spot < light.spotCosCutoff ? 0.0 : pow(spot, light.spotExponent));
+        }
+    }
+    vec3 lightDirection = normalize(toLight);
+    float diffuseFactor = max(dot(normal, lightDirection), 0.0);
+    vec4 color = ambient * light.ambient + diffuse * light.diffuse * diffuseFactor;
+    if (diffuseFactor > 0.0)
+    {
+        vec3 halfVector = normalize(lightDirection + vec3(0.0, 0.0, 1.0));
+        color += gl_FrontMaterial.specular * light.specular * pow(max(dot(normal, halfVector), 0.0), gl_FrontMaterial.shininess);
+    }
+    return attenuation * color;
+}
+)";
+    }
+
+    ss << R"(
+void main()
+{
+    vec4 eyePosition = gl_ModelViewMatrix * gl_Vertex;
+)";
+    if (state.isLightingEnabled)
+    {
+        ss << "    vec3 normal = gl_NormalMatrix * gl_Normal;\n";
+        if (state.isNormalizeEnabled)
+            ss << "    normal = normalize(normal);\n";
+        const std::string ambient = (state.isColorMaterialEnabled ? "gl_Color" : "gl_FrontMaterial.ambient");
+        const std::string diffuse = (state.isColorMaterialEnabled ? "gl_Color" : "gl_FrontMaterial.diffuse");
+        ss << "    vec4 ambient = " << ambient << ";\n";
+        ss << "    vec4 diffuse = " << diffuse << ";\n";
+        ss << "    vec4 color = gl_FrontMaterial.emission + ambient * gl_LightModel.ambient;\n";
+        for (size_t light = 0; light < helper::maxLights; light++)
+        {
+            if (!(state.enabledLights & (1u << light)))
+                continue;
+            ss << "    color += injector_ff_light(gl_LightSource[" << light << "], eyePosition.xyz, normal, ambient, diffuse);\n";
+        }
+        ss << "    injector_ff_color = clamp(vec4(color.rgb, diffuse.a), 0.0, 1.0);\n";
+    }
+    else
+    {
+        ss << "    injector_ff_color = gl_Color;\n";
+    }
+    if (state.isTexture2DEnabled)
+        ss << "    injector_ff_texCoord = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n";
+    if (state.isFogEnabled)
+        ss << "    injector_ff_fogCoord = abs(eyePosition.z);\n";
+    ss << "    gl_Position = " << projectionUniform << " * eyePosition;\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+std::string FixedPipelineEmulation::generateFragmentShader(const FixedPipelineState& state)
+{
+    std::stringstream ss;
+    ss << "#version 150 compatibility\n";
+    ss << "varying vec4 injector_ff_color;\n";
+    if (state.isTexture2DEnabled)
+    {
+        ss << "varying vec4 injector_ff_texCoord;\n";
+        ss << "uniform sampler2D injector_ff_texture;\n";
+    }
+    if (state.isFogEnabled)
+        ss << "varying float injector_ff_fogCoord;\n";
+    if (helper::hasAlphaTest(state))
+        ss << "uniform float " << alphaReferenceUniform << ";\n";
+
+    ss << R"(
+void main()
+{
+    vec4 color = injector_ff_color;
+)";
+    if (state.isTexture2DEnabled)
+    {
+        ss << "    vec4 texel = texture2D(injector_ff_texture, injector_ff_texCoord.st / injector_ff_texCoord.q);\n";
+        switch (state.textureEnvMode)
+        {
+        case GL_REPLACE:
+            ss << "    color = texel;\n";
+            break;
+        case GL_DECAL:
+            ss << "    color = vec4(mix(color.rgb, texel.rgb, texel.a), color.a);\n";
+            break;
+        case GL_ADD:
+            ss << "    color = vec4(color.rgb + texel.rgb, color.a * texel.a);\n";
+            break;
+        case GL_BLEND:
+            ss << "    color = vec4(mix(color.rgb, gl_TextureEnvColor[0].rgb, texel.rgb), color.a * texel.a);\n";
+            break;
+        case GL_MODULATE:
+        default:
+            ss << "    color *= texel;\n";
+            break;
+        }
+    }
+    if (state.isFogEnabled)
+    {
+        switch (state.fogMode)
+        {
+        case GL_LINEAR:
+            ss << "    float fogFactor = (gl_Fog.end - injector_ff_fogCoord) * gl_Fog.scale;\n";
+            break;
+        case GL_EXP2:
+            ss << "    float fogFactor = exp(-pow(gl_Fog.density * injector_ff_fogCoord, 2.0));\n";
+            break;
+        case GL_EXP:
+        default:
+            ss << "    float fogFactor = exp(-gl_Fog.density * injector_ff_fogCoord);\n";
+            break;
+        }
+        ss << "    color.rgb = mix(gl_Fog.color.rgb, color.rgb, clamp(fogFactor, 0.0, 1.0));\n";
+    }
+    if (helper::hasAlphaTest(state))
+    {
+        ss << "    if (!(" << helper::getAlphaTestCondition(state.alphaFunc, "color.a", alphaReferenceUniform) << "))\n";
+        ss << "        discard;\n";
+    }
+    ss << "    gl_FragColor = color;\n";
+    ss << "}\n";
+    return ss.str();
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        pipeline/fixed_pipeline_emulation.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_FIXED_PIPELINE_EMULATION_HPP
+#define HI_FIXED_PIPELINE_EMULATION_HPP
+
+#include <GL/gl.h>
+#include <cstdint>
+
+#include "pipeline/pipeline_injector.hpp"
+
+namespace hi
+{
+namespace pipeline
+{
+    /**
+     * @brief Fixed-pipeline state, which selects variant of emulation program
+     *
+     * Only state, which changes the code of generated shaders, is stored here. Values
+     * (light parameters, materials, fog color, matrices, ...) are read by generated
+     * shaders from compatibility built-in uniforms (gl_LightSource, gl_Fog, ...).
+     */
+    struct FixedPipelineState
+    {
+        bool isLightingEnabled = false;
+        /// Bit i is set when GL_LIGHTi is enabled
+        uint8_t enabledLights = 0;
+        /// Ambient & diffuse material track current color (GL_AMBIENT_AND_DIFFUSE)
+        bool isColorMaterialEnabled = false;
+        bool isNormalizeEnabled = false;
+
+        /// GL_TEXTURE_2D on texture unit 0
+        bool isTexture2DEnabled = false;
+        GLenum textureEnvMode = GL_MODULATE;
+
+        bool isFogEnabled = false;
+        GLenum fogMode = GL_EXP;
+
+        bool isAlphaTestEnabled = false;
+        GLenum alphaFunc = GL_ALWAYS;
+
+        /**
+         * @brief Compact identifier of variant
+         *
+         * State, which has no effect (e.g. lights when lighting is disabled), is ignored,
+         * thus states with equal output of FixedPipelineEmulation::generate() share the key.
+         */
+        uint32_t getKey() const;
+    };
+
+    /**
+     * @brief Generates shader program, which emulates fixed-pipeline for given state
+     *
+     * Generated program covers transformation, per-vertex lighting (single-sided, infinite
+     * viewer), texturing of unit 0 (GL_MODULATE, GL_REPLACE, GL_DECAL, GL_ADD, GL_BLEND),
+     * fog and alpha test. Projection is read from injectorProjectionUniform, so that
+     * ShaderInspector detects it as the transformation of program, and the program can be
+     * injected by PipelineInjector as any application's program.
+     */
+    class FixedPipelineEmulation
+    {
+    public:
+        /// Projection matrix (GL_PROJECTION), uploaded before draw call
+        static constexpr const char* projectionUniform = "injector_ff_projection";
+        /// Reference value of alpha test (glAlphaFunc)
+        static constexpr const char* alphaReferenceUniform = "injector_ff_alphaRef";
+
+        /// Can given texture environment mode be emulated?
+        static bool isTextureEnvModeSupported(GLenum mode);
+
+        /// Create VS & FS of emulation program
+        static PipelineInjector::PipelineType generate(const FixedPipelineState& state);
+
+    private:
+        static std::string generateVertexShader(const FixedPipelineState& state);
+        static std::string generateFragmentShader(const FixedPipelineState& state);
+    };
+} // namespace pipeline
+} // namespace hi
+#endif
@@ -0,0 +1,172 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        pipeline/immediate_mode_buffer.cpp
+*
+*****************************************************************************/
+
+#include <cstring>
+#include <utility>
+
+#define GL_GLEXT_PROTOTYPES 1
+#include "GL/gl.h"
+
+#include "pipeline/immediate_mode_buffer.hpp"
+
+#include "logger.hpp"
+#include "trackers/state_tracker.hpp"
+#include "utils/context_capabilities.hpp"
+#include "utils/opengl_objects.hpp"
+
+using namespace hi;
+using namespace hi::pipeline;
+
+ImmediateModeBuffer::~ImmediateModeBuffer()
+{
+    // Context may be gone (see AbandonOpenGLObjectsRAII)
+    if (!utils::AbandonOpenGLObjectsRAII::isActive())
+        deinitialize();
+}
+
+GLint ImmediateModeBuffer::push(const Vertex* vertices, size_t count)
+{
+    if (count == 0 || count > regionVertices)
+        return -1;
+    if (!m_Mapping && !allocate())
+        return -1;
+
+    if (m_Offset + count > (m_Region + 1) * regionVertices)
+    {
+        // Draw calls, reading filled region, have already been issued
+        m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_Region = (m_Region + 1) % regions;
+        m_Offset = m_Region * regionVertices;
+        if (auto fence = m_Fences[m_Region])
+        {
+            // Wait until GPU has consumed the next region
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+            {
+            }
+            glDeleteSync(fence);
+            m_Fences[m_Region] = nullptr;
+        }
+    }
+
+    std::memcpy(m_Mapping + m_Offset, vertices, count * sizeof(Vertex));
+    const auto first = m_Offset;
+    m_Offset += count;
+    return static_cast<GLint>(first);
+}
+
+GLuint ImmediateModeBuffer::getVertexArray() const
+{
+    return m_VertexArray;
+}
+
+void ImmediateModeBuffer::setAttributes(unsigned attributes)
+{
+    if (!m_VertexArray || attributes == m_Attributes)
+        return;
+    glBindVertexArray(m_VertexArray);
+    glClientActiveTexture(GL_TEXTURE0);
+
+    using Tracker = hi::trackers::ImmediateModeTracker;
+    const std::pair<Tracker::Attribute, GLenum> arrays[] = {
+        { Tracker::NORMAL_ATTRIBUTE, GL_NORMAL_ARRAY },
+        { Tracker::COLOR_ATTRIBUTE, GL_COLOR_ARRAY },
+        { Tracker::TEXCOORD_ATTRIBUTE, GL_TEXTURE_COORD_ARRAY },
+    };
+    for (const auto& [attribute, array] : arrays)
+    {
+        if ((attributes & attribute) == (m_Attributes & attribute))
+            continue;
+        if (attributes & attribute)
+            glEnableClientState(array);
+        else
+            glDisableClientState(array);
+    }
+    m_Attributes = attributes;
+
+    glClientActiveTexture(m_Mirror->getClientActiveTexture());
+    glBindVertexArray(m_Mirror->getBoundVertexArray());
+}
+
+void ImmediateModeBuffer::initialize(const utils::ContextCapabilities& capabilities, const trackers::StateTracker& mirror)
+{
+    m_Mirror = &mirror;
+    const bool hasBufferStorage = capabilities.isVersionAtLeast(4, 4) || capabilities.hasExtension("GL_ARB_buffer_storage");
+    const bool hasDirectStateAccess = capabilities.isVersionAtLeast(4, 5) || capabilities.hasExtension("GL_ARB_direct_state_access");
+    m_HasFailed = !hasBufferStorage || !hasDirectStateAccess;
+    if (m_HasFailed)
+    {
+        Logger::log("GL_ARB_buffer_storage or GL_ARB_direct_state_access is not available -> immediate mode falls back to display lists");
+    }
+}
+
+bool ImmediateModeBuffer::allocate()
+{
+    // Unsupported or not initialized by context
+    if (m_HasFailed || !m_Mirror)
+        return false;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const auto size = sizeof(Vertex) * regionVertices * regions;
+    glCreateBuffers(1, &m_Buffer);
+    glNamedBufferStorage(m_Buffer, size, nullptr, flags);
+    m_Mapping = static_cast<Vertex*>(glMapNamedBufferRange(m_Buffer, 0, size, flags));
+    if (!m_Mapping)
+    {
+        Logger::logError("Failed to map immediate-mode buffer", HI_POS);
+        deinitialize();
+        m_HasFailed = true;
+        return false;
+    }
+
+    // Fixed-pipeline arrays are part of VAO, except for client active texture unit
+    glGenVertexArrays(1, &m_VertexArray);
+    glBindVertexArray(m_VertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, m_Buffer);
+    const GLsizei stride = sizeof(Vertex);
+    glVertexPointer(4, GL_FLOAT, stride, reinterpret_cast<const void*>(offsetof(Vertex, position)));
+    glNormalPointer(GL_FLOAT, stride, reinterpret_cast<const void*>(offsetof(Vertex, normal)));
+    glColorPointer(4, GL_FLOAT, stride, reinterpret_cast<const void*>(offsetof(Vertex, color)));
+    glClientActiveTexture(GL_TEXTURE0);
+    glTexCoordPointer(4, GL_FLOAT, stride, reinterpret_cast<const void*>(offsetof(Vertex, texCoord)));
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    glClientActiveTexture(m_Mirror->getClientActiveTexture());
+    glBindBuffer(GL_ARRAY_BUFFER, m_Mirror->getBoundBuffer(GL_ARRAY_BUFFER));
+    glBindVertexArray(m_Mirror->getBoundVertexArray());
+
+    m_Offset = 0;
+    m_Region = 0;
+    m_Attributes = hi::trackers::ImmediateModeTracker::ALL_ATTRIBUTES;
+    return true;
+}
+
+void ImmediateModeBuffer::deinitialize()
+{
+    for (auto& fence : m_Fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (m_VertexArray)
+    {
+        glDeleteVertexArrays(1, &m_VertexArray);
+        m_VertexArray = 0;
+    }
+    if (m_Buffer)
+    {
+        if (m_Mapping)
+            glUnmapNamedBuffer(m_Buffer);
+        glDeleteBuffers(1, &m_Buffer);
+        m_Buffer = 0;
+    }
+    m_Mapping = nullptr;
+}
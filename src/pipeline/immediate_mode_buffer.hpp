@@ -0,0 +1,91 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        pipeline/immediate_mode_buffer.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_IMMEDIATE_MODE_BUFFER_HPP
+#define HI_IMMEDIATE_MODE_BUFFER_HPP
+
+#include <GL/gl.h>
+#include <array>
+#include <cstddef>
+
+#include "trackers/immediate_mode_tracker.hpp"
+
+namespace hi
+{
+namespace trackers
+{
+    class StateTracker;
+}
+namespace utils
+{
+    class ContextCapabilities;
+}
+namespace pipeline
+{
+    /**
+     * @brief Streams immediate-mode vertices through a persistently mapped ring buffer
+     *
+     * Buffer is split into regions. Batches are copied into mapped memory directly, and
+     * a region is fenced once it's been filled, so that it's reused only after GPU has
+     * drawn it. Vertex array object, which points fixed-pipeline arrays (vertex, normal,
+     * color and texture coordinates) to the buffer, is shared by all batches, thus each
+     * batch only costs a copy and glDrawArrays() per view.
+     *
+     * Requires GL_ARB_buffer_storage & GL_ARB_direct_state_access, allocation is lazy.
+     * Application's bindings, changed while VAO is set up, are restored from StateTracker's mirror.
+     */
+    class ImmediateModeBuffer
+    {
+    public:
+        using Vertex = hi::trackers::ImmediateModeTracker::Vertex;
+
+        /// Count of vertices, which fit into a single region (upper bound of batch size)
+        static constexpr size_t regionVertices = 1 << 15;
+        static constexpr size_t regions = 4;
+
+        ImmediateModeBuffer() = default;
+        ~ImmediateModeBuffer();
+
+        /**
+         * @brief Copy vertices into ring buffer
+         *
+         * @return index of first vertex in buffer, or -1 if buffer is not available or batch
+         * is larger than region
+         */
+        GLint push(const Vertex* vertices, size_t count);
+        /// Get vertex array object, sourcing vertices from ring buffer
+        GLuint getVertexArray() const;
+        /// Source only given attributes (ImmediateModeTracker::Attribute bits) from arrays, others from current state
+        void setAttributes(unsigned attributes);
+
+        /// Determine if buffer is supported by context (buffer itself is allocated on first push)
+        void initialize(const hi::utils::ContextCapabilities& capabilities, const hi::trackers::StateTracker& mirror);
+        /// Clean up
+        void deinitialize();
+
+    private:
+        bool allocate();
+
+        GLuint m_Buffer = 0;
+        GLuint m_VertexArray = 0;
+        Vertex* m_Mapping = nullptr;
+        bool m_HasFailed = false;
+        /// Mirror of application's VAO, GL_ARRAY_BUFFER & client active texture bindings
+        const hi::trackers::StateTracker* m_Mirror = nullptr;
+        /// Attributes, whose arrays are enabled in VAO
+        unsigned m_Attributes = hi::trackers::ImmediateModeTracker::ALL_ATTRIBUTES;
+
+        /// Write position (in vertices) & its region
+        size_t m_Offset = 0;
+        size_t m_Region = 0;
+        /// Fences of filled regions
+        std::array<GLsync, regions> m_Fences = {};
+    };
+} // namespace pipeline
+} // namespace hi
+#endif
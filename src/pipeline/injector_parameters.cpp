@@ -0,0 +1,161 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        pipeline/injector_parameters.cpp
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#define GL_GLEXT_PROTOTYPES 1
+#include "GL/gl.h"
+
+#include "pipeline/camera_parameters.hpp"
+#include "pipeline/injector_parameters.hpp"
+#include "pipeline/virtual_cameras.hpp"
+
+#include "logger.hpp"
+#include "trackers/state_tracker.hpp"
+#include "utils/context_capabilities.hpp"
+#include "utils/opengl_objects.hpp"
+
+using namespace hi;
+using namespace hi::pipeline;
+
+static_assert(sizeof(InjectorParameters::BlockLayout) == 16 + 16 * InjectorParameters::maxViews, "BlockLayout must match std140 layout");
+
+InjectorParameters::~InjectorParameters()
+{
+    // Context may be gone (see AbandonOpenGLObjectsRAII)
+    if (!utils::AbandonOpenGLObjectsRAII::isActive())
+        deinitialize();
+}
+
+void InjectorParameters::initialize(const utils::ContextCapabilities& capabilities, const trackers::StateTracker& mirror)
+{
+    if (!capabilities.isVersionAtLeast(3, 1) && !capabilities.hasExtension("GL_ARB_uniform_buffer_object"))
+    {
+        Logger::log("GL_ARB_uniform_buffer_object is not available -> injector parameters fall back to per-program uniforms");
+        return;
+    }
+    m_HasDirectStateAccess = capabilities.isVersionAtLeast(4, 5) || capabilities.hasExtension("GL_ARB_direct_state_access");
+    m_HasMultiBind = capabilities.isVersionAtLeast(4, 4) || capabilities.hasExtension("GL_ARB_multi_bind");
+    m_Mirror = &mirror;
+
+    // Reserve the last binding point, which is the least likely to be used by application
+    GLint maxBindings = 0;
+    glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &maxBindings);
+    m_BindingIndex = std::max(maxBindings, 1) - 1;
+
+    if (m_HasDirectStateAccess)
+    {
+        glCreateBuffers(1, &m_Buffer);
+        glNamedBufferData(m_Buffer, sizeof(BlockLayout), &m_Block, GL_DYNAMIC_DRAW);
+    }
+    else
+    {
+        glGenBuffers(1, &m_Buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_Buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockLayout), &m_Block, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_Mirror->getBoundBuffer(GL_UNIFORM_BUFFER));
+    }
+    m_IsDirty = true;
+}
+
+void InjectorParameters::deinitialize()
+{
+    if (m_Buffer)
+    {
+        glDeleteBuffers(1, &m_Buffer);
+        m_Buffer = 0;
+    }
+}
+
+void InjectorParameters::update(const CameraParameters& parameters, const VirtualCameras& cameras)
+{
+    BlockLayout block;
+    block.xShiftMultiplier = parameters.m_XShiftMultiplier;
+    block.frontalDistance = parameters.m_frontOpticalAxisCentreDistance;
+    block.replayViewID = m_Block.replayViewID;
+
+    const auto& allCameras = cameras.getCameras();
+    if (allCameras.size() > maxViews)
+    {
+        Logger::logError("Injector's uniform block can hold only ", maxViews, " views, got ", allCameras.size());
+    }
+    const auto viewCount = std::min(allCameras.size(), maxViews);
+    for (size_t cameraId = 0; cameraId < maxViews; cameraId++)
+    {
+        if (cameraId >= viewCount)
+        {
+            block.viewShifts[cameraId] = glm::vec4(0.0f);
+            continue;
+        }
+        // Note: must match the per-view shift, used by injector_transform()
+        const float normalizedDistance = 1.0f - 2.0f * float(cameraId + 1) / float(allCameras.size() + 1);
+        const float centerShift = normalizedDistance * block.xShiftMultiplier;
+        block.viewShifts[cameraId] = glm::vec4(centerShift / block.frontalDistance, centerShift, 0.0f, 0.0f);
+    }
+
+    if (!m_IsDirty && std::memcmp(&block, &m_Block, sizeof(BlockLayout)) == 0)
+        return;
+    m_Block = block;
+    m_IsDirty = false;
+
+    upload(0, sizeof(BlockLayout), &m_Block);
+}
+
+void InjectorParameters::bind()
+{
+    if (!m_Buffer)
+        return;
+    // Multi-bind variant does not change generic GL_UNIFORM_BUFFER binding
+    if (m_HasMultiBind)
+    {
+        glBindBuffersBase(GL_UNIFORM_BUFFER, m_BindingIndex, 1, &m_Buffer);
+        return;
+    }
+    glBindBufferBase(GL_UNIFORM_BUFFER, m_BindingIndex, m_Buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_Mirror->getBoundBuffer(GL_UNIFORM_BUFFER));
+}
+
+void InjectorParameters::setReplayView(int view)
+{
+    if (m_Block.replayViewID == view)
+        return;
+    m_Block.replayViewID = view;
+    upload(offsetof(BlockLayout, replayViewID), sizeof(m_Block.replayViewID), &m_Block.replayViewID);
+}
+
+void InjectorParameters::upload(size_t offset, size_t size, const void* data)
+{
+    if (!m_Buffer)
+        return;
+    if (m_HasDirectStateAccess)
+    {
+        glNamedBufferSubData(m_Buffer, offset, size, data);
+        return;
+    }
+    // Bind-to-edit, restore application's (mirrored) binding afterwards
+    glBindBuffer(GL_UNIFORM_BUFFER, m_Buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_Mirror->getBoundBuffer(GL_UNIFORM_BUFFER));
+}
+
+bool InjectorParameters::isEnabled() const
+{
+    return m_Buffer != 0;
+}
+
+GLuint InjectorParameters::getBindingIndex() const
+{
+    return m_BindingIndex;
+}
+
+const InjectorParameters::BlockLayout& InjectorParameters::getBlock() const
+{
+    return m_Block;
+}
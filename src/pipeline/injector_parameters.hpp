@@ -0,0 +1,102 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        pipeline/injector_parameters.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_INJECTOR_PARAMETERS_HPP
+#define HI_INJECTOR_PARAMETERS_HPP
+
+#include "GL/gl.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace hi
+{
+namespace trackers
+{
+    class StateTracker;
+}
+namespace utils
+{
+    class ContextCapabilities;
+}
+namespace pipeline
+{
+    /// Fwd declaration
+    class CameraParameters;
+    class VirtualCameras;
+
+    /**
+     * @brief Owns a uniform buffer with per-frame parameters of all injected programs
+     *
+     * Injected shaders declare 'injector_ParametersBlock' (std140), which is bound
+     * to a reserved binding point right after link. The buffer is updated once per
+     * frame, so that draw calls don't need to upload the parameters again.
+     */
+    class InjectorParameters
+    {
+    public:
+        /// Name of uniform block in injected shaders
+        static constexpr const char* blockName = "injector_ParametersBlock";
+        /// Maximal count of views, the block can hold
+        static constexpr size_t maxViews = 64;
+
+        /// CPU-side mirror of std140 layout of 'injector_ParametersBlock'
+        struct BlockLayout
+        {
+            float xShiftMultiplier = 0.0f;
+            float frontalDistance = 1.0f;
+            /// View selected by DeferredReplay, or -1 when draw calls select view themselves
+            int32_t replayViewID = -1;
+            float padding = 0.0f;
+            /// (projection shift, center shift, 0, 0) for each view
+            glm::vec4 viewShifts[maxViews];
+        };
+
+        InjectorParameters() = default;
+        ~InjectorParameters();
+
+        /**
+         * @brief Creates OpenGL buffer and reserves binding point (unless uniform buffers aren't supported)
+         * @param mirror Context's mirror of buffer bindings, which are restored after bind-to-edit
+         */
+        void initialize(const hi::utils::ContextCapabilities& capabilities, const hi::trackers::StateTracker& mirror);
+        /// Clean up
+        void deinitialize();
+
+        /// Recalculate per-view shifts and upload them if any parameter has changed
+        void update(const CameraParameters& parameters, const VirtualCameras& cameras);
+        /// Bind buffer to reserved binding point (does not alter GL_UNIFORM_BUFFER binding)
+        void bind();
+        /// Select view of replayed draw calls (-1 = none), uploads only the changed field
+        void setReplayView(int view);
+
+        /// Is the block available (otherwise injected programs must use per-program uniforms)
+        bool isEnabled() const;
+        /// Get reserved uniform buffer binding point
+        GLuint getBindingIndex() const;
+        /// Get cached block content
+        const BlockLayout& getBlock() const;
+
+    private:
+        /// Upload range of block, either with DSA or bind-to-edit
+        void upload(size_t offset, size_t size, const void* data);
+
+        GLuint m_Buffer = 0;
+        GLuint m_BindingIndex = 0;
+        BlockLayout m_Block;
+        /// Forces upload on first update()
+        bool m_IsDirty = true;
+        /// GL 4.5 / ARB_direct_state_access
+        bool m_HasDirectStateAccess = false;
+        /// GL 4.4 / ARB_multi_bind
+        bool m_HasMultiBind = false;
+        /// Mirror of application's GL_UNIFORM_BUFFER binding (non-DSA paths)
+        const hi::trackers::StateTracker* m_Mirror = nullptr;
+    };
+} // namespace pipeline
+} // namespace hi
+#endif
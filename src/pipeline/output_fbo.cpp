@@ -50,7 +50,9 @@ size_t OutputFBOParameters::getGridSizeY() const
 //-----------------------------------------------------------------------------
 OutputFBO::~OutputFBO()
 {
-    deinitialize();
+    // Context may be gone (see AbandonOpenGLObjectsRAII)
+    if (!utils::AbandonOpenGLObjectsRAII::isActive())
+        deinitialize();
 }
 
 void OutputFBO::initialize(OutputFBOParameters params)
@@ -223,6 +225,16 @@ void OutputFBO::initialize(OutputFBOParameters params)
     assert(program.getID() != 0);
     m_ViewerProgram = program.releaseID();
 
+    m_ViewerUniforms.gridXSize = glGetUniformLocation(m_ViewerProgram, "gridXSize");
+    m_ViewerUniforms.gridYSize = glGetUniformLocation(m_ViewerProgram, "gridYSize");
+    m_ViewerUniforms.shouldDisplayGrid = glGetUniformLocation(m_ViewerProgram, "shouldDisplayGrid");
+    m_ViewerUniforms.shouldSingleViewQuilt = glGetUniformLocation(m_ViewerProgram, "shouldSingleViewQuilt");
+    m_ViewerUniforms.singleViewID = glGetUniformLocation(m_ViewerProgram, "singleViewID");
+    m_ViewerUniforms.pitch = glGetUniformLocation(m_ViewerProgram, "pitch");
+    m_ViewerUniforms.tilt = glGetUniformLocation(m_ViewerProgram, "tilt");
+    m_ViewerUniforms.center = glGetUniformLocation(m_ViewerProgram, "center");
+    m_ViewerUniforms.subpixelSize = glGetUniformLocation(m_ViewerProgram, "subp");
+
     m_VAO = std::make_shared<hi::utils::glFullscreenVAO>();
 
     setHoloDisplayParameters(HoloDisplayParameters {});
@@ -235,6 +247,12 @@ void OutputFBO::deinitialize()
         glDeleteFramebuffers(1, &m_FBOId);
         m_FBOId = 0;
     }
+    if (m_MultiviewFBOId)
+    {
+        glDeleteFramebuffers(1, &m_MultiviewFBOId);
+        m_MultiviewFBOId = 0;
+    }
+    m_HasMultiviewFBOFailed = false;
     if (m_LayeredColorBuffer)
     {
         glDeleteTextures(1, &m_LayeredColorBuffer);
@@ -251,6 +269,7 @@ void OutputFBO::deinitialize()
     {
         glDeleteProgram(m_ViewerProgram);
         m_ViewerProgram = 0;
+        m_ViewerUniforms = {};
     }
 }
 void OutputFBO::renderToBackbuffer(const CameraParameters& params)
@@ -342,6 +361,34 @@ GLuint OutputFBO::createProxyFBO(size_t layer)
     return m_proxyFBO[layer].getID();
 }
 
+GLuint OutputFBO::getMultiviewFBOId()
+{
+    if (m_MultiviewFBOId || m_HasMultiviewFBOFailed)
+    {
+        return m_MultiviewFBOId;
+    }
+    assert(m_FBOId != 0);
+
+    GLuint multiviewFBO;
+    glGenFramebuffers(1, &multiviewFBO);
+    ASSERT_GL_ERROR()
+    // Hack: OpenGL require at least one bind before attaching
+    glBindFramebuffer(GL_FRAMEBUFFER, multiviewFBO);
+    glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_LayeredColorBuffer, 0, 0, m_Params.getLayers());
+    glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, m_LayeredDepthStencilBuffer, 0, 0, m_Params.getLayers());
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        Logger::logError("Failed to create multiview OutputFBO, status: ", status, HI_POS);
+        glDeleteFramebuffers(1, &multiviewFBO);
+        m_HasMultiviewFBOFailed = true;
+        return 0;
+    }
+    m_MultiviewFBOId = multiviewFBO;
+    return m_MultiviewFBOId;
+}
+
 void OutputFBO::toggleGridView()
 {
     shouldDisplayGrid = !shouldDisplayGrid;
@@ -364,51 +411,25 @@ const HoloDisplayParameters OutputFBO::getHoloDisplayParameters() const
 
 void OutputFBO::setHoloDisplayParameters(const HoloDisplayParameters params)
 {
-    if (m_HoloParameters.m_Pitch != params.m_Pitch)
-    {
-        glUniform1f(glGetUniformLocation(m_ViewerProgram, "pitch"), params.m_Pitch);
-    }
-
-    if (m_HoloParameters.m_Tilt != params.m_Tilt)
-    {
-        glUniform1f(glGetUniformLocation(m_ViewerProgram, "til"), params.m_Tilt);
-    }
-
-    if (m_HoloParameters.m_Center != params.m_Center)
-    {
-        glUniform1f(glGetUniformLocation(m_ViewerProgram, "center"), params.m_Center);
-    }
-
-    if (m_HoloParameters.m_SubpixelSize != params.m_SubpixelSize)
-    {
-        glUniform1f(glGetUniformLocation(m_ViewerProgram, "subp"), params.m_SubpixelSize);
-    }
-
+    // Uploaded to viewer program by renderGridLayout() (using cached locations)
     m_HoloParameters = params;
 }
 
 void OutputFBO::renderGridLayout()
 {
     glUseProgram(m_ViewerProgram);
-    auto gridXLocation = glGetUniformLocation(m_ViewerProgram, "gridXSize");
-    glUniform1i(gridXLocation, m_Params.getGridSizeX());
-
-    auto gridYLocation = glGetUniformLocation(m_ViewerProgram, "gridYSize");
-    glUniform1i(gridYLocation, m_Params.getGridSizeY());
-
-    auto gridToggleLocation = glGetUniformLocation(m_ViewerProgram, "shouldDisplayGrid");
-    glUniform1i(gridToggleLocation, shouldDisplayGrid);
-
-    auto singleViewQuilt = glGetUniformLocation(m_ViewerProgram, "shouldSingleViewQuilt");
-    glUniform1i(singleViewQuilt, shouldDisplayOnlySingleQuiltImage);
-
-    auto quiltSingle = glGetUniformLocation(m_ViewerProgram, "singleViewID");
-    glUniform1i(quiltSingle, m_OnlyQuiltImageID);
+    const auto& locations = m_ViewerUniforms;
+    glUniform1i(locations.gridXSize, m_Params.getGridSizeX());
+    glUniform1i(locations.gridYSize, m_Params.getGridSizeY());
+    glUniform1i(locations.shouldDisplayGrid, shouldDisplayGrid);
+    glUniform1i(locations.shouldSingleViewQuilt, shouldDisplayOnlySingleQuiltImage);
+    glUniform1i(locations.singleViewID, m_OnlyQuiltImageID);
 
     auto& params = m_HoloParameters;
-    glUniform1f(glGetUniformLocation(m_ViewerProgram, "pitch"), params.m_Pitch);
-    glUniform1f(glGetUniformLocation(m_ViewerProgram, "tilt"), params.m_Tilt);
-    glUniform1f(glGetUniformLocation(m_ViewerProgram, "center"), params.m_Center);
+    glUniform1f(locations.pitch, params.m_Pitch);
+    glUniform1f(locations.tilt, params.m_Tilt);
+    glUniform1f(locations.center, params.m_Center);
+    glUniform1f(locations.subpixelSize, params.m_SubpixelSize);
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glActiveTexture(GL_TEXTURE0);
@@ -93,6 +93,9 @@ namespace pipeline
         /// Create proxy FBO from texture views to a single layer of shadow FBO
         GLuint createProxyFBO(size_t layer);
 
+        /// Get FBO with all layers attached as views (GL_OVR_multiview), created on first use (0 on failure)
+        GLuint getMultiviewFBOId();
+
         /// Toggle grid vs native format view
         void toggleGridView();
 
@@ -115,12 +118,28 @@ namespace pipeline
         void renderParalax(const CameraParameters& params);
         bool m_ContainsImageFlag = false;
         GLuint m_FBOId = 0;
+        GLuint m_MultiviewFBOId = 0;
+        bool m_HasMultiviewFBOFailed = false;
         GLuint m_LayeredColorBuffer = 0;
         GLuint m_LayeredDepthStencilBuffer = 0;
 
         /// Shader program for displaying layared color buffers
         GLuint m_ViewerProgram = 0;
 
+        /// Cached uniform locations of m_ViewerProgram (resolved in initialize())
+        struct ViewerUniformLocations
+        {
+            GLint gridXSize = -1;
+            GLint gridYSize = -1;
+            GLint shouldDisplayGrid = -1;
+            GLint shouldSingleViewQuilt = -1;
+            GLint singleViewID = -1;
+            GLint pitch = -1;
+            GLint tilt = -1;
+            GLint center = -1;
+            GLint subpixelSize = -1;
+        } m_ViewerUniforms;
+
         // Full screen quad
         std::shared_ptr<hi::utils::glFullscreenVAO> m_VAO;
 
@@ -0,0 +1,297 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        pipeline/pipeline_cache.cpp
+*
+*****************************************************************************/
+
+#include "pipeline/pipeline_cache.hpp"
+#include "logger.hpp"
+#include "utils/enviroment.hpp"
+#include "utils/string_utils.hpp"
+
+#include <atomic>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace hi;
+using namespace hi::pipeline;
+
+namespace helper
+{
+/// Bump when format of entries changes
+constexpr auto cacheHeader = "holoinjector-pipeline-cache 1\n";
+constexpr auto checksumTag = "checksum";
+
+/// Append record 'tag length\nvalue\n'
+void writeRecord(std::string& output, const std::string& tag, const std::string& value)
+{
+    output += tag;
+    output += ' ';
+    output += std::to_string(value.size());
+    output += '\n';
+    output += value;
+    output += '\n';
+}
+
+void writeRecord(std::string& output, const std::string& tag, bool value)
+{
+    writeRecord(output, tag, std::string(value ? "1" : "0"));
+}
+
+/// Read record at position, moving position past the record
+bool readRecord(const std::string& input, size_t& position, std::string& tag, std::string& value)
+{
+    const auto tagEnd = input.find(' ', position);
+    const auto lineEnd = input.find('\n', position);
+    if (tagEnd == std::string::npos || lineEnd == std::string::npos || tagEnd > lineEnd)
+        return false;
+    size_t length = 0;
+    const auto [end, error] = std::from_chars(input.data() + tagEnd + 1, input.data() + lineEnd, length);
+    if (error != std::errc() || end != input.data() + lineEnd)
+        return false;
+    const auto valueStart = lineEnd + 1;
+    if (length > input.size() - valueStart || valueStart + length >= input.size() || input[valueStart + length] != '\n')
+        return false;
+    tag = input.substr(position, tagEnd - position);
+    value = input.substr(valueStart, length);
+    position = valueStart + length + 1;
+    return true;
+}
+
+std::string getChecksum(const std::string_view& payload)
+{
+    return utils::toHex(utils::computeStableHash(payload));
+}
+} // namespace helper
+
+PipelineCache::PipelineCache(std::filesystem::path directory)
+    : m_Directory(std::move(directory))
+{
+    if (m_Directory.empty())
+        return;
+    std::error_code error;
+    std::filesystem::create_directories(m_Directory, error);
+    if (error)
+    {
+        Logger::logError("[PipelineCache] Failed to create ", m_Directory, ": ", error.message(), ", disabling cache");
+        m_Directory.clear();
+    }
+}
+
+std::filesystem::path PipelineCache::getDefaultDirectory()
+{
+    auto cacheHome = enviroment::getEnviromentValueStr("XDG_CACHE_HOME", "");
+    if (cacheHome.empty())
+        cacheHome = (std::filesystem::path(enviroment::getEnviromentValueStr("HOME", "/tmp")) / ".cache").string();
+    return std::filesystem::path(cacheHome) / "holoinjector";
+}
+
+bool PipelineCache::isEnabled() const
+{
+    return !m_Directory.empty();
+}
+
+const std::filesystem::path& PipelineCache::getDirectory() const
+{
+    return m_Directory;
+}
+
+std::optional<PipelineInjector::PipelineProcessResult> PipelineCache::load(const std::string& key)
+{
+    const auto data = loadEntry(key);
+    if (!data.has_value())
+        return std::nullopt;
+    auto result = deserialize(key, data.value());
+    if (!result)
+    {
+        Logger::logError("[PipelineCache] Removing corrupted entry ", getEntryPath(key));
+        removeEntry(key);
+        return std::nullopt;
+    }
+    Logger::logDebug("[PipelineCache] Loaded ", getEntryPath(key));
+    return result;
+}
+
+bool PipelineCache::store(const std::string& key, const PipelineInjector::PipelineProcessResult& result)
+{
+    if (!isEnabled())
+        return false;
+    return storeEntry(key, serialize(key, result));
+}
+
+std::optional<std::string> PipelineCache::loadEntry(const std::string& key) const
+{
+    if (!isEnabled())
+        return std::nullopt;
+    std::ifstream input(getEntryPath(key), std::ios::binary);
+    if (!input.is_open())
+        return std::nullopt;
+    std::stringstream data;
+    data << input.rdbuf();
+    return data.str();
+}
+
+bool PipelineCache::storeEntry(const std::string& key, const std::string& data)
+{
+    if (!isEnabled())
+        return false;
+    // Write unique temporary file and rename it, which is atomic for concurrent processes
+    static std::atomic<size_t> counter = 0;
+    const auto path = getEntryPath(key);
+    auto temporaryPath = path;
+    temporaryPath += "." + std::to_string(getpid()) + "." + std::to_string(counter++) + ".tmp";
+    {
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!output.is_open())
+        {
+            Logger::logError("[PipelineCache] Failed to open ", temporaryPath, " for writing");
+            return false;
+        }
+        output << data;
+        if (!output.good())
+        {
+            output.close();
+            std::error_code error;
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        Logger::logError("[PipelineCache] Failed to store ", path, ": ", error.message());
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+void PipelineCache::removeEntry(const std::string& key)
+{
+    if (!isEnabled())
+        return;
+    std::error_code error;
+    std::filesystem::remove(getEntryPath(key), error);
+}
+
+std::string PipelineCache::serialize(const std::string& key, const PipelineInjector::PipelineProcessResult& result)
+{
+    std::string payload;
+    helper::writeRecord(payload, "key", key);
+    helper::writeRecord(payload, "success", result.wasSuccessfull);
+    if (result.failReason.has_value())
+        helper::writeRecord(payload, "failReason", result.failReason.value());
+    for (const auto& [type, sourceCode] : result.pipeline)
+        helper::writeRecord(payload, "stage:" + std::to_string(type), sourceCode);
+    if (const auto& metadata = result.metadata)
+    {
+        helper::writeRecord(payload, "metadata", true);
+        helper::writeRecord(payload, "isInvisible", metadata->m_IsInvisible);
+        helper::writeRecord(payload, "isInjected", metadata->m_IsInjected);
+        helper::writeRecord(payload, "isUniformInInterfaceBlock", metadata->m_IsUniformInInterfaceBlock);
+        helper::writeRecord(payload, "interfaceBlockName", metadata->m_InterfaceBlockName);
+        helper::writeRecord(payload, "transformationMatrixName", metadata->m_TransformationMatrixName);
+        helper::writeRecord(payload, "hasAnyUniform", metadata->m_HasAnyUniform);
+        helper::writeRecord(payload, "isClipSpaceTransform", metadata->m_IsClipSpaceTransform);
+        helper::writeRecord(payload, "hasAnyFtransform", metadata->m_HasAnyFtransform);
+        helper::writeRecord(payload, "isGeometryShaderUsed", metadata->m_IsGeometryShaderUsed);
+        helper::writeRecord(payload, "isInstancedLayeringUsed", metadata->m_IsInstancedLayeringUsed);
+        helper::writeRecord(payload, "isMultiviewExtensionUsed", metadata->m_IsMultiviewExtensionUsed);
+        for (const auto& sampler : metadata->m_LayeredSamplers)
+            helper::writeRecord(payload, "layeredSampler", sampler);
+    }
+    // Note: m_IsLinkedCorrectly is a property of linked program, thus it's not stored
+
+    std::string output = helper::cacheHeader;
+    output += payload;
+    helper::writeRecord(output, helper::checksumTag, helper::getChecksum(payload));
+    return output;
+}
+
+std::optional<PipelineInjector::PipelineProcessResult> PipelineCache::deserialize(const std::string& key, const std::string& data)
+{
+    const std::string header = helper::cacheHeader;
+    if (data.compare(0, header.size(), header) != 0)
+        return std::nullopt;
+
+    PipelineInjector::PipelineProcessResult result;
+    result.wasSuccessfull = false;
+    bool hasKey = false;
+    std::string tag, value;
+    size_t position = header.size();
+    while (true)
+    {
+        const auto recordStart = position;
+        if (!helper::readRecord(data, position, tag, value))
+            return std::nullopt;
+
+        if (tag == helper::checksumTag)
+        {
+            const auto payload = std::string_view(data).substr(header.size(), recordStart - header.size());
+            if (position != data.size() || value != helper::getChecksum(payload) || !hasKey)
+                return std::nullopt;
+            return result;
+        }
+
+        const bool flag = (value == "1");
+        auto& metadata = result.metadata;
+        if (tag == "key")
+        {
+            if (value != key)
+                return std::nullopt;
+            hasKey = true;
+        }
+        else if (tag == "success")
+            result.wasSuccessfull = flag;
+        else if (tag == "failReason")
+            result.failReason = value;
+        else if (tag.rfind("stage:", 0) == 0)
+        {
+            GLenum type = 0;
+            const auto [end, error] = std::from_chars(tag.data() + 6, tag.data() + tag.size(), type);
+            if (error != std::errc() || end != tag.data() + tag.size())
+                return std::nullopt;
+            result.pipeline[type] = value;
+        }
+        else if (tag == "metadata")
+            metadata = std::make_unique<ProgramMetadata>();
+        else if (!metadata)
+            return std::nullopt;
+        else if (tag == "isInvisible")
+            metadata->m_IsInvisible = flag;
+        else if (tag == "isInjected")
+            metadata->m_IsInjected = flag;
+        else if (tag == "isUniformInInterfaceBlock")
+            metadata->m_IsUniformInInterfaceBlock = flag;
+        else if (tag == "interfaceBlockName")
+            metadata->m_InterfaceBlockName = value;
+        else if (tag == "transformationMatrixName")
+            metadata->m_TransformationMatrixName = value;
+        else if (tag == "hasAnyUniform")
+            metadata->m_HasAnyUniform = flag;
+        else if (tag == "isClipSpaceTransform")
+            metadata->m_IsClipSpaceTransform = flag;
+        else if (tag == "hasAnyFtransform")
+            metadata->m_HasAnyFtransform = flag;
+        else if (tag == "isGeometryShaderUsed")
+            metadata->m_IsGeometryShaderUsed = flag;
+        else if (tag == "isInstancedLayeringUsed")
+            metadata->m_IsInstancedLayeringUsed = flag;
+        else if (tag == "isMultiviewExtensionUsed")
+            metadata->m_IsMultiviewExtensionUsed = flag;
+        else if (tag == "layeredSampler")
+            metadata->m_LayeredSamplers.push_back(value);
+        else
+            return std::nullopt;
+    }
+}
+
+std::filesystem::path PipelineCache::getEntryPath(const std::string& key) const
+{
+    return m_Directory / key;
+}
@@ -0,0 +1,63 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        pipeline/pipeline_cache.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_PIPELINE_CACHE_HPP
+#define HI_PIPELINE_CACHE_HPP
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "pipeline/pipeline_injector.hpp"
+
+namespace hi
+{
+namespace pipeline
+{
+    /**
+     * @brief Persistent, content-addressed cache of PipelineInjector's results
+     *
+     * Each entry is a file named by key (see PipelineInjector::getCacheKey), which holds
+     * injected sources & metadata. Entries are written into a temporary file and renamed,
+     * thus concurrent processes never see a partial entry. Corrupted entries (failed
+     * checksum) are treated as misses and removed.
+     */
+    class PipelineCache
+    {
+    public:
+        /// Creates disabled cache
+        PipelineCache() = default;
+        explicit PipelineCache(std::filesystem::path directory);
+
+        /// Get $XDG_CACHE_HOME/holoinjector (or ~/.cache/holoinjector)
+        static std::filesystem::path getDefaultDirectory();
+
+        bool isEnabled() const;
+        const std::filesystem::path& getDirectory() const;
+        std::optional<PipelineInjector::PipelineProcessResult> load(const std::string& key);
+        bool store(const std::string& key, const PipelineInjector::PipelineProcessResult& result);
+
+        /// Read raw content of entry (or nothing if entry doesn't exist)
+        std::optional<std::string> loadEntry(const std::string& key) const;
+        /// Write raw content of entry atomically
+        bool storeEntry(const std::string& key, const std::string& data);
+        void removeEntry(const std::string& key);
+
+        /// Serialize entry (including checksum)
+        static std::string serialize(const std::string& key, const PipelineInjector::PipelineProcessResult& result);
+        /// Deserialize entry or return nothing if entry is corrupted / belongs to other key
+        static std::optional<PipelineInjector::PipelineProcessResult> deserialize(const std::string& key, const std::string& data);
+
+    private:
+        std::filesystem::path getEntryPath(const std::string& key) const;
+
+        std::filesystem::path m_Directory;
+    };
+} //namespace pipeline
+} //namespace hi
+#endif
@@ -11,13 +11,84 @@
 #include "pipeline/shader_parser.hpp"
 
 #include "utils/string_utils.hpp"
+#include "version.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <map>
 #include <regex>
+#include <sstream>
+
 
 using namespace hi;
 using namespace hi::pipeline;
 
+namespace helper
+{
+/// Get GLSL version, declared by #version (or 0 if not present)
+size_t getGLSLVersion(const std::string& sourceCode)
+{
+    static const auto versionPattern = std::regex("#[\f\r\t\v ]*version[\f\r\t\v ]+([0-9]+)");
+    std::smatch m;
+    if (!std::regex_search(sourceCode, m, versionPattern))
+        return 0;
+    return std::stoul(m[1].str());
+}
+
+/// Uniform blocks require GLSL 1.40 (shaders without #version are upgraded to 4.50 later)
+bool supportsUniformBlocks(const PipelineInjector::PipelineType& pipeline)
+{
+    return std::all_of(pipeline.begin(), pipeline.end(), [](const auto& stage) {
+        const auto version = getGLSLVersion(stage.second);
+        return version == 0 || version >= 140;
+    });
+}
+
+/// gl_InstanceID requires GLSL 1.40 (shaders without #version are upgraded to 4.50 later)
+bool supportsInstancedLayers(const std::string& vertexShader)
+{
+    const auto version = getGLSLVersion(vertexShader);
+    return version == 0 || version >= 140;
+}
+
+/// GL_OVR_multiview2 requires GLSL 1.30 (shaders without #version are upgraded to 4.50 later)
+bool supportsMultiviewExtension(const std::string& vertexShader)
+{
+    const auto version = getGLSLVersion(vertexShader);
+    return version == 0 || version >= 130;
+}
+
+/**
+ * @brief Get FS's samplers, which can be redirected to layered (shadowed) textures
+ *
+ * Layer of fragment's view is passed from inserted GS as flat input, which requires GLSL 1.30.
+ * Samplers of VS would need the layer before GS is executed, thus such programs are skipped.
+ */
+std::vector<std::string> getLayerableSamplers(const PipelineInjector::PipelineType& pipeline)
+{
+    const auto& fragmentShader = pipeline.at(GL_FRAGMENT_SHADER);
+    const auto version = getGLSLVersion(fragmentShader);
+    if (version != 0 && version < 130)
+        return {};
+    if (ShaderInspector(pipeline.at(GL_VERTEX_SHADER)).hasSamplers())
+        return {};
+    return ShaderInspector(fragmentShader).getLayerableSamplers();
+}
+
+/// Insert code right after #version (or to the beginning), where #extension directives are allowed
+void insertAfterVersion(std::string& sourceCode, const std::string& code)
+{
+    size_t position = 0;
+    static const auto versionPattern = std::regex("#[\f\r\t\v ]*version[^\n]*\n");
+    std::smatch m;
+    if (std::regex_search(sourceCode, m, versionPattern))
+    {
+        position = m.position(0) + m.length(0);
+    }
+    sourceCode.insert(position, code);
+}
+} // namespace helper
+
 PipelineInjector::PipelineInjector(ShaderProfile& profileInst) :
     profiles { profileInst }
 {
@@ -49,6 +120,9 @@ PipelineInjector::PipelineProcessResult PipelineInjector::process(PipelineType i
     assert(output.count(GL_FRAGMENT_SHADER) > 0);
     assert(output.count(GL_VERTEX_SHADER) > 0);
 
+    // All stages must agree on declaration of per-frame parameters, otherwise program won't link
+    const bool useParametersBlock = params.shouldUseParametersBlock && helper::supportsUniformBlocks(input);
+
     /*
      * Inspect original shader program and search for transformation
      */
@@ -62,26 +136,27 @@ PipelineInjector::PipelineProcessResult PipelineInjector::process(PipelineType i
             return { false, input, std::move(metadata), "Geometry Shader is already layered -> processing not implemented" };
         }
         // does Geometry Shader calculate MVP transformation?
-        if (injectShader(GS, *metadata))
+        if (injectShader(GS, *metadata, useParametersBlock))
         {
             hasFilledMetadata = true;
             output[GL_GEOMETRY_SHADER] = GS;
         }
         else
         {
-            ShaderInspector::injectCommonCode(output[GL_GEOMETRY_SHADER]);
+            ShaderInspector::injectCommonCode(output[GL_GEOMETRY_SHADER], useParametersBlock);
         }
     }
 
     auto VS = output.at(GL_VERTEX_SHADER);
     // if geometry shader does not exist or it does not calculat MVP and VS does
-    if (!hasFilledMetadata && injectShader(VS, *metadata))
+    if (!hasFilledMetadata && injectShader(VS, *metadata, useParametersBlock))
     { // try VS if GS does not exists or does not contain transformation
         hasFilledMetadata = true;
         output[GL_VERTEX_SHADER] = VS;
     }
 
     auto updatedParams = params;
+    updatedParams.shouldUseParametersBlock = useParametersBlock;
     if (metadata)
     {
         updatedParams.shouldRenderToClipspace = metadata->m_IsClipSpaceTransform;
@@ -95,13 +170,26 @@ PipelineInjector::PipelineProcessResult PipelineInjector::process(PipelineType i
     // Inject new GS if none is provided
     if (input.count(GL_GEOMETRY_SHADER) == 0)
     {
-        if (params.shouldPreventGeometryShaderInsertion)
+        updatedParams.shouldUseMultiviewExtension = params.shouldUseMultiviewExtension && helper::supportsMultiviewExtension(input.at(GL_VERTEX_SHADER));
+        if (updatedParams.shouldUseMultiviewExtension)
+        {
+            updatedParams.shouldUseInstancedLayers = false;
+            metadata->m_IsGeometryShaderUsed = false;
+            metadata->m_IsMultiviewExtensionUsed = true;
+            output = injectVertexShader(output, updatedParams);
+        }
+        else if (params.shouldPreventGeometryShaderInsertion)
         {
+            updatedParams.shouldUseInstancedLayers = params.shouldUseInstancedLayers && helper::supportsInstancedLayers(input.at(GL_VERTEX_SHADER));
             metadata->m_IsGeometryShaderUsed = false;
+            metadata->m_IsInstancedLayeringUsed = updatedParams.shouldUseInstancedLayers;
             output = injectVertexShader(output, updatedParams);
         }
         else
-            output = insertGeometryShader(output, updatedParams);
+        {
+            metadata->m_LayeredSamplers = helper::getLayerableSamplers(input);
+            output = insertGeometryShader(output, updatedParams, metadata->m_LayeredSamplers);
+        }
     }
     else
     {
@@ -127,7 +215,7 @@ PipelineInjector::PipelineProcessResult PipelineInjector::process(PipelineType i
     return { true, output, std::move(metadata) };
 }
 
-PipelineInjector::PipelineType PipelineInjector::insertGeometryShader(const PipelineType& pipeline, const PipelineParams params)
+PipelineInjector::PipelineType PipelineInjector::insertGeometryShader(const PipelineType& pipeline, const PipelineParams params, const std::vector<std::string>& layeredSamplers)
 {
     // Verify that pipeline has FS and does not have GS
     assert(pipeline.count(GL_FRAGMENT_SHADER) == 1);
@@ -142,7 +230,7 @@ PipelineInjector::PipelineType PipelineInjector::insertGeometryShader(const Pipe
         )";
 
     geometryShaderStream << "//------------ Injector Insert Header start\n";
-    geometryShaderStream << ShaderInspector::getCommonTransformationShader() << "\n";
+    geometryShaderStream << ShaderInspector::getCommonTransformationShader(params.shouldUseParametersBlock) << "\n";
     geometryShaderStream << "layout (triangle_strip, max_vertices = " << 3 * params.countOfPrimitivesDuplicates << ") out;\n";
     geometryShaderStream << "layout (invocations= " << params.countOfInvocations << ") in;\n";
     geometryShaderStream << "const bool injector_geometry_isClipSpace = "
@@ -189,10 +277,10 @@ PipelineInjector::PipelineType PipelineInjector::insertGeometryShader(const Pipe
      * Remap 'varying' to out (VS) and in (FS) before replacing in/out
      */
     auto vertexShader = result[GL_VERTEX_SHADER];
-    vertexShader = utils::regex_replace_identifiers(vertexShader, "varying", [] { return "out"; });
+    vertexShader = utils::replace_identifiers(vertexShader, { { "varying", "out" } });
 
     auto fragmentShader = result[GL_FRAGMENT_SHADER];
-    fragmentShader = utils::regex_replace_identifiers(fragmentShader, "varying", [] { return "in"; });
+    fragmentShader = utils::replace_identifiers(fragmentShader, { { "varying", "in" } });
 
     ShaderInspector inspector(fragmentShader);
 
@@ -233,6 +321,15 @@ PipelineInjector::PipelineType PipelineInjector::insertGeometryShader(const Pipe
         }
     }
 
+    /*
+     * Pass view's layer to FS, which samples shadowed textures as layered
+     */
+    if (!layeredSamplers.empty())
+    {
+        ioDefinitionString += "flat out int injector_fragLayer;\n";
+        ioRedirections += "injector_fragLayer = (injector_isSingleViewActivated?injector_singleViewID:layer);\n";
+    }
+
     /*
      * Insert in/out redirection in Geometry Shader
      */
@@ -243,14 +340,23 @@ PipelineInjector::PipelineType PipelineInjector::insertGeometryShader(const Pipe
     geometryShader = geometryShader.insert(pos, ioRedirections);
 
     /*
-     * Replace all in attributes with prefixed version
+     * Replace all in attributes with prefixed version (in a single pass)
      */
+    utils::IdentifierSubstitutions inputRenames;
     for (const auto& [type, name] : inputs)
     {
-        std::string inputName = name;
         bool isInterfaceBlock = type.find_first_of("{}") != std::string::npos;
         auto nameSuffix = (isInterfaceBlock ? "_fs" : "");
-        fragmentShader = utils::regex_replace_identifiers(fragmentShader, inputName, [inputName, nameSuffix] { return "injector_frag_" + inputName + nameSuffix; });
+        inputRenames[name] = "injector_frag_" + name + nameSuffix;
+    }
+    fragmentShader = utils::replace_identifiers(fragmentShader, inputRenames);
+
+    if (!layeredSamplers.empty())
+    {
+        fragmentShader = ShaderInspector(fragmentShader).injectLayeredSamplers(layeredSamplers, "injector_fragLayer");
+        auto lastMacroDeclarationPosition = fragmentShader.find_first_of("\n", fragmentShader.find_last_of("#"));
+        lastMacroDeclarationPosition = (lastMacroDeclarationPosition != std::string::npos ? lastMacroDeclarationPosition + 1 : 0);
+        fragmentShader.insert(lastMacroDeclarationPosition, "flat in int injector_fragLayer;\n");
     }
 
     /*
@@ -293,8 +399,11 @@ PipelineInjector::PipelineType PipelineInjector::injectGeometryShader(const Pipe
     geometryShader = std::regex_replace(geometryShader, std::regex("void[\f\n\r\t\v ]+main[\f\n\r\t\v ]*\\([\f\n\r\t\v ]*\\)"), "void old_main(int injector_layer)");
 
     // 2. Add gl_Layer = injector_layer; before each EmitVertex
-    geometryShader = std::regex_replace(geometryShader, std::regex("EmitVertex"), "gl_Layer = (injector_isSingleViewActivated?injector_singleViewID:injector_layer); \nEmitVertex");
-    geometryShader = std::regex_replace(geometryShader, std::regex("EmitVertex"), "gl_Position = injector_transform(injector_geometry_isClipSpace, injector_layer, gl_Position); \nEmitVertex");
+    geometryShader = utils::replace_identifiers(geometryShader,
+        { { "EmitVertex",
+            "gl_Layer = (injector_isSingleViewActivated?injector_singleViewID:injector_layer); \n"
+            "gl_Position = injector_transform(injector_geometry_isClipSpace, injector_layer, gl_Position); \n"
+            "EmitVertex" } });
     // 3. insert double the 'max_vertices' count
     // 3. insert double the 'max_vertices' count
     auto maxVerticesPosition = geometryShader.find("max_vertices");
@@ -388,16 +497,71 @@ PipelineInjector::PipelineType PipelineInjector::injectVertexShader(const Pipeli
     auto beforeMainFunctionPosition = vertexShader.find("void");
     vertexShader.insert(beforeMainFunctionPosition, beforeMainCodeChunk.str());
 
+    // View of repeated draw call, overridden when draw calls are replayed from display list (see DeferredReplay)
+    const std::string singleViewID = (params.shouldUseParametersBlock ? "(injector_replayViewID >= 0 ? injector_replayViewID : injector_singleViewID)" : "injector_singleViewID");
+
     // 3. Insert new main() function, computing shifted gl_Position
     std::string newMainFunction =
         R"(
     void main()
     {
         old_main();
-        gl_Position = injector_transform(injector_geometry_isClipSpace,injector_singleViewID, gl_Position);
+        gl_Position = injector_transform(injector_geometry_isClipSpace,)"
+        + singleViewID + R"(, gl_Position);
     }
     )";
 
+    if (params.shouldUseMultiviewExtension)
+    {
+        // 3.a Driver renders all views => select view by gl_ViewID_OVR
+        std::stringstream multiviewHeader;
+        multiviewHeader << "#extension GL_OVR_multiview2 : require\n";
+        multiviewHeader << "//------------ Injector Inject Header start\n";
+        multiviewHeader << "layout(num_views = " << params.countOfViews << ") in;\n";
+        multiviewHeader << "//------------ Injector Inject Header end\n";
+        helper::insertAfterVersion(vertexShader, multiviewHeader.str());
+
+        newMainFunction =
+            R"(
+    void main()
+    {
+        old_main();
+        gl_Position = injector_transform(injector_geometry_isClipSpace,int(gl_ViewID_OVR), gl_Position);
+    }
+    )";
+    }
+    else if (params.shouldUseInstancedLayers)
+    {
+        // 3.b Replicate using instancing: application sees original instance ID
+        vertexShader = utils::replace_identifiers(vertexShader, { { "gl_InstanceID", "injector_instanceID" } });
+
+        std::stringstream instancingHeader;
+        instancingHeader << "#extension GL_ARB_shader_viewport_layer_array : require\n";
+        instancingHeader << "//------------ Injector Inject Header start\n";
+        instancingHeader << "uniform int injector_instanced_views = 1;\n";
+        instancingHeader << "int injector_instanceID = 0;\n";
+        instancingHeader << "//------------ Injector Inject Header end\n";
+        helper::insertAfterVersion(vertexShader, instancingHeader.str());
+
+        newMainFunction =
+            R"(
+    void main()
+    {
+        int injector_view = )"
+            + singleViewID + R"(;
+        injector_instanceID = gl_InstanceID;
+        if(injector_instanced_views > 1)
+        {
+            injector_view = gl_InstanceID % injector_instanced_views;
+            injector_instanceID = gl_InstanceID / injector_instanced_views;
+        }
+        old_main();
+        gl_Position = injector_transform(injector_geometry_isClipSpace,injector_view, gl_Position);
+        gl_Layer = injector_view;
+    }
+    )";
+    }
+
     // Place new main() into the end of shader
     vertexShader.insert(vertexShader.size(), newMainFunction);
 
@@ -407,7 +571,38 @@ PipelineInjector::PipelineType PipelineInjector::injectVertexShader(const Pipeli
     return output;
 }
 
-bool PipelineInjector::injectShader(std::string& sourceCode, ProgramMetadata& outMetadata)
+std::string PipelineInjector::getCacheKey(const PipelineType& input, const PipelineParams& params)
+{
+    std::stringstream key;
+    // Note: bump revision when injection changes without change of version
+    key << "holoinjector " << HI_VERSION << " revision 1\n";
+    key << params.shouldRenderToClipspace << params.shouldPreventGeometryShaderInsertion
+        << params.shouldUseParametersBlock << params.shouldUseInstancedLayers
+        << params.shouldUseMultiviewExtension << " " << params.countOfPrimitivesDuplicates
+        << " " << params.countOfInvocations << " " << params.countOfViews << "\n";
+
+    // Stages ordered by type
+    std::map<GLenum, const std::string*> stages;
+    for (const auto& [type, sourceCode] : input)
+        stages[type] = &sourceCode;
+    for (const auto& [type, sourceCode] : stages)
+    {
+        key << "stage " << type << " " << sourceCode->size() << "\n"
+            << *sourceCode << "\n";
+        // User profile overrides metadata of VS/GS (@see injectShader)
+        const auto shaderHash = utils::computeHash(*sourceCode);
+        if ((type == GL_VERTEX_SHADER || type == GL_GEOMETRY_SHADER) && profiles.hasProfile(shaderHash))
+        {
+            const auto& profile = profiles.getProfile(shaderHash);
+            key << "profile " << profile.transformationMatrixName << " "
+                << (profile.shouldMakeProgramInvisible.has_value() ? int(profile.shouldMakeProgramInvisible.value()) : -1) << "\n";
+        }
+    }
+
+    return utils::computeStableKey(key.str());
+}
+
+bool PipelineInjector::injectShader(std::string& sourceCode, ProgramMetadata& outMetadata, bool useParametersBlock)
 {
     // Inspect shader: find all assignments to gl_Position and detect transformation name
     ShaderInspector inspector(sourceCode);
@@ -437,7 +632,7 @@ bool PipelineInjector::injectShader(std::string& sourceCode, ProgramMetadata& ou
 
     if (!outMetadata.m_TransformationMatrixName.empty())
     {
-        sourceCode = inspector.injectShader(statements);
+        sourceCode = inspector.injectShader(statements, useParametersBlock);
         return true;
     }
     return false;
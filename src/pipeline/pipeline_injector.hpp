@@ -13,6 +13,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "pipeline/program_metadata.hpp"
 #include "pipeline/shader_profile.hpp"
@@ -31,6 +32,18 @@ namespace pipeline
 
         size_t countOfPrimitivesDuplicates = 1;
         size_t countOfInvocations = 9;
+
+        // When true, per-frame parameters are read from std140 block (if all stages support it)
+        bool shouldUseParametersBlock = false;
+
+        // When true, injected VS selects view by gl_InstanceID and writes gl_Layer
+        // (requires ARB_shader_viewport_layer_array, see injectVertexShader)
+        bool shouldUseInstancedLayers = false;
+
+        // When true, views are fanned out by driver (GL_OVR_multiview2): VS is injected with
+        // countOfViews views and program must render into multiview FBO
+        bool shouldUseMultiviewExtension = false;
+        size_t countOfViews = 9;
     };
 
     /*
@@ -40,6 +53,8 @@ namespace pipeline
      * The PipelineInjector can:
      * - insert Geometry shader to force multiple invocations for multi-layered
      *   rendering (@see insertGeometryShader)
+     * - inject Vertex shader, rendering views by repeated / instanced draw calls, or natively
+     *   using GL_OVR_multiview (@see injectVertexShader)
      * - inject application's Geometry shader
      * - inspect both GS & Vertex Shader's transformation (@see process)
      */
@@ -68,14 +83,23 @@ namespace pipeline
              */
         PipelineProcessResult process(PipelineType inputPipeline, const PipelineParams& params = PipelineParams());
 
+        /**
+         * @brief Get stable key, which identifies result of process() (@see PipelineCache)
+         *
+         * Key covers input sources, parameters, user profiles and injector's version.
+         */
+        std::string getCacheKey(const PipelineType& inputPipeline, const PipelineParams& params);
+
     private:
         /**
              * @brief Insert new geometry shader
              *
              * @param pipeline
+             * @param layeredSamplers FS's samplers, which are redirected to layer of fragment's view
+             * (see ShaderInspector::injectLayeredSamplers)
              * @return alterned pipeline with correct in/out attributes passing
              */
-        PipelineType insertGeometryShader(const PipelineType& pipeline, const PipelineParams params);
+        PipelineType insertGeometryShader(const PipelineType& pipeline, const PipelineParams params, const std::vector<std::string>& layeredSamplers = {});
         /**
              * @brief Inject the old GS
              *
@@ -86,10 +110,20 @@ namespace pipeline
              */
         PipelineType injectGeometryShader(const PipelineType& pipeline, const PipelineParams params);
 
-        /// Insert repeating logic into Vertex shader and dont use any additional GS
+        /**
+         * @brief Insert repeating logic into Vertex shader and dont use any additional GS
+         *
+         * With params.shouldUseInstancedLayers, the shader can also replicate a draw call to all
+         * views in a single pass: when injector_instanced_views > 1, the view is derived from
+         * gl_InstanceID (instance = original instance * views + view) and the primitive is routed
+         * into layer of the view by gl_Layer. Application's gl_InstanceID is rescaled accordingly.
+         *
+         * With params.shouldUseMultiviewExtension, the shader declares params.countOfViews views
+         * and the view is selected by gl_ViewID_OVR.
+         */
         PipelineType injectVertexShader(const PipelineType& pipeline, const PipelineParams params);
 
-        bool injectShader(std::string& sourceCode, ProgramMetadata& outMetadata);
+        bool injectShader(std::string& sourceCode, ProgramMetadata& outMetadata, bool useParametersBlock);
 
         ShaderProfile& profiles;
     };
@@ -0,0 +1,135 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        pipeline/program_binary_cache.cpp
+*
+*****************************************************************************/
+
+#define GL_GLEXT_PROTOTYPES 1
+#include "GL/gl.h"
+
+#include "pipeline/program_binary_cache.hpp"
+#include "logger.hpp"
+#include "utils/opengl_utils.hpp"
+#include "utils/string_utils.hpp"
+#include "version.hpp"
+
+#include <cstdio>
+#include <map>
+#include <sstream>
+
+using namespace hi;
+using namespace hi::pipeline;
+
+namespace helper
+{
+/// Bump when format of entries changes
+constexpr auto binaryHeader = "holoinjector-program-binary 1\n";
+
+std::string getString(GLenum name)
+{
+    const auto value = reinterpret_cast<const char*>(glGetString(name));
+    return (value ? value : "");
+}
+} // namespace helper
+
+void ProgramBinaryCache::initialize(const std::filesystem::path& directory)
+{
+    GLint countOfFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &countOfFormats);
+    glGetError();
+    if (countOfFormats <= 0)
+    {
+        Logger::log("[ProgramBinaryCache] Driver doesn't support program binaries, disabling cache");
+        return;
+    }
+    m_DriverIdentification = helper::getString(GL_VENDOR) + "\n" + helper::getString(GL_RENDERER) + "\n" + helper::getString(GL_VERSION);
+    m_Storage = PipelineCache(directory);
+}
+
+bool ProgramBinaryCache::isEnabled() const
+{
+    return m_Storage.isEnabled();
+}
+
+std::string ProgramBinaryCache::getKey(const PipelineInjector::PipelineType& pipeline, const std::string& preLinkState) const
+{
+    std::stringstream key;
+    key << "holoinjector " << HI_VERSION << "\n"
+        << m_DriverIdentification << "\n";
+    // Stages ordered by type
+    const std::map<GLenum, std::string> stages(pipeline.begin(), pipeline.end());
+    for (const auto& [type, sourceCode] : stages)
+        key << "stage " << type << " " << sourceCode.size() << "\n"
+            << sourceCode << "\n";
+    key << "pre-link " << preLinkState.size() << "\n"
+        << preLinkState;
+    return utils::computeStableKey(key.str());
+}
+
+void ProgramBinaryCache::prepareForLinking(GLuint programId)
+{
+    if (!isEnabled())
+        return;
+    glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+bool ProgramBinaryCache::load(const std::string& key, GLuint programId)
+{
+    const auto data = m_Storage.loadEntry(key);
+    if (!data.has_value())
+        return false;
+
+    // Entry: header, 'format length checksum' line and binary
+    const std::string header = helper::binaryHeader;
+    const auto lineEnd = data->find('\n', header.size());
+    GLenum format = 0;
+    unsigned long long length = 0;
+    char checksum[17] = {};
+    const bool isValid = data->compare(0, header.size(), header) == 0 && lineEnd != std::string::npos
+        && std::sscanf(data->c_str() + header.size(), "%u %llu %16s", &format, &length, checksum) == 3
+        && length == data->size() - lineEnd - 1
+        && utils::toHex(utils::computeStableHash(std::string_view(*data).substr(lineEnd + 1))) == checksum;
+    if (!isValid)
+    {
+        Logger::logError("[ProgramBinaryCache] Removing corrupted entry ", key);
+        m_Storage.removeEntry(key);
+        return false;
+    }
+
+    glProgramBinary(programId, format, data->data() + lineEnd + 1, static_cast<GLsizei>(length));
+    if (!opengl_utils::isProgramLinked(programId))
+    {
+        // E.g. driver has been updated without changing its version string
+        Logger::log("[ProgramBinaryCache] Driver rejected binary ", key);
+        m_Storage.removeEntry(key);
+        return false;
+    }
+    Logger::logDebug("[ProgramBinaryCache] Loaded program ", programId, " from binary ", key);
+    return true;
+}
+
+bool ProgramBinaryCache::store(const std::string& key, GLuint programId)
+{
+    if (!isEnabled())
+        return false;
+    GLint length = 0;
+    glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return false;
+
+    std::string binary(length, '\0');
+    GLsizei writtenLength = 0;
+    GLenum format = 0;
+    glGetProgramBinary(programId, length, &writtenLength, &format, binary.data());
+    if (writtenLength <= 0)
+        return false;
+    binary.resize(writtenLength);
+
+    std::stringstream entry;
+    entry << helper::binaryHeader << format << " " << binary.size() << " "
+          << utils::toHex(utils::computeStableHash(binary)) << "\n"
+          << binary;
+    return m_Storage.storeEntry(key, entry.str());
+}
@@ -0,0 +1,58 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        pipeline/program_binary_cache.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_PROGRAM_BINARY_CACHE_HPP
+#define HI_PROGRAM_BINARY_CACHE_HPP
+
+#include <GL/gl.h>
+#include <filesystem>
+#include <string>
+
+#include "pipeline/pipeline_cache.hpp"
+#include "pipeline/pipeline_injector.hpp"
+
+namespace hi
+{
+namespace pipeline
+{
+    /**
+     * @brief Persistent cache of driver's binaries (glGetProgramBinary) of injected programs
+     *
+     * Binaries are keyed by injected sources, application's pre-link state (glBindAttribLocation,
+     * transform feedback varyings, etc., which are baked into binary), driver (vendor, renderer,
+     * version) and injector's version. Loading a binary, which is rejected by driver, removes
+     * entry and caller falls back to compiling sources.
+     */
+    class ProgramBinaryCache
+    {
+    public:
+        /// Creates disabled cache
+        ProgramBinaryCache() = default;
+
+        /// Enable cache if current GL context supports program binaries
+        void initialize(const std::filesystem::path& directory);
+        bool isEnabled() const;
+
+        /// Get key of linked pipeline, preLinkState is serialized ShaderProgram::PreLinkState
+        std::string getKey(const PipelineInjector::PipelineType& pipeline, const std::string& preLinkState) const;
+
+        /// Must be called before linking program to make its binary retrievable
+        void prepareForLinking(GLuint programId);
+        /// Load program's binary, returns true when program has been linked from binary
+        bool load(const std::string& key, GLuint programId);
+        /// Store binary of linked program
+        bool store(const std::string& key, GLuint programId);
+
+    private:
+        PipelineCache m_Storage;
+        /// Vendor, renderer & version of driver
+        std::string m_DriverIdentification;
+    };
+} //namespace pipeline
+} //namespace hi
+#endif
@@ -31,6 +31,21 @@ bool ProgramMetadata::usesGeometryShader() const
     return m_IsGeometryShaderUsed;
 }
 
+bool ProgramMetadata::usesInstancedLayering() const
+{
+    return m_IsInstancedLayeringUsed;
+}
+
+bool ProgramMetadata::usesMultiviewExtension() const
+{
+    return m_IsMultiviewExtensionUsed;
+}
+
+bool ProgramMetadata::usesLayeredSamplers() const
+{
+    return !m_LayeredSamplers.empty();
+}
+
 bool ProgramMetadata::isLinked() const
 {
     return m_IsLinkedCorrectly;
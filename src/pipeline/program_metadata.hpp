@@ -10,6 +10,7 @@
 #define HI_PROGRAM_METADATA_HPP
 
 #include <string>
+#include <vector>
 
 namespace hi
 {
@@ -34,6 +35,12 @@ namespace pipeline
 
         // Is geometry shader user
         bool m_IsGeometryShaderUsed = true;
+        // Can VS replicate draw call to all layers using instancing (see PipelineParams)
+        bool m_IsInstancedLayeringUsed = false;
+        // Are views rendered natively by GL_OVR_multiview (program requires multiview FBO)
+        bool m_IsMultiviewExtensionUsed = false;
+        // FS's sampler2D uniforms, which can sample shadowed texture's layer of fragment's view
+        std::vector<std::string> m_LayeredSamplers;
 
         // Is linked by enhancer correctly
         bool m_IsLinkedCorrectly = false;
@@ -42,6 +49,9 @@ namespace pipeline
         bool hasDetectedTransformation() const;
         bool hasFtransform() const;
         bool usesGeometryShader() const;
+        bool usesInstancedLayering() const;
+        bool usesMultiviewExtension() const;
+        bool usesLayeredSamplers() const;
         bool isLinked() const;
     };
 
@@ -11,10 +11,12 @@
 #include <cassert>
 #include <cctype>
 #include <iostream>
-#include <regex>
+#include <sstream>
 #include <string_view>
+#include <unordered_map>
 #include <unordered_set>
 
+#include "pipeline/injector_parameters.hpp"
 #include "pipeline/shader_parser.hpp"
 #include "utils/glsl_preprocess.hpp"
 
@@ -23,29 +25,6 @@ using namespace hi::pipeline;
 
 namespace helper
 {
-/**
-     * @brief Returns first right-hand identifier/token literal
-     * @return "" or token
-     */
-std::string getFirstTokenAfterEq(const std::string assignmentStatement)
-{
-    // trim gl_Position = X*Y*Z.... to '= X'
-    static auto firstTokenPattern = std::regex("=[\f\n\r\t\v ]*[a-zA-Z0-9_]*");
-    std::smatch m;
-    std::regex_search(assignmentStatement, m, firstTokenPattern);
-
-    // if trimming was possible
-    if (m.size())
-    {
-        // then take everything since last whitespace character till the end
-        const std::string str = m[0];
-        auto start = str.find_last_of("\f\n\r\t\v ");
-        start = (start == std::string::npos) ? start : start + 1;
-        return str.substr(start);
-    }
-    return "";
-}
-
 /// Given "X = Y;", do "X = expression (Y);"
 std::string wrapAssignmentExpresion(const std::string assignment, const std::string expression)
 {
@@ -62,80 +41,124 @@ std::string wrapAssignmentExpresion(const std::string assignment, const std::str
     output.insert(semicolon, std::string(")"));
     return output;
 }
+
+/// List <type, name> of global variables with storage (e.g. 'in'), interface blocks are listed as <definition, instance>
+ShaderInspector::TypeNamePairList getListOfGlobals(const ShaderIndex& index, const std::string& code, const std::string& storage)
+{
+    ShaderInspector::TypeNamePairList result;
+    const auto& declarations = index.getDeclarations();
+    for (size_t i = 0; i < declarations.size(); i++)
+    {
+        const auto& declaration = declarations[i];
+        if (declaration.storage != storage || !declaration.isGlobal)
+            continue;
+        if (declaration.block < 0)
+        {
+            result.emplace_back(declaration.type, declaration.name);
+            continue;
+        }
+        // Interface block is listed once, at its first member
+        const auto& block = index.getInterfaceBlocks()[declaration.block];
+        if (block.members.front() == i)
+            result.emplace_back(code.substr(block.start, block.end - block.start), block.instanceName);
+    }
+    return result;
+}
+
+/// Is name a global variable with storage (e.g. 'in'), or instance of such interface block?
+bool isInterfaceVariable(const ShaderIndex& index, const std::string& name, const std::string& storage)
+{
+    const auto declaration = index.findDeclaration(name, storage);
+    if (declaration && declaration->isGlobal && declaration->block < 0)
+        return true;
+    const auto& blocks = index.getInterfaceBlocks();
+    return std::any_of(blocks.begin(), blocks.end(), [&](const auto& block) { return block.storage == storage && block.instanceName == name; });
+}
+
+/// Sampling functions, which can be redirected to layered sampler, mapped to name of wrapper
+const std::unordered_map<std::string_view, std::string_view>& getLayerableSamplingFunctions()
+{
+    static const std::unordered_map<std::string_view, std::string_view> functions = {
+        { "texture", "texture" },
+        { "texture2D", "texture" },
+        { "textureLod", "textureLod" },
+        { "texture2DLod", "textureLod" },
+        { "texelFetch", "texelFetch" },
+        { "textureSize", "textureSize" },
+    };
+    return functions;
+}
+
+/// Is token at position a sampler's declaration, or sampler as the 1st argument of sampling function?
+bool isLayerableSamplerUsage(const std::vector<std::string_view>& tokens, size_t position)
+{
+    const bool isDeclaration = (position >= 1 && tokens[position - 1] == "sampler2D");
+    const bool hasNext = (position + 1 < tokens.size());
+    if (isDeclaration)
+        return hasNext && tokens[position + 1] == ";";
+    const bool isFunctionArgument = (position >= 2 && tokens[position - 1] == "(" && getLayerableSamplingFunctions().count(tokens[position - 2]));
+    return isFunctionArgument && hasNext && tokens[position + 1] == ",";
+}
+
+/// Declare layered sampler & wrappers of sampling functions for sampler
+std::string getLayeredSamplerDeclaration(const std::string& sampler, const std::string& layerVariable)
+{
+    const auto layered = ShaderInspector::getLayeredSamplerName(sampler);
+    const auto flag = ShaderInspector::getLayeredSamplerFlagName(sampler);
+    const auto layer = std::string("float(") + layerVariable + ")";
+    std::stringstream ss;
+    ss << "\nuniform sampler2DArray " << layered << ";\n";
+    ss << "uniform bool " << flag << ";\n";
+    ss << "vec4 injector_texture_" << sampler << "(vec2 injector_coord) { return " << flag << " ? texture(" << layered << ", vec3(injector_coord, " << layer << ")) : texture(" << sampler << ", injector_coord); }\n";
+    ss << "vec4 injector_texture_" << sampler << "(vec2 injector_coord, float injector_bias) { return " << flag << " ? texture(" << layered << ", vec3(injector_coord, " << layer << "), injector_bias) : texture(" << sampler << ", injector_coord, injector_bias); }\n";
+    ss << "vec4 injector_textureLod_" << sampler << "(vec2 injector_coord, float injector_lod) { return " << flag << " ? textureLod(" << layered << ", vec3(injector_coord, " << layer << "), injector_lod) : textureLod(" << sampler << ", injector_coord, injector_lod); }\n";
+    ss << "vec4 injector_texelFetch_" << sampler << "(ivec2 injector_coord, int injector_lod) { return " << flag << " ? texelFetch(" << layered << ", ivec3(injector_coord, " << layerVariable << "), injector_lod) : texelFetch(" << sampler << ", injector_coord, injector_lod); }\n";
+    ss << "ivec2 injector_textureSize_" << sampler << "(int injector_lod) { return " << flag << " ? textureSize(" << layered << ", injector_lod).xy : textureSize(" << sampler << ", injector_lod); }\n";
+    return ss.str();
+}
 } // namespace helper
 
 bool hi::pipeline::ShaderInspector::isIdentifier(const std::string_view& token) const
 {
-    auto tk = std::string(token);
-    std::smatch m;
-    static auto identifier = std::regex("[a-zA-Z][a-zA-Z0-9_]*");
-    return std::regex_match(tk, m, identifier);
+    return hi::pipeline::isIdentifierToken(token);
 }
 
 bool hi::pipeline::ShaderInspector::isUniformVariableInInterfaceBlock(const std::string& identifier) const
 {
-    std::string regexLiteral = std::string("uniform[^;]*\\{[^\\}]*[\f\n\r\t\v ]") + identifier + std::string("[\f\n\r\t\v ]*;[^\\}]*\\}");
-    auto isDefinedAsUniform = std::regex(regexLiteral, std::regex::extended);
-    std::smatch m;
-    std::regex_search(sourceCode, m, isDefinedAsUniform);
-    return m.size() > 0;
+    const auto declaration = index.findDeclaration(identifier, "uniform");
+    return declaration && declaration->block >= 0;
 }
 
 std::string hi::pipeline::ShaderInspector::getUniformBlockName(const std::string& uniformName) const
 {
-    if (uniformName.empty())
+    if (uniformName.empty() || !isUniformVariableInInterfaceBlock(uniformName))
         return "";
-    std::string rgxLiteral = std::string("uniform[^;]*[\f\n\r\t\v ]([a-zA-Z][a-zA-Z0-9_]*)[^;]*\\{[^\\}]*[\f\n\r\t\v ]") + uniformName + std::string("[\f\n\r\t\v ]*;[^\\}]*\\}");
-    auto finalregex = std::regex(rgxLiteral, std::regex::extended);
-    std::smatch matches;
-
-    if (std::regex_search(sourceCode, matches, finalregex))
-    {
-        if (matches.size() > 1)
-            return matches[1];
-    }
-    return "";
+    return index.getInterfaceBlocks()[index.findDeclaration(uniformName, "uniform")->block].name;
 }
 
 bool hi::pipeline::ShaderInspector::isUniformVariable(const std::string& identifier) const
 {
     if (identifier.empty())
         return false;
-
-    if (isUniformVariableInInterfaceBlock(identifier))
-        return true;
-    std::string regexLiteral = std::string("uniform[^;]*[\f\n\r\t\v ]") + identifier + std::string("[\f\n\r\t\v ]*;");
-    auto isDefinedAsUniform = std::regex(regexLiteral, std::regex::extended);
-    std::smatch m;
-    std::regex_search(sourceCode, m, isDefinedAsUniform);
-    return m.size() > 0;
+    return index.findDeclaration(identifier, "uniform") != nullptr;
 }
 
 std::string hi::pipeline::ShaderInspector::getVariableType(const std::string& variable) const
 {
-    std::string regexLiteral = std::string("[a-zA-Z0-9]+[\f\n\r\t\v ]+") + variable + std::string("[\f\n\r\t\v ]*;");
-    auto definitionPattern = std::regex(regexLiteral, std::regex::extended);
-    std::smatch m;
-    std::regex_search(sourceCode, m, definitionPattern);
-    if (!m.size())
-        return "";
-    auto definitionStatementRawText = std::string(m[0]);
-    auto firstWhitespacePosition = definitionStatementRawText.find_first_of("\f\n\r\t\v ");
-    return definitionStatementRawText.substr(0, firstWhitespacePosition);
+    const auto declaration = index.findDeclaration(variable);
+    return (declaration ? declaration->type : "");
 }
 
 std::vector<ShaderInspector::VertextAssignment> hi::pipeline::ShaderInspector::findAllOutVertexAssignments() const
 {
     std::vector<VertextAssignment> results;
     // Search for all assignments into gl_Position
-    auto vertexTransformationPattern = std::regex("gl_Position[\f\n\r\t\v ]*=[\f\n\r\t\v ]*[^;]*;", std::regex::extended);
-    std::smatch assignments;
-    std::string toBeSearched = sourceCode;
-    while (std::regex_search(toBeSearched, assignments, vertexTransformationPattern))
+    for (const auto assignmentIndex : index.getAssignmentsTo("gl_Position"))
     {
-        std::string foundText = assignments.str();
+        const auto& assignment = index.getAssignments()[assignmentIndex];
+        std::string foundText = sourceCode.substr(assignment.start, assignment.end + 1 - assignment.start);
         VertextAssignment outputAssignment;
-        outputAssignment.positionInCode = assignments.position();
+        outputAssignment.positionInCode = assignment.start;
         outputAssignment.statementRawText = foundText;
         outputAssignment.analysis = analyzeGLPositionAssignment(foundText);
         switch (outputAssignment.analysis.type)
@@ -175,13 +198,11 @@ std::vector<ShaderInspector::VertextAssignment> hi::pipeline::ShaderInspector::f
             break;
         }
         results.push_back(outputAssignment);
-
-        toBeSearched = assignments.suffix();
     }
     return results;
 }
 
-std::string hi::pipeline::ShaderInspector::injectShader(const std::vector<ShaderInspector::VertextAssignment>& assignments)
+std::string hi::pipeline::ShaderInspector::injectShader(const std::vector<ShaderInspector::VertextAssignment>& assignments, bool useParametersBlock)
 {
     std::string output = sourceCode;
     for (auto& statement : assignments)
@@ -201,7 +222,7 @@ std::string hi::pipeline::ShaderInspector::injectShader(const std::vector<Shader
     // At this point, caller must have verified that this is a VS, containing void main() method
     assert(startOfFunction != std::string::npos);
 
-    auto code = getCommonTransformationShader();
+    auto code = getCommonTransformationShader(useParametersBlock);
     output.insert(startOfFunction, code);
     return output;
 }
@@ -219,155 +240,33 @@ std::string hi::pipeline::ShaderInspector::getTransformationUniformName(std::vec
 /// Get count of declared uniforms in shader
 size_t hi::pipeline::ShaderInspector::getCountOfUniforms() const
 {
-    size_t count = 0;
-    size_t position = sourceCode.find("uniform");
-    while (position != std::string::npos)
-    {
-        count++;
-        position = sourceCode.find("uniform", position + 1);
-    }
-    return count;
+    return index.getCountOfUniformQualifiers();
 }
 
 std::vector<std::pair<std::string, std::string>> hi::pipeline::ShaderInspector::getListOfUniforms() const
 {
     std::vector<std::pair<std::string, std::string>> result;
-    size_t position = sourceCode.find("uniform");
-    while (position != std::string::npos)
+    for (const auto& declaration : index.getDeclarations())
     {
-        auto positionSemicolon = sourceCode.find_first_of(";", position + 1);
-        auto positionBracket = sourceCode.find_first_of("{", position + 1);
-
-        if (positionBracket < positionSemicolon)
-        {
-            // parser shader block
-            auto positionBracketEnd = sourceCode.find_first_of("}", position + 1);
-            auto uniformDefinition = sourceCode.substr(position, positionBracketEnd - position);
-            auto tokens = hi::pipeline::tokenize(uniformDefinition);
-            decltype(tokens)::iterator semicolon = tokens.begin();
-            while ((semicolon = std::find(semicolon, tokens.end(), ";")) != tokens.end())
-            {
-                result.emplace_back(std::make_pair(*(semicolon - 2), *(semicolon - 1)));
-                semicolon += 1;
-            }
-        }
-        else
-        {
-            // parse scalar uniform definition
-            auto uniformDefinition = sourceCode.substr(position, positionSemicolon - position);
-            auto definitionTokens = hi::pipeline::tokenize(uniformDefinition);
-            const auto& type = definitionTokens[definitionTokens.size() - 2];
-            const auto& name = definitionTokens[definitionTokens.size() - 1];
-
-            result.emplace_back(std::make_pair(type, name));
-        }
-
-        position = sourceCode.find("uniform", position + 1);
+        if (declaration.storage == "uniform" && declaration.isGlobal)
+            result.emplace_back(declaration.type, declaration.name);
     }
     return result;
 }
 
 std::vector<std::pair<std::string, std::string>> hi::pipeline::ShaderInspector::getListOfInputs() const
 {
-    std::vector<std::pair<std::string, std::string>> result;
-
-    std::smatch m;
-    static auto inDefinition = std::regex("[\f\n\r\t\v ]in[\f\n\r\t\v ][^;]+");
-
-    auto searchIn = glsl_preprocess::removeComments(sourceCode);
-    while (std::regex_search(searchIn, m, inDefinition))
-    {
-        for (auto& match : m)
-        {
-            std::string s = match.str();
-            if (s.find_first_of("{}") != std::string::npos)
-            {
-                auto start = sourceCode.find("in", m.position());
-                assert(start != std::string::npos);
-                // skip 'in'
-                start += 2;
-                auto end = sourceCode.find("}", m.position());
-                assert(end != std::string::npos);
-                end += 1;
-                auto idEnd = sourceCode.find(";", end);
-
-                auto snippet = sourceCode.substr(start, idEnd - start);
-                auto definitionTokens = hi::pipeline::tokenize(snippet);
-
-                const auto type = sourceCode.substr(start, end - start);
-                const auto& name = definitionTokens[definitionTokens.size() - 1];
-                assert(name.find_first_of(")(,;") == std::string::npos);
-                result.emplace_back(std::make_pair(type, name));
-                continue;
-            }
-
-            // is interface
-            auto definitionTokens = hi::pipeline::tokenize(s);
-            assert(definitionTokens.size() >= 2);
-            const auto& type = definitionTokens[definitionTokens.size() - 2];
-            const auto& name = definitionTokens[definitionTokens.size() - 1];
-
-            assert(type.find_first_of(")(,;") == std::string::npos);
-            assert(name.find_first_of(")(,;") == std::string::npos);
-            result.emplace_back(std::make_pair(type, name));
-        }
-        searchIn = m.suffix();
-    }
-    return result;
+    return helper::getListOfGlobals(index, sourceCode, "in");
 }
 
 std::vector<std::pair<std::string, std::string>> hi::pipeline::ShaderInspector::getListOfOutputs() const
 {
-    std::vector<std::pair<std::string, std::string>> result;
-
-    std::smatch m;
-    static auto inDefinition = std::regex("[\f\n\r\t\v ]out[\f\n\r\t\v ][^;]+");
-
-    auto searchIn = glsl_preprocess::removeComments(sourceCode);
-    while (std::regex_search(searchIn, m, inDefinition))
-    {
-        for (auto& match : m)
-        {
-            std::string s = match.str();
-            auto definitionTokens = hi::pipeline::tokenize(s);
-            assert(definitionTokens.size() >= 2);
-            const auto& type = definitionTokens[definitionTokens.size() - 2];
-            const auto& name = definitionTokens[definitionTokens.size() - 1];
-
-            assert(type.find_first_of(")(,;") == std::string::npos);
-            assert(name.find_first_of(")(,;") == std::string::npos);
-            result.emplace_back(std::make_pair(type, name));
-        }
-        searchIn = m.suffix();
-    }
-    return result;
+    return helper::getListOfGlobals(index, sourceCode, "out");
 }
 
 std::vector<std::pair<std::string, std::string>> hi::pipeline::ShaderInspector::getListOfVaryings() const
 {
-    std::vector<std::pair<std::string, std::string>> result;
-
-    std::smatch m;
-    static auto inDefinition = std::regex("[\f\n\r\t\v ]varying[\f\n\r\t\v ][^;]+");
-
-    auto searchIn = glsl_preprocess::removeComments(sourceCode);
-    while (std::regex_search(searchIn, m, inDefinition))
-    {
-        for (auto& match : m)
-        {
-            std::string s = match.str();
-            auto definitionTokens = hi::pipeline::tokenize(s);
-            assert(definitionTokens.size() >= 2);
-            const auto& type = definitionTokens[definitionTokens.size() - 2];
-            const auto& name = definitionTokens[definitionTokens.size() - 1];
-
-            assert(type.find_first_of(")(,;") == std::string::npos);
-            assert(name.find_first_of(")(,;") == std::string::npos);
-            result.emplace_back(std::make_pair(type, name));
-        }
-        searchIn = m.suffix();
-    }
-    return result;
+    return helper::getListOfGlobals(index, sourceCode, "varying");
 }
 
 hi::pipeline::ShaderInspector::TypeNamePairList hi::pipeline::ShaderInspector::mergeList(const TypeNamePairList a, const TypeNamePairList b) const
@@ -383,18 +282,13 @@ ShaderInspector::Analysis hi::pipeline::ShaderInspector::analyzeGLPositionAssign
 
     auto firstIdentifier = std::find_if(tokens.begin() + 1, tokens.end(), [&](const auto token) -> bool { return isIdentifier(token) && !hi::pipeline::isBuiltinGLSLType(token); });
 
-    const auto uniforms = getListOfUniforms();
-    const auto inputs = getListOfInputs();
-
-    auto uniformPosition = std::find_if(uniforms.begin(), uniforms.end(), [&](auto variable) -> bool { return variable.second == *firstIdentifier; });
-
-    auto inputPosition = std::find_if(inputs.begin(), inputs.end(), [&](auto variable) -> bool { return variable.second == *firstIdentifier; });
-
-    bool isUniform = (uniformPosition != uniforms.end());
-    bool isInput = (inputPosition != inputs.end());
-    bool isFunction = (*(firstIdentifier + 1) == "(");
-    bool isGLPosition = (*(firstIdentifier) == "gl_Position");
     bool isConstantAssignment = firstIdentifier == tokens.end();
+    const auto identifier = (isConstantAssignment ? std::string() : std::string(*firstIdentifier));
+
+    bool isUniform = isUniformVariable(identifier);
+    bool isInput = !isConstantAssignment && helper::isInterfaceVariable(index, identifier, "in");
+    bool isFunction = !isConstantAssignment && (firstIdentifier + 1) != tokens.end() && *(firstIdentifier + 1) == "(";
+    bool isGLPosition = (identifier == "gl_Position");
     bool couldBeVariable = (!isUniform && !isInput && !isFunction && !isGLPosition && !isConstantAssignment);
 
     /*std::cout << "IsUniform " << isUniform << std::endl;
@@ -405,7 +299,7 @@ ShaderInspector::Analysis hi::pipeline::ShaderInspector::analyzeGLPositionAssign
     std::cout << "MightBeAVariable" << couldBeVariable << std::endl;
     */
     Analysis ana;
-    ana.foundIdentifier = (firstIdentifier == tokens.end()) ? "" : *firstIdentifier;
+    ana.foundIdentifier = identifier;
     if (isUniform)
         ana.type = AnalysisType::UNIFORM;
     else if (isInput)
@@ -447,11 +341,10 @@ std::string ShaderInspector::recursivelySearchUniformFromTemporaryVariable(std::
 {
     if (level == 0)
         return "";
-    auto firstTokenPattern = std::regex(tmpName + "[\f\n\r\t\v ]*=[^;]*");
-    std::smatch m;
-    while (std::regex_search(sourceCode, m, firstTokenPattern))
+    for (const auto assignmentIndex : index.getAssignmentsTo(tmpName))
     {
-        std::string foundStr = m.str();
+        const auto& assignment = index.getAssignments()[assignmentIndex];
+        const std::string_view foundStr = std::string_view(sourceCode).substr(assignment.start, assignment.end - assignment.start);
         auto tokens = hi::pipeline::tokenize(foundStr);
 
         auto firstIdentifier = std::find_if(tokens.begin() + 1, tokens.end(), [&](const auto token) -> bool { return isIdentifier(token) && !hi::pipeline::isBuiltinGLSLType(token); });
@@ -488,37 +381,75 @@ std::string ShaderInspector::getFallbackUniformViaHeuristic() const
 
 bool ShaderInspector::isClipSpaceShader() const
 {
-    static auto clipAssign = std::regex(".[\f\n\r\t\v ]*xyww");
-    std::smatch m;
-    return std::regex_search(sourceCode, m, clipAssign);
+    return index.hasSwizzle("xyww");
 }
 
 bool ShaderInspector::hasFtransform() const
 {
-    static auto keyWord = std::regex("ftransform");
-    std::smatch m;
-    return std::regex_search(sourceCode, m, keyWord);
+    return index.hasIdentifier("ftransform");
 }
 
-void ShaderInspector::injectCommonCode(std::string& sourceOriginal)
+void ShaderInspector::injectCommonCode(std::string& sourceOriginal, bool useParametersBlock)
 {
     auto pos = sourceOriginal.find_first_of("\n", sourceOriginal.find_last_of("#"));
     assert(pos != std::string::npos);
     pos += 1;
-    sourceOriginal.insert(pos, getCommonTransformationShader());
+    sourceOriginal.insert(pos, getCommonTransformationShader(useParametersBlock));
 }
 
-std::string ShaderInspector::getCommonTransformationShader()
+std::string ShaderInspector::getCommonTransformationShader(bool useParametersBlock)
 {
-    static std::string code = R"(
+    static const std::string header = R"(
     uniform int injector_cameraId = 0;
     uniform int injector_max_views = 9;
     uniform bool injector_isSingleViewActivated = false;
     uniform int injector_singleViewID = 0;
+)";
 
+    // Per-frame parameters as loose uniforms, uploaded for each draw call
+    static const std::string looseParameters = R"(
     uniform float injector_XShiftMultiplier = 5.0;
     uniform float injector_FrontalDistance = 5.0;
 
+    float injector_getProjectionShift(int cameraId)
+    {
+        float normalizedDistance = 1.0-2.0*float(cameraId+1)/float(injector_max_views+1);
+        return normalizedDistance*injector_XShiftMultiplier/injector_FrontalDistance;
+    }
+
+    float injector_getCenterShift(int cameraId)
+    {
+        float normalizedDistance = 1.0- 2.0*float(cameraId+1)/float(injector_max_views+1);
+        return normalizedDistance*injector_XShiftMultiplier;
+    }
+)";
+
+    // Per-frame parameters in a shared std140 block (see InjectorParameters)
+    static const std::string blockParameters = std::string(R"(
+    layout(std140) uniform )")
+        + InjectorParameters::blockName + R"(
+    {
+        float injector_XShiftMultiplier;
+        float injector_FrontalDistance;
+        // View of replayed draw calls or -1 (see DeferredReplay)
+        int injector_replayViewID;
+        // (projection shift, center shift, 0, 0) for each view
+        vec4 injector_viewShifts[)"
+        + std::to_string(InjectorParameters::maxViews) + R"(];
+    };
+
+    float injector_getProjectionShift(int cameraId)
+    {
+        return injector_viewShifts[cameraId].x;
+    }
+
+    float injector_getCenterShift(int cameraId)
+    {
+        return injector_viewShifts[cameraId].y;
+    }
+)";
+
+    static const std::string body = R"(
     uniform bool injector_isOrthogonal = false; 
     // when true, keeps original transformation flowing => used for shadow maps
     uniform bool injector_identity = true;
@@ -533,11 +464,6 @@ std::string ShaderInspector::getCommonTransformationShader()
     {
         return 1.0-2.0*float(cameraId+1)/float(injector_max_views+1);
     }
-    float injector_getProjectionShift(int cameraId)
-    {
-        float normalizedDistance = 1.0-2.0*float(cameraId+1)/float(injector_max_views+1);
-        return normalizedDistance*injector_XShiftMultiplier/injector_FrontalDistance;
-    }
 
     float injector_getShearCoeff(int cameraId, float r)
     {
@@ -545,13 +471,6 @@ std::string ShaderInspector::getCommonTransformationShader()
         return 1.0*normalizedDistance*injector_XShiftMultiplier/r;
     }
 
-
-    float injector_getCenterShift(int cameraId)
-    {
-        float normalizedDistance = 1.0- 2.0*float(cameraId+1)/float(injector_max_views+1);
-        return normalizedDistance*injector_XShiftMultiplier;
-    }
-
     // Reversts original projection and apple per-view transformation & projection
     vec4 injector_extractViewSpace(vec4 clipSpace)
     {
@@ -607,7 +526,92 @@ std::string ShaderInspector::getCommonTransformationShader()
     }
     )";
 
-    // Hack: remove clip space
-    code = std::regex_replace(code, std::regex(". xyww"), "");
+    std::string code = header + (useParametersBlock ? blockParameters : looseParameters) + body;
+
+    // Hack: remove clip space (any character, followed by ' xyww')
+    auto position = code.find(" xyww", 1);
+    while (position != std::string::npos)
+    {
+        code.erase(position - 1, 6);
+        position = code.find(" xyww", std::max<size_t>(position - 1, 1));
+    }
     return code;
 }
+
+bool ShaderInspector::hasSamplers() const
+{
+    const auto uniforms = getListOfUniforms();
+    return std::any_of(uniforms.begin(), uniforms.end(), [](const auto& uniform) {
+        return uniform.first.find("sampler") != std::string::npos;
+    });
+}
+
+std::vector<std::string> ShaderInspector::getLayerableSamplers() const
+{
+    std::vector<std::string> samplers;
+    for (const auto& [type, name] : getListOfUniforms())
+    {
+        if (type.find("sampler") == std::string::npos)
+            continue;
+        if (type != "sampler2D" || !isIdentifier(name))
+            return {};
+        samplers.push_back(name);
+    }
+    if (samplers.empty())
+        return {};
+
+    const std::unordered_set<std::string_view> samplerNames(samplers.begin(), samplers.end());
+    const auto tokens = hi::pipeline::tokenize(sourceCode);
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        if (samplerNames.count(tokens[i]) && !helper::isLayerableSamplerUsage(tokens, i))
+            return {};
+    }
+    return samplers;
+}
+
+std::string ShaderInspector::injectLayeredSamplers(const std::vector<std::string>& samplers, const std::string& layerVariable) const
+{
+    const std::unordered_set<std::string_view> samplerNames(samplers.begin(), samplers.end());
+    const std::string_view code = sourceCode;
+    const auto tokens = hi::pipeline::tokenize(code);
+
+    // Collect replacements <start, length, text> in order of appearance
+    std::vector<std::tuple<size_t, size_t, std::string>> replacements;
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        if (!samplerNames.count(tokens[i]) || !helper::isLayerableSamplerUsage(tokens, i))
+            continue;
+        const std::string sampler = std::string(tokens[i]);
+        if (tokens[i - 1] == "sampler2D")
+        {
+            // Declare wrappers right after sampler's declaration
+            const size_t end = tokens[i + 1].data() - code.data() + 1;
+            replacements.emplace_back(end, 0, helper::getLayeredSamplerDeclaration(sampler, layerVariable));
+            continue;
+        }
+        // 'function ( sampler ,' => 'injector_function_sampler('
+        const size_t start = tokens[i - 2].data() - code.data();
+        const size_t end = tokens[i + 1].data() - code.data() + 1;
+        const auto wrapper = helper::getLayerableSamplingFunctions().at(tokens[i - 2]);
+        replacements.emplace_back(start, end - start, "injector_" + std::string(wrapper) + "_" + sampler + "(");
+    }
+
+    std::string output = sourceCode;
+    for (auto it = replacements.rbegin(); it != replacements.rend(); it++)
+    {
+        const auto& [start, length, text] = *it;
+        output.replace(start, length, text);
+    }
+    return output;
+}
+
+std::string ShaderInspector::getLayeredSamplerName(const std::string& sampler)
+{
+    return "injector_layered_" + sampler;
+}
+
+std::string ShaderInspector::getLayeredSamplerFlagName(const std::string& sampler)
+{
+    return "injector_isLayered_" + sampler;
+}
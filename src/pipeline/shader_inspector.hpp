@@ -12,6 +12,8 @@
 #include <string>
 #include <vector>
 
+#include "pipeline/shader_parser.hpp"
+
 namespace hi
 {
 namespace pipeline
@@ -20,10 +22,13 @@ namespace pipeline
     {
     protected:
         std::string sourceCode;
+        /// Declarations & assignments of sourceCode, collected once
+        ShaderIndex index;
 
     public:
         ShaderInspector(std::string code)
             : sourceCode(std::move(code))
+            , index(sourceCode)
         {
         }
 
@@ -72,12 +77,12 @@ namespace pipeline
         std::string replaceGLAssignement(VertextAssignment originalStatement);
 
         /// Injects Injector-specific transformation into shader and returns modified code
-        std::string injectShader(const std::vector<VertextAssignment>& assignments);
+        std::string injectShader(const std::vector<VertextAssignment>& assignments, bool useParametersBlock = false);
 
         /// Get transformation matrix from assigments
         std::string getTransformationUniformName(std::vector<VertextAssignment>);
 
-        /// Get count of declared uniforms in shader in O(n)
+        /// Get count of declared uniforms in shader
         size_t getCountOfUniforms() const;
 
         /// List uniforms pairs <type, name>
@@ -100,10 +105,40 @@ namespace pipeline
         bool isClipSpaceShader() const;
         bool hasFtransform() const;
 
-        static void injectCommonCode(std::string& sourceOriginal);
-
+        /*
+         * Layered sampling (shadowed textures)
+         */
+        /// Does shader declare any sampler uniform?
+        bool hasSamplers() const;
+
+        /**
+         * @brief Get sampler2D uniforms, which can be redirected to layered (array) texture
+         *
+         * Samplers must only be sampled directly by texture(), texture2D(), textureLod(),
+         * texture2DLod(), texelFetch() or queried by textureSize(). If any sampler of shader
+         * can't be redirected (or isn't sampler2D), no sampler is returned, so that bound
+         * program never samples shadowed texture by non-redirected sampler.
+         */
+        std::vector<std::string> getLayerableSamplers() const;
+
+        /**
+         * @brief Redirect sampling of samplers to wrappers, which read layer 'layerVariable'
+         * of sampler2DArray if 'injector_isLayered_<sampler>' is set
+         *
+         * @return modified code (layerVariable must be declared by caller)
+         */
+        std::string injectLayeredSamplers(const std::vector<std::string>& samplers, const std::string& layerVariable) const;
+
+        /// Name of sampler2DArray, which substitutes sampler
+        static std::string getLayeredSamplerName(const std::string& sampler);
+        /// Name of bool uniform, which selects layered sampler
+        static std::string getLayeredSamplerFlagName(const std::string& sampler);
+
+        static void injectCommonCode(std::string& sourceOriginal, bool useParametersBlock = false);
+
+        /// Get injector's uniforms & functions (per-frame parameters either as loose uniforms or std140 block)
         //TODO: separate into logic module
-        static std::string getCommonTransformationShader();
+        static std::string getCommonTransformationShader(bool useParametersBlock = false);
     };
 } //namespace pipeline
 } //namespace hi
@@ -11,8 +11,6 @@
 #include <algorithm>
 #include <cassert>
 #include <cctype>
-#include <iostream>
-#include <regex>
 #include <string>
 #include <string_view>
 #include <unordered_set>
@@ -53,7 +51,7 @@ size_t findEndOfToken(const std::string_view& str)
     // Distinguish = and ==
     if (str[0] == '=')
     {
-        return (str[1] == '=') ? 2 : 1;
+        return (str.size() > 1 && str[1] == '=') ? 2 : 1;
     }
 
     enum TokenType
@@ -64,7 +62,7 @@ size_t findEndOfToken(const std::string_view& str)
     } state;
 
     const auto& firstCharacter = str[0];
-    if (std::isalpha(firstCharacter))
+    if (std::isalpha(firstCharacter) || firstCharacter == '_')
     {
         state = IDENTIFIER;
     }
@@ -122,6 +120,100 @@ std::vector<std::string_view> whitespaceSeparatedTokens(const std::string_view&
     return result;
 }
 
+/// Skip preprocessor directive, including lines joined by backslash
+size_t findEndOfDirective(const std::string_view& code, size_t position)
+{
+    while ((position = code.find('\n', position)) != std::string::npos)
+    {
+        if (position == 0 || code[position - 1] != '\\')
+            return position;
+        position++;
+    }
+    return code.size();
+}
+
+const std::unordered_set<std::string_view>& getStorageQualifiers()
+{
+    static const std::unordered_set<std::string_view> qualifiers = {
+        "uniform", "in", "out", "inout", "varying", "attribute", "buffer", "const", "shared"
+    };
+    return qualifiers;
+}
+
+const std::unordered_set<std::string_view>& getOtherQualifiers()
+{
+    static const std::unordered_set<std::string_view> qualifiers = {
+        "flat", "smooth", "noperspective", "centroid", "sample", "patch", "highp", "mediump", "lowp",
+        "invariant", "precise", "coherent", "volatile", "restrict", "readonly", "writeonly"
+    };
+    return qualifiers;
+}
+
+/// Keywords, which start a statement (and thus can't be a type)
+bool isStatementKeyword(const std::string_view& token)
+{
+    static const std::unordered_set<std::string_view> keywords = {
+        "return", "else", "do", "case", "default", "discard", "precision", "break", "continue",
+        "if", "while", "for", "switch", "struct", "layout"
+    };
+    return keywords.count(token) > 0;
+}
+
+size_t getOffset(const std::string_view& code, const std::string_view& token)
+{
+    return token.data() - code.data();
+}
+
+/**
+ * @brief Skip qualifiers of declaration
+ * @return index of first token after qualifiers
+ */
+size_t parseQualifiers(const std::vector<std::string_view>& tokens, size_t begin, size_t end, const std::string_view& code, std::string& storage, std::vector<std::string>& qualifiers, size_t& storageToken)
+{
+    size_t i = begin;
+    while (i < end)
+    {
+        if (getStorageQualifiers().count(tokens[i]))
+        {
+            storage = std::string(tokens[i]);
+            storageToken = i++;
+            continue;
+        }
+        if (getOtherQualifiers().count(tokens[i]))
+        {
+            qualifiers.emplace_back(tokens[i++]);
+            continue;
+        }
+        if (tokens[i] == "layout" && i + 1 < end && tokens[i + 1] == "(")
+        {
+            // layout(...) is kept as a single qualifier
+            const auto start = i;
+            while (i < end && tokens[i] != ")")
+                i++;
+            if (i == end)
+                return end;
+            const auto startOffset = getOffset(code, tokens[start]);
+            qualifiers.emplace_back(code.substr(startOffset, getOffset(code, tokens[i]) + 1 - startOffset));
+            i++;
+            continue;
+        }
+        break;
+    }
+    return i;
+}
+
+/// Skip array specifier ([N]), if any
+size_t skipArraySpecifier(const std::vector<std::string_view>& tokens, size_t i, size_t end)
+{
+    while (i < end && tokens[i] == "[")
+    {
+        while (i < end && tokens[i] != "]")
+            i++;
+        i = std::min(i + 1, end);
+    }
+    return i;
+}
+
 } //namespace helper
 
 std::vector<std::string_view> hi::pipeline::tokenize(const std::string_view& code)
@@ -135,3 +227,279 @@ bool hi::pipeline::isBuiltinGLSLType(const std::string_view& token)
     static const auto builtinTypes = std::unordered_set<std::string> { "vec3", "vec4", "mat3", "mat4", "float", "double" };
     return (builtinTypes.count(key) > 0);
 }
+
+bool hi::pipeline::isIdentifierToken(const std::string_view& token)
+{
+    if (token.empty() || !(std::isalpha(token[0]) || token[0] == '_'))
+        return false;
+    return std::all_of(token.begin() + 1, token.end(), [](char c) { return std::isalnum(c) || c == '_'; });
+}
+
+std::vector<std::string_view> hi::pipeline::tokenizeSource(const std::string_view& code)
+{
+    std::vector<std::string_view> result;
+    size_t position = 0;
+    bool isLineStart = true;
+    while (position < code.size())
+    {
+        const auto character = code[position];
+        if (std::isspace(character))
+        {
+            isLineStart = isLineStart || character == '\n';
+            position++;
+            continue;
+        }
+        if (code.compare(position, 2, "//") == 0)
+        {
+            position = std::min(code.find('\n', position), code.size());
+            continue;
+        }
+        if (code.compare(position, 2, "/*") == 0)
+        {
+            const auto end = code.find("*/", position + 2);
+            position = (end == std::string::npos ? code.size() : end + 2);
+            continue;
+        }
+        if (character == '#' && isLineStart)
+        {
+            position = helper::findEndOfDirective(code, position);
+            continue;
+        }
+        isLineStart = false;
+        const auto length = helper::findEndOfToken(code.substr(position));
+        result.push_back(code.substr(position, length));
+        position += length;
+    }
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ShaderIndex
+///////////////////////////////////////////////////////////////////////////////
+ShaderIndex::ShaderIndex(const std::string_view& code)
+{
+    const auto tokens = tokenizeSource(code);
+
+    // Start of currently parsed statement
+    size_t statementStart = 0;
+    size_t braceDepth = 0;
+    size_t parenDepth = 0;
+    // Parenthesis depth of layout(...) or 0
+    size_t layoutDepth = 0;
+    // Block, whose members are being declared
+    int currentBlock = -1;
+    // Block, whose instance name is expected
+    int closedBlock = -1;
+    // Assignments, waiting for their semicolon
+    std::vector<Assignment> pendingAssignments;
+
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        const auto& token = tokens[i];
+        if (isIdentifierToken(token))
+        {
+            m_Identifiers.emplace(token);
+            if (i > 0 && tokens[i - 1] == ".")
+                m_Swizzles.emplace(token);
+            if (token == "uniform")
+                m_UniformQualifiers++;
+        }
+        else if (token == "(")
+        {
+            parenDepth++;
+            if (i > 0 && tokens[i - 1] == "layout")
+                layoutDepth = parenDepth;
+        }
+        else if (token == ")")
+        {
+            if (parenDepth == layoutDepth)
+                layoutDepth = 0;
+            parenDepth -= (parenDepth > 0 ? 1 : 0);
+        }
+        else if (token == "=")
+        {
+            const bool isTarget = (i > 0 && isIdentifierToken(tokens[i - 1]) && (i < 2 || tokens[i - 2] != "."));
+            if (isTarget && layoutDepth == 0)
+            {
+                Assignment assignment;
+                assignment.target = std::string(tokens[i - 1]);
+                assignment.start = helper::getOffset(code, tokens[i - 1]);
+                pendingAssignments.push_back(std::move(assignment));
+            }
+        }
+        else if (token == ";")
+        {
+            for (auto& assignment : pendingAssignments)
+            {
+                assignment.end = helper::getOffset(code, token);
+                m_AssignmentsByTarget[assignment.target].push_back(m_Assignments.size());
+                m_Assignments.push_back(std::move(assignment));
+            }
+            pendingAssignments.clear();
+
+            // Semicolons of for (;;)
+            if (parenDepth > 0)
+                continue;
+
+            if (closedBlock >= 0)
+            {
+                if (statementStart < i && isIdentifierToken(tokens[statementStart]))
+                    m_InterfaceBlocks[closedBlock].instanceName = std::string(tokens[statementStart]);
+                closedBlock = -1;
+            }
+            else
+            {
+                addDeclarations(tokens, statementStart, i, code, currentBlock, braceDepth == 0 || currentBlock >= 0);
+            }
+            statementStart = i + 1;
+        }
+        else if (token == "{")
+        {
+            // Either interface block / struct, or function's body
+            if (braceDepth == 0 && parenDepth == 0)
+            {
+                std::string storage;
+                std::vector<std::string> qualifiers;
+                size_t storageToken = statementStart;
+                auto nameToken = helper::parseQualifiers(tokens, statementStart, i, code, storage, qualifiers, storageToken);
+                if (nameToken < i && tokens[nameToken] == "struct")
+                {
+                    storage = "struct";
+                    storageToken = nameToken++;
+                }
+                const bool isBlock = (storage == "struct" || storage == "uniform" || storage == "in" || storage == "out" || storage == "buffer");
+                if (isBlock && nameToken + 1 == i && isIdentifierToken(tokens[nameToken]))
+                {
+                    InterfaceBlock block;
+                    block.storage = storage;
+                    block.name = std::string(tokens[nameToken]);
+                    block.start = helper::getOffset(code, tokens[storageToken]) + tokens[storageToken].size();
+                    currentBlock = m_InterfaceBlocks.size();
+                    m_InterfaceBlocks.push_back(std::move(block));
+                }
+            }
+            braceDepth++;
+            closedBlock = -1;
+            statementStart = i + 1;
+        }
+        else if (token == "}")
+        {
+            braceDepth -= (braceDepth > 0 ? 1 : 0);
+            if (braceDepth == 0 && currentBlock >= 0)
+            {
+                m_InterfaceBlocks[currentBlock].end = helper::getOffset(code, token) + 1;
+                closedBlock = currentBlock;
+                currentBlock = -1;
+            }
+            statementStart = i + 1;
+        }
+    }
+}
+
+void ShaderIndex::addDeclarations(const std::vector<std::string_view>& tokens, size_t begin, size_t end, const std::string_view& code, int blockIndex, bool isGlobal)
+{
+    std::string storage;
+    std::vector<std::string> qualifiers;
+    size_t storageToken = begin;
+    auto i = helper::parseQualifiers(tokens, begin, end, code, storage, qualifiers, storageToken);
+    if (blockIndex >= 0 && storage.empty() && m_InterfaceBlocks[blockIndex].storage != "struct")
+        storage = m_InterfaceBlocks[blockIndex].storage;
+
+    // Type (e.g. 'vec4' or 'float[3]')
+    if (i >= end || !isIdentifierToken(tokens[i]) || helper::isStatementKeyword(tokens[i]))
+        return;
+    const auto type = std::string(tokens[i]);
+    i = helper::skipArraySpecifier(tokens, i + 1, end);
+
+    // Declarators: name ([N])? (= initializer)? (, ...)*
+    while (i < end)
+    {
+        if (!isIdentifierToken(tokens[i]))
+            return;
+        const auto next = helper::skipArraySpecifier(tokens, i + 1, end);
+        if (next < end && tokens[next] != "," && tokens[next] != "=")
+            return;
+
+        Declaration declaration;
+        declaration.storage = storage;
+        declaration.qualifiers = qualifiers;
+        declaration.type = type;
+        declaration.name = std::string(tokens[i]);
+        declaration.block = blockIndex;
+        declaration.isGlobal = isGlobal;
+        declaration.position = helper::getOffset(code, tokens[i]);
+        m_DeclarationsByName[declaration.name].push_back(m_Declarations.size());
+        if (blockIndex >= 0)
+            m_InterfaceBlocks[blockIndex].members.push_back(m_Declarations.size());
+        m_Declarations.push_back(std::move(declaration));
+
+        // Skip initializer till next declarator
+        size_t depth = 0;
+        for (i = next; i < end && !(depth == 0 && tokens[i] == ","); i++)
+        {
+            if (tokens[i] == "(" || tokens[i] == "[" || tokens[i] == "{")
+                depth++;
+            else if ((tokens[i] == ")" || tokens[i] == "]" || tokens[i] == "}") && depth > 0)
+                depth--;
+        }
+        i++;
+    }
+}
+
+const std::vector<ShaderIndex::Declaration>& ShaderIndex::getDeclarations() const
+{
+    return m_Declarations;
+}
+
+const std::vector<ShaderIndex::InterfaceBlock>& ShaderIndex::getInterfaceBlocks() const
+{
+    return m_InterfaceBlocks;
+}
+
+const std::vector<ShaderIndex::Assignment>& ShaderIndex::getAssignments() const
+{
+    return m_Assignments;
+}
+
+const ShaderIndex::Declaration* ShaderIndex::findDeclaration(const std::string& name) const
+{
+    auto it = m_DeclarationsByName.find(name);
+    if (it == m_DeclarationsByName.end())
+        return nullptr;
+    return &m_Declarations[it->second.front()];
+}
+
+const ShaderIndex::Declaration* ShaderIndex::findDeclaration(const std::string& name, const std::string& storage) const
+{
+    auto it = m_DeclarationsByName.find(name);
+    if (it == m_DeclarationsByName.end())
+        return nullptr;
+    for (const auto index : it->second)
+    {
+        if (m_Declarations[index].storage == storage)
+            return &m_Declarations[index];
+    }
+    return nullptr;
+}
+
+const std::vector<size_t>& ShaderIndex::getAssignmentsTo(const std::string& target) const
+{
+    static const std::vector<size_t> none;
+    auto it = m_AssignmentsByTarget.find(target);
+    return (it != m_AssignmentsByTarget.end() ? it->second : none);
+}
+
+size_t ShaderIndex::getCountOfUniformQualifiers() const
+{
+    return m_UniformQualifiers;
+}
+
+bool ShaderIndex::hasIdentifier(const std::string& identifier) const
+{
+    return m_Identifiers.count(identifier) > 0;
+}
+
+bool ShaderIndex::hasSwizzle(const std::string& swizzle) const
+{
+    return m_Swizzles.count(swizzle) > 0;
+}
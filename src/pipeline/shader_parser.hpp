@@ -6,7 +6,13 @@
 *
 *****************************************************************************/
 
+#ifndef HI_SHADER_PARSER_HPP
+#define HI_SHADER_PARSER_HPP
+
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace hi
@@ -15,7 +21,101 @@ namespace pipeline
 {
     std::vector<std::string_view> tokenize(const std::string_view& code);
 
+    /// Tokenize GLSL source code, skipping comments and preprocessor directives
+    std::vector<std::string_view> tokenizeSource(const std::string_view& code);
+
     /// Verifies if 'token' names a GLSL builtin type
     bool isBuiltinGLSLType(const std::string_view& token);
+
+    /// Verifies if 'token' is an identifier ([a-zA-Z_][a-zA-Z0-9_]*)
+    bool isIdentifierToken(const std::string_view& token);
+
+    /**
+     * @brief Table of declarations & assignments in GLSL code, built by a single pass over tokens
+     *
+     * Queries are served from hash maps, thus inspecting a shader doesn't rescan its code.
+     * Positions are offsets into indexed code (index doesn't keep reference to the code).
+     */
+    class ShaderIndex
+    {
+    public:
+        struct Declaration
+        {
+            /// Storage qualifier (uniform, in, out, varying, attribute, buffer, const) or empty
+            std::string storage;
+            /// Remaining qualifiers (e.g. flat, highp, layout(location = 0))
+            std::vector<std::string> qualifiers;
+            std::string type;
+            std::string name;
+            /// Index of interface block (or struct), which declares variable as its member, or -1
+            int block = -1;
+            /// Declared outside of function bodies
+            bool isGlobal = true;
+            /// Offset of name in code
+            size_t position = 0;
+        };
+
+        struct InterfaceBlock
+        {
+            /// Storage qualifier (uniform, in, out, buffer) or "struct"
+            std::string storage;
+            std::string name;
+            /// Instance name (e.g. 'vs' in "out Data {...} vs;") or empty
+            std::string instanceName;
+            /// Offset of the first character after storage qualifier and one past closing bracket
+            size_t start = 0;
+            size_t end = 0;
+            /// Indices of members in declarations
+            std::vector<size_t> members;
+        };
+
+        /// Statement 'target = expression;', including declarations with initializer
+        struct Assignment
+        {
+            std::string target;
+            /// Offset of target
+            size_t start = 0;
+            /// Offset of terminating semicolon
+            size_t end = 0;
+        };
+
+        ShaderIndex() = default;
+        explicit ShaderIndex(const std::string_view& code);
+
+        /// All declarations in order of appearance
+        const std::vector<Declaration>& getDeclarations() const;
+        const std::vector<InterfaceBlock>& getInterfaceBlocks() const;
+        /// All assignments in order of appearance
+        const std::vector<Assignment>& getAssignments() const;
+
+        /// Get first declaration of variable or nullptr
+        const Declaration* findDeclaration(const std::string& name) const;
+        /// Get first declaration of variable with given storage (e.g. uniform) or nullptr
+        const Declaration* findDeclaration(const std::string& name, const std::string& storage) const;
+        /// Get indices of assignments into variable, in order of appearance
+        const std::vector<size_t>& getAssignmentsTo(const std::string& target) const;
+
+        /// Get count of 'uniform' qualifiers (a block counts as a single uniform)
+        size_t getCountOfUniformQualifiers() const;
+        /// Is identifier used anywhere in code?
+        bool hasIdentifier(const std::string& identifier) const;
+        /// Is swizzle (or member, e.g. '.xyww') selected anywhere in code?
+        bool hasSwizzle(const std::string& swizzle) const;
+
+    private:
+        void addDeclarations(const std::vector<std::string_view>& tokens, size_t begin, size_t end, const std::string_view& code, int blockIndex, bool isGlobal);
+
+        std::vector<Declaration> m_Declarations;
+        std::vector<InterfaceBlock> m_InterfaceBlocks;
+        std::vector<Assignment> m_Assignments;
+
+        /// Name => indices of declarations, assignments
+        std::unordered_map<std::string, std::vector<size_t>> m_DeclarationsByName;
+        std::unordered_map<std::string, std::vector<size_t>> m_AssignmentsByTarget;
+        std::unordered_set<std::string> m_Identifiers;
+        std::unordered_set<std::string> m_Swizzles;
+        size_t m_UniformQualifiers = 0;
+    };
 }; //namespace pipeline
 }; //namespace hi
+#endif
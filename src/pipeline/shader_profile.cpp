@@ -45,6 +45,7 @@ ShaderProfile::ShaderProfile(std::filesystem::path dir) :
 
 bool ShaderProfile::hasProfile(size_t hashValue)
 {
+    std::lock_guard<std::mutex> lock(mutex);
     if (hasProfileInCache(hashValue))
         return true;
     searchForProfile(hashValue);
@@ -53,6 +54,7 @@ bool ShaderProfile::hasProfile(size_t hashValue)
 
 const ProfileEntry& ShaderProfile::getProfile(size_t hashValue)
 {
+    std::lock_guard<std::mutex> lock(mutex);
     assert(hasProfileInCache(hashValue));
     return cache[hashValue];
 }
@@ -92,7 +94,7 @@ void ShaderProfile::searchForProfile(size_t hashValue)
         cache[hashValue] = result;
     } catch (YAML::BadFile& e)
     {
-        Logger::logDebug("[ShaderProfile] Profile for ", std::to_string(hashValue)," not found");
+        Logger::logDebug("[ShaderProfile] Profile for ", hashValue, " not found");
     }
 }
 
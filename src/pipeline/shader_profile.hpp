@@ -11,6 +11,7 @@
 
 #include <map>
 #include <filesystem>
+#include <mutex>
 #include <optional>
 
 namespace hi
@@ -24,6 +25,8 @@ namespace pipeline
     };
     /*
      * @brief Provides user-defined settings for given shader
+     *
+     * Queries are thread-safe (shaders are injected on worker threads, see ShaderManager).
      */
     class ShaderProfile 
     {
@@ -45,6 +48,9 @@ namespace pipeline
 
         /// The directory to use when searching for profiles
         std::filesystem::path searchDir;
+
+        /// Guards cache
+        std::mutex mutex;
     };
 } //namespace pipeline
 } //namespace hi
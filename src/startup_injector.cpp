@@ -11,10 +11,10 @@
  * setsebool allow_execheap on
  */
 #include <cstdio>
+#include <cstring>
 #include <dlfcn.h>
 //#include <subhook.h>
 #include <memory>
-#include <mutex>
 
 #include "hooking/redirector_base.hpp"
 
@@ -53,11 +53,6 @@ bool shouldLogApiCall()
 }
 namespace hi
 {
-/*
-     * Stores function names, that were replaced by our symbols
-     */
-std::unordered_map<std::string, void*> m_OriginalCalls;
-
 void* original_dlsym(void* params, const char* symbol)
 {
     typedef void* (*PFN_DLSYM)(void*, const char*);
@@ -96,13 +91,31 @@ void* original_dlsym(void* params, const char* symbol)
         return reinterpret_cast<dlsym_type*>(original_dlsym)(params, symbol);
         */
 }
+
+/// Get original (next in lookup order) address of known symbol, resolved on first use
+void* getCachedOriginal(const hi::hooking::SymbolRedirection::Symbol& knownSymbol)
+{
+    auto address = knownSymbol.original.load(std::memory_order_acquire);
+    if (!address)
+    {
+        address = original_dlsym(RTLD_NEXT, knownSymbol.name.c_str());
+        if (!address)
+            return nullptr;
+        void* expected = nullptr;
+        // In case of race, keep the first resolved address
+        if (!knownSymbol.original.compare_exchange_strong(expected, address))
+            address = expected;
+    }
+    return address;
+}
+
 void* hooked_dlsym(void* params, const char* symbol)
 {
     /*
          * Fix: route dlopen() directly to libc.so
          * This is needed for libraries such as apitrace
          */
-    if (std::string(symbol) == "dlopen")
+    if (std::strcmp(symbol, "dlopen") == 0)
     {
         //auto moduleHandle = dlopen("libc.so",RTLD_LAZY);
         //return original_dlsym(RTLD_NEXT, symbol);
@@ -125,41 +138,35 @@ void* hooked_dlsym(void* params, const char* symbol)
         return (void*)dlopen_sym;
     }
 
-    static std::mutex dlsym_mutex;
-    auto lock = std::unique_lock<std::mutex>(dlsym_mutex);
-
     if (helper::shouldLogApiCall())
     {
         printf("[Injector dlsym] '%s'\n", symbol);
     }
 
     assert(context != nullptr);
-    const auto& functions = context->redirector->getRedirectedFunctions();
-
-    auto originalSymbol = original_dlsym(params, symbol);
-    m_OriginalCalls[symbol] = originalSymbol;
-
-    if (functions.hasRedirection(symbol))
+    // Lock-free: table of known symbols is read-only after initialization
+    const auto knownSymbol = context->redirector->getRedirectedFunctions().find(symbol);
+    if (knownSymbol && knownSymbol->target)
     {
-        auto* const targetAddress = functions.getTarget(symbol);
-        return targetAddress;
+        return knownSymbol->target;
     }
-    // Else, return original address
-    return originalSymbol;
+    // Else, return original address (resolved with caller's handle, which may differ between calls)
+    return original_dlsym(params, symbol);
 }
 
-void* getOriginalCallAddress(std::string symbol)
+void* getOriginalCallAddress(const char* symbol)
 {
-    if (m_OriginalCalls.count(symbol) > 0)
+    if (auto knownSymbol = context->redirector->getRedirectedFunctions().find(symbol))
     {
-        return m_OriginalCalls[symbol];
+        if (auto address = getCachedOriginal(*knownSymbol))
+            return address;
     }
 
     if (helper::shouldLogApiCall())
     {
-        printf("[Injector- symbol getter] Calling original dlsym with symbo %s\n", symbol.c_str());
+        printf("[Injector- symbol getter] Calling original dlsym with symbo %s\n", symbol);
     }
-    auto addr = hi::original_dlsym(RTLD_NEXT, symbol.c_str());
+    auto addr = hi::original_dlsym(RTLD_NEXT, symbol);
     if (addr == NULL)
     {
         puts("[Injector- symbol getter] Failed to get original address via dlsym()");
@@ -200,13 +207,12 @@ namespace helper
     }
     */
 
-template <typename DICT>
-void dumpRedirections(DICT dict)
+void dumpRedirections(const std::vector<std::string>& symbols)
 {
-    printf("Dumping redirected functions (%lu):\n", dict.size());
-    for (const auto& keyValue : dict)
+    printf("Dumping redirected functions (%lu):\n", symbols.size());
+    for (const auto& symbol : symbols)
     {
-        puts(keyValue.first.c_str());
+        puts(symbol.c_str());
     }
     puts("End of dump");
 }
@@ -260,7 +266,7 @@ void injector_setup(std::unique_ptr<hi::hooking::RedirectorBase> redirector)
      * Register OpenGL calls that should be redirected
      */
     context->redirector->registerCallbacks();
-    helper::dumpRedirections(context->redirector->getRedirectedFunctions().getMapping());
+    helper::dumpRedirections(context->redirector->getRedirectedFunctions().getRedirectedSymbols());
     fputs("[Injector] Registration done\n", stdout);
     if (dlSymHookStatus == false)
     {
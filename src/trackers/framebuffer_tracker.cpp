@@ -14,12 +14,19 @@
 
 #include "utils/opengl_debug.hpp"
 
+#include <atomic>
 #include <cassert>
 #include <unordered_set>
 
 using namespace hi;
 using namespace hi::trackers;
 
+namespace helper
+{
+/// Incremented whenever any FBO's attachments or shadow FBO change (by any context's thread)
+std::atomic<size_t> framebufferStateEpoch = 1;
+} // namespace helper
+
 ///////////////////////////////////////////////////////////////////////////////
 // FramebufferMetadata
 ///////////////////////////////////////////////////////////////////////////////
@@ -27,6 +34,8 @@ using namespace hi::trackers;
 FramebufferMetadata::FramebufferMetadata(size_t id)
     : m_id(id)
 {
+    // ID may be reused by a new FBO
+    incrementStateEpoch();
 }
 void hi::trackers::FramebufferMetadata::attach(GLenum attachmentType, std::shared_ptr<TextureMetadata> texture, GLenum type, size_t level, size_t layer)
 {
@@ -36,6 +45,7 @@ void hi::trackers::FramebufferMetadata::attach(GLenum attachmentType, std::share
     attachment.layer = layer;
     attachment.texture = texture;
     m_attachments.add(attachmentType, attachment);
+    incrementStateEpoch();
 
     assert(hasAnyAttachment() == true);
     assert(hasAttachment(attachmentType) == true);
@@ -61,6 +71,16 @@ size_t hi::trackers::FramebufferMetadata::getShadowFBO() const
     return m_shadowFBOId;
 }
 
+bool hi::trackers::FramebufferMetadata::hasMultiviewFBO() const
+{
+    return m_multiviewFBOId;
+}
+
+GLuint hi::trackers::FramebufferMetadata::getMultiviewFBO() const
+{
+    return m_multiviewFBOId;
+}
+
 void hi::trackers::FramebufferMetadata::setDrawBuffers(std::vector<GLenum> buffers)
 {
     m_drawBuffers = buffers;
@@ -68,10 +88,15 @@ void hi::trackers::FramebufferMetadata::setDrawBuffers(std::vector<GLenum> buffe
     {
         glNamedFramebufferDrawBuffers(m_shadowFBOId, buffers.size(), buffers.data());
     }
+    if (hasMultiviewFBO())
+    {
+        glNamedFramebufferDrawBuffers(m_multiviewFBOId, buffers.size(), buffers.data());
+    }
 }
 
-void hi::trackers::FramebufferMetadata::createShadowedFBO(size_t numLayers)
+void hi::trackers::FramebufferMetadata::createShadowedFBO(size_t numLayers, bool shouldCreateMultiviewFBO)
 {
+    incrementStateEpoch();
     assert(hasAnyAttachment());
     ASSERT_GL_ERROR();
     GLuint shadowFBO;
@@ -111,6 +136,10 @@ void hi::trackers::FramebufferMetadata::createShadowedFBO(size_t numLayers)
     if (status == GL_FRAMEBUFFER_COMPLETE)
     {
         m_shadowFBOId = shadowFBO;
+        if (shouldCreateMultiviewFBO)
+        {
+            createMultiviewFBO(numLayers);
+        }
     }
     else
     {
@@ -127,6 +156,29 @@ void hi::trackers::FramebufferMetadata::createShadowedFBO(size_t numLayers)
     }
 }
 
+void hi::trackers::FramebufferMetadata::createMultiviewFBO(size_t numViews)
+{
+    GLuint multiviewFBO;
+    glGenFramebuffers(1, &multiviewFBO);
+    // Hack: OpenGL require at least one bind before attaching
+    glBindFramebuffer(GL_FRAMEBUFFER, multiviewFBO);
+    for (auto& [attachmentType, metadata] : m_attachments.getMap())
+    {
+        auto shadowedTexture = metadata.texture->getShadowedTextureId();
+        glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, attachmentType, shadowedTexture, metadata.level, 0, numViews);
+    }
+    glDrawBuffers(m_drawBuffers.size(), m_drawBuffers.data());
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        Logger::logError("Failed to create multiview FBO for shadow FBO: ", m_shadowFBOId, " status: ", status, HI_POS);
+        glDeleteFramebuffers(1, &multiviewFBO);
+        return;
+    }
+    m_multiviewFBOId = multiviewFBO;
+}
+
 GLuint hi::trackers::FramebufferMetadata::createProxyFBO(size_t layer)
 {
     // draw() call should be over existing FBO, which should have been previously created
@@ -172,6 +224,7 @@ GLuint hi::trackers::FramebufferMetadata::createProxyFBO(size_t layer)
 
 void hi::trackers::FramebufferMetadata::freeShadowedFBO()
 {
+    incrementStateEpoch();
     for (auto& fbo : m_proxyFBO)
     {
         GLuint id = fbo.getID();
@@ -185,6 +238,12 @@ void hi::trackers::FramebufferMetadata::freeShadowedFBO()
         glDeleteFramebuffers(1, &id);
         m_shadowFBOId = 0;
     }
+
+    if (m_multiviewFBOId)
+    {
+        glDeleteFramebuffers(1, &m_multiviewFBOId);
+        m_multiviewFBOId = 0;
+    }
 }
 
 bool hi::trackers::FramebufferMetadata::isShadowMapFBO() const
@@ -221,6 +280,16 @@ bool hi::trackers::FramebufferMetadata::hasAnyAttachment() const
     return m_attachments.size() > 0;
 }
 
+size_t hi::trackers::FramebufferMetadata::getStateEpoch()
+{
+    return helper::framebufferStateEpoch.load(std::memory_order_relaxed);
+}
+
+void hi::trackers::FramebufferMetadata::incrementStateEpoch()
+{
+    helper::framebufferStateEpoch.fetch_add(1, std::memory_order_relaxed);
+}
+
 ContextTracker<FramebufferAttachment>& hi::trackers::FramebufferMetadata::getAttachmentMap()
 {
     return m_attachments;
@@ -57,6 +57,11 @@ namespace trackers
      * Instead, it's possible to create *proxy FBO*, a FBO made of texture views, where each texture
      * view is a proxy texture to a certain layer of original attachment's texture.
      * createProxyFBO() thus serves to create a new FBO, which points to a certain layer of shadowed FBO.
+     *
+     * ## Multiview FBO
+     * Programs, injected using GL_OVR_multiview, must render into a FBO with the same count of views.
+     * Thus, the shadow FBO's layers are also attached to a separate multiview FBO, while the shadow FBO
+     * stays layered for the rest of programs.
      */
     struct FramebufferMetadata
     {
@@ -83,8 +88,13 @@ namespace trackers
         /// Get shadow FBO's OpenGL's object ID. Undefined behavior if shadow FBO does not exist
         size_t getShadowFBO() const;
 
-        /// Create multi-layer shadow FBO
-        void createShadowedFBO(size_t numLayers);
+        /// Create multi-layer shadow FBO (and multiview FBO with numLayers views, if requested)
+        void createShadowedFBO(size_t numLayers, bool shouldCreateMultiviewFBO = false);
+
+        /// Determine if multiview FBO (GL_OVR_multiview) has been created together with shadow FBO
+        bool hasMultiviewFBO() const;
+        /// Get multiview FBO's ID or 0
+        GLuint getMultiviewFBO() const;
 
         /// Delete all shadow FBO relatd resources
         void freeShadowedFBO();
@@ -108,10 +118,18 @@ namespace trackers
 
         ContextTracker<FramebufferAttachment>& getAttachmentMap();
 
+        /// Counter, incremented whenever any FBO's attachments or shadow FBO change (heuristics may differ)
+        static size_t getStateEpoch();
+
         /// Debug: serialize attachment type to string
         static std::string getAttachmentTypeAsString(GLenum attachmentType);
 
     private:
+        static void incrementStateEpoch();
+
+        /// Attach layers of shadowed textures as views of a new multiview FBO
+        void createMultiviewFBO(size_t numViews);
+
         /// Tracked FBO's OpenGL object ID
         size_t m_id;
         /// Vector of intercepted allowed colour attachments (glDrawBuffers), 0 by default
@@ -129,6 +147,9 @@ namespace trackers
         /// Shadow FBO's ID
         size_t m_shadowFBOId = 0;
 
+        /// Multiview FBO's ID (the same attachments as the shadow FBO)
+        GLuint m_multiviewFBOId = 0;
+
         /**
          * \brief Flag: has creation of shadow FBO failed?
          *
@@ -0,0 +1,178 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        trackers/immediate_mode_tracker.cpp
+*
+*****************************************************************************/
+
+#include "trackers/immediate_mode_tracker.hpp"
+
+#include <algorithm>
+
+using namespace hi;
+using namespace hi::trackers;
+
+namespace helper
+{
+size_t getAttributeIndex(ImmediateModeTracker::Attribute attribute)
+{
+    switch (attribute)
+    {
+    case ImmediateModeTracker::NORMAL_ATTRIBUTE:
+        return 0;
+    case ImmediateModeTracker::COLOR_ATTRIBUTE:
+        return 1;
+    default:
+        return 2;
+    }
+}
+} // namespace helper
+
+bool ImmediateModeTracker::begin(GLenum mode)
+{
+    // Display list records batch as is
+    if (m_ListMode != 0)
+        return false;
+    m_Mode = mode;
+    m_IsInsideBatch = true;
+    m_Vertices.clear();
+    m_BatchAttributes = 0;
+    m_UnknownVertices = {};
+    return true;
+}
+
+void ImmediateModeTracker::end()
+{
+    m_IsInsideBatch = false;
+}
+
+void ImmediateModeTracker::vertex(float x, float y, float z, float w)
+{
+    if (!m_IsInsideBatch)
+        return;
+    auto& vertex = m_Vertices.emplace_back(m_Current);
+    vertex.position[0] = x;
+    vertex.position[1] = y;
+    vertex.position[2] = z;
+    vertex.position[3] = w;
+
+    for (auto attribute : { NORMAL_ATTRIBUTE, COLOR_ATTRIBUTE, TEXCOORD_ATTRIBUTE })
+    {
+        if (!(m_KnownAttributes & attribute))
+            m_UnknownVertices[helper::getAttributeIndex(attribute)] = m_Vertices.size();
+    }
+}
+
+void ImmediateModeTracker::normal(float x, float y, float z)
+{
+    if (m_ListMode == GL_COMPILE)
+        return;
+    m_Current.normal[0] = x;
+    m_Current.normal[1] = y;
+    m_Current.normal[2] = z;
+    setAttribute(NORMAL_ATTRIBUTE);
+}
+
+void ImmediateModeTracker::color(float r, float g, float b, float a)
+{
+    if (m_ListMode == GL_COMPILE)
+        return;
+    m_Current.color[0] = r;
+    m_Current.color[1] = g;
+    m_Current.color[2] = b;
+    m_Current.color[3] = a;
+    setAttribute(COLOR_ATTRIBUTE);
+}
+
+void ImmediateModeTracker::texCoord(float s, float t, float r, float q)
+{
+    if (m_ListMode == GL_COMPILE)
+        return;
+    m_Current.texCoord[0] = s;
+    m_Current.texCoord[1] = t;
+    m_Current.texCoord[2] = r;
+    m_Current.texCoord[3] = q;
+    setAttribute(TEXCOORD_ATTRIBUTE);
+}
+
+void ImmediateModeTracker::invalidate()
+{
+    m_KnownAttributes = 0;
+}
+
+void ImmediateModeTracker::beginList(GLenum mode)
+{
+    m_ListMode = mode;
+}
+
+void ImmediateModeTracker::endList()
+{
+    m_ListMode = 0;
+}
+
+void ImmediateModeTracker::resolve(Attribute attribute, const float value[4])
+{
+    auto& count = m_UnknownVertices[helper::getAttributeIndex(attribute)];
+    for (size_t i = 0; i < count; i++)
+    {
+        auto& vertex = m_Vertices[i];
+        switch (attribute)
+        {
+        case NORMAL_ATTRIBUTE:
+            std::copy(value, value + 3, vertex.normal);
+            break;
+        case COLOR_ATTRIBUTE:
+            std::copy(value, value + 4, vertex.color);
+            break;
+        default:
+            std::copy(value, value + 4, vertex.texCoord);
+            break;
+        }
+    }
+    count = 0;
+}
+
+void ImmediateModeTracker::setAttribute(Attribute attribute)
+{
+    m_KnownAttributes |= attribute;
+    if (m_IsInsideBatch)
+        m_BatchAttributes |= attribute;
+}
+
+bool ImmediateModeTracker::isInsideBatch() const
+{
+    return m_IsInsideBatch;
+}
+
+GLenum ImmediateModeTracker::getMode() const
+{
+    return m_Mode;
+}
+
+const std::vector<ImmediateModeTracker::Vertex>& ImmediateModeTracker::getVertices() const
+{
+    return m_Vertices;
+}
+
+const ImmediateModeTracker::Vertex& ImmediateModeTracker::getCurrent() const
+{
+    return m_Current;
+}
+
+unsigned ImmediateModeTracker::getBatchAttributes() const
+{
+    return m_BatchAttributes;
+}
+
+unsigned ImmediateModeTracker::getUnresolvedAttributes() const
+{
+    unsigned attributes = 0;
+    for (auto attribute : { NORMAL_ATTRIBUTE, COLOR_ATTRIBUTE, TEXCOORD_ATTRIBUTE })
+    {
+        // Attributes, which aren't set in batch, are sourced from OpenGL's state anyway
+        if ((m_BatchAttributes & attribute) && m_UnknownVertices[helper::getAttributeIndex(attribute)] > 0)
+            attributes |= attribute;
+    }
+    return attributes;
+}
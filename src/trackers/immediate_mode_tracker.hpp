@@ -0,0 +1,137 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        trackers/immediate_mode_tracker.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_IMMEDIATE_MODE_TRACKER_HPP
+#define HI_IMMEDIATE_MODE_TRACKER_HPP
+
+#include <GL/gl.h>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace hi
+{
+namespace trackers
+{
+    /**
+     * \brief Captures legacy immediate-mode primitives (glBegin/glVertex/glEnd)
+     *
+     * Vertices, issued between glBegin() and glEnd(), are stored into a client-side array
+     * together with current normal, color and texture coordinates. The batch can be then
+     * uploaded at once and drawn by glDrawArrays() for each view, instead of recompiling
+     * a display list for each batch.
+     *
+     * Only attributes, set inside the batch, are sourced from arrays. Mirror of current attributes
+     * is invalidated when OpenGL changes them directly (glPopAttrib, glCallList, ...), thus vertices,
+     * emitted before the attribute is set in batch, are resolved from OpenGL when batch ends.
+     */
+    class ImmediateModeTracker
+    {
+    public:
+        /// Interleaved vertex, as uploaded to GPU (see ImmediateModeBuffer)
+        struct Vertex
+        {
+            float position[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            float normal[3] = { 0.0f, 0.0f, 1.0f };
+            float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            float texCoord[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        };
+
+        /// Bits of vertex attributes (besides position)
+        enum Attribute : unsigned
+        {
+            NORMAL_ATTRIBUTE = 1,
+            COLOR_ATTRIBUTE = 2,
+            TEXCOORD_ATTRIBUTE = 4,
+            ALL_ATTRIBUTES = NORMAL_ATTRIBUTE | COLOR_ATTRIBUTE | TEXCOORD_ATTRIBUTE,
+        };
+
+        /*
+         * Book-keeping methods
+         */
+        /// Start new batch of primitives, returns false when batch belongs to compiled display list
+        bool begin(GLenum mode);
+        /// Close batch, its vertices are available until next begin()
+        void end();
+
+        /// Emit vertex with current attributes (ignored outside of batch)
+        void vertex(float x, float y, float z = 0.0f, float w = 1.0f);
+        /// Set current normal
+        void normal(float x, float y, float z);
+        /// Set current color
+        void color(float r, float g, float b, float a = 1.0f);
+        /// Set current texture coordinates (texture unit 0)
+        void texCoord(float s, float t = 0.0f, float r = 0.0f, float q = 1.0f);
+
+        /// Current attributes have been changed by OpenGL directly (e.g. glPopAttrib, glCallList)
+        void invalidate();
+        /// Track glNewList()/glEndList(): attributes of GL_COMPILE lists don't change current state
+        void beginList(GLenum mode);
+        void endList();
+
+        /// Replace unknown value of attribute in vertices of last batch by value from OpenGL
+        void resolve(Attribute attribute, const float value[4]);
+
+        /*
+         * Queries
+         */
+        /// Is application between glBegin() and glEnd()?
+        bool isInsideBatch() const;
+        /// Primitive mode of last batch
+        GLenum getMode() const;
+        /// Vertices of last batch
+        const std::vector<Vertex>& getVertices() const;
+        /// Current attributes (position is unused), valid only for attributes set in last batch
+        const Vertex& getCurrent() const;
+        /// Attributes, set inside last batch (others should be taken from OpenGL's current state)
+        unsigned getBatchAttributes() const;
+        /// Attributes of last batch, whose value was unknown for some vertices (see resolve())
+        unsigned getUnresolvedAttributes() const;
+
+        /// Convert integer component to float as OpenGL does for normals & colors
+        template <typename T>
+        static float normalize(T value)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                return static_cast<float>(value);
+            }
+            else if constexpr (std::is_unsigned_v<T>)
+            {
+                return static_cast<float>(static_cast<double>(value) / std::numeric_limits<T>::max());
+            }
+            else
+            {
+                // (2c + 1) / (2^b - 1)
+                return static_cast<float>((2.0 * value + 1.0) / (2.0 * std::numeric_limits<T>::max() + 1.0));
+            }
+        }
+
+    private:
+        /// Mark attribute as set (and known)
+        void setAttribute(Attribute attribute);
+
+        GLenum m_Mode = GL_POINTS;
+        bool m_IsInsideBatch = false;
+        /// Mode of display list, being compiled, or 0
+        GLenum m_ListMode = 0;
+        /// Current attributes
+        Vertex m_Current;
+        /// Attributes, whose current value is mirrored (OpenGL defaults initially)
+        unsigned m_KnownAttributes = ALL_ATTRIBUTES;
+        unsigned m_BatchAttributes = 0;
+        /// Count of first vertices of batch, emitted while attribute was unknown
+        std::array<std::size_t, 3> m_UnknownVertices = {};
+        /// Reused between batches to avoid allocations
+        std::vector<Vertex> m_Vertices;
+    };
+} // namespace trackers
+} // namespace hi
+#endif
@@ -7,6 +7,8 @@
 *****************************************************************************/
 
 #include "trackers/legacy_tracker.hpp"
+#include <GL/glext.h>
+#include <algorithm>
 #include <glm/gtc/matrix_access.hpp>
 #include <glm/gtx/norm.hpp>
 #include <glm/gtx/string_cast.hpp>
@@ -15,6 +17,49 @@
 using namespace hi;
 using namespace hi::trackers;
 
+namespace helper
+{
+/// Capability depends on active texture unit
+bool isTextureCapability(GLenum capability)
+{
+    switch (capability)
+    {
+    case GL_TEXTURE_1D:
+    case GL_TEXTURE_2D:
+    case GL_TEXTURE_3D:
+    case GL_TEXTURE_CUBE_MAP:
+    case GL_TEXTURE_GEN_S:
+    case GL_TEXTURE_GEN_T:
+    case GL_TEXTURE_GEN_R:
+    case GL_TEXTURE_GEN_Q:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Capability changes fixed-pipeline, but emulation doesn't implement it
+bool isUnsupportedCapability(GLenum capability)
+{
+    if (capability >= GL_CLIP_PLANE0 && capability <= GL_CLIP_PLANE5)
+        return true;
+    switch (capability)
+    {
+    case GL_TEXTURE_1D:
+    case GL_TEXTURE_3D:
+    case GL_TEXTURE_CUBE_MAP:
+    case GL_TEXTURE_GEN_S:
+    case GL_TEXTURE_GEN_T:
+    case GL_TEXTURE_GEN_R:
+    case GL_TEXTURE_GEN_Q:
+    case GL_COLOR_SUM:
+        return true;
+    default:
+        return false;
+    }
+}
+} // namespace helper
+
 bool LegacyTracker::isLegacyNeeded() const
 {
     return m_isLegacyOpenGLUsed;
@@ -75,3 +120,206 @@ const glm::mat4& LegacyTracker::getProjection() const
 {
     return m_currentProjection;
 }
+
+const hi::pipeline::FixedPipelineState& LegacyTracker::getFixedPipelineState() const
+{
+    return m_FixedPipeline.state;
+}
+
+float LegacyTracker::getAlphaReference() const
+{
+    return m_FixedPipeline.alphaReference;
+}
+
+bool LegacyTracker::isFixedPipelineEmulable() const
+{
+    const auto& fixedPipeline = m_FixedPipeline;
+    if (!fixedPipeline.unsupportedCapabilities.empty())
+        return false;
+    if (fixedPipeline.state.isTexture2DEnabled && !fixedPipeline.isTextureEnvModeSupported)
+        return false;
+    if (fixedPipeline.state.isLightingEnabled)
+    {
+        if (fixedPipeline.isTwoSidedLighting || fixedPipeline.isLocalViewer || fixedPipeline.isSeparateSpecular)
+            return false;
+        if (fixedPipeline.state.isColorMaterialEnabled && fixedPipeline.colorMaterialMode != GL_AMBIENT_AND_DIFFUSE)
+            return false;
+    }
+    return true;
+}
+
+void LegacyTracker::setCapability(GLenum capability, bool isEnabled, size_t textureUnit)
+{
+    auto& fixedPipeline = m_FixedPipeline;
+    auto& state = fixedPipeline.state;
+    const size_t unit = (helper::isTextureCapability(capability) ? textureUnit : 0);
+    if (capability >= GL_LIGHT0 && capability < GL_LIGHT0 + 8)
+    {
+        const auto bit = static_cast<uint8_t>(1u << (capability - GL_LIGHT0));
+        state.enabledLights = (isEnabled ? (state.enabledLights | bit) : (state.enabledLights & ~bit));
+        return;
+    }
+    switch (capability)
+    {
+    case GL_LIGHTING:
+        state.isLightingEnabled = isEnabled;
+        return;
+    case GL_COLOR_MATERIAL:
+        state.isColorMaterialEnabled = isEnabled;
+        return;
+    case GL_NORMALIZE:
+        fixedPipeline.isNormalizeEnabled = isEnabled;
+        state.isNormalizeEnabled = fixedPipeline.isNormalizeEnabled || fixedPipeline.isRescaleNormalEnabled;
+        return;
+    case GL_RESCALE_NORMAL:
+        // Normals of uniformly scaled models are unit-length after normalization as well
+        fixedPipeline.isRescaleNormalEnabled = isEnabled;
+        state.isNormalizeEnabled = fixedPipeline.isNormalizeEnabled || fixedPipeline.isRescaleNormalEnabled;
+        return;
+    case GL_FOG:
+        state.isFogEnabled = isEnabled;
+        return;
+    case GL_ALPHA_TEST:
+        state.isAlphaTestEnabled = isEnabled;
+        return;
+    case GL_TEXTURE_2D:
+        if (unit == 0)
+        {
+            state.isTexture2DEnabled = isEnabled;
+            return;
+        }
+        // Multitexturing is not emulated
+        break;
+    default:
+        if (!helper::isUnsupportedCapability(capability))
+            return;
+        break;
+    }
+
+    if (isEnabled)
+        fixedPipeline.unsupportedCapabilities.insert({ capability, unit });
+    else
+        fixedPipeline.unsupportedCapabilities.erase({ capability, unit });
+}
+
+void LegacyTracker::alphaFunc(GLenum func, float reference)
+{
+    m_FixedPipeline.state.alphaFunc = func;
+    m_FixedPipeline.alphaReference = std::clamp(reference, 0.0f, 1.0f);
+}
+
+void LegacyTracker::fogMode(GLenum mode)
+{
+    m_FixedPipeline.state.fogMode = mode;
+}
+
+void LegacyTracker::textureEnvMode(GLenum mode, size_t textureUnit)
+{
+    // Other units can't be enabled (see isFixedPipelineEmulable())
+    if (textureUnit != 0)
+        return;
+    m_FixedPipeline.isTextureEnvModeSupported = hi::pipeline::FixedPipelineEmulation::isTextureEnvModeSupported(mode);
+    if (m_FixedPipeline.isTextureEnvModeSupported)
+        m_FixedPipeline.state.textureEnvMode = mode;
+}
+
+void LegacyTracker::colorMaterial(GLenum face, GLenum mode)
+{
+    // Back face is only lit when two-sided lighting is enabled, which is not emulated
+    if (face == GL_BACK)
+        return;
+    m_FixedPipeline.colorMaterialMode = mode;
+}
+
+void LegacyTracker::lightModel(GLenum parameter, GLint value)
+{
+    switch (parameter)
+    {
+    case GL_LIGHT_MODEL_TWO_SIDE:
+        m_FixedPipeline.isTwoSidedLighting = (value != 0);
+        break;
+    case GL_LIGHT_MODEL_LOCAL_VIEWER:
+        m_FixedPipeline.isLocalViewer = (value != 0);
+        break;
+    case GL_LIGHT_MODEL_COLOR_CONTROL:
+        m_FixedPipeline.isSeparateSpecular = (value == GL_SEPARATE_SPECULAR_COLOR);
+        break;
+    default:
+        break;
+    }
+}
+
+void LegacyTracker::pushAttributes(GLbitfield mask)
+{
+    m_AttributeStack.emplace_back(mask, m_FixedPipeline);
+}
+
+void LegacyTracker::popAttributes()
+{
+    if (m_AttributeStack.empty())
+        return;
+    const auto [mask, saved] = std::move(m_AttributeStack.back());
+    m_AttributeStack.pop_back();
+
+    auto& current = m_FixedPipeline;
+    const auto restoreCapabilities = [&](auto predicate) {
+        for (auto it = current.unsupportedCapabilities.begin(); it != current.unsupportedCapabilities.end();)
+            it = (predicate(it->first) ? current.unsupportedCapabilities.erase(it) : std::next(it));
+        for (const auto& capability : saved.unsupportedCapabilities)
+            if (predicate(capability.first))
+                current.unsupportedCapabilities.insert(capability);
+    };
+
+    // See 'Attribute groups' of OpenGL 2.1 specification
+    if (mask & (GL_ENABLE_BIT | GL_LIGHTING_BIT))
+    {
+        current.state.isLightingEnabled = saved.state.isLightingEnabled;
+        current.state.enabledLights = saved.state.enabledLights;
+        current.state.isColorMaterialEnabled = saved.state.isColorMaterialEnabled;
+    }
+    if (mask & GL_LIGHTING_BIT)
+    {
+        current.colorMaterialMode = saved.colorMaterialMode;
+        current.isTwoSidedLighting = saved.isTwoSidedLighting;
+        current.isLocalViewer = saved.isLocalViewer;
+        current.isSeparateSpecular = saved.isSeparateSpecular;
+    }
+    if (mask & (GL_ENABLE_BIT | GL_TRANSFORM_BIT))
+    {
+        current.isNormalizeEnabled = saved.isNormalizeEnabled;
+        current.isRescaleNormalEnabled = saved.isRescaleNormalEnabled;
+        current.state.isNormalizeEnabled = saved.state.isNormalizeEnabled;
+        restoreCapabilities([](GLenum capability) { return capability >= GL_CLIP_PLANE0 && capability <= GL_CLIP_PLANE5; });
+    }
+    if (mask & (GL_ENABLE_BIT | GL_TEXTURE_BIT))
+    {
+        current.state.isTexture2DEnabled = saved.state.isTexture2DEnabled;
+        restoreCapabilities(helper::isTextureCapability);
+    }
+    if (mask & GL_TEXTURE_BIT)
+    {
+        current.state.textureEnvMode = saved.state.textureEnvMode;
+        current.isTextureEnvModeSupported = saved.isTextureEnvModeSupported;
+    }
+    if (mask & (GL_ENABLE_BIT | GL_FOG_BIT))
+    {
+        current.state.isFogEnabled = saved.state.isFogEnabled;
+    }
+    if (mask & GL_FOG_BIT)
+    {
+        current.state.fogMode = saved.state.fogMode;
+    }
+    if (mask & (GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT))
+    {
+        current.state.isAlphaTestEnabled = saved.state.isAlphaTestEnabled;
+    }
+    if (mask & GL_COLOR_BUFFER_BIT)
+    {
+        current.state.alphaFunc = saved.state.alphaFunc;
+        current.alphaReference = saved.alphaReference;
+    }
+    if (mask & GL_ENABLE_BIT)
+    {
+        restoreCapabilities([](GLenum capability) { return capability == GL_COLOR_SUM; });
+    }
+}
@@ -6,8 +6,15 @@
 *
 *****************************************************************************/
 
+#ifndef HI_LEGACY_TRACKER_HPP
+#define HI_LEGACY_TRACKER_HPP
+
 #include <GL/gl.h>
 #include <glm/glm.hpp>
+#include <set>
+#include <vector>
+
+#include "pipeline/fixed_pipeline_emulation.hpp"
 
 namespace hi
 {
@@ -17,7 +24,8 @@ namespace trackers
      * \brief Tracks fixed-pipeline methods (such as settings of projects)
      *
      * This class intercepts projection matrix from fixed-pipeline methods of legacy OpenGL
-     * programming model.
+     * programming model. Besides, it mirrors fixed-pipeline state, which selects variant of
+     * emulation program (see FixedPipelineEmulation).
      */
     class LegacyTracker
     {
@@ -33,6 +41,13 @@ namespace trackers
 
         /// Returns intercepted matrix
         const glm::mat4& getProjection() const;
+
+        /// Mirrored fixed-pipeline state (variant of emulation program)
+        const hi::pipeline::FixedPipelineState& getFixedPipelineState() const;
+        /// Reference value of alpha test
+        float getAlphaReference() const;
+        /// Can current fixed-pipeline state be emulated by FixedPipelineEmulation?
+        bool isFixedPipelineEmulable() const;
         /*
          * Book-keeping methods
          */
@@ -48,6 +63,21 @@ namespace trackers
         /// Multiply top of stack with m
         void multMatrix(const glm::mat4& m);
 
+        /// glEnable/glDisable, texture unit is active unit of texture capabilities
+        void setCapability(GLenum capability, bool isEnabled, size_t textureUnit);
+        void alphaFunc(GLenum func, float reference);
+        void fogMode(GLenum mode);
+        /// GL_TEXTURE_ENV_MODE of given texture unit
+        void textureEnvMode(GLenum mode, size_t textureUnit);
+        void colorMaterial(GLenum face, GLenum mode);
+        /// Light model parameter (glLightModel)
+        void lightModel(GLenum parameter, GLint value);
+
+        /// Store state, which is restored by glPopAttrib()
+        void pushAttributes(GLbitfield mask);
+        /// Restore state, saved by matching glPushAttrib()
+        void popAttributes();
+
     private:
         /// Mode: affects load/multMatrix() operations
         GLenum m_currentMode = GL_PROJECTION;
@@ -60,7 +90,29 @@ namespace trackers
 
         /// Cache: store whether least recent GL_PROJECTION is orthogonal
         bool m_isOrthogonalProjection = false;
+
+        /// Fixed-pipeline state, which is mirrored by tracker
+        struct FixedPipeline
+        {
+            hi::pipeline::FixedPipelineState state;
+            float alphaReference = 0.0f;
+            bool isNormalizeEnabled = false;
+            bool isRescaleNormalEnabled = false;
+            /// Color material mode of front face (GL_AMBIENT_AND_DIFFUSE is emulated only)
+            GLenum colorMaterialMode = GL_AMBIENT_AND_DIFFUSE;
+            bool isTwoSidedLighting = false;
+            bool isLocalViewer = false;
+            bool isSeparateSpecular = false;
+            /// Texture environment mode of unit 0 can be emulated (e.g. GL_COMBINE can't)
+            bool isTextureEnvModeSupported = true;
+            /// Enabled capabilities & their texture units, which can't be emulated (texture generation, clip planes, ...)
+            std::set<std::pair<GLenum, size_t>> unsupportedCapabilities;
+        };
+        FixedPipeline m_FixedPipeline;
+        /// Attribute stack (glPushAttrib), mask & state before push
+        std::vector<std::pair<GLbitfield, FixedPipeline>> m_AttributeStack;
     };
 
 } // namespace trackers
 } // namespace hi
+#endif
@@ -29,7 +29,10 @@ namespace trackers
         // Override creation of shadow renderbuffer
         virtual void createShadowedTexture(size_t numOfLayers = 9) override;
     };
-    class RenderbufferTracker : public ContextTracker<std::shared_ptr<RenderbufferMetadata>>
+    /**
+     * \brief Tracks creation & binding of OpenGL's renderbuffers
+     */
+    class RenderbufferTracker : public BindableContextTracker<std::shared_ptr<RenderbufferMetadata>>
     {
     };
 } //namespace trackers
@@ -6,17 +6,36 @@
 *
 *****************************************************************************/
 
+#define GL_GLEXT_PROTOTYPES 1
+#include <GL/gl.h>
+
+#include "pipeline/injector_parameters.hpp"
+#include "pipeline/shader_inspector.hpp"
 #include "trackers/shader_tracker.hpp"
 #include <algorithm>
 
+#include <atomic>
 #include <cassert>
+#include <sstream>
 
 using namespace hi;
 using namespace hi::trackers;
 
+namespace helper
+{
+/// Incremented whenever any program is (re)linked (by any context's thread)
+std::atomic<size_t> programLinkEpoch = 1;
+} // namespace helper
+
 ///////////////////////////////////////////////////////////////////////////////
 // ShaderMetadata
 ///////////////////////////////////////////////////////////////////////////////
+const std::string& ShaderMetadata::getPreprocessedSourceCode() const
+{
+    static const std::string empty;
+    return (preprocessedSourceCode.valid() ? preprocessedSourceCode.get() : empty);
+}
+
 bool ShaderMetadata::isShaderOneOf(const std::unordered_set<GLenum>& allowedTypes)
 {
     return (allowedTypes.count(m_Type) > 0);
@@ -59,6 +78,84 @@ bool ShaderProgram::hasUniformBlock(const std::string& name) const
     return m_UniformBlocks.count(name) > 0;
 }
 
+void ShaderProgram::resolveUniformLocations(GLuint programId)
+{
+    m_LinkStamp = helper::programLinkEpoch.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto& locations = m_InjectorUniforms;
+    locations.identity = glGetUniformLocation(programId, "injector_identity");
+    locations.maxViews = glGetUniformLocation(programId, "injector_max_views");
+    locations.maxInvocations = glGetUniformLocation(programId, "injector_max_invocations");
+    locations.xShiftMultiplier = glGetUniformLocation(programId, "injector_XShiftMultiplier");
+    locations.frontalDistance = glGetUniformLocation(programId, "injector_FrontalDistance");
+    locations.deprojection = glGetUniformLocation(programId, "injector_deprojection");
+    locations.deprojectionInv = glGetUniformLocation(programId, "injector_deprojection_inv");
+    locations.isOrthogonal = glGetUniformLocation(programId, "injector_isOrthogonal");
+    locations.isSingleViewActivated = glGetUniformLocation(programId, "injector_isSingleViewActivated");
+    locations.singleViewID = glGetUniformLocation(programId, "injector_singleViewID");
+    locations.instancedViews = glGetUniformLocation(programId, "injector_instanced_views");
+    locations.parametersBlock = glGetUniformBlockIndex(programId, hi::pipeline::InjectorParameters::blockName);
+
+    locations.transformationMatrix = -1;
+    if (hasMetadata() && m_Metadata->hasDetectedTransformation())
+    {
+        locations.transformationMatrix = glGetUniformLocation(programId, m_Metadata->m_TransformationMatrixName.c_str());
+    }
+
+    locations.layeredSamplers.clear();
+    m_LayeredSamplerUnits.clear();
+    if (hasMetadata() && m_Metadata->usesLayeredSamplers())
+    {
+        using hi::pipeline::ShaderInspector;
+        for (const auto& sampler : m_Metadata->m_LayeredSamplers)
+        {
+            InjectorUniformLocations::LayeredSampler samplerLocations;
+            samplerLocations.sampler = glGetUniformLocation(programId, sampler.c_str());
+            samplerLocations.layeredSampler = glGetUniformLocation(programId, ShaderInspector::getLayeredSamplerName(sampler).c_str());
+            samplerLocations.isLayered = glGetUniformLocation(programId, ShaderInspector::getLayeredSamplerFlagName(sampler).c_str());
+            locations.layeredSamplers.push_back(samplerLocations);
+
+            // Initial unit is 0, unless shader declares layout(binding), later updates are mirrored
+            GLint unit = 0;
+            if (samplerLocations.sampler != -1)
+                glGetUniformiv(programId, samplerLocations.sampler, &unit);
+            m_LayeredSamplerUnits.push_back(unit);
+        }
+    }
+}
+
+void ShaderProgram::setSamplerUnits(GLint location, GLsizei count, const GLint* units)
+{
+    const auto& samplers = m_InjectorUniforms.layeredSamplers;
+    for (size_t i = 0; i < samplers.size() && i < m_LayeredSamplerUnits.size(); i++)
+    {
+        const auto element = samplers[i].sampler - location;
+        if (samplers[i].sampler != -1 && element >= 0 && element < count)
+            m_LayeredSamplerUnits[i] = units[element];
+    }
+}
+
+size_t ShaderProgram::getLinkEpoch()
+{
+    return helper::programLinkEpoch.load(std::memory_order_relaxed);
+}
+
+std::string ShaderProgram::PreLinkState::toString() const
+{
+    std::stringstream result;
+    for (const auto& [name, index] : attributeLocations)
+        result << "attribute " << index << " " << name << "\n";
+    for (const auto& [name, location] : fragmentDataLocations)
+        result << "fragment data " << location.first << " " << location.second << " " << name << "\n";
+    if (!feedbackVaryings.empty())
+    {
+        result << "feedback " << feedbackBufferMode << " " << feedbackVaryings.size() << "\n";
+        for (const auto& varying : feedbackVaryings)
+            result << varying << "\n";
+    }
+    result << "separable " << isSeparable << "\n";
+    return result.str();
+}
+
 void ShaderProgram::attachShaderToProgram(std::shared_ptr<ShaderMetadata> shader)
 {
     shaders.add(shader->m_Type, shader);
@@ -6,11 +6,16 @@
 *
 *****************************************************************************/
 
+#include <future>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
+#include "pipeline/pipeline_injector.hpp"
 #include "pipeline/program_metadata.hpp"
 #include "utils/context_tracker.hpp"
 
@@ -35,7 +40,10 @@ namespace trackers
         GLenum m_Type = 0;
 
         /// Preprocessed (expanded macros) source code of original shader as created by application
-        std::string preprocessedSourceCode;
+        /// (preprocessing may still run on worker thread, see ShaderManager::shaderSource)
+        std::shared_future<std::string> preprocessedSourceCode;
+        /// Get preprocessed source code (waits for pending preprocessing)
+        const std::string& getPreprocessedSourceCode() const;
 
         /// Helper: is shader one of type {VS, GS, etc}
         bool isShaderOneOf(const std::unordered_set<GLenum>& allowedTypes);
@@ -44,6 +52,44 @@ namespace trackers
         const std::string getTypeAsString() const;
     };
 
+    /**
+     * \brief Caches locations of injector-owned uniforms of a single program
+     *
+     * Locations are resolved once, right after the program is linked, so that
+     * draw calls don't have to query them by name (-1 = uniform is not active).
+     */
+    struct InjectorUniformLocations
+    {
+        GLint identity = -1;
+        GLint maxViews = -1;
+        GLint maxInvocations = -1;
+        GLint xShiftMultiplier = -1;
+        GLint frontalDistance = -1;
+        GLint deprojection = -1;
+        GLint deprojectionInv = -1;
+        GLint isOrthogonal = -1;
+        GLint isSingleViewActivated = -1;
+        GLint singleViewID = -1;
+        GLint instancedViews = -1;
+
+        /// Location of application's transformation matrix (as detected during injection)
+        GLint transformationMatrix = -1;
+
+        /// Locations of FS's sampler, redirectable to layered (shadowed) texture (see ProgramMetadata::m_LayeredSamplers)
+        struct LayeredSampler
+        {
+            GLint sampler = -1;
+            GLint layeredSampler = -1;
+            GLint isLayered = -1;
+        };
+        std::vector<LayeredSampler> layeredSamplers;
+
+        /// Index of injector's per-frame uniform block (GL_INVALID_INDEX = parameters are loose uniforms)
+        GLuint parametersBlock = GL_INVALID_INDEX;
+
+        bool hasParametersBlock() const { return parametersBlock != GL_INVALID_INDEX; }
+    };
+
     /**
      * \brief Tracks program metadata (such as attached shaders and results of injection)
      */
@@ -54,6 +100,48 @@ namespace trackers
         /// Metadata are created as a result of injection
         std::unique_ptr<hi::pipeline::ProgramMetadata> m_Metadata;
 
+        /// Injection of attached shaders, speculatively started on worker thread (see ShaderManager::attachShader)
+        struct PendingInjection
+        {
+            /// Key of injected pipeline & parameters (see PipelineInjector::getCacheKey)
+            std::string cacheKey;
+            hi::pipeline::PipelineInjector::PipelineProcessResult result;
+        };
+        std::future<PendingInjection> m_PendingInjection;
+
+        /// Submitted compilation & link, whose result hasn't been queried yet (see ShaderManager::resolveLink)
+        struct PendingLink
+        {
+            /// Shaders of injected pipeline, attached to program
+            std::vector<GLuint> shaders;
+            /// Shaders of application's original pipeline (compiled ahead only with parallel compilation)
+            std::vector<GLuint> fallbackShaders;
+            hi::pipeline::PipelineInjector::PipelineType injectedPipeline;
+            hi::pipeline::PipelineInjector::PipelineType originalPipeline;
+            /// Key of program binary cache's entry
+            std::string binaryKey;
+        };
+        std::optional<PendingLink> m_PendingLink;
+        bool hasPendingLink() const { return m_PendingLink.has_value(); }
+
+        /// Application's state, which is applied when program is linked (and baked into its binary)
+        struct PreLinkState
+        {
+            /// glBindAttribLocation: name => index
+            std::map<std::string, GLuint> attributeLocations;
+            /// glBindFragDataLocation(Indexed): name => (color, index)
+            std::map<std::string, std::pair<GLuint, GLuint>> fragmentDataLocations;
+            /// glTransformFeedbackVaryings
+            std::vector<std::string> feedbackVaryings;
+            GLenum feedbackBufferMode = 0;
+            /// glProgramParameteri(GL_PROGRAM_SEPARABLE)
+            bool isSeparable = false;
+
+            /// Serialize (e.g. as a part of program binary cache's key)
+            std::string toString() const;
+        };
+        PreLinkState m_PreLinkState;
+
         struct UniformBlock
         {
             size_t location = -1;
@@ -62,6 +150,26 @@ namespace trackers
         };
         std::unordered_map<std::string, UniformBlock> m_UniformBlocks;
 
+        /// Cached locations of injector's uniforms (valid after resolveUniformLocations())
+        InjectorUniformLocations m_InjectorUniforms;
+
+        /// Texture units, assigned to original samplers of m_InjectorUniforms.layeredSamplers (by index)
+        std::vector<GLint> m_LayeredSamplerUnits;
+        /// Mirror texture units, assigned by application to uniforms starting at location (glUniform1i(v))
+        void setSamplerUnits(GLint location, GLsizei count, const GLint* units);
+
+        /// Application's original sources of program, injected with GL_OVR_multiview (see SingleViewVariantManager)
+        hi::pipeline::PipelineInjector::PipelineType m_OriginalPipeline;
+        /// Value of link epoch, when program has been linked last time (identifies the link)
+        size_t m_LinkStamp = 0;
+        /// Incremented whenever application updates program's uniforms or uniform block bindings
+        size_t m_UniformEpoch = 0;
+
+        /// Query & cache locations of injector's uniforms and initial texture units of samplers (program must be linked)
+        void resolveUniformLocations(GLuint programId);
+        /// Counter, incremented whenever any program's metadata & locations are resolved (i.e. program is linked)
+        static size_t getLinkEpoch();
+
         /// Set binding index of Uniform Block with location
         void updateUniformBlock(size_t location, size_t bindingIndex);
         bool hasUniformBlock(const std::string& name) const;
@@ -0,0 +1,259 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        trackers/state_tracker.cpp
+*
+*****************************************************************************/
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GL/gl.h>
+
+#include "logger.hpp"
+#include "state_tracker.hpp"
+#include "utils/opengl_utils.hpp"
+#include <algorithm>
+
+using namespace hi;
+using namespace hi::trackers;
+
+void StateTracker::synchronize()
+{
+    for (size_t slot = 0; slot < bufferTargets.size(); slot++)
+    {
+        GLint buffer = 0;
+        glGetIntegerv(getBufferBindingQuery(bufferTargets[slot]), &buffer);
+        m_Buffers[slot] = buffer;
+    }
+    for (size_t slot = 0; slot < capabilities.size(); slot++)
+    {
+        m_Capabilities[slot] = glIsEnabled(capabilities[slot]);
+    }
+    GLint vertexArray = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+    m_VertexArray = vertexArray;
+}
+
+void StateTracker::bindBuffer(GLenum target, GLuint buffer)
+{
+    const auto slot = getBufferSlot(target);
+    if (slot == bufferTargets.size())
+        return;
+    m_Buffers[slot] = buffer;
+}
+
+void StateTracker::deleteBuffer(GLuint buffer)
+{
+    if (buffer == 0)
+        return;
+    std::replace(m_Buffers.begin(), m_Buffers.end(), buffer, 0u);
+}
+
+GLuint StateTracker::getBoundBuffer(GLenum target) const
+{
+    const auto slot = getBufferSlot(target);
+    if (slot == bufferTargets.size())
+    {
+        GLint buffer = 0;
+        glGetIntegerv(getBufferBindingQuery(target), &buffer);
+        return buffer;
+    }
+    return m_Buffers[slot];
+}
+
+void StateTracker::setCapability(GLenum capability, bool isEnabled)
+{
+    const auto slot = getCapabilitySlot(capability);
+    if (slot == capabilities.size())
+        return;
+    m_Capabilities[slot] = isEnabled;
+}
+
+void StateTracker::setCapability(GLenum capability, GLuint index, bool isEnabled)
+{
+    if (index != 0)
+        return;
+    setCapability(capability, isEnabled);
+}
+
+bool StateTracker::isEnabled(GLenum capability) const
+{
+    const auto slot = getCapabilitySlot(capability);
+    if (slot == capabilities.size())
+    {
+        return glIsEnabled(capability);
+    }
+    return m_Capabilities[slot];
+}
+
+void StateTracker::bindVertexArray(GLuint vertexArray)
+{
+    m_VertexArray = vertexArray;
+}
+
+void StateTracker::deleteVertexArray(GLuint vertexArray)
+{
+    if (vertexArray == 0)
+        return;
+    m_InstancedBindings.erase(vertexArray);
+    if (m_VertexArray == vertexArray)
+        m_VertexArray = 0;
+}
+
+void StateTracker::setBindingDivisor(GLuint vertexArray, GLuint bindingIndex, GLuint divisor)
+{
+    const uint64_t bit = uint64_t(1) << std::min<GLuint>(bindingIndex, 63);
+    auto& bindings = m_InstancedBindings[vertexArray];
+    bindings = (divisor != 0 ? (bindings | bit) : (bindings & ~bit));
+}
+
+GLuint StateTracker::getBoundVertexArray() const
+{
+    return m_VertexArray;
+}
+
+bool StateTracker::hasInstancedAttributes() const
+{
+    auto it = m_InstancedBindings.find(m_VertexArray);
+    return it != m_InstancedBindings.end() && it->second != 0;
+}
+
+void StateTracker::setClientActiveTexture(GLenum texture)
+{
+    m_ClientActiveTexture = texture;
+}
+
+GLenum StateTracker::getClientActiveTexture() const
+{
+    return m_ClientActiveTexture;
+}
+
+void StateTracker::pushClientAttributes(GLbitfield mask)
+{
+    m_ClientAttributeStack.emplace_back(mask, m_ClientActiveTexture);
+}
+
+void StateTracker::popClientAttributes()
+{
+    if (m_ClientAttributeStack.empty())
+        return;
+    const auto [mask, saved] = m_ClientAttributeStack.back();
+    m_ClientAttributeStack.pop_back();
+    if (mask & GL_CLIENT_VERTEX_ARRAY_BIT)
+        m_ClientActiveTexture = saved;
+}
+
+void StateTracker::beginList(GLuint list)
+{
+    m_List = list;
+}
+
+void StateTracker::endList()
+{
+    m_List = 0;
+}
+
+bool StateTracker::isCompilingList() const
+{
+    return m_List != 0;
+}
+
+void StateTracker::pushAttributes(GLbitfield mask)
+{
+    m_AttributeStack.emplace_back(mask, m_Capabilities);
+}
+
+void StateTracker::popAttributes()
+{
+    if (m_AttributeStack.empty())
+        return;
+    const auto [mask, saved] = m_AttributeStack.back();
+    m_AttributeStack.pop_back();
+    for (size_t slot = 0; slot < capabilities.size(); slot++)
+    {
+        if (capabilityGroups[slot] & mask)
+            m_Capabilities[slot] = saved[slot];
+    }
+}
+
+bool StateTracker::validate() const
+{
+    bool isConsistent = true;
+    for (size_t slot = 0; slot < bufferTargets.size(); slot++)
+    {
+        GLint buffer = 0;
+        glGetIntegerv(getBufferBindingQuery(bufferTargets[slot]), &buffer);
+        if (static_cast<GLuint>(buffer) != m_Buffers[slot])
+        {
+            Logger::logError("State mirror: buffer binding of ", opengl_utils::getEnumStringRepresentation(bufferTargets[slot]),
+                " is ", buffer, ", mirrored ", m_Buffers[slot], HI_POS);
+            isConsistent = false;
+        }
+    }
+    for (size_t slot = 0; slot < capabilities.size(); slot++)
+    {
+        const bool isEnabled = glIsEnabled(capabilities[slot]);
+        if (isEnabled != m_Capabilities[slot])
+        {
+            Logger::logError("State mirror: capability ", opengl_utils::getEnumStringRepresentation(capabilities[slot]),
+                " is ", isEnabled, ", mirrored ", m_Capabilities[slot], HI_POS);
+            isConsistent = false;
+        }
+    }
+    GLint vertexArray = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+    if (static_cast<GLuint>(vertexArray) != m_VertexArray)
+    {
+        Logger::logError("State mirror: GL_VERTEX_ARRAY_BINDING is ", vertexArray, ", mirrored ", m_VertexArray, HI_POS);
+        isConsistent = false;
+    }
+    return isConsistent;
+}
+
+size_t StateTracker::getBufferSlot(GLenum target)
+{
+    return std::distance(bufferTargets.begin(), std::find(bufferTargets.begin(), bufferTargets.end(), target));
+}
+
+size_t StateTracker::getCapabilitySlot(GLenum capability)
+{
+    return std::distance(capabilities.begin(), std::find(capabilities.begin(), capabilities.end(), capability));
+}
+
+GLenum StateTracker::getBufferBindingQuery(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:
+        return GL_ARRAY_BUFFER_BINDING;
+    case GL_ATOMIC_COUNTER_BUFFER:
+        return GL_ATOMIC_COUNTER_BUFFER_BINDING;
+    case GL_COPY_READ_BUFFER:
+        return GL_COPY_READ_BUFFER_BINDING;
+    case GL_COPY_WRITE_BUFFER:
+        return GL_COPY_WRITE_BUFFER_BINDING;
+    case GL_DISPATCH_INDIRECT_BUFFER:
+        return GL_DISPATCH_INDIRECT_BUFFER_BINDING;
+    case GL_DRAW_INDIRECT_BUFFER:
+        return GL_DRAW_INDIRECT_BUFFER_BINDING;
+    case GL_ELEMENT_ARRAY_BUFFER:
+        return GL_ELEMENT_ARRAY_BUFFER_BINDING;
+    case GL_PIXEL_PACK_BUFFER:
+        return GL_PIXEL_PACK_BUFFER_BINDING;
+    case GL_PIXEL_UNPACK_BUFFER:
+        return GL_PIXEL_UNPACK_BUFFER_BINDING;
+    case GL_QUERY_BUFFER:
+        return GL_QUERY_BUFFER_BINDING;
+    case GL_SHADER_STORAGE_BUFFER:
+        return GL_SHADER_STORAGE_BUFFER_BINDING;
+    case GL_TEXTURE_BUFFER:
+        return GL_TEXTURE_BUFFER_BINDING;
+    case GL_TRANSFORM_FEEDBACK_BUFFER:
+        return GL_TRANSFORM_FEEDBACK_BUFFER_BINDING;
+    case GL_UNIFORM_BUFFER:
+        return GL_UNIFORM_BUFFER_BINDING;
+    default:
+        Logger::logError("Unknown buffer target: ", target, HI_POS);
+        return GL_NONE;
+    }
+}
@@ -0,0 +1,178 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        trackers/state_tracker.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_STATE_TRACKER_HPP
+#define HI_STATE_TRACKER_HPP
+
+#include "GL/gl.h"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hi
+{
+namespace trackers
+{
+    /**
+     * \brief Client-side mirror of buffer bindings and capabilities (glEnable/glDisable)
+     *
+     * Querying OpenGL state with glGet*() / glIsEnabled() forces a client-server round trip
+     * in threaded drivers (e.g. Mesa's glthread). Instead, the state is mirrored from intercepted
+     * calls and only synchronized with OpenGL once, when the context is made current.
+     *
+     * The rest of binding state is mirrored by other trackers:
+     * - textures per unit & target and active unit by TextureTracker
+     * - current program by ShaderTracker
+     * - bound FBO by FramebufferTracker
+     * - bound renderbuffer by RenderbufferTracker
+     *
+     * GL_ELEMENT_ARRAY_BUFFER is part of VAO's state, thus it is not mirrored. Of vertex array
+     * state, only bound VAO and its instanced (divisor != 0) bindings are mirrored. Compiled
+     * display list is only tracked from glNewList()/glEndList() (GL_LIST_INDEX isn't synchronized).
+     * Neither is client active texture unit, which is unknown to core profile, thus mirror starts at
+     * GL_TEXTURE0 (context is initialized before application's first call).
+     */
+    class StateTracker
+    {
+    public:
+        /// Fetch mirrored state from OpenGL (expects current context)
+        void synchronize();
+
+        /// Track glBindBuffer() and generic binding side effect of glBindBufferBase/Range()
+        void bindBuffer(GLenum target, GLuint buffer);
+        /// Track glDeleteBuffers(): deleted buffers are unbound from all targets
+        void deleteBuffer(GLuint buffer);
+        /// Get buffer, bound to target (untracked targets are queried from OpenGL)
+        GLuint getBoundBuffer(GLenum target) const;
+
+        /// Track glEnable()/glDisable()
+        void setCapability(GLenum capability, bool isEnabled);
+        /// Track glEnablei()/glDisablei() (mirror holds index 0, which glIsEnabled() returns)
+        void setCapability(GLenum capability, GLuint index, bool isEnabled);
+        /// Equivalent of glIsEnabled() (untracked capabilities are queried from OpenGL)
+        bool isEnabled(GLenum capability) const;
+
+        /// Track glBindVertexArray()
+        void bindVertexArray(GLuint vertexArray);
+        /// Track glDeleteVertexArrays()
+        void deleteVertexArray(GLuint vertexArray);
+        /// Track glVertexAttribDivisor() / glVertexBindingDivisor() (vertexArray = bound VAO for non-DSA)
+        void setBindingDivisor(GLuint vertexArray, GLuint bindingIndex, GLuint divisor);
+        GLuint getBoundVertexArray() const;
+        /// Determine if bound VAO fetches any attribute per instance
+        bool hasInstancedAttributes() const;
+
+        /// Track glClientActiveTexture()
+        void setClientActiveTexture(GLenum texture);
+        /// Equivalent of glGetIntegerv(GL_CLIENT_ACTIVE_TEXTURE)
+        GLenum getClientActiveTexture() const;
+        /// Track glPushClientAttrib()
+        void pushClientAttributes(GLbitfield mask);
+        /// Track glPopClientAttrib(): restore client active texture, saved by matching glPushClientAttrib()
+        void popClientAttributes();
+
+        /// Track glNewList()/glEndList()
+        void beginList(GLuint list);
+        void endList();
+        /// Equivalent of glGetIntegerv(GL_LIST_INDEX) != 0, i.e. draw calls are compiled into application's list
+        bool isCompilingList() const;
+
+        /// Track glPushAttrib(): store capabilities, which are restored by glPopAttrib()
+        void pushAttributes(GLbitfield mask);
+        /// Track glPopAttrib(): restore capabilities of groups, saved by matching glPushAttrib()
+        void popAttributes();
+
+        /// Compare mirror with OpenGL state and log each mismatch. Returns true if consistent
+        bool validate() const;
+
+    private:
+        /// Buffer targets, tracked by mirror
+        static constexpr std::array<GLenum, 12> bufferTargets = {
+            GL_ARRAY_BUFFER,
+            GL_ATOMIC_COUNTER_BUFFER,
+            GL_COPY_READ_BUFFER,
+            GL_COPY_WRITE_BUFFER,
+            GL_DISPATCH_INDIRECT_BUFFER,
+            GL_DRAW_INDIRECT_BUFFER,
+            GL_PIXEL_PACK_BUFFER,
+            GL_PIXEL_UNPACK_BUFFER,
+            GL_SHADER_STORAGE_BUFFER,
+            GL_TEXTURE_BUFFER,
+            GL_TRANSFORM_FEEDBACK_BUFFER,
+            GL_UNIFORM_BUFFER,
+        };
+
+        /// Capabilities, tracked by mirror
+        static constexpr std::array<GLenum, 16> capabilities = {
+            GL_BLEND,
+            GL_COLOR_LOGIC_OP,
+            GL_CULL_FACE,
+            GL_DEPTH_CLAMP,
+            GL_DEPTH_TEST,
+            GL_DITHER,
+            GL_FRAMEBUFFER_SRGB,
+            GL_LINE_SMOOTH,
+            GL_MULTISAMPLE,
+            GL_POLYGON_OFFSET_FILL,
+            GL_PRIMITIVE_RESTART,
+            GL_PROGRAM_POINT_SIZE,
+            GL_RASTERIZER_DISCARD,
+            GL_SAMPLE_ALPHA_TO_COVERAGE,
+            GL_SCISSOR_TEST,
+            GL_STENCIL_TEST,
+        };
+
+        /// Attribute groups of capabilities (see 'Attribute groups' of OpenGL compatibility profile)
+        static constexpr std::array<GLbitfield, capabilities.size()> capabilityGroups = {
+            GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT,
+            GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT,
+            GL_ENABLE_BIT | GL_POLYGON_BIT,
+            GL_ENABLE_BIT | GL_TRANSFORM_BIT,
+            GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT,
+            GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT,
+            GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT,
+            GL_ENABLE_BIT | GL_LINE_BIT,
+            GL_ENABLE_BIT | GL_MULTISAMPLE_BIT,
+            GL_ENABLE_BIT | GL_POLYGON_BIT,
+            // Client (vertex array) state, not affected by glPushAttrib()
+            0,
+            GL_ENABLE_BIT,
+            // Transform feedback state, not affected by glPushAttrib()
+            0,
+            GL_ENABLE_BIT | GL_MULTISAMPLE_BIT,
+            GL_ENABLE_BIT | GL_SCISSOR_BIT,
+            GL_ENABLE_BIT | GL_STENCIL_BUFFER_BIT,
+        };
+
+        /// Get index of target in bufferTargets or bufferTargets.size() when not tracked
+        static size_t getBufferSlot(GLenum target);
+        /// Get index of capability in capabilities or capabilities.size() when not tracked
+        static size_t getCapabilitySlot(GLenum capability);
+        /// Get enum for glGetIntegerv, which returns binding of target
+        static GLenum getBufferBindingQuery(GLenum target);
+
+        std::array<GLuint, bufferTargets.size()> m_Buffers = {};
+        std::array<bool, capabilities.size()> m_Capabilities = {};
+        /// Attribute stack (glPushAttrib), mask & capabilities before push
+        std::vector<std::pair<GLbitfield, std::array<bool, capabilities.size()>>> m_AttributeStack;
+
+        GLuint m_VertexArray = 0;
+        /// GL_CLIENT_ACTIVE_TEXTURE
+        GLenum m_ClientActiveTexture = GL_TEXTURE0;
+        /// Client attribute stack (glPushClientAttrib), mask & client active texture before push
+        std::vector<std::pair<GLbitfield, GLenum>> m_ClientAttributeStack;
+        /// List, compiled by application (GL_LIST_INDEX)
+        GLuint m_List = 0;
+        /// Bitmask of bindings with non-zero divisor per VAO (bindings above 63 share the last bit)
+        std::unordered_map<GLuint, uint64_t> m_InstancedBindings;
+    };
+} //namespace trackers
+} //namespace hi
+#endif
@@ -12,13 +12,23 @@
 #include "logger.hpp"
 #include "texture_tracker.hpp"
 #include "utils/opengl_debug.hpp"
+#include "utils/opengl_objects.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <limits>
 
 using namespace hi;
 using namespace hi::trackers;
 
 namespace helper
 {
+/// Incremented whenever a shadow texture is created or freed (by any context's thread)
+std::atomic<size_t> shadowEpoch = 1;
+
+/// Marks pooled view, which has failed to be created (e.g. format doesn't support views)
+constexpr GLuint failedTextureView = std::numeric_limits<GLuint>::max();
+
 template <typename T>
 inline T max(T a, T b)
 {
@@ -31,7 +41,9 @@ inline T max(T a, T b)
 //-----------------------------------------------------------------------------
 TextureMetadata::~TextureMetadata()
 {
-    deinitialize();
+    // Context may be gone (see AbandonOpenGLObjectsRAII)
+    if (!utils::AbandonOpenGLObjectsRAII::isActive())
+        deinitialize();
 }
 
 TextureType TextureMetadata::getPhysicalTextureType()
@@ -41,19 +53,14 @@ TextureType TextureMetadata::getPhysicalTextureType()
 
 void TextureMetadata::deinitialize()
 {
-    GLuint textures[2];
-    size_t numOfTextures = 0;
+    freeTextureViews();
     if (m_shadowedLayerVersionId)
     {
-        textures[numOfTextures++] = m_shadowedLayerVersionId;
+        GLuint id = m_shadowedLayerVersionId;
+        glDeleteTextures(1, &id);
         m_shadowedLayerVersionId = 0;
+        incrementShadowEpoch();
     }
-    if (m_shadowTextureViewId)
-    {
-        textures[numOfTextures++] = m_shadowTextureViewId;
-        m_shadowTextureViewId = 0;
-    }
-    glDeleteTextures(numOfTextures, textures);
 }
 
 void TextureMetadata::setStorage(GLenum type, size_t width, size_t height, size_t levels, size_t layers, GLenum internalFormat)
@@ -164,6 +171,7 @@ void TextureMetadata::createShadowedTexture(size_t numOfLayers)
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
     m_shadowedLayerVersionId = textures[0];
+    incrementShadowEpoch();
 
     // set texture view as original texture
     setTextureViewToLayer(0);
@@ -171,41 +179,75 @@ void TextureMetadata::createShadowedTexture(size_t numOfLayers)
 
 void TextureMetadata::freeShadowedTexture()
 {
-    if (m_shadowTextureViewId)
-    {
-        GLuint id = m_shadowTextureViewId;
-        glDeleteTextures(1, &id);
-        m_shadowTextureViewId = 0;
-    }
+    freeTextureViews();
     if (m_shadowedLayerVersionId)
     {
         GLuint id = m_shadowedLayerVersionId;
         glDeleteTextures(1, &id);
         m_shadowedLayerVersionId = 0;
+        incrementShadowEpoch();
     }
 }
 
-void TextureMetadata::setTextureViewToLayer(size_t layer)
+void TextureMetadata::freeTextureViews()
 {
-    CLEAR_GL_ERROR();
-    GLuint viewId = m_shadowTextureViewId;
-    assert(m_shadowedLayerVersionId != 0);
-    // If view already exists, delete it
-    if (m_shadowTextureViewId)
+    for (auto& [target, views] : m_shadowTextureViews)
     {
-        glDeleteTextures(1, &viewId);
+        views.erase(std::remove_if(views.begin(), views.end(), [](GLuint view) { return view == 0 || view == helper::failedTextureView; }), views.end());
+        glDeleteTextures(views.size(), views.data());
     }
+    m_shadowTextureViews.clear();
     m_shadowTextureViewId = 0;
+}
+
+size_t TextureMetadata::getShadowEpoch()
+{
+    return helper::shadowEpoch.load(std::memory_order_relaxed);
+}
+
+void TextureMetadata::incrementShadowEpoch()
+{
+    helper::shadowEpoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t TextureMetadata::getTextureViewOfLayer(size_t layer, GLenum target)
+{
+    assert(m_shadowedLayerVersionId != 0);
+    auto& views = m_shadowTextureViews[target];
+    if (views.size() <= layer)
+    {
+        views.resize(layer + 1, 0);
+    }
+    if (views[layer] == helper::failedTextureView)
+    {
+        return 0;
+    }
+    if (views[layer])
+    {
+        return views[layer];
+    }
+
+    CLEAR_GL_ERROR();
+    GLuint viewId = 0;
     glGenTextures(1, &viewId);
-    Logger::logDebugPerFrame("Creating texture view (layer = ", layer, ") for ", TextureMetadata::getFormatAsString(getFormat()), " with res: ", getWidth(), "x", getHeight());
-    glTextureView(viewId, GL_TEXTURE_2D, m_shadowedLayerVersionId, getFormat(), 0, 1, layer, 1);
+    Logger::logDebug("Creating texture view (layer = ", layer, ") for ", TextureMetadata::getFormatAsString(getFormat()), " with res: ", getWidth(), "x", getHeight());
+    glTextureView(viewId, target, m_shadowedLayerVersionId, getFormat(), 0, 1, layer, 1);
     auto textureViewError = glGetError();
     if (textureViewError != GL_NO_ERROR)
     {
         Logger::logError(" Failed to create texture view.: ", hi::debug::convertErrorToString(textureViewError), HI_POS);
-        return;
+        glDeleteTextures(1, &viewId);
+        // Don't retry (and stall on glGetError) for each draw, until shadow texture is recreated
+        views[layer] = helper::failedTextureView;
+        return 0;
     }
-    m_shadowTextureViewId = viewId;
+    views[layer] = viewId;
+    return viewId;
+}
+
+void TextureMetadata::setTextureViewToLayer(size_t layer)
+{
+    m_shadowTextureViewId = getTextureViewOfLayer(layer);
 }
 
 std::string TextureMetadata::getTypeAsString(GLenum type)
@@ -308,37 +350,127 @@ std::string TextureMetadata::getFormatAsString(GLenum type)
 //-----------------------------------------------------------------------------
 // TextureUnitTracker
 //-----------------------------------------------------------------------------
-bool TextureUnitTracker::hasShadowedTextureBinded() const
+size_t TextureUnitTracker::getTargetSlot(GLenum target)
 {
-    for (auto& [id, unit] : getConstMap())
+    switch (target)
     {
-        for (auto& [target, texture] : unit->getConstMap())
+    case GL_TEXTURE_1D:
+        return SLOT_1D;
+    case GL_TEXTURE_1D_ARRAY:
+        return SLOT_1D_ARRAY;
+    case GL_TEXTURE_2D:
+    case GL_PROXY_TEXTURE_2D:
+        return SLOT_2D;
+    case GL_TEXTURE_2D_ARRAY:
+        return SLOT_2D_ARRAY;
+    case GL_TEXTURE_2D_MULTISAMPLE:
+        return SLOT_2D_MULTISAMPLE;
+    case GL_TEXTURE_2D_MULTISAMPLE_ARRAY:
+        return SLOT_2D_MULTISAMPLE_ARRAY;
+    case GL_TEXTURE_3D:
+        return SLOT_3D;
+    case GL_TEXTURE_CUBE_MAP:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+        return SLOT_CUBE_MAP;
+    case GL_TEXTURE_CUBE_MAP_ARRAY:
+        return SLOT_CUBE_MAP_ARRAY;
+    case GL_TEXTURE_RECTANGLE:
+        return SLOT_RECTANGLE;
+    case GL_TEXTURE_BUFFER:
+        return SLOT_BUFFER;
+    default:
+        return SLOT_COUNT;
+    }
+}
+
+GLenum TextureUnitTracker::getSlotTarget(size_t slot)
+{
+    static constexpr GLenum targets[SLOT_COUNT] = {
+        GL_TEXTURE_1D,
+        GL_TEXTURE_1D_ARRAY,
+        GL_TEXTURE_2D,
+        GL_TEXTURE_2D_ARRAY,
+        GL_TEXTURE_2D_MULTISAMPLE,
+        GL_TEXTURE_2D_MULTISAMPLE_ARRAY,
+        GL_TEXTURE_3D,
+        GL_TEXTURE_CUBE_MAP,
+        GL_TEXTURE_CUBE_MAP_ARRAY,
+        GL_TEXTURE_RECTANGLE,
+        GL_TEXTURE_BUFFER,
+    };
+    assert(slot < SLOT_COUNT);
+    return targets[slot];
+}
+
+void TextureUnitTracker::updateShadowedUnit(size_t unit) const
+{
+    const auto& bindings = m_Units[unit];
+    const bool hasShadowed = std::any_of(bindings.begin(), bindings.end(), [](const auto& texture) {
+        return texture && texture->hasShadowTexture();
+    });
+    const auto bit = uint64_t(1) << (unit % maskWordBits);
+    auto& word = m_ShadowedUnits[unit / maskWordBits];
+    word = hasShadowed ? (word | bit) : (word & ~bit);
+}
+
+void TextureUnitTracker::validateShadowedUnits() const
+{
+    const auto epoch = TextureMetadata::getShadowEpoch();
+    if (m_ShadowedUnitsEpoch == epoch)
+        return;
+    m_ShadowedUnitsEpoch = epoch;
+    for (size_t unit = 0; unit < maxUnits; unit++)
+    {
+        updateShadowedUnit(unit);
+    }
+}
+
+template <typename F>
+void TextureUnitTracker::forEachShadowedUnit(F func) const
+{
+    for (size_t wordId = 0; wordId < maskWords; wordId++)
+    {
+        auto word = m_ShadowedUnits[wordId];
+        while (word)
         {
-            if (texture->hasShadowTexture())
-                return true;
+            const auto bit = static_cast<size_t>(__builtin_ctzll(word));
+            word &= word - 1;
+            func(wordId * maskWordBits + bit);
         }
     }
-    return false;
+}
+
+bool TextureUnitTracker::hasShadowedTextureBinded() const
+{
+    validateShadowedUnits();
+    uint64_t mask = 0;
+    for (const auto word : m_ShadowedUnits)
+        mask |= word;
+    return mask != 0;
 }
 
 void TextureUnitTracker::bindShadowedTexturesToLayer(size_t layer)
 {
-    GLint id;
-    glGetIntegerv(GL_ACTIVE_TEXTURE, &id);
-    for (auto& [id, unit] : getMap())
-    {
-        assert(id <= 80);
-        for (auto& [target, texture] : unit->getMap())
+    validateShadowedUnits();
+    forEachShadowedUnit([&](size_t unit) {
+        auto& bindings = m_Units[unit];
+        for (size_t slot = 0; slot < SLOT_COUNT; slot++)
         {
-            if (!texture->hasShadowTexture())
+            auto& texture = bindings[slot];
+            if (!texture || !texture->hasShadowTexture())
                 continue;
             texture->setTextureViewToLayer(layer);
-            glActiveTexture(GL_TEXTURE0 + id);
+            glActiveTexture(GL_TEXTURE0 + unit);
             auto textureView = texture->getTextureViewIdOfShadowedTexture();
             if (textureView)
             {
                 Logger::logDebugPerFrame("TU: bindShadowTexture (", texture->getID(), " -> ", textureView, HI_POS);
-                glBindTexture(target, textureView);
+                glBindTexture(getSlotTarget(slot), textureView);
                 ASSERT_GL_ERROR();
             }
             else
@@ -346,50 +478,116 @@ void TextureUnitTracker::bindShadowedTexturesToLayer(size_t layer)
                 Logger::logError("TU: Texture has shadowed texture,but not view", HI_POS);
             }
         }
-    }
-    glActiveTexture(id);
+    });
+    glActiveTexture(GL_TEXTURE0 + m_ActiveUnit);
 }
 
 void TextureUnitTracker::unbindShadowedTextures()
 {
-    GLint id;
-    glGetIntegerv(GL_ACTIVE_TEXTURE, &id);
-    for (auto& [id, unit] : getMap())
-    {
-        assert(id <= 80);
-        for (auto& [target, texture] : unit->getMap())
+    validateShadowedUnits();
+    forEachShadowedUnit([&](size_t unit) {
+        auto& bindings = m_Units[unit];
+        for (size_t slot = 0; slot < SLOT_COUNT; slot++)
         {
-            glActiveTexture(GL_TEXTURE0 + id);
-            glBindTexture(target, texture->getID());
+            auto& texture = bindings[slot];
+            if (!texture || !texture->hasShadowTexture())
+                continue;
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(getSlotTarget(slot), texture->getID());
         }
-    }
-    glActiveTexture(id);
+    });
+    glActiveTexture(GL_TEXTURE0 + m_ActiveUnit);
 }
 
-void TextureUnitTracker::activate(size_t id)
+bool TextureUnitTracker::isUnitShadowed(size_t unit) const
 {
-    baseType::bind(id);
+    if (unit >= maxUnits)
+        return false;
+    validateShadowedUnits();
+    return m_ShadowedUnits[unit / maskWordBits] & (uint64_t(1) << (unit % maskWordBits));
 }
 
-void TextureUnitTracker::bind(size_t target, std::shared_ptr<TextureMetadata> texture)
+void TextureUnitTracker::bindShadowedTexturesAsArrays()
 {
-    if (texture == nullptr)
-    {
-        if (!has(getBoundId()))
+    validateShadowedUnits();
+    forEachShadowedUnit([&](size_t unit) {
+        const auto& texture = m_Units[unit][SLOT_2D];
+        if (!texture || !texture->hasShadowTexture())
             return;
-        get(getBoundId())->remove(target);
-    }
-    else
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture->getShadowedTextureId());
+        ASSERT_GL_ERROR();
+    });
+    glActiveTexture(GL_TEXTURE0 + m_ActiveUnit);
+}
+
+void TextureUnitTracker::unbindShadowedTextureArrays()
+{
+    validateShadowedUnits();
+    forEachShadowedUnit([&](size_t unit) {
+        const auto& texture = m_Units[unit][SLOT_2D];
+        if (!texture || !texture->hasShadowTexture())
+            return;
+        const auto& applicationArray = m_Units[unit][SLOT_2D_ARRAY];
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, applicationArray ? applicationArray->getID() : 0);
+    });
+    glActiveTexture(GL_TEXTURE0 + m_ActiveUnit);
+}
+
+size_t TextureUnitTracker::getReservedUnit(GLenum samplerTarget)
+{
+    static const size_t countOfUnits = [] {
+        GLint count = 0;
+        glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &count);
+        return helper::max<size_t>(count, 2);
+    }();
+    return (samplerTarget == GL_TEXTURE_2D_ARRAY ? countOfUnits - 1 : countOfUnits - 2);
+}
+
+std::shared_ptr<TextureMetadata> TextureUnitTracker::getBoundTexture(GLenum target) const
+{
+    const auto slot = getTargetSlot(target);
+    if (m_ActiveUnit >= maxUnits || slot == SLOT_COUNT)
+        return nullptr;
+    return m_Units[m_ActiveUnit][slot];
+}
+
+size_t TextureUnitTracker::getActiveUnit() const
+{
+    return m_ActiveUnit;
+}
+
+void TextureUnitTracker::activate(size_t id)
+{
+    m_ActiveUnit = id;
+}
+
+void TextureUnitTracker::bind(GLenum target, std::shared_ptr<TextureMetadata> texture)
+{
+    bindToUnit(m_ActiveUnit, target, std::move(texture));
+}
+
+void TextureUnitTracker::bindToUnit(size_t unit, GLenum target, std::shared_ptr<TextureMetadata> texture)
+{
+    const auto slot = getTargetSlot(target);
+    if (unit >= maxUnits || slot == SLOT_COUNT)
     {
-        if (!has(getBoundId()))
-            add(getBoundId(), std::make_shared<TextureUnit>());
-        getBound()->add(target, texture);
+        Logger::logDebug("TU: untracked binding (unit: ", unit, ", target: ", TextureMetadata::getTypeAsString(target), ")", HI_POS);
+        return;
     }
+    m_Units[unit][slot] = std::move(texture);
+    updateShadowedUnit(unit);
 }
-TextureUnitTracker::MapType& TextureUnitTracker::getUnits()
+
+void TextureUnitTracker::unbindUnit(size_t unit)
 {
-    return getMap();
+    if (unit >= maxUnits)
+        return;
+    m_Units[unit].fill(nullptr);
+    updateShadowedUnit(unit);
 }
+
 //-----------------------------------------------------------------------------
 // Texture Tracker
 //-----------------------------------------------------------------------------
@@ -546,6 +744,23 @@ void TextureTracker::bind(GLenum target, size_t id)
     m_TextureUnits.bind(target, get(id));
 }
 
+void TextureTracker::bindMultiple(size_t first, size_t count, const GLuint* ids)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto unit = first + i;
+        // glBindTextures() unbinds all targets of unit for zero or NULL
+        m_TextureUnits.unbindUnit(unit);
+        if (ids == nullptr || ids[i] == 0 || !has(ids[i]))
+            continue;
+        auto texture = get(ids[i]);
+        // Texture's target is deduced from its storage, thus textures without storage are not tracked
+        if (texture->getType() == 0)
+            continue;
+        m_TextureUnits.bindToUnit(unit, texture->getType(), texture);
+    }
+}
+
 void TextureTracker::activate(size_t id)
 {
     getTextureUnits().activate(id);
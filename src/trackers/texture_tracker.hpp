@@ -9,7 +9,11 @@
 #ifndef HI_TEXTURE_TRACKER_HPP
 #define HI_TEXTURE_TRACKER_HPP
 #include "GL/gl.h"
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "pipeline/program_metadata.hpp"
 #include "utils/context_tracker.hpp"
@@ -40,6 +44,9 @@ namespace trackers
      * ## Texture views
      * To obtain a single GL_TEXTURE_2D for layered shadow texture, texture views are used to create proxy
      * textures, pointing to precise layer of shadow texture.
+     * Views are created lazily (one per layer & target) and kept in a pool until shadow texture is freed,
+     * thus rebinding to another layer doesn't create any new OpenGL object.
+     * Failed views are pooled as well, thus a view is attempted only once per shadow texture.
      */
     class TextureMetadata
     {
@@ -79,8 +86,10 @@ namespace trackers
          */
         bool hasShadowTexture() const;
         size_t getShadowedTextureId() const;
-        /// Get the most recently created texture view
+        /// Get the most recently selected texture view
         size_t getTextureViewIdOfShadowedTexture() const;
+        /// Get view of a single layer of shadow texture (created on first use, 0 on failure)
+        size_t getTextureViewOfLayer(size_t layer, GLenum target = GL_TEXTURE_2D);
 
         /// Attempt to create layered (array) version of texture
         virtual void createShadowedTexture(size_t numOfLayers = 9);
@@ -88,6 +97,11 @@ namespace trackers
         /// Set texture view to precise level of shadowed texture. Undefined behavior if shadow FBO does not exist
         void setTextureViewToLayer(size_t layer);
         void freeShadowedTexture();
+        /// Release all pooled texture views
+        void freeTextureViews();
+
+        /// Counter, incremented whenever any texture's shadow texture is created or freed
+        static size_t getShadowEpoch();
 
         /// Helper: serialize type (e.gl GL_TEXTURE_2D) to string
         static std::string getTypeAsString(GLenum type);
@@ -96,6 +110,9 @@ namespace trackers
         static std::string getFormatAsString(GLenum type);
 
     protected:
+        /// Notify observers (e.g. TextureUnitTracker) that shadow texture has been created/freed
+        static void incrementShadowEpoch();
+
         /// Resource's ID
         size_t m_Id = 0;
 
@@ -117,15 +134,10 @@ namespace trackers
          */
         /// Layered shadow texture resource ID
         size_t m_shadowedLayerVersionId = 0;
-        /// Single-layer texture, pointing to a precise layer of shadow texture
+        /// Single-layer texture, pointing to a precise layer of shadow texture (the last selected view)
         size_t m_shadowTextureViewId = 0;
-    };
-
-    /**
-     * \brief Map of <texture_type, textureID>
-     */
-    class TextureUnit : public ContextTracker<std::shared_ptr<TextureMetadata>>
-    {
+        /// Pool of single-layer views of shadow texture, indexed by [target][layer] (0 = not created yet, failures are cached)
+        std::unordered_map<GLenum, std::vector<GLuint>> m_shadowTextureViews;
     };
 
     // Forwarding due to friend class
@@ -136,11 +148,19 @@ namespace trackers
      * 
      * Such tracking is needed to bind layered (shadowed) textures for active original textures when
      * needed.
+     *
+     * Bindings are stored in a flat array, indexed by [unit][target slot]. In addition, a bitmask of
+     * units, which hold at least one shadowed texture, is maintained during binding, thus draw calls
+     * without shadowed textures are resolved by a single test and rebinding only visits set bits.
+     * As textures may gain or lose shadow texture while being bound, the mask is also recalculated
+     * whenever TextureMetadata's shadow epoch changes.
      */
-
-    class TextureUnitTracker : private BindableContextTracker<std::shared_ptr<TextureUnit>, false>
+    class TextureUnitTracker
     {
     public:
+        /// Count of tracked texture units (GL_TEXTURE0 .. GL_TEXTURE0 + maxUnits - 1)
+        static constexpr size_t maxUnits = 128;
+
         /// Has any texture with shadow texture active?
         bool hasShadowedTextureBinded() const;
 
@@ -150,16 +170,92 @@ namespace trackers
         /// Rebind to original (application's) texture
         void unbindShadowedTextures();
 
+        /// Does unit hold any texture with shadow texture?
+        bool isUnitShadowed(size_t unit) const;
+
+        /**
+         * @brief Bind whole layered shadow texture of each shadowed 2D texture to GL_TEXTURE_2D_ARRAY
+         * of the same unit
+         *
+         * Allows a single draw call to sample layer of fragment's view (see ShaderInspector::injectLayeredSamplers).
+         */
+        void bindShadowedTexturesAsArrays();
+
+        /// Restore application's GL_TEXTURE_2D_ARRAY bindings after bindShadowedTexturesAsArrays()
+        void unbindShadowedTextureArrays();
+
+        /**
+         * @brief Get texture unit, reserved by injector for samplers of given type
+         *
+         * Samplers of different types must not refer to the same unit, thus layered samplers,
+         * which are not in use, point to the last unit, and original samplers, which have been
+         * redirected, point to the one before.
+         */
+        static size_t getReservedUnit(GLenum samplerTarget);
+
+        /// Get texture, bound to target of active unit (nullptr if none)
+        std::shared_ptr<TextureMetadata> getBoundTexture(GLenum target) const;
+
+        /// Get index of active unit (mirrors GL_ACTIVE_TEXTURE - GL_TEXTURE0)
+        size_t getActiveUnit() const;
+
     protected:
         /// Track activation of texture unit with id
         void activate(size_t id);
 
-        void bind(size_t target, std::shared_ptr<TextureMetadata> texture);
-        MapType& getUnits();
+        /// Track binding of texture to target of active unit
+        void bind(GLenum target, std::shared_ptr<TextureMetadata> texture);
+
+        /// Track binding of texture to target of given unit
+        void bindToUnit(size_t unit, GLenum target, std::shared_ptr<TextureMetadata> texture);
+
+        /// Track unbinding of all targets of given unit
+        void unbindUnit(size_t unit);
         friend class TextureTracker;
 
     private:
-        using baseType = BindableContextTracker<std::shared_ptr<TextureUnit>, false>;
+        /// Compact index of texture target
+        enum TargetSlot : size_t
+        {
+            SLOT_1D,
+            SLOT_1D_ARRAY,
+            SLOT_2D,
+            SLOT_2D_ARRAY,
+            SLOT_2D_MULTISAMPLE,
+            SLOT_2D_MULTISAMPLE_ARRAY,
+            SLOT_3D,
+            SLOT_CUBE_MAP,
+            SLOT_CUBE_MAP_ARRAY,
+            SLOT_RECTANGLE,
+            SLOT_BUFFER,
+            SLOT_COUNT
+        };
+        /// Convert target (e.g. GL_TEXTURE_2D) to slot, returns SLOT_COUNT for untracked targets
+        static size_t getTargetSlot(GLenum target);
+        /// Convert slot back to target
+        static GLenum getSlotTarget(size_t slot);
+
+        /// Update bit of unit after its binding has changed
+        void updateShadowedUnit(size_t unit) const;
+        /// Recalculate whole mask if any shadow texture has been created/freed since last check
+        void validateShadowedUnits() const;
+
+        /// Call func(unit) for each unit with shadowed texture
+        template <typename F>
+        void forEachShadowedUnit(F func) const;
+
+        using UnitBindings = std::array<std::shared_ptr<TextureMetadata>, SLOT_COUNT>;
+        static constexpr size_t maskWordBits = 64;
+        static constexpr size_t maskWords = (maxUnits + maskWordBits - 1) / maskWordBits;
+
+        /// Textures, indexed by [unit][slot]
+        std::array<UnitBindings, maxUnits> m_Units;
+        /// Bitmask of units with at least a single shadowed texture
+        mutable std::array<uint64_t, maskWords> m_ShadowedUnits = {};
+        /// TextureMetadata's shadow epoch at time of the last mask validation
+        mutable size_t m_ShadowedUnitsEpoch = 0;
+        /// Currently active unit (mirrors GL_ACTIVE_TEXTURE)
+        size_t m_ActiveUnit = 0;
     };
 
     /**
@@ -176,6 +272,9 @@ namespace trackers
         /// Mark id as binded for target
         void bind(GLenum target, size_t id);
 
+        /// Mark ids as binded to consecutive units, starting with first (glBindTextures)
+        void bindMultiple(size_t first, size_t count, const GLuint* ids);
+
         /// Track activation of texture unit
         void activate(size_t id);
 
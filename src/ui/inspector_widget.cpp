@@ -74,9 +74,9 @@ inline void drawShader(trackers::ShaderMetadata& shader)
     if (ImGui::TreeNode(title.str().c_str()))
     {
         ImGui::BeginTable("Metadata", 2);
-        tableLine("Hash: ", std::to_string(std::hash<std::string>()(shader.preprocessedSourceCode)).c_str());
+        tableLine("Hash: ", std::to_string(std::hash<std::string>()(shader.getPreprocessedSourceCode())).c_str());
         ImGui::EndTable();
-        ImGui::Text(shader.preprocessedSourceCode.c_str());
+        ImGui::Text(shader.getPreprocessedSourceCode().c_str());
         ImGui::TreePop();
     }
 }
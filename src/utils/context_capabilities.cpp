@@ -0,0 +1,92 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        utils/context_capabilities.cpp
+*
+*****************************************************************************/
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GL/gl.h>
+
+#include <cctype>
+#include <sstream>
+#include <tuple>
+
+#include "utils/context_capabilities.hpp"
+
+using namespace hi;
+using namespace hi::utils;
+
+void ContextCapabilities::query()
+{
+    const auto version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    std::tie(m_Major, m_Minor) = parseVersion(version ? version : "");
+
+    m_Extensions.clear();
+    if (isVersionAtLeast(3, 0))
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const auto extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension)
+                m_Extensions.insert(extension);
+        }
+    }
+    else
+    {
+        const auto extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+        m_Extensions = parseExtensions(extensions ? extensions : "");
+    }
+
+    // Profiles are introduced by GL 3.2
+    m_IsCompatibilityProfile = true;
+    if (isVersionAtLeast(3, 2))
+    {
+        GLint profileMask = 0;
+        glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &profileMask);
+        m_IsCompatibilityProfile = (profileMask & GL_CONTEXT_COMPATIBILITY_PROFILE_BIT) != 0;
+    }
+}
+
+bool ContextCapabilities::isVersionAtLeast(int major, int minor) const
+{
+    return m_Major > major || (m_Major == major && m_Minor >= minor);
+}
+
+bool ContextCapabilities::hasExtension(const std::string& name) const
+{
+    return m_Extensions.count(name) > 0;
+}
+
+bool ContextCapabilities::isCompatibilityProfile() const
+{
+    return m_IsCompatibilityProfile;
+}
+
+std::pair<int, int> ContextCapabilities::parseVersion(const std::string& version)
+{
+    // Skip prefix (e.g. "OpenGL ES ")
+    size_t position = 0;
+    while (position < version.size() && !std::isdigit(static_cast<unsigned char>(version[position])))
+        position++;
+
+    int major = 0, minor = 0;
+    char separator = 0;
+    std::istringstream stream(version.substr(position));
+    if (!(stream >> major >> separator >> minor) || separator != '.')
+        return { 0, 0 };
+    return { major, minor };
+}
+
+std::unordered_set<std::string> ContextCapabilities::parseExtensions(const std::string& extensions)
+{
+    std::unordered_set<std::string> result;
+    std::istringstream stream(extensions);
+    std::string extension;
+    while (stream >> extension)
+        result.insert(extension);
+    return result;
+}
@@ -0,0 +1,52 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        utils/context_capabilities.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_UTILS_CONTEXT_CAPABILITIES_HPP
+#define HI_UTILS_CONTEXT_CAPABILITIES_HPP
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+namespace hi
+{
+namespace utils
+{
+    /**
+     * \brief Version, profile & extensions of a context, queried once when context is initialized
+     *
+     * Only queries, which are valid in every version, are used (GL_VERSION instead of
+     * GL_MAJOR_VERSION), thus application's error state (glGetError) is never touched.
+     */
+    class ContextCapabilities
+    {
+    public:
+        /// Query current context
+        void query();
+
+        /// Determine if context's version is at least major.minor
+        bool isVersionAtLeast(int major, int minor) const;
+        /// Determine if extension is supported by context
+        bool hasExtension(const std::string& name) const;
+        /// Determine if context provides deprecated API (e.g. display lists)
+        bool isCompatibilityProfile() const;
+
+        /// Parse (major, minor) from GL_VERSION string (e.g. "4.6.0 NVIDIA", "OpenGL ES 3.2"), (0, 0) if invalid
+        static std::pair<int, int> parseVersion(const std::string& version);
+        /// Split space-separated GL_EXTENSIONS string of legacy contexts
+        static std::unordered_set<std::string> parseExtensions(const std::string& extensions);
+
+    private:
+        int m_Major = 0;
+        int m_Minor = 0;
+        bool m_IsCompatibilityProfile = true;
+        std::unordered_set<std::string> m_Extensions;
+    };
+} // namespace utils
+} // namespace hi
+#endif
@@ -9,33 +9,180 @@
 #ifndef HI_CONTEXT_TRACKER_HPP
 #define HI_CONTEXT_TRACKER_HPP
 #include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 /**
  * @brief Generic object tracker functionality
  *
  * Provides the most generic object tracking functionality, that is used almost
  * by all OpenGL objects (e.g. shaders, buffers)
+ *
+ * OpenGL names (glGen*) are small dense integers, thus objects are stored in a vector of
+ * slots, indexed directly by name. Keys, which would make the vector sparse (e.g. GLenum
+ * keys such as GL_COLOR_ATTACHMENT0), are kept in a fallback hash map instead. The vector
+ * only grows while at least half of its slots would be used.
+ *
+ * Each slot carries a generation, incremented whenever its object is removed, thus a Handle
+ * detects that name has been deleted (and possibly reused) since the handle was taken.
+ *
+ * Storage may be shared by several trackers (see shareWith()), which mirrors objects of
+ * OpenGL contexts within the same share group. Copying a tracker copies its objects.
  */
 template <typename T>
 class ContextTracker
 {
+    using Entry = std::pair<const size_t, T>;
+    struct Slot
+    {
+        std::optional<Entry> entry;
+        uint32_t generation = 0;
+    };
+    using DenseStorage = std::vector<Slot>;
+    using SparseStorage = std::unordered_map<size_t, Slot>;
+    struct Storage
+    {
+        DenseStorage dense;
+        SparseStorage sparse;
+        size_t count = 0;
+    };
+
+    /// Iterates over occupied dense slots, then over occupied sparse slots
+    template <bool IS_CONST>
+    class Iterator
+    {
+        using DenseIterator = std::conditional_t<IS_CONST, typename DenseStorage::const_iterator, typename DenseStorage::iterator>;
+        using SparseIterator = std::conditional_t<IS_CONST, typename SparseStorage::const_iterator, typename SparseStorage::iterator>;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IS_CONST, const Entry&, Entry&>;
+        using pointer = std::conditional_t<IS_CONST, const Entry*, Entry*>;
+
+        Iterator(DenseIterator dense, DenseIterator denseEnd, SparseIterator sparse, SparseIterator sparseEnd)
+            : m_Dense(dense)
+            , m_DenseEnd(denseEnd)
+            , m_Sparse(sparse)
+            , m_SparseEnd(sparseEnd)
+        {
+            skipEmpty();
+        }
+        reference operator*() const { return (m_Dense != m_DenseEnd ? *m_Dense->entry : *m_Sparse->second.entry); }
+        pointer operator->() const { return &**this; }
+        Iterator& operator++()
+        {
+            if (m_Dense != m_DenseEnd)
+                ++m_Dense;
+            else
+                ++m_Sparse;
+            skipEmpty();
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return m_Dense == other.m_Dense && m_Sparse == other.m_Sparse; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        void skipEmpty()
+        {
+            while (m_Dense != m_DenseEnd && !m_Dense->entry)
+                ++m_Dense;
+            if (m_Dense != m_DenseEnd)
+                return;
+            while (m_Sparse != m_SparseEnd && !m_Sparse->second.entry)
+                ++m_Sparse;
+        }
+        DenseIterator m_Dense;
+        DenseIterator m_DenseEnd;
+        SparseIterator m_Sparse;
+        SparseIterator m_SparseEnd;
+    };
+
 public:
-    using MapType = std::unordered_map<size_t, T>;
+    /// Reference to object, which is invalidated when object is removed
+    struct Handle
+    {
+        size_t id = 0;
+        uint32_t generation = 0;
+    };
+
+    /// Map-like view of tracked objects (iteration yields pair<const size_t, T>)
+    template <bool IS_CONST>
+    class View
+    {
+        using Tracker = std::conditional_t<IS_CONST, const ContextTracker, ContextTracker>;
+
+    public:
+        using iterator = Iterator<IS_CONST>;
+        explicit View(Tracker& tracker)
+            : m_Tracker(tracker)
+        {
+        }
+        iterator begin() const
+        {
+            auto& storage = *m_Tracker.m_Storage;
+            return iterator(storage.dense.begin(), storage.dense.end(), storage.sparse.begin(), storage.sparse.end());
+        }
+        iterator end() const
+        {
+            auto& storage = *m_Tracker.m_Storage;
+            return iterator(storage.dense.end(), storage.dense.end(), storage.sparse.end(), storage.sparse.end());
+        }
+        size_t size() const { return m_Tracker.size(); }
+        bool empty() const { return m_Tracker.size() == 0; }
+        size_t count(size_t id) const { return m_Tracker.has(id) ? 1 : 0; }
+        auto& at(size_t id) const { return m_Tracker.get(id); }
+
+    private:
+        Tracker& m_Tracker;
+    };
+    using MapType = View<false>;
+    using ConstMapType = View<true>;
+
     ContextTracker() = default;
+    ContextTracker(const ContextTracker& other);
+    ContextTracker& operator=(const ContextTracker& other);
+    ContextTracker(ContextTracker&& other) = default;
+    ContextTracker& operator=(ContextTracker&& other) = default;
+
     bool has(size_t id) const;
     T& get(size_t id);
+    const T& get(size_t id) const;
     const T& getConst(size_t id) const;
     void add(size_t id, T object);
     void remove(size_t id);
     size_t size() const;
 
-    // TODO: replace with something that can iterate
-    MapType& getMap();
-    const MapType& getConstMap() const;
+    /// Get handle of tracked object
+    Handle getHandle(size_t id) const;
+    /// Is object, referenced by handle, still tracked?
+    bool isValid(const Handle& handle) const;
+
+    MapType getMap();
+    ConstMapType getConstMap() const;
+
+    /// Use the same storage as other tracker (objects of shared OpenGL contexts)
+    void shareWith(const ContextTracker& other);
+    /// Does the storage belong to more than a single tracker?
+    bool isShared() const;
 
 protected:
-    MapType m_storage;
+    /// Dense vector may grow to cover id if at least half of its slots would be used
+    bool shouldBeDense(size_t id) const;
+    const Slot* findSlot(size_t id) const;
+    Slot* findSlot(size_t id);
+    /// Lookup of object, which isn't in dense vector (throws when object isn't tracked)
+    const T& getSparse(size_t id) const;
+
+    std::shared_ptr<Storage> m_Storage = std::make_shared<Storage>();
 };
 
 /**
@@ -66,54 +213,172 @@ protected:
 // Implementation
 ///////////////////////////////////////////////////////////////////////////////
 
+template <typename T>
+ContextTracker<T>::ContextTracker(const ContextTracker& other)
+    : m_Storage(std::make_shared<Storage>(*other.m_Storage))
+{
+}
+
+template <typename T>
+ContextTracker<T>& ContextTracker<T>::operator=(const ContextTracker& other)
+{
+    if (this != &other)
+        m_Storage = std::make_shared<Storage>(*other.m_Storage);
+    return *this;
+}
+
+template <typename T>
+bool ContextTracker<T>::shouldBeDense(size_t id) const
+{
+    constexpr size_t minimalDenseSize = 64;
+    return id < m_Storage->dense.size() || id < 2 * m_Storage->count + minimalDenseSize;
+}
+
+template <typename T>
+const typename ContextTracker<T>::Slot* ContextTracker<T>::findSlot(size_t id) const
+{
+    const auto& storage = *m_Storage;
+    if (id < storage.dense.size())
+        return &storage.dense[id];
+    if (storage.sparse.empty())
+        return nullptr;
+    auto it = storage.sparse.find(id);
+    return (it != storage.sparse.end() ? &it->second : nullptr);
+}
+
+template <typename T>
+typename ContextTracker<T>::Slot* ContextTracker<T>::findSlot(size_t id)
+{
+    return const_cast<Slot*>(static_cast<const ContextTracker<T>*>(this)->findSlot(id));
+}
+
 template <typename T>
 bool ContextTracker<T>::has(size_t id) const
 {
-    return m_storage.count(id) > 0;
+    const auto slot = findSlot(id);
+    return slot && slot->entry;
 }
 
 template <typename T>
 T& ContextTracker<T>::get(size_t id)
 {
-    assert(this->has(id) == true);
-    return m_storage.at(id);
+    return const_cast<T&>(static_cast<const ContextTracker<T>*>(this)->get(id));
+}
+
+template <typename T>
+const T& ContextTracker<T>::get(size_t id) const
+{
+    // Fast path: single bounds & occupancy check of dense slot
+    const auto& dense = m_Storage->dense;
+    if (id < dense.size() && dense[id].entry)
+        return dense[id].entry->second;
+    return getSparse(id);
+}
+
+template <typename T>
+const T& ContextTracker<T>::getSparse(size_t id) const
+{
+    const auto& sparse = m_Storage->sparse;
+    if (id >= m_Storage->dense.size())
+    {
+        auto it = sparse.find(id);
+        if (it != sparse.end() && it->second.entry)
+            return it->second.entry->second;
+    }
+    throw std::out_of_range("ContextTracker: object is not tracked");
 }
 
 template <typename T>
 const T& ContextTracker<T>::getConst(size_t id) const
 {
-    assert(this->has(id) == true);
-    return m_storage.at(id);
+    return get(id);
 }
 
 template <typename T>
 void ContextTracker<T>::add(size_t id, T object)
 {
-    m_storage[id] = object;
+    auto& storage = *m_Storage;
+    if (id >= storage.dense.size() && shouldBeDense(id))
+    {
+        storage.dense.resize(id + 1);
+        // Move sparse entries, which are now covered by dense vector
+        for (auto it = storage.sparse.begin(); it != storage.sparse.end();)
+        {
+            if (it->first < storage.dense.size())
+            {
+                auto& slot = storage.dense[it->first];
+                slot.generation = it->second.generation;
+                if (it->second.entry)
+                    slot.entry.emplace(std::move(*it->second.entry));
+                it = storage.sparse.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    auto& slot = (id < storage.dense.size() ? storage.dense[id] : storage.sparse[id]);
+    if (!slot.entry)
+        storage.count++;
+    slot.entry.emplace(id, std::move(object));
 }
 
 template <typename T>
 void ContextTracker<T>::remove(size_t id)
 {
-    m_storage.erase(id);
+    auto slot = findSlot(id);
+    if (!slot || !slot->entry)
+        return;
+    slot->entry.reset();
+    slot->generation++;
+    m_Storage->count--;
 }
 
 template <typename T>
 size_t ContextTracker<T>::size() const
 {
-    return m_storage.size();
+    return m_Storage->count;
 }
 
 template <typename T>
-typename ContextTracker<T>::MapType& ContextTracker<T>::getMap()
+typename ContextTracker<T>::Handle ContextTracker<T>::getHandle(size_t id) const
 {
-    return m_storage;
+    const auto slot = findSlot(id);
+    assert(slot && slot->entry);
+    return { id, slot->generation };
 }
 
 template <typename T>
-const typename ContextTracker<T>::MapType& ContextTracker<T>::getConstMap() const
+bool ContextTracker<T>::isValid(const Handle& handle) const
 {
-    return m_storage;
+    const auto slot = findSlot(handle.id);
+    return slot && slot->entry && slot->generation == handle.generation;
+}
+
+template <typename T>
+typename ContextTracker<T>::MapType ContextTracker<T>::getMap()
+{
+    return MapType(*this);
+}
+
+template <typename T>
+typename ContextTracker<T>::ConstMapType ContextTracker<T>::getConstMap() const
+{
+    return ConstMapType(*this);
+}
+
+template <typename T>
+void ContextTracker<T>::shareWith(const ContextTracker& other)
+{
+    m_Storage = other.m_Storage;
+}
+
+template <typename T>
+bool ContextTracker<T>::isShared() const
+{
+    return m_Storage.use_count() > 1;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -142,15 +407,13 @@ bool BindableContextTracker<T, IS_ZERO_RESERVED>::hasBounded() const
 template <typename T, bool IS_ZERO_RESERVED>
 T& BindableContextTracker<T, IS_ZERO_RESERVED>::getBound()
 {
-    assert(this->has(m_currentlyBoundObjectId));
     return this->get(m_currentlyBoundObjectId);
 }
 
 template <typename T, bool IS_ZERO_RESERVED>
 const T& BindableContextTracker<T, IS_ZERO_RESERVED>::getBoundConst() const
 {
-    assert(this->has(m_currentlyBoundObjectId));
-    return this->getConst(m_currentlyBoundObjectId);
+    return this->get(m_currentlyBoundObjectId);
 }
 
 template <typename T, bool IS_ZERO_RESERVED>
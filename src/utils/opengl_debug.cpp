@@ -32,9 +32,11 @@ void logOpenglDebugMessageStr(std::string file, size_t location, std::string err
     Logger::logError("OpenGL error:", error, " at ", file, ":", location);
 }
 
-void logTrace(const std::string msg)
+void logTrace(const char* msg)
 {
-    glGetUniformLocation(0, ("trace: " + msg).c_str());
+    if (!Logger::isLevelEnabled(Logger::DEBUG_PER_FRAME_LOG))
+        return;
+    glGetUniformLocation(0, (std::string("trace: ") + msg).c_str());
     CLEAR_GL_ERROR();
 }
 }
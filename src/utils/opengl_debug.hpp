@@ -46,7 +46,8 @@ namespace debug
 {
     void logOpenglDebugMessage(std::string file, size_t location, GLenum errorCode);
     void logOpenglDebugMessageStr(std::string file, size_t location, std::string error);
-    void logTrace(const std::string msg);
+    /// Emit trace marker into OpenGL's call stream (e.g. for apitrace). Only when per-frame debug logging is on
+    void logTrace(const char* msg);
     std::string convertErrorToString(GLenum errorCode);
 }
 }
@@ -12,9 +12,30 @@
 #include "GL/gl.h"
 #include "utils/opengl_objects.hpp"
 
+namespace helper
+{
+thread_local bool isAbandoningObjects = false;
+} // namespace helper
+
+hi::utils::AbandonOpenGLObjectsRAII::AbandonOpenGLObjectsRAII()
+    : m_WasActive(helper::isAbandoningObjects)
+{
+    helper::isAbandoningObjects = true;
+}
+
+hi::utils::AbandonOpenGLObjectsRAII::~AbandonOpenGLObjectsRAII()
+{
+    helper::isAbandoningObjects = m_WasActive;
+}
+
+bool hi::utils::AbandonOpenGLObjectsRAII::isActive()
+{
+    return helper::isAbandoningObjects;
+}
+
 hi::utils::glObject::~glObject()
 {
-    if (m_ID == 0)
+    if (m_ID == 0 || AbandonOpenGLObjectsRAII::isActive())
         return;
     if (glIsProgram(m_ID))
         glDeleteProgram(m_ID);
@@ -21,6 +21,28 @@ namespace hi
 {
 namespace utils
 {
+    /**
+     * \brief RAII helper, making destructors forget names of OpenGL objects instead of deleting them
+     *
+     * Used to free state of a context, which isn't current: driver releases context's objects
+     * itself, whereas deleting the names would hit objects of another context.
+     */
+    class AbandonOpenGLObjectsRAII
+    {
+    public:
+        AbandonOpenGLObjectsRAII();
+        ~AbandonOpenGLObjectsRAII();
+
+        AbandonOpenGLObjectsRAII(const AbandonOpenGLObjectsRAII&) = delete;
+        AbandonOpenGLObjectsRAII& operator=(const AbandonOpenGLObjectsRAII&) = delete;
+
+        /// Are objects, destroyed by calling thread, abandoned
+        static bool isActive();
+
+    private:
+        bool m_WasActive;
+    };
+
     class glObject
     {
     public:
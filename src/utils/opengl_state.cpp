@@ -7,6 +7,7 @@
 *****************************************************************************/
 
 #include "utils/opengl_state.hpp"
+#include "trackers/state_tracker.hpp"
 
 namespace hi::utils
 {
@@ -24,10 +25,10 @@ BackupOpenGLStatesRAII::~BackupOpenGLStatesRAII()
         }
     }
 }
-BackupOpenGLStatesRAII::BackupOpenGLStatesRAII(GLenum state)
+BackupOpenGLStatesRAII::BackupOpenGLStatesRAII(GLenum state, bool isEnabled)
     : m_State(state)
+    , m_IsEnabled(isEnabled)
 {
-    m_IsEnabled = glIsEnabled(state);
 }
 
 // Move constructable
@@ -43,12 +44,12 @@ BackupOpenGLStatesRAII& BackupOpenGLStatesRAII::operator=(BackupOpenGLStatesRAII
     return *this;
 }
 
-void restoreStateFunctor(const std::vector<GLenum>& states, const std::function<void()>& functor)
+void restoreStateFunctor(const hi::trackers::StateTracker& mirror, const std::vector<GLenum>& states, const std::function<void()>& functor)
 {
     std::vector<BackupOpenGLStatesRAII> stateKeepers;
     for (auto& state : states)
     {
-        stateKeepers.emplace_back(std::move(BackupOpenGLStatesRAII(state)));
+        stateKeepers.emplace_back(std::move(BackupOpenGLStatesRAII(state, mirror.isEnabled(state))));
     }
     functor();
 }
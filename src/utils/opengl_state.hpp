@@ -15,6 +15,10 @@
 
 namespace hi
 {
+namespace trackers
+{
+    class StateTracker;
+}
 namespace utils
 {
     /**
@@ -24,7 +28,8 @@ namespace utils
     {
     public:
         BackupOpenGLStatesRAII() = default;
-        explicit BackupOpenGLStatesRAII(GLenum state);
+        /// Keep state, whose current value (isEnabled) is provided by caller (e.g. from StateTracker)
+        BackupOpenGLStatesRAII(GLenum state, bool isEnabled);
         ~BackupOpenGLStatesRAII();
 
         // Delete copy constructor
@@ -42,7 +47,8 @@ namespace utils
         bool m_IsEnabled = false;
     };
 
-    void restoreStateFunctor(const std::vector<GLenum>& states, const std::function<void()>& functor);
+    /// Call functor and restore states afterwards. Current values are taken from the mirror, not glIsEnabled()
+    void restoreStateFunctor(const hi::trackers::StateTracker& mirror, const std::vector<GLenum>& states, const std::function<void()>& functor);
 
 } // namespace raii
 } // namespace hi
@@ -7,10 +7,39 @@
 *****************************************************************************/
 
 #include "utils/string_utils.hpp"
+#include <algorithm>
+#include <cctype>
 #include <functional>
+#include <string_view>
 
 using namespace hi::utils;
 
+namespace helper
+{
+bool isIdentifierStart(char c)
+{
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isIdentifierCharacter(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+/// Get end of comment, starting at position, or position if there is no comment
+size_t findEndOfComment(const std::string& str, size_t position)
+{
+    if (str.compare(position, 2, "//") == 0)
+        return std::min(str.find('\n', position), str.size());
+    if (str.compare(position, 2, "/*") == 0)
+    {
+        const auto end = str.find("*/", position + 2);
+        return (end == std::string::npos ? str.size() : end + 2);
+    }
+    return position;
+}
+} // namespace helper
+
 /// Iterate&replace over generic text, matched by regex
 std::string hi::utils::regex_replace_functor(const std::string str, const std::regex reg, std::function<std::string(std::string)> functor)
 {
@@ -45,6 +74,51 @@ std::string hi::utils::regex_replace_identifiers(const std::string str, const st
     });
 }
 
+std::string hi::utils::replace_identifiers(const std::string& str, const IdentifierSubstitutions& substitutions)
+{
+    // Lookup by views of text, thus identifiers aren't copied
+    std::unordered_map<std::string_view, const std::string*> lookup;
+    lookup.reserve(substitutions.size());
+    for (const auto& [identifier, substitution] : substitutions)
+        lookup.emplace(identifier, &substitution);
+
+    std::string result;
+    result.reserve(str.size());
+    const std::string_view text = str;
+    size_t position = 0;
+    while (position < str.size())
+    {
+        const auto character = str[position];
+        size_t end = position + 1;
+        if (helper::isIdentifierStart(character))
+        {
+            while (end < str.size() && helper::isIdentifierCharacter(str[end]))
+                end++;
+            const auto identifier = text.substr(position, end - position);
+            auto it = lookup.find(identifier);
+            if (it != lookup.end())
+                result.append(*it->second);
+            else
+                result.append(identifier);
+            position = end;
+            continue;
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(character)))
+        {
+            // Literal (e.g. 1.0f, 0x1F) isn't an identifier
+            while (end < str.size() && (helper::isIdentifierCharacter(str[end]) || str[end] == '.'))
+                end++;
+        }
+        else if (character == '/')
+        {
+            end = std::max(end, helper::findEndOfComment(str, position));
+        }
+        result.append(text.substr(position, end - position));
+        position = end;
+    }
+    return result;
+}
 
 size_t hi::utils::computeHash(const std::string str)
 {
@@ -52,3 +126,29 @@ size_t hi::utils::computeHash(const std::string str)
     // See note in https://en.cppreference.com/w/cpp/utility/hash
     return std::hash<std::string>{}(str);
 }
+
+std::string hi::utils::toHex(uint64_t value)
+{
+    constexpr auto digits = "0123456789abcdef";
+    std::string result(16, '0');
+    for (size_t i = 0; i < result.size(); i++, value >>= 4)
+        result[result.size() - 1 - i] = digits[value & 0xf];
+    return result;
+}
+
+std::string hi::utils::computeStableKey(const std::string_view& material)
+{
+    return toHex(computeStableHash(material)) + toHex(computeStableHash(material, 0x84222325cbf29ce4ull));
+}
+
+uint64_t hi::utils::computeStableHash(const std::string_view& str, uint64_t seed)
+{
+    constexpr uint64_t prime = 0x100000001b3ull;
+    auto hash = seed;
+    for (const auto character : str)
+    {
+        hash ^= static_cast<unsigned char>(character);
+        hash *= prime;
+    }
+    return hash;
+}
@@ -8,9 +8,12 @@
 
 #ifndef STRING_UTILS_HPP
 #define STRING_UTILS_HPP
+#include <cstdint>
 #include <functional>
 #include <regex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace hi
 {
@@ -18,9 +21,29 @@ namespace utils
 {
     std::string regex_replace_functor(const std::string str, const std::regex reg, std::function<std::string(std::string)> functor);
 
+    /// Note: scans whole text per identifier, use replace_identifiers() for multiple identifiers
     std::string regex_replace_identifiers(const std::string str, const std::string identifierName, std::function<std::string()> functor);
 
+    /// Identifier => substitution
+    using IdentifierSubstitutions = std::unordered_map<std::string, std::string>;
+
+    /**
+     * @brief Substitute whole identifiers in a single pass over text
+     *
+     * Comments, numeric literals and whitespace are copied as they are.
+     */
+    std::string replace_identifiers(const std::string& str, const IdentifierSubstitutions& substitutions);
+
     size_t computeHash(const std::string str);
+
+    /// Hash, which is stable across builds and processes (64-bit FNV-1a), e.g. for on-disk keys
+    uint64_t computeStableHash(const std::string_view& str, uint64_t seed = 0xcbf29ce484222325ull);
+
+    /// Get 16-digit (zero-padded) lowercase hexadecimal representation
+    std::string toHex(uint64_t value);
+
+    /// Get 128-bit key of material (two differently seeded stable hashes) as 32 hex digits
+    std::string computeStableKey(const std::string_view& material);
 }
 }
 
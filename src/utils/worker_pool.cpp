@@ -0,0 +1,84 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        utils/worker_pool.cpp
+*
+*****************************************************************************/
+
+#include "utils/worker_pool.hpp"
+
+#include <algorithm>
+
+using namespace hi::utils;
+
+WorkerPool::WorkerPool(size_t countOfThreads)
+    : m_CountOfThreads(countOfThreads)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_IsStopping = true;
+    }
+    m_HasTask.notify_all();
+    // Remaining tasks are executed before threads terminate
+    for (auto& thread : m_Threads)
+        thread.join();
+}
+
+size_t WorkerPool::getDefaultCountOfThreads()
+{
+    const size_t cores = std::thread::hardware_concurrency();
+    return std::max<size_t>(cores, 2) - 1;
+}
+
+void WorkerPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_IsIdle.wait(lock, [this] { return m_CountOfUnfinishedTasks == 0; });
+}
+
+void WorkerPool::enqueue(std::function<void()> task)
+{
+    if (m_CountOfThreads == 0)
+    {
+        task();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Threads.empty())
+        {
+            for (size_t i = 0; i < m_CountOfThreads; i++)
+                m_Threads.emplace_back([this] { run(); });
+        }
+        m_Tasks.push_back(std::move(task));
+        m_CountOfUnfinishedTasks++;
+    }
+    m_HasTask.notify_one();
+}
+
+void WorkerPool::run()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_HasTask.wait(lock, [this] { return m_IsStopping || !m_Tasks.empty(); });
+            if (m_Tasks.empty())
+                return;
+            task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+        }
+        task();
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_CountOfUnfinishedTasks--;
+        }
+        m_IsIdle.notify_all();
+    }
+}
@@ -0,0 +1,74 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        utils/worker_pool.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_UTILS_WORKER_POOL_HPP
+#define HI_UTILS_WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace hi
+{
+namespace utils
+{
+    /**
+     * @brief Fixed pool of worker threads, executing CPU-only tasks in FIFO order
+     *
+     * Threads are started lazily by the first submitted task. Pool without threads
+     * executes tasks synchronously in submit().
+     */
+    class WorkerPool
+    {
+    public:
+        explicit WorkerPool(size_t countOfThreads = getDefaultCountOfThreads());
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /// Get count of cores - 1 (main thread keeps one), at least 1
+        static size_t getDefaultCountOfThreads();
+
+        template <typename F>
+        std::future<std::invoke_result_t<F>> submit(F&& task)
+        {
+            using ResultType = std::invoke_result_t<F>;
+            auto packagedTask = std::make_shared<std::packaged_task<ResultType()>>(std::forward<F>(task));
+            auto result = packagedTask->get_future();
+            enqueue([packagedTask] { (*packagedTask)(); });
+            return result;
+        }
+
+        /// Block until all submitted tasks are finished
+        void wait();
+
+    private:
+        void enqueue(std::function<void()> task);
+        void run();
+
+        size_t m_CountOfThreads = 0;
+        std::vector<std::thread> m_Threads;
+        std::deque<std::function<void()>> m_Tasks;
+        /// Count of tasks, which are queued or being executed
+        size_t m_CountOfUnfinishedTasks = 0;
+        bool m_IsStopping = false;
+        std::mutex m_Mutex;
+        std::condition_variable m_HasTask;
+        std::condition_variable m_IsIdle;
+    };
+} // namespace utils
+} // namespace hi
+
+#endif
@@ -0,0 +1,17 @@
+/*****************************************************************************
+*
+*  PROJECT:     HoloInjector - https://github.com/Romop5/holoinjector
+*  LICENSE:     See LICENSE in the top level directory
+*  FILE:        version.hpp
+*
+*****************************************************************************/
+
+#ifndef HI_VERSION_HPP
+#define HI_VERSION_HPP
+
+/// Injector's version (defined by CMake), part of keys of on-disk caches
+#ifndef HI_VERSION
+#define HI_VERSION "unknown"
+#endif
+
+#endif
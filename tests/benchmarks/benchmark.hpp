@@ -0,0 +1,40 @@
+#ifndef HI_BENCHMARK_HPP
+#define HI_BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <string>
+
+/*
+ * Shared helpers of benchmarks (timing-sensitive, thus not a part of unittests / ctest)
+ */
+namespace benchmark
+{
+/// Best (minimal) wall time of repeated runs of func in milliseconds
+template <typename F>
+double measure(F func, size_t repeats = 5)
+{
+    double best = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < repeats; i++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+/// Print measured time(s) of benchmark case
+inline void report(const std::string& name, double time, const std::string& referenceName = "", double referenceTime = 0.0)
+{
+    std::cout << "[Benchmark] " << name << ": " << time << " ms";
+    if (!referenceName.empty())
+        std::cout << ", " << referenceName << ": " << referenceTime << " ms";
+    std::cout << std::endl;
+}
+} // namespace benchmark
+
+#endif
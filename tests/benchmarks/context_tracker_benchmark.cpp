@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "benchmark.hpp"
+#include "utils/context_tracker.hpp"
+
+#include <memory>
+#include <unordered_map>
+
+namespace {
+/*
+ * Benchmarks: churn of tens of thousands of objects, compared to hash map storage
+ */
+constexpr size_t benchmarkObjects = 50000;
+constexpr size_t benchmarkRounds = 20;
+
+/// Dense slots must beat hash map storage
+TEST(ContextTrackerBenchmark, AddRemove) {
+    BindableContextTracker<std::shared_ptr<int>> tracker;
+    std::unordered_map<size_t, std::shared_ptr<int>> reference;
+    auto object = std::make_shared<int>(0);
+
+    const auto trackerTime = benchmark::measure([&] {
+        for (size_t round = 0; round < benchmarkRounds; round++)
+        {
+            for (size_t id = 1; id <= benchmarkObjects; id++)
+                tracker.add(id, object);
+            for (size_t id = 1; id <= benchmarkObjects; id += 2)
+                tracker.remove(id);
+        }
+    });
+    const auto referenceTime = benchmark::measure([&] {
+        for (size_t round = 0; round < benchmarkRounds; round++)
+        {
+            for (size_t id = 1; id <= benchmarkObjects; id++)
+                reference[id] = object;
+            for (size_t id = 1; id <= benchmarkObjects; id += 2)
+                reference.erase(id);
+        }
+    });
+    benchmark::report("add/remove, tracker", trackerTime, "unordered_map", referenceTime);
+    ASSERT_EQ(tracker.size(), reference.size());
+    EXPECT_LT(trackerTime, referenceTime);
+}
+
+TEST(ContextTrackerBenchmark, LookupAndBind) {
+    BindableContextTracker<std::shared_ptr<int>> tracker;
+    std::unordered_map<size_t, std::shared_ptr<int>> reference;
+    for (size_t id = 1; id <= benchmarkObjects; id++)
+    {
+        tracker.add(id, std::make_shared<int>(id));
+        reference[id] = tracker.get(id);
+    }
+
+    size_t trackerSum = 0;
+    const auto trackerTime = benchmark::measure([&] {
+        for (size_t round = 0; round < benchmarkRounds; round++)
+        {
+            for (size_t id = 1; id <= benchmarkObjects; id++)
+            {
+                // Bind churn: bind & query bound object as draw calls do
+                tracker.bind((id * 7919) % benchmarkObjects + 1);
+                if (tracker.hasBounded() && tracker.has(tracker.getBoundId()))
+                    trackerSum += *tracker.getBound();
+            }
+        }
+    });
+    size_t referenceSum = 0;
+    size_t bound = 0;
+    const auto referenceTime = benchmark::measure([&] {
+        for (size_t round = 0; round < benchmarkRounds; round++)
+        {
+            for (size_t id = 1; id <= benchmarkObjects; id++)
+            {
+                bound = (id * 7919) % benchmarkObjects + 1;
+                if (bound != 0 && reference.count(bound))
+                    referenceSum += *reference.at(bound);
+            }
+        }
+    });
+    benchmark::report("lookup/bind, tracker", trackerTime, "unordered_map", referenceTime);
+    ASSERT_EQ(trackerSum, referenceSum);
+    EXPECT_LT(trackerTime, referenceTime);
+}
+} //namespace
@@ -0,0 +1,46 @@
+#include "gtest/gtest.h"
+#include "benchmark.hpp"
+#include "pipeline/shader_inspector.hpp"
+
+#include <sstream>
+#include <vector>
+
+namespace {
+std::string generateUberShader(size_t size)
+{
+    std::stringstream ss;
+    ss << "#version 330 core\nin vec4 position;\n";
+    for (size_t i = 0; i < size; i++)
+        ss << "uniform mat4 matrix" << i << ";\n";
+    ss << "void main()\n{\n";
+    for (size_t i = 0; i < size; i++)
+    {
+        ss << "    vec4 tmp" << i << " = matrix" << i << " * position;\n";
+        ss << "    gl_Position = tmp" << i << ";\n";
+    }
+    ss << "}\n";
+    return ss.str();
+}
+
+/// Analysis of uber-shader must scale linearly with count of uniforms & assignments
+TEST(ShaderParserBenchmark, UberShader) {
+    constexpr size_t baseSize = 250;
+    constexpr size_t scale = 4;
+    std::vector<double> times;
+    for (const size_t size : { baseSize, baseSize * scale })
+    {
+        const auto code = generateUberShader(size);
+        const auto time = benchmark::measure([&] {
+            hi::pipeline::ShaderInspector inspector(code);
+            const auto assignments = inspector.findAllOutVertexAssignments();
+            ASSERT_EQ(assignments.size(), size);
+            ASSERT_EQ(assignments.back().transformName, "matrix" + std::to_string(size - 1));
+            ASSERT_EQ(inspector.getListOfUniforms().size(), size);
+        });
+        benchmark::report(std::to_string(size) + " uniforms & assignments", time);
+        times.push_back(time);
+    }
+    // Quadratic analysis would take scale^2 times longer, allow for noise with half of that
+    EXPECT_LT(times.back(), times.front() * scale * scale / 2);
+}
+} //namespace
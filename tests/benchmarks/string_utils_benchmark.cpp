@@ -0,0 +1,49 @@
+#include "gtest/gtest.h"
+#include "benchmark.hpp"
+#include "utils/string_utils.hpp"
+
+#include <sstream>
+
+using namespace hi;
+using namespace hi::utils;
+
+namespace {
+/*
+ * Benchmark: renaming inputs of a fragment shader with many varyings
+ */
+std::string generateShader(size_t varyings)
+{
+    std::stringstream shader;
+    shader << "#version 330 core\n";
+    for (size_t i = 0; i < varyings; i++)
+        shader << "in vec4 attribute" << i << ";\n";
+    shader << "out vec4 color;\nvoid main()\n{\n    color = vec4(0.0);\n";
+    for (size_t i = 0; i < varyings; i++)
+        shader << "    color += attribute" << i << " * attribute" << (varyings - i - 1) << ";\n";
+    shader << "}\n";
+    return shader.str();
+}
+
+/// Single-pass replace_identifiers must beat regex pass per identifier (and give the same result)
+TEST(StringUtilsBenchmark, ReplaceIdentifiers) {
+    for (size_t varyings : { 16, 64 })
+    {
+        const auto shader = generateShader(varyings);
+        IdentifierSubstitutions renames;
+        for (size_t i = 0; i < varyings; i++)
+            renames["attribute" + std::to_string(i)] = "injector_frag_attribute" + std::to_string(i);
+
+        std::string regexResult;
+        const auto regexTime = benchmark::measure([&] {
+            regexResult = shader;
+            for (const auto& [name, newName] : renames)
+                regexResult = regex_replace_identifiers(regexResult, name, [newName = newName] { return newName; });
+        });
+        std::string result;
+        const auto time = benchmark::measure([&] { result = replace_identifiers(shader, renames); });
+        benchmark::report(std::to_string(varyings) + " varyings, replace_identifiers", time, "regex_replace_identifiers", regexTime);
+        ASSERT_EQ(result, regexResult);
+        EXPECT_LT(time, regexTime);
+    }
+}
+} //namespace
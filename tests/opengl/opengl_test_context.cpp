@@ -1,3 +1,5 @@
+#include "opengl_test_context.hpp"
+
 #include <iostream>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
@@ -5,8 +7,6 @@
 #include <GL/gl.h>
 #include <GL/glx.h>
 
-#include "opengl_test_context.hpp"
-
 int OpenGLTestContext::initialize()
 {
     // Open the display
@@ -25,6 +25,7 @@ int OpenGLTestContext::initialize()
     if (majorGLX <= 1 && minorGLX < 2) {
             std::cout << "GLX 1.2 or greater is required.\n";
             XCloseDisplay(display);
+            display = nullptr;
             return 1;
     }
     else {
@@ -49,6 +50,7 @@ int OpenGLTestContext::initialize()
     if (visual == 0) {
             std::cout << "Could not create correct visual window.\n";
             XCloseDisplay(display);
+            display = nullptr;
             return 1;
     }
 
@@ -78,7 +80,11 @@ int OpenGLTestContext::initialize()
 
 void OpenGLTestContext::deinitialize()
 {
+    if (display == nullptr)
+        return;
+
     // Cleanup GLX
+    glXMakeCurrent(display, None, nullptr);
     glXDestroyContext(display, context);
 
     // Cleanup X11
@@ -86,15 +92,19 @@ void OpenGLTestContext::deinitialize()
     XFreeColormap(display, windowAttribs.colormap);
     XDestroyWindow(display, window);
     XCloseDisplay(display);
+    display = nullptr;
 }
 
 void OpenGLTestContext::handleEvents()
 {
-    XNextEvent(display, &ev);
-    if (ev.type == Expose) {
-        XWindowAttributes attribs;
-        XGetWindowAttributes(display, window, &attribs);
-        glViewport(0, 0, attribs.width, attribs.height);
+    // Don't block when there are no events
+    while (XPending(display) > 0) {
+        XNextEvent(display, &ev);
+        if (ev.type == Expose) {
+            XWindowAttributes attribs;
+            XGetWindowAttributes(display, window, &attribs);
+            glViewport(0, 0, attribs.width, attribs.height);
+        }
     }
 }
 
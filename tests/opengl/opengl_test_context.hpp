@@ -1,3 +1,6 @@
+// gtest before X11 (its macros, e.g. None, clash with gtest)
+#include "gtest/gtest.h"
+
 #include <X11/Xlib.h>
 #include <GL/gl.h>
 #include <GL/glx.h>
@@ -28,4 +31,17 @@ struct OpenGLTestContext
         XSetWindowAttributes windowAttribs;
 };
 
+/**
+ * Fixture: creates window with GL context for each test (skipped without X server)
+ */
+class OpenGLTest : public ::testing::Test
+{
+    protected:
+    void SetUp() override
+    {
+        if (windowSystem.initialize() != 0)
+            GTEST_SKIP() << "Failed to create OpenGL context";
+    }
 
+    OpenGLTestContext windowSystem;
+};
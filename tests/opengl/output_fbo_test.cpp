@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include <cassert>
+#include "gtest/gtest.h"
 #include "opengl_test_context.hpp"
 
 #include "pipeline/output_fbo.hpp"
@@ -133,12 +134,10 @@ struct Triangle
         GLuint  m_VAO;
 };
 
-int main(int argc, char** argv) {
-    OpenGLTestContext windowSystem;
-    windowSystem.initialize();
-
+TEST_F(OpenGLTest, OutputFBO) {
     hi::pipeline::OutputFBO fbo;
     fbo.initialize();
+    ASSERT_NE(fbo.getFBOId(), 0u);
 
     Triangle triangle;
     triangle.initialize();
@@ -148,8 +147,8 @@ int main(int argc, char** argv) {
 
     hi::pipeline::CameraParameters params;
 
-        // Enter message loop
-    while (true) {
+    // Render a few frames
+    for (size_t frame = 0; frame < 10; frame++) {
         windowSystem.handleEvents();
         glClear(GL_DEPTH_BUFFER_BIT|GL_COLOR_BUFFER_BIT|GL_STENCIL_BUFFER_BIT);
 
@@ -160,20 +159,8 @@ int main(int argc, char** argv) {
 
         fbo.renderToBackbuffer(params);
 
-        /*glBegin(GL_TRIANGLES);
-                glColor3f(  1.0f,  0.0f, 0.0f);
-                glVertex3f( 0.0f, -1.0f, 0.0f);
-                glColor3f(  0.0f,  1.0f, 0.0f);
-                glVertex3f(-1.0f,  1.0f, 0.0f);
-                glColor3f(  0.0f,  0.0f, 1.0f);
-                glVertex3f( 1.0f,  1.0f, 0.0f);
-        glEnd();
-        */
-
         // Present frame
         glXSwapBuffers(windowSystem.getDisplay(), windowSystem.getWindow());
     }
-    
-    return 0;
+    ASSERT_EQ(glGetError(), GL_NO_ERROR);
 }
-
@@ -0,0 +1,102 @@
+#define GL_GLEXT_PROTOTYPES 1
+#include "GL/gl.h"
+#include "GL/glext.h"
+
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+#include "gtest/gtest.h"
+#include "opengl_test_context.hpp"
+
+#include "pipeline/program_binary_cache.hpp"
+#include "utils/opengl_utils.hpp"
+
+/*
+ * Verifies store / load of program binaries with current driver (e.g. LIBGL_ALWAYS_SOFTWARE=1
+ * for Mesa's llvmpipe), skipped when driver doesn't support them.
+ */
+namespace
+{
+const hi::pipeline::PipelineInjector::PipelineType pipeline = {
+    { GL_VERTEX_SHADER, R"(
+        #version 330 core
+        layout (location = 0) in vec3 position;
+        void main()
+        {
+            gl_Position = vec4(position,1.0);
+        }
+    )" },
+    { GL_FRAGMENT_SHADER, R"(
+        #version 330 core
+        uniform vec4 tint;
+        out vec4 color;
+        void main()
+        {
+            color = tint;
+        }
+    )" },
+};
+
+bool linkFromSources(GLuint program)
+{
+    std::vector<GLuint> shaders;
+    for (const auto& [type, sourceCode] : pipeline)
+    {
+        auto shader = glCreateShader(type);
+        const GLchar* sources[1] = { sourceCode.c_str() };
+        glShaderSource(shader, 1, sources, nullptr);
+        glCompileShader(shader);
+        glAttachShader(program, shader);
+        shaders.push_back(shader);
+    }
+    glLinkProgram(program);
+    for (auto shader : shaders)
+    {
+        glDetachShader(program, shader);
+        glDeleteShader(shader);
+    }
+    return hi::opengl_utils::isProgramLinked(program);
+}
+
+} // namespace
+
+TEST_F(OpenGLTest, ProgramBinaryCache) {
+    const auto directory = std::filesystem::temp_directory_path() / ("hi_program_binary_test_" + std::to_string(getpid()));
+    hi::pipeline::ProgramBinaryCache cache;
+    cache.initialize(directory);
+    if (!cache.isEnabled())
+        GTEST_SKIP() << "Driver doesn't support program binaries";
+
+    const auto key = cache.getKey(pipeline, "");
+    // Pre-link state is baked into binary
+    ASSERT_NE(key, cache.getKey(pipeline, "attribute 0 position\n"));
+
+    // Cold: link from sources & store
+    auto program = glCreateProgram();
+    ASSERT_FALSE(cache.load(key, program));
+    cache.prepareForLinking(program);
+    ASSERT_TRUE(linkFromSources(program));
+    ASSERT_TRUE(cache.store(key, program));
+
+    // Warm: link from binary
+    auto cachedProgram = glCreateProgram();
+    ASSERT_TRUE(cache.load(key, cachedProgram));
+    ASSERT_NE(glGetUniformLocation(cachedProgram, "tint"), -1);
+
+    // Corrupted entry is rejected and removed
+    {
+        std::fstream entry(directory / key, std::ios::in | std::ios::out | std::ios::binary);
+        entry.seekg(-1, std::ios::end);
+        const auto lastByte = entry.get();
+        entry.seekp(-1, std::ios::end);
+        entry.put(static_cast<char>(lastByte ^ 0xff));
+    }
+    auto rejectedProgram = glCreateProgram();
+    ASSERT_FALSE(cache.load(key, rejectedProgram));
+    ASSERT_FALSE(std::filesystem::exists(directory / key));
+
+    glDeleteProgram(program);
+    glDeleteProgram(cachedProgram);
+    glDeleteProgram(rejectedProgram);
+    std::filesystem::remove_all(directory);
+}
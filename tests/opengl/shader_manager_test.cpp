@@ -0,0 +1,138 @@
+#define GL_GLEXT_PROTOTYPES 1
+#include "GL/gl.h"
+#include "GL/glext.h"
+
+#include <chrono>
+#include <thread>
+#include "gtest/gtest.h"
+#include "opengl_test_context.hpp"
+
+#include "context.hpp"
+#include "managers/shader_manager.hpp"
+#include "pipeline/pipeline_injector.hpp"
+#include "trackers/shader_tracker.hpp"
+#include "utils/context_capabilities.hpp"
+#include "utils/opengl_utils.hpp"
+
+/*
+ * Verifies deferred link of injected programs (ShaderManager::linkProgram / resolveLink)
+ */
+namespace
+{
+const hi::pipeline::PipelineInjector::PipelineType pipeline = {
+    { GL_VERTEX_SHADER, R"(
+        #version 330 core
+        layout (location = 0) in vec3 position;
+        uniform mat4 mvp;
+        void main()
+        {
+            gl_Position = mvp*vec4(position,1.0);
+        }
+    )" },
+    { GL_FRAGMENT_SHADER, R"(
+        #version 330 core
+        out vec4 color;
+        void main()
+        {
+            color = vec4(1.0);
+        }
+    )" },
+};
+
+class ShaderManagerTest : public OpenGLTest
+{
+    protected:
+    void SetUp() override
+    {
+        OpenGLTest::SetUp();
+        if (IsSkipped())
+            return;
+        auto& capabilities = context.getCapabilities();
+        capabilities.query();
+        context.parallelShaderCompileFlag = capabilities.hasExtension("GL_KHR_parallel_shader_compile") || capabilities.hasExtension("GL_ARB_parallel_shader_compile");
+    }
+
+    void TearDown() override
+    {
+        manager.waitForBackgroundWork();
+    }
+
+    /// Create program from pipeline and submit its link
+    GLuint link(const hi::pipeline::PipelineParams& parameters)
+    {
+        auto program = manager.createProgram(context);
+        for (const auto& [type, sourceCode] : pipeline)
+        {
+            auto shader = manager.createShader(context, type);
+            const GLchar* sources[1] = { sourceCode.c_str() };
+            manager.shaderSource(context, shader, 1, sources, nullptr);
+            manager.compileShader(context, shader);
+            manager.attachShader(context, program, shader);
+        }
+        manager.linkProgram(context, program, parameters);
+        return program;
+    }
+
+    GLint getLinkStatus(GLuint program)
+    {
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        return status;
+    }
+
+    hi::Context context;
+    hi::managers::ShaderManager manager;
+};
+} // namespace
+
+TEST_F(ShaderManagerTest, DeferredLink) {
+    auto program = link(hi::pipeline::PipelineParams());
+    auto record = context.getManager().get(program);
+    ASSERT_TRUE(record->hasPendingLink());
+
+    ASSERT_TRUE(manager.resolveLink(context, program));
+    ASSERT_FALSE(record->hasPendingLink());
+    ASSERT_TRUE(record->isLinked());
+    ASSERT_EQ(getLinkStatus(program), GL_TRUE);
+
+    // Nothing left to resolve
+    ASSERT_FALSE(manager.resolveLink(context, program));
+    ASSERT_TRUE(manager.isLinkCompleted(context, program));
+}
+
+TEST_F(ShaderManagerTest, DeferredLinkFallback) {
+    // Injected GS exceeds GL_MAX_GEOMETRY_SHADER_INVOCATIONS => original pipeline is linked instead
+    hi::pipeline::PipelineParams parameters;
+    parameters.countOfInvocations = 4096;
+    auto program = link(parameters);
+    auto record = context.getManager().get(program);
+    ASSERT_TRUE(record->hasPendingLink());
+
+    ASSERT_TRUE(manager.resolveLink(context, program));
+    ASSERT_FALSE(record->isLinked());
+    ASSERT_EQ(getLinkStatus(program), GL_TRUE);
+    ASSERT_NE(glGetUniformLocation(program, "mvp"), -1);
+}
+
+TEST_F(ShaderManagerTest, DeferredLinkCompletionStatus) {
+    auto program = link(hi::pipeline::PipelineParams());
+    auto record = context.getManager().get(program);
+
+    if (!context.parallelShaderCompileFlag)
+    {
+        // Without KHR_parallel_shader_compile, completion can't be determined without blocking
+        ASSERT_FALSE(manager.isLinkCompleted(context, program));
+    }
+    else
+    {
+        // Poll as application would do
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (!manager.isLinkCompleted(context, program) && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ASSERT_TRUE(manager.isLinkCompleted(context, program));
+        // Polling doesn't resolve link
+        ASSERT_TRUE(record->hasPendingLink());
+    }
+    ASSERT_TRUE(manager.resolveLink(context, program));
+    ASSERT_TRUE(manager.isLinkCompleted(context, program));
+}
@@ -0,0 +1,106 @@
+#define GL_GLEXT_PROTOTYPES 1
+#include "GL/gl.h"
+#include "GL/glext.h"
+
+#include "gtest/gtest.h"
+#include "opengl_test_context.hpp"
+
+#include "trackers/texture_tracker.hpp"
+#include "utils/context_capabilities.hpp"
+
+/*
+ * Verifies pooling of views of shadow texture, skipped when driver doesn't support texture views.
+ */
+namespace
+{
+class TextureViewTest : public OpenGLTest
+{
+    protected:
+    void SetUp() override
+    {
+        OpenGLTest::SetUp();
+        if (IsSkipped())
+            return;
+        hi::utils::ContextCapabilities capabilities;
+        capabilities.query();
+        if (!capabilities.isVersionAtLeast(4, 3) && !capabilities.hasExtension("GL_ARB_texture_view"))
+            GTEST_SKIP() << "Texture views are not supported";
+
+        texture.setStorage(GL_TEXTURE_2D, 64, 64, 0, 0, GL_RGBA8);
+        texture.createShadowedTexture(layers);
+        ASSERT_TRUE(texture.hasShadowTexture());
+    }
+
+    void TearDown() override
+    {
+        texture.deinitialize();
+    }
+
+    static constexpr size_t layers = 4;
+    hi::trackers::TextureMetadata texture = hi::trackers::TextureMetadata(1);
+};
+
+TEST_F(TextureViewTest, CreatesViewPerLayer)
+{
+    // View of the first layer is selected when shadow texture is created
+    const auto firstView = texture.getTextureViewIdOfShadowedTexture();
+    ASSERT_NE(firstView, 0);
+    EXPECT_EQ(texture.getTextureViewOfLayer(0), firstView);
+
+    const auto secondView = texture.getTextureViewOfLayer(1);
+    ASSERT_NE(secondView, 0);
+    EXPECT_NE(secondView, firstView);
+    EXPECT_TRUE(glIsTexture(secondView));
+
+    GLint minLayer = -1;
+    glGetTextureParameteriv(secondView, GL_TEXTURE_VIEW_MIN_LAYER, &minLayer);
+    EXPECT_EQ(minLayer, 1);
+    EXPECT_EQ(glGetError(), GL_NO_ERROR);
+}
+
+TEST_F(TextureViewTest, ReusesViews)
+{
+    const auto view = texture.getTextureViewOfLayer(2);
+    ASSERT_NE(view, 0);
+    EXPECT_EQ(texture.getTextureViewOfLayer(2), view);
+
+    // Rebinding to another layer & back doesn't create a new view
+    texture.setTextureViewToLayer(3);
+    texture.setTextureViewToLayer(2);
+    EXPECT_EQ(texture.getTextureViewIdOfShadowedTexture(), view);
+}
+
+TEST_F(TextureViewTest, CachesFailedViews)
+{
+    // Layered 2D texture can't be viewed as 3D texture
+    EXPECT_EQ(texture.getTextureViewOfLayer(1, GL_TEXTURE_3D), 0);
+    EXPECT_EQ(texture.getTextureViewOfLayer(1, GL_TEXTURE_3D), 0);
+    EXPECT_EQ(glGetError(), GL_NO_ERROR);
+
+    // Failure doesn't affect views of valid target
+    EXPECT_NE(texture.getTextureViewOfLayer(1), 0);
+
+    texture.freeTextureViews();
+    EXPECT_EQ(glGetError(), GL_NO_ERROR);
+}
+
+TEST_F(TextureViewTest, InvalidatesViewsWithShadowTexture)
+{
+    const auto view = texture.getTextureViewOfLayer(1);
+    ASSERT_NE(view, 0);
+
+    const auto epoch = hi::trackers::TextureMetadata::getShadowEpoch();
+    texture.freeShadowedTexture();
+    EXPECT_FALSE(texture.hasShadowTexture());
+    EXPECT_EQ(texture.getTextureViewIdOfShadowedTexture(), 0);
+    EXPECT_FALSE(glIsTexture(view));
+    EXPECT_NE(hi::trackers::TextureMetadata::getShadowEpoch(), epoch);
+
+    // Views are created again for new shadow texture
+    texture.createShadowedTexture(layers);
+    ASSERT_TRUE(texture.hasShadowTexture());
+    const auto newView = texture.getTextureViewOfLayer(1);
+    ASSERT_NE(newView, 0);
+    EXPECT_TRUE(glIsTexture(newView));
+}
+} // namespace
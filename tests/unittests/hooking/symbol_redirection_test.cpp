@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+#include "hooking/symbol_redirection.hpp"
+
+using namespace hi::hooking;
+
+namespace {
+TEST(SymbolRedirection, Empty) {
+    SymbolRedirection redirection;
+    EXPECT_EQ(redirection.find("glClear"), nullptr);
+    EXPECT_FALSE(redirection.hasRedirection("glClear"));
+}
+
+TEST(SymbolRedirection, KnownAndRedirectedSymbols) {
+    SymbolRedirection redirection;
+    int target = 0;
+    redirection.addRedirection("glClear", &target);
+    redirection.addSymbol("glClearColor");
+
+    EXPECT_TRUE(redirection.hasRedirection("glClear"));
+    EXPECT_EQ(redirection.getTarget("glClear"), &target);
+
+    ASSERT_NE(redirection.find("glClearColor"), nullptr);
+    EXPECT_FALSE(redirection.hasRedirection("glClearColor"));
+    EXPECT_EQ(redirection.find("glClearDepth"), nullptr);
+    EXPECT_EQ(redirection.find(""), nullptr);
+
+    // Known symbol can become redirected, table is rebuilt
+    redirection.addRedirection("glClearColor", &target);
+    EXPECT_TRUE(redirection.hasRedirection("glClearColor"));
+    EXPECT_EQ(redirection.getRedirectedSymbols().size(), 2);
+}
+
+TEST(SymbolRedirection, ManySymbols) {
+    SymbolRedirection redirection;
+    const size_t count = 5000;
+    std::vector<int> targets(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        redirection.addRedirection("glFunction" + std::to_string(i), &targets[i]);
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto name = "glFunction" + std::to_string(i);
+        ASSERT_EQ(redirection.getTarget(name.c_str()), &targets[i]) << name;
+    }
+    for (size_t i = count; i < 2 * count; i++)
+    {
+        const auto name = "glFunction" + std::to_string(i);
+        ASSERT_EQ(redirection.find(name.c_str()), nullptr) << name;
+    }
+}
+}
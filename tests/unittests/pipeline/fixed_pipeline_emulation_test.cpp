@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+#include "pipeline/fixed_pipeline_emulation.hpp"
+#include <GL/gl.h>
+using namespace hi;
+using namespace hi::pipeline;
+namespace {
+TEST(FixedPipelineEmulation, Key) {
+    FixedPipelineState defaultState;
+    FixedPipelineState state;
+
+    // State, which doesn't affect output, doesn't create new variant
+    state.enabledLights = 0x3;
+    state.fogMode = GL_LINEAR;
+    state.alphaFunc = GL_GREATER;
+    ASSERT_EQ(state.getKey(), defaultState.getKey());
+
+    state.isAlphaTestEnabled = true;
+    ASSERT_NE(state.getKey(), defaultState.getKey());
+    auto alphaKey = state.getKey();
+    state.alphaFunc = GL_LESS;
+    ASSERT_NE(state.getKey(), alphaKey);
+    state.alphaFunc = GL_ALWAYS;
+    ASSERT_EQ(state.getKey(), defaultState.getKey());
+
+    state.isLightingEnabled = true;
+    auto lightingKey = state.getKey();
+    state.enabledLights = 0x1;
+    ASSERT_NE(state.getKey(), lightingKey);
+}
+
+TEST(FixedPipelineEmulation, Generate) {
+    FixedPipelineState state;
+    state.isLightingEnabled = true;
+    state.enabledLights = 0x5;
+    state.isTexture2DEnabled = true;
+    state.textureEnvMode = GL_REPLACE;
+    state.isFogEnabled = true;
+    state.fogMode = GL_LINEAR;
+    state.isAlphaTestEnabled = true;
+    state.alphaFunc = GL_GREATER;
+
+    auto pipeline = FixedPipelineEmulation::generate(state);
+    ASSERT_EQ(pipeline.size(), 2);
+    const auto& vertexShader = pipeline[GL_VERTEX_SHADER];
+    const auto& fragmentShader = pipeline[GL_FRAGMENT_SHADER];
+
+    ASSERT_NE(vertexShader.find("gl_LightSource[0]"), std::string::npos);
+    ASSERT_EQ(vertexShader.find("gl_LightSource[1]"), std::string::npos);
+    ASSERT_NE(vertexShader.find("gl_LightSource[2]"), std::string::npos);
+    ASSERT_NE(vertexShader.find("gl_MultiTexCoord0"), std::string::npos);
+    ASSERT_NE(fragmentShader.find("color = texel;"), std::string::npos);
+    ASSERT_NE(fragmentShader.find("gl_Fog.scale"), std::string::npos);
+    ASSERT_NE(fragmentShader.find("color.a > injector_ff_alphaRef"), std::string::npos);
+
+    // Disabled features aren't emitted
+    auto unlit = FixedPipelineEmulation::generate(FixedPipelineState());
+    ASSERT_EQ(unlit[GL_VERTEX_SHADER].find("gl_LightSource"), std::string::npos);
+    ASSERT_EQ(unlit[GL_FRAGMENT_SHADER].find("discard"), std::string::npos);
+    ASSERT_EQ(unlit[GL_FRAGMENT_SHADER].find("texture2D"), std::string::npos);
+}
+} //namespace
@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+#include "pipeline/pipeline_cache.hpp"
+#include "pipeline/shader_profile.hpp"
+
+#include <fstream>
+#include <unistd.h>
+
+using namespace hi;
+using namespace hi::pipeline;
+
+namespace {
+const char* vertexShader = R"(
+    #version 330 core
+    layout (location = 0) in vec3 aPos;
+    uniform mat4 mvp;
+    void main()
+    {
+        gl_Position = mvp*vec4(aPos, 1.0);
+    }
+)";
+
+const char* fragmentShader = R"(
+    #version 330 core
+    out vec4 color;
+    void main()
+    {
+        color = vec4(1.0);
+    }
+)";
+
+class PipelineCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        directory = std::filesystem::temp_directory_path() / ("hi_pipeline_cache_test_" + std::to_string(getpid()));
+        std::filesystem::remove_all(directory);
+    }
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+    std::filesystem::path directory;
+    ShaderProfile profiles;
+};
+
+TEST_F(PipelineCacheTest, KeyIsStable)
+{
+    PipelineInjector injector(profiles);
+    PipelineInjector::PipelineType pipeline = { { GL_VERTEX_SHADER, vertexShader }, { GL_FRAGMENT_SHADER, fragmentShader } };
+    PipelineParams params;
+    const auto key = injector.getCacheKey(pipeline, params);
+    ASSERT_EQ(key.size(), 32);
+    ASSERT_EQ(key, injector.getCacheKey(pipeline, params));
+
+    params.countOfViews = 4;
+    ASSERT_NE(key, injector.getCacheKey(pipeline, params));
+
+    params = PipelineParams();
+    pipeline[GL_FRAGMENT_SHADER] += " ";
+    ASSERT_NE(key, injector.getCacheKey(pipeline, params));
+}
+
+TEST_F(PipelineCacheTest, StoreAndLoad)
+{
+    PipelineInjector injector(profiles);
+    PipelineInjector::PipelineType pipeline = { { GL_VERTEX_SHADER, vertexShader }, { GL_FRAGMENT_SHADER, fragmentShader } };
+    const auto key = injector.getCacheKey(pipeline, PipelineParams());
+    auto result = injector.process(pipeline);
+    ASSERT_TRUE(result.metadata);
+
+    PipelineCache cache(directory);
+    ASSERT_TRUE(cache.isEnabled());
+    ASSERT_FALSE(cache.load(key).has_value());
+    ASSERT_TRUE(cache.store(key, result));
+
+    // Other process (instance) reads the entry
+    PipelineCache otherCache(directory);
+    auto cached = otherCache.load(key);
+    ASSERT_TRUE(cached.has_value());
+    ASSERT_EQ(cached->wasSuccessfull, result.wasSuccessfull);
+    ASSERT_EQ(cached->pipeline, result.pipeline);
+    ASSERT_TRUE(cached->metadata);
+    ASSERT_EQ(cached->metadata->m_TransformationMatrixName, "mvp");
+    ASSERT_EQ(cached->metadata->m_IsGeometryShaderUsed, result.metadata->m_IsGeometryShaderUsed);
+    ASSERT_EQ(cached->metadata->m_LayeredSamplers, result.metadata->m_LayeredSamplers);
+
+    // Only entry stays in directory (no temporary files)
+    ASSERT_EQ(std::distance(std::filesystem::directory_iterator(directory), {}), 1);
+}
+
+TEST_F(PipelineCacheTest, CorruptedEntry)
+{
+    PipelineInjector::PipelineProcessResult result { true, { { GL_VERTEX_SHADER, "void main() {}" } }, std::make_unique<ProgramMetadata>(), std::nullopt };
+    auto data = PipelineCache::serialize("key", result);
+    ASSERT_TRUE(PipelineCache::deserialize("key", data).has_value());
+    ASSERT_FALSE(PipelineCache::deserialize("otherKey", data).has_value());
+    ASSERT_FALSE(PipelineCache::deserialize("key", data.substr(0, data.size() / 2)).has_value());
+
+    auto corrupted = data;
+    corrupted[corrupted.find("void")] = 'V';
+    ASSERT_FALSE(PipelineCache::deserialize("key", corrupted).has_value());
+
+    // Corrupted entry is a miss and is removed
+    PipelineCache cache(directory);
+    std::ofstream(directory / "key", std::ios::binary) << corrupted;
+    ASSERT_FALSE(cache.load("key").has_value());
+    ASSERT_FALSE(std::filesystem::exists(directory / "key"));
+}
+
+TEST_F(PipelineCacheTest, Disabled)
+{
+    PipelineCache cache;
+    PipelineInjector::PipelineProcessResult result { true, {}, nullptr, std::nullopt };
+    ASSERT_FALSE(cache.isEnabled());
+    ASSERT_FALSE(cache.store("key", result));
+    ASSERT_FALSE(cache.load("key").has_value());
+}
+} //namespace
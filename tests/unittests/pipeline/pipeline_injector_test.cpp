@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 #include "pipeline/pipeline_injector.hpp"
 #include "pipeline/shader_profile.hpp"
+#include "pipeline/shader_inspector.hpp"
 #include <GL/gl.h>
 using namespace hi;
 using namespace hi::pipeline;
@@ -23,6 +24,26 @@ namespace helper
         printf("[Metadata] is clip space: %d\n",metadata.m_IsClipSpaceTransform);
  
     }
+
+    /// VS & FS pipeline of given GLSL version, whose VS outputs vec4(position, 1.0)
+    static PipelineInjector::PipelineType createPipeline(const std::string& version, const std::string& position = "vertex")
+    {
+        return {
+            {GL_VERTEX_SHADER, "#version " + version + R"(
+            in vec3 vertex;
+            void main()
+            {
+                gl_Position = vec4()" + position + R"(, 1.0);
+            }
+        )"},
+            {GL_FRAGMENT_SHADER, "#version " + version + R"(
+            void main()
+            {
+                gl_FragColor = vec4(1.0);
+            }
+        )"},
+        };
+    }
 } // helper
 namespace {
 TEST(PipelineInjector, Insertion) {
@@ -224,4 +245,111 @@ TEST(PipelineInjector, InOutTest) {
     ASSERT_TRUE((result.pipeline[GL_FRAGMENT_SHADER]).find(" uv") == std::string::npos);
 }
 
+TEST(PipelineInjector, ParametersBlock) {
+
+    ShaderProfile profiles;
+    PipelineInjector injector(profiles);
+
+    PipelineParams params;
+    params.shouldUseParametersBlock = true;
+
+    // GLSL 3.30 supports uniform blocks
+    auto result = injector.process(helper::createPipeline("330"), params);
+    ASSERT_TRUE(result.wasSuccessfull);
+    EXPECT_NE(result.pipeline[GL_GEOMETRY_SHADER].find("injector_ParametersBlock"), std::string::npos);
+    EXPECT_EQ(result.pipeline[GL_GEOMETRY_SHADER].find("uniform float injector_XShiftMultiplier"), std::string::npos);
+
+    // GLSL 1.20 does not, so all stages must fall back to loose uniforms
+    result = injector.process(helper::createPipeline("120"), params);
+    ASSERT_TRUE(result.wasSuccessfull);
+    EXPECT_EQ(result.pipeline[GL_GEOMETRY_SHADER].find("injector_ParametersBlock"), std::string::npos);
+    EXPECT_NE(result.pipeline[GL_GEOMETRY_SHADER].find("uniform float injector_XShiftMultiplier"), std::string::npos);
+}
+
+TEST(PipelineInjector, InstancedLayers) {
+
+    ShaderProfile profiles;
+    PipelineInjector injector(profiles);
+
+    PipelineParams params;
+    params.shouldPreventGeometryShaderInsertion = true;
+    params.shouldUseInstancedLayers = true;
+
+    auto result = injector.process(helper::createPipeline("330", "vertex+vec3(gl_InstanceID)"), params);
+    ASSERT_TRUE(result.wasSuccessfull);
+    ASSERT_TRUE(result.metadata);
+    EXPECT_FALSE(result.metadata->usesGeometryShader());
+    EXPECT_TRUE(result.metadata->usesInstancedLayering());
+    EXPECT_EQ(result.pipeline.count(GL_GEOMETRY_SHADER), 0);
+
+    const auto& vs = result.pipeline[GL_VERTEX_SHADER];
+    // Extension must directly follow #version
+    EXPECT_EQ(vs.find("#version 330\n#extension GL_ARB_shader_viewport_layer_array : require"), 0);
+    EXPECT_NE(vs.find("gl_Layer = injector_view"), std::string::npos);
+    // Application's instance ID is rescaled
+    EXPECT_NE(vs.find("vec3(injector_instanceID)"), std::string::npos);
+    EXPECT_NE(vs.find("injector_instanceID = gl_InstanceID / injector_instanced_views"), std::string::npos);
+
+    // gl_InstanceID is not available in GLSL 1.20 => views are repeated by draw calls
+    result = injector.process(helper::createPipeline("120", "vertex+vec3(gl_InstanceID)"), params);
+    ASSERT_TRUE(result.wasSuccessfull);
+    EXPECT_FALSE(result.metadata->usesInstancedLayering());
+    EXPECT_EQ(result.pipeline[GL_VERTEX_SHADER].find("gl_Layer"), std::string::npos);
+}
+
+TEST(PipelineInjector, ReplayView) {
+
+    ShaderProfile profiles;
+    PipelineInjector injector(profiles);
+
+    PipelineParams params;
+    params.shouldPreventGeometryShaderInsertion = true;
+    params.shouldUseParametersBlock = true;
+
+    // Replayed draw calls select view by parameters block
+    auto result = injector.process(helper::createPipeline("330"), params);
+    ASSERT_TRUE(result.wasSuccessfull);
+    const auto& vs = result.pipeline[GL_VERTEX_SHADER];
+    EXPECT_NE(vs.find("injector_transform(injector_geometry_isClipSpace,(injector_replayViewID >= 0 ? injector_replayViewID : injector_singleViewID), gl_Position)"), std::string::npos);
+
+    std::string commonCode = "#version 330\n";
+    ShaderInspector::injectCommonCode(commonCode, true);
+    EXPECT_NE(commonCode.find("int injector_replayViewID;"), std::string::npos);
+
+    // Without parameters block, draw calls can't be replayed
+    result = injector.process(helper::createPipeline("120"), params);
+    ASSERT_TRUE(result.wasSuccessfull);
+    EXPECT_EQ(result.pipeline[GL_VERTEX_SHADER].find("injector_replayViewID"), std::string::npos);
+    EXPECT_NE(result.pipeline[GL_VERTEX_SHADER].find("injector_transform(injector_geometry_isClipSpace,injector_singleViewID, gl_Position)"), std::string::npos);
+}
+
+TEST(PipelineInjector, MultiviewExtension) {
+
+    ShaderProfile profiles;
+    PipelineInjector injector(profiles);
+
+    PipelineParams params;
+    params.shouldUseMultiviewExtension = true;
+    params.countOfViews = 4;
+
+    auto result = injector.process(helper::createPipeline("330"), params);
+    ASSERT_TRUE(result.wasSuccessfull);
+    ASSERT_TRUE(result.metadata);
+    EXPECT_FALSE(result.metadata->usesGeometryShader());
+    EXPECT_TRUE(result.metadata->usesMultiviewExtension());
+    EXPECT_EQ(result.pipeline.count(GL_GEOMETRY_SHADER), 0);
+
+    const auto& vs = result.pipeline[GL_VERTEX_SHADER];
+    EXPECT_EQ(vs.find("#version 330\n#extension GL_OVR_multiview2 : require"), 0);
+    EXPECT_NE(vs.find("layout(num_views = 4) in;"), std::string::npos);
+    EXPECT_NE(vs.find("int(gl_ViewID_OVR)"), std::string::npos);
+
+    // GLSL 1.20 is not supported by extension => fall back to Geometry Shader
+    result = injector.process(helper::createPipeline("120"), params);
+    ASSERT_TRUE(result.wasSuccessfull);
+    EXPECT_FALSE(result.metadata->usesMultiviewExtension());
+    EXPECT_TRUE(result.metadata->usesGeometryShader());
+    EXPECT_EQ(result.pipeline[GL_VERTEX_SHADER].find("gl_ViewID_OVR"), std::string::npos);
+}
+
 }
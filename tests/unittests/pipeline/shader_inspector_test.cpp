@@ -340,3 +340,49 @@ TEST(ShaderInspector, InOutTest) {
 }
 
 
+
+TEST(ShaderInspector, LayeredSamplers) {
+    std::string shader = R"(
+        #version 330 core
+        uniform sampler2D diffuse;
+        uniform sampler2D   normals ;
+        in vec2 uv;
+        out vec4 color;
+        void main()
+        {
+            ivec2 size = textureSize(normals, 0);
+            color = texture(diffuse, uv) + texelFetch(normals, ivec2(uv * vec2(size)), 0);
+        }
+        )";
+    auto inspector = hi::pipeline::ShaderInspector(shader);
+    ASSERT_TRUE(inspector.hasSamplers());
+    auto samplers = inspector.getLayerableSamplers();
+    ASSERT_EQ(samplers.size(), 2);
+    ASSERT_EQ(samplers[0], "diffuse");
+    ASSERT_EQ(samplers[1], "normals");
+
+    auto result = inspector.injectLayeredSamplers(samplers, "layer");
+    ASSERT_NE(result.find("uniform sampler2DArray injector_layered_diffuse;"), std::string::npos);
+    ASSERT_NE(result.find("uniform bool injector_isLayered_normals;"), std::string::npos);
+    ASSERT_NE(result.find("textureSize(injector_layered_normals"), std::string::npos);
+    ASSERT_NE(result.find("color = injector_texture_diffuse( uv)"), std::string::npos);
+    ASSERT_NE(result.find("injector_texelFetch_normals( ivec2"), std::string::npos);
+    ASSERT_NE(result.find("size = injector_textureSize_normals( 0)"), std::string::npos);
+
+    // Sampler passed to a user function can't be redirected
+    std::string passedSampler = R"(
+        uniform sampler2D diffuse;
+        vec4 sample(sampler2D s) { return texture(s, vec2(0.0)); }
+        void main() { gl_FragColor = sample(diffuse); }
+        )";
+    ASSERT_TRUE(hi::pipeline::ShaderInspector(passedSampler).getLayerableSamplers().empty());
+
+    // Other sampler types prevent redirection
+    std::string cubeSampler = R"(
+        uniform sampler2D diffuse;
+        uniform samplerCube sky;
+        void main() { gl_FragColor = texture2D(diffuse, vec2(0.0)) + textureCube(sky, vec3(0.0)); }
+        )";
+    ASSERT_TRUE(hi::pipeline::ShaderInspector(cubeSampler).getLayerableSamplers().empty());
+    ASSERT_FALSE(hi::pipeline::ShaderInspector("void main() {}").hasSamplers());
+}
@@ -0,0 +1,300 @@
+#include "gtest/gtest.h"
+#include "pipeline/shader_inspector.hpp"
+#include "pipeline/shader_parser.hpp"
+#include "utils/glsl_preprocess.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <regex>
+#include <set>
+#include <sstream>
+
+namespace {
+/*
+ * Regex-based queries, which ShaderIndex replaces (kept as reference)
+ */
+namespace reference
+{
+    const std::string ws = "[\f\n\r\t\v ]";
+
+    bool isUniformVariableInInterfaceBlock(const std::string& code, const std::string& identifier)
+    {
+        auto pattern = std::regex("uniform[^;]*[{][^}]*" + ws + identifier + ws + "*;[^}]*[}]", std::regex::extended);
+        return std::regex_search(code, pattern);
+    }
+
+    std::string getUniformBlockName(const std::string& code, const std::string& uniformName)
+    {
+        auto pattern = std::regex("uniform[^;]*" + ws + "([a-zA-Z][a-zA-Z0-9_]*)[^;]*[{][^}]*" + ws + uniformName + ws + "*;[^}]*[}]", std::regex::extended);
+        std::smatch matches;
+        if (std::regex_search(code, matches, pattern) && matches.size() > 1)
+            return matches[1];
+        return "";
+    }
+
+    bool isUniformVariable(const std::string& code, const std::string& identifier)
+    {
+        if (isUniformVariableInInterfaceBlock(code, identifier))
+            return true;
+        auto pattern = std::regex("uniform[^;]*" + ws + identifier + ws + "*;", std::regex::extended);
+        return std::regex_search(code, pattern);
+    }
+
+    std::string getVariableType(const std::string& code, const std::string& variable)
+    {
+        auto pattern = std::regex("[a-zA-Z0-9]+" + ws + "+" + variable + ws + "*;", std::regex::extended);
+        std::smatch m;
+        if (!std::regex_search(code, m, pattern))
+            return "";
+        const auto statement = std::string(m[0]);
+        return statement.substr(0, statement.find_first_of("\f\n\r\t\v "));
+    }
+
+    std::vector<std::string> findAllOutVertexAssignments(const std::string& code)
+    {
+        std::vector<std::string> result;
+        auto pattern = std::regex("gl_Position" + ws + "*=" + ws + "*[^;]*;", std::regex::extended);
+        for (auto it = std::sregex_iterator(code.begin(), code.end(), pattern); it != std::sregex_iterator(); it++)
+            result.push_back(it->str());
+        return result;
+    }
+
+    hi::pipeline::ShaderInspector::TypeNamePairList getListOfGlobals(const std::string& code, const std::string& storage)
+    {
+        hi::pipeline::ShaderInspector::TypeNamePairList result;
+        auto pattern = std::regex(ws + storage + ws + "[^;]+");
+        const auto searchIn = hi::glsl_preprocess::removeComments(code);
+        for (auto it = std::sregex_iterator(searchIn.begin(), searchIn.end(), pattern); it != std::sregex_iterator(); it++)
+        {
+            const auto definition = it->str();
+            const auto tokens = hi::pipeline::tokenize(definition);
+            result.emplace_back(tokens[tokens.size() - 2], tokens[tokens.size() - 1]);
+        }
+        return result;
+    }
+
+    size_t getCountOfUniforms(const std::string& code)
+    {
+        size_t count = 0;
+        for (auto position = code.find("uniform"); position != std::string::npos; position = code.find("uniform", position + 1))
+            count++;
+        return count;
+    }
+} // namespace reference
+
+const std::vector<std::string> shaders = {
+    R"(
+        uniform mat4 MV ;
+        uniform vec3 normal;
+        uniform mat4 MVP  ;
+        uniform mat4    P   ;
+        int main()
+        {
+            gl_Position    =   P*   MVP*vec4(1.0);
+        }
+        )",
+    R"(
+        #version 330 core
+        layout(location = 3) in vec3 normal;
+        int main()
+        {
+            gl_Position = vec3(normal, 1.0);
+            vec3 test = gl_Position;
+            gl_Position = gl_Position+vec3(1.0);
+        }
+        )",
+    R"(
+        #version 330 core
+        layout(location = 3) in vec3 normal;
+        int main()
+        {
+            gl_Position.xyz    =   vec3(normal, 1.0);
+        }
+        )",
+    R"(
+        #version 330 core
+        layout(location = 0) in vec4 position;
+        uniform mat4 MV;
+        uniform mat4 MVP;
+        int main()
+        {
+            gl_Position   =   MVP*position;
+            // Some arbitrary constant offset => just for test
+            gl_Position = gl_Position + vec4(0.0,0.0,1.0,0.0);
+        }
+        )",
+    R"(
+        #version 330 core
+
+        // Input vertex data, different for all executions of this shader.
+        layout(location = 0) in vec3 vertexPosition_modelspace;
+        layout(location = 1) in vec2 vertexUV;
+
+        // Output data ; will be interpolated for each fragment.
+        out vec2 UV;
+
+        // Values that stay constant for the whole mesh.
+        uniform Hello{
+            mat4 MVP;
+        };
+
+        void main(){
+
+                // Output position of the vertex, in clip space : MVP * position
+                gl_Position =  MVP * vec4(vertexPosition_modelspace,1);
+
+                // UV of the vertex. No special space for this one.
+                UV = vertexUV;
+        }
+        )",
+    R"(
+        #version 330 core
+        layout (location = 0) in vec3 aPos;
+
+        out vec3 TexCoords;
+
+        uniform mat4 projection;
+        uniform mat4 view;
+        uniform mat4 MVP_P  ;
+
+        void main()
+        {
+            TexCoords = aPos;
+            vec4 pos = projection * view * vec4(aPos, 1.0);
+            gl_Position = vec4(aPos, 1.0);
+            vec4 tmp = projection * aPos;
+            gl_Position = vec4(tmp);
+            gl_Position = tmp.xyww;
+            gl_Position = ftransform();
+            gl_Position = vec4(projection*aPos);
+
+            vec4 a = projection*aPos;
+            vec4 b = a;
+            gl_Position = b;
+        }
+        )",
+    R"(
+            #version 330
+            in vec3 vertex;
+
+            out vec2 uv;
+
+            uniform mat4 mvp;
+            void main()
+            {
+                normal = vertex.xy;
+                gl_Position = mvp*vec4(vertex);
+            }
+        )",
+};
+
+/// Inspector, exposing its source code
+class TestedInspector : public hi::pipeline::ShaderInspector
+{
+public:
+    using ShaderInspector::ShaderInspector;
+    const std::string& getCode() const { return sourceCode; }
+};
+
+TEST(ShaderParser, TokenizeSource) {
+    const auto tokens = hi::pipeline::tokenizeSource(R"(
+        #version 330 core
+        #define X \
+            1
+        // uniform mat4 commented;
+        uniform mat4 _MVP; /* uniform
+        mat4 alsoCommented; */ out vec4 color;
+        )");
+    const std::vector<std::string_view> expected = { "uniform", "mat4", "_MVP", ";", "out", "vec4", "color", ";" };
+    ASSERT_EQ(tokens, expected);
+}
+
+TEST(ShaderParser, Index) {
+    hi::pipeline::ShaderIndex index(R"(
+        #version 330 core
+        layout(std140) uniform Params
+        {
+            mat4 VP;
+            vec4 colors[4];
+        } params;
+        in VertexData { vec2 uv; } vs;
+        flat in int layer;
+        uniform mat4 model, view = mat4(1.0, 0.0), proj[2];
+        struct Light { vec3 position; };
+        vec4 transform(in vec4 p);
+        void main()
+        {
+            vec4 position = proj[0] * view * model * vec4(vs.uv, 0.0, 1.0);
+            for (int i = 0; i < 4; i++)
+                position += colors[i];
+            gl_Position = position;
+            gl_Position.xy = vec2(0.0);
+        }
+        )");
+    ASSERT_EQ(index.getCountOfUniformQualifiers(), 2);
+
+    const auto vp = index.findDeclaration("VP", "uniform");
+    ASSERT_NE(vp, nullptr);
+    ASSERT_EQ(vp->type, "mat4");
+    ASSERT_EQ(index.getInterfaceBlocks()[vp->block].name, "Params");
+    ASSERT_EQ(index.getInterfaceBlocks()[vp->block].instanceName, "params");
+    ASSERT_EQ(index.findDeclaration("colors")->type, "vec4");
+
+    ASSERT_EQ(index.findDeclaration("uv", "in")->block, 1);
+    ASSERT_EQ(index.getInterfaceBlocks()[1].instanceName, "vs");
+    ASSERT_EQ(index.findDeclaration("layer")->qualifiers, std::vector<std::string> { "flat" });
+    ASSERT_EQ(index.findDeclaration("model")->storage, "uniform");
+    ASSERT_EQ(index.findDeclaration("view")->storage, "uniform");
+    ASSERT_EQ(index.findDeclaration("proj")->type, "mat4");
+    ASSERT_EQ(index.findDeclaration("position")->storage, "");
+    ASSERT_EQ(index.findDeclaration("position")->block, 2);
+    ASSERT_FALSE(index.findDeclaration("p"));
+    ASSERT_FALSE(index.findDeclaration("transform"));
+
+    const auto localPosition = index.getDeclarations().back();
+    ASSERT_EQ(localPosition.name, "position");
+    ASSERT_FALSE(localPosition.isGlobal);
+
+    ASSERT_EQ(index.getAssignmentsTo("gl_Position").size(), 1);
+    ASSERT_EQ(index.getAssignmentsTo("position").size(), 1);
+    ASSERT_EQ(index.getAssignmentsTo("i").size(), 1);
+    ASSERT_EQ(index.getAssignmentsTo("location").size(), 0);
+    ASSERT_TRUE(index.hasSwizzle("xy"));
+    ASSERT_FALSE(index.hasSwizzle("xyww"));
+}
+
+/// Index-based queries must give the same answers as regex-based ones on unit-test shaders
+TEST(ShaderParser, RegexEquivalence) {
+    for (const auto& shader : shaders)
+    {
+        TestedInspector inspector(shader);
+        const auto& code = inspector.getCode();
+
+        const auto tokens = hi::pipeline::tokenize(code);
+        const std::set<std::string> identifiers(tokens.begin(), tokens.end());
+        for (const auto& identifier : identifiers)
+        {
+            if (!inspector.isIdentifier(identifier))
+                continue;
+            ASSERT_EQ(inspector.isUniformVariable(identifier), reference::isUniformVariable(code, identifier)) << identifier;
+            ASSERT_EQ(inspector.isUniformVariableInInterfaceBlock(identifier), reference::isUniformVariableInInterfaceBlock(code, identifier)) << identifier;
+            ASSERT_EQ(inspector.getUniformBlockName(identifier), reference::getUniformBlockName(code, identifier)) << identifier;
+            // Index also resolves declarations with initializer, which regex skipped, and ignores comments
+            const auto referenceType = reference::getVariableType(hi::glsl_preprocess::removeComments(code), identifier);
+            if (!referenceType.empty())
+                ASSERT_EQ(inspector.getVariableType(identifier), referenceType) << identifier;
+        }
+
+        std::vector<std::string> assignments;
+        for (const auto& assignment : inspector.findAllOutVertexAssignments())
+            assignments.push_back(assignment.statementRawText);
+        ASSERT_EQ(assignments, reference::findAllOutVertexAssignments(code));
+
+        ASSERT_EQ(inspector.getListOfInputs(), reference::getListOfGlobals(code, "in"));
+        ASSERT_EQ(inspector.getListOfOutputs(), reference::getListOfGlobals(code, "out"));
+        ASSERT_EQ(inspector.getCountOfUniforms(), reference::getCountOfUniforms(code));
+        ASSERT_EQ(inspector.isClipSpaceShader(), std::regex_search(code, std::regex(".[\f\n\r\t\v ]*xyww")));
+        ASSERT_EQ(inspector.hasFtransform(), code.find("ftransform") != std::string::npos);
+    }
+}
+} //namespace
@@ -0,0 +1,137 @@
+#include "gtest/gtest.h"
+#include "trackers/immediate_mode_tracker.hpp"
+
+using namespace hi;
+using namespace hi::trackers;
+
+namespace {
+TEST(ImmediateModeTracker, Batch) {
+    ImmediateModeTracker tracker;
+    EXPECT_FALSE(tracker.isInsideBatch());
+
+    // Vertices outside batch are ignored
+    tracker.vertex(1.0f, 2.0f);
+    tracker.begin(GL_TRIANGLES);
+    EXPECT_TRUE(tracker.isInsideBatch());
+    EXPECT_EQ(tracker.getMode(), GL_TRIANGLES);
+    EXPECT_TRUE(tracker.getVertices().empty());
+
+    /*
+     * Each vertex captures current attributes
+     */
+    tracker.color(1.0f, 0.0f, 0.0f);
+    tracker.vertex(1.0f, 2.0f);
+    tracker.normal(0.0f, 1.0f, 0.0f);
+    tracker.texCoord(0.5f, 0.25f);
+    tracker.color(0.0f, 1.0f, 0.0f, 0.5f);
+    tracker.vertex(3.0f, 4.0f, 5.0f);
+    tracker.end();
+    EXPECT_FALSE(tracker.isInsideBatch());
+
+    const auto& vertices = tracker.getVertices();
+    ASSERT_EQ(vertices.size(), 2);
+    EXPECT_FLOAT_EQ(vertices[0].position[0], 1.0f);
+    EXPECT_FLOAT_EQ(vertices[0].position[2], 0.0f);
+    EXPECT_FLOAT_EQ(vertices[0].position[3], 1.0f);
+    EXPECT_FLOAT_EQ(vertices[0].color[0], 1.0f);
+    EXPECT_FLOAT_EQ(vertices[0].color[1], 0.0f);
+    EXPECT_FLOAT_EQ(vertices[0].normal[2], 1.0f);
+    EXPECT_FLOAT_EQ(vertices[0].texCoord[3], 1.0f);
+
+    EXPECT_FLOAT_EQ(vertices[1].position[2], 5.0f);
+    EXPECT_FLOAT_EQ(vertices[1].normal[1], 1.0f);
+    EXPECT_FLOAT_EQ(vertices[1].texCoord[0], 0.5f);
+    EXPECT_FLOAT_EQ(vertices[1].texCoord[1], 0.25f);
+    EXPECT_FLOAT_EQ(vertices[1].color[1], 1.0f);
+    EXPECT_FLOAT_EQ(vertices[1].color[3], 0.5f);
+
+    // Current attributes persist to next batch
+    tracker.begin(GL_LINES);
+    EXPECT_TRUE(tracker.getVertices().empty());
+    tracker.vertex(0.0f, 0.0f);
+    tracker.end();
+    ASSERT_EQ(tracker.getVertices().size(), 1);
+    EXPECT_FLOAT_EQ(tracker.getVertices()[0].color[1], 1.0f);
+    EXPECT_FLOAT_EQ(tracker.getCurrent().texCoord[0], 0.5f);
+}
+
+TEST(ImmediateModeTracker, BatchAttributes) {
+    ImmediateModeTracker tracker;
+    // Attributes, set outside of batch, are current state of OpenGL
+    tracker.color(1.0f, 0.0f, 0.0f);
+    tracker.begin(GL_TRIANGLES);
+    tracker.vertex(0.0f, 0.0f);
+    tracker.normal(0.0f, 1.0f, 0.0f);
+    tracker.vertex(1.0f, 0.0f);
+    tracker.end();
+    EXPECT_EQ(tracker.getBatchAttributes(), ImmediateModeTracker::NORMAL_ATTRIBUTE);
+    EXPECT_EQ(tracker.getUnresolvedAttributes(), 0);
+}
+
+TEST(ImmediateModeTracker, Invalidation) {
+    ImmediateModeTracker tracker;
+    tracker.color(1.0f, 0.0f, 0.0f);
+    // E.g. glPopAttrib(GL_CURRENT_BIT)
+    tracker.invalidate();
+
+    tracker.begin(GL_LINES);
+    tracker.vertex(0.0f, 0.0f);
+    tracker.vertex(1.0f, 0.0f);
+    tracker.color(0.0f, 0.0f, 1.0f);
+    tracker.vertex(2.0f, 0.0f);
+    tracker.end();
+
+    // Color of first two vertices is unknown, normal isn't sourced from batch
+    EXPECT_EQ(tracker.getBatchAttributes(), ImmediateModeTracker::COLOR_ATTRIBUTE);
+    EXPECT_EQ(tracker.getUnresolvedAttributes(), ImmediateModeTracker::COLOR_ATTRIBUTE);
+    const float current[4] = { 0.0f, 1.0f, 0.0f, 1.0f };
+    tracker.resolve(ImmediateModeTracker::COLOR_ATTRIBUTE, current);
+    EXPECT_EQ(tracker.getUnresolvedAttributes(), 0);
+
+    const auto& vertices = tracker.getVertices();
+    ASSERT_EQ(vertices.size(), 3);
+    EXPECT_FLOAT_EQ(vertices[0].color[1], 1.0f);
+    EXPECT_FLOAT_EQ(vertices[1].color[1], 1.0f);
+    EXPECT_FLOAT_EQ(vertices[2].color[2], 1.0f);
+
+    // Set color is known again
+    tracker.begin(GL_POINTS);
+    tracker.vertex(0.0f, 0.0f);
+    tracker.color(1.0f, 1.0f, 1.0f);
+    tracker.end();
+    EXPECT_EQ(tracker.getUnresolvedAttributes(), 0);
+}
+
+TEST(ImmediateModeTracker, DisplayLists) {
+    ImmediateModeTracker tracker;
+    tracker.color(1.0f, 0.0f, 0.0f);
+
+    // Compiled list neither captures batches, nor changes current attributes
+    tracker.beginList(GL_COMPILE);
+    EXPECT_FALSE(tracker.begin(GL_TRIANGLES));
+    EXPECT_FALSE(tracker.isInsideBatch());
+    tracker.color(0.0f, 1.0f, 0.0f);
+    tracker.endList();
+    EXPECT_FLOAT_EQ(tracker.getCurrent().color[0], 1.0f);
+
+    // Executed list changes current attributes
+    tracker.beginList(GL_COMPILE_AND_EXECUTE);
+    tracker.color(0.0f, 1.0f, 0.0f);
+    tracker.endList();
+    EXPECT_FLOAT_EQ(tracker.getCurrent().color[1], 1.0f);
+    EXPECT_TRUE(tracker.begin(GL_TRIANGLES));
+}
+
+TEST(ImmediateModeTracker, Normalization) {
+    EXPECT_FLOAT_EQ(ImmediateModeTracker::normalize(0.25), 0.25f);
+    EXPECT_FLOAT_EQ(ImmediateModeTracker::normalize(static_cast<GLubyte>(255)), 1.0f);
+    EXPECT_FLOAT_EQ(ImmediateModeTracker::normalize(static_cast<GLubyte>(0)), 0.0f);
+    EXPECT_FLOAT_EQ(ImmediateModeTracker::normalize(static_cast<GLushort>(65535)), 1.0f);
+    EXPECT_FLOAT_EQ(ImmediateModeTracker::normalize(static_cast<GLuint>(4294967295u)), 1.0f);
+    // Signed: (2c + 1) / (2^b - 1)
+    EXPECT_FLOAT_EQ(ImmediateModeTracker::normalize(static_cast<GLbyte>(127)), 1.0f);
+    EXPECT_FLOAT_EQ(ImmediateModeTracker::normalize(static_cast<GLbyte>(-128)), -1.0f);
+    EXPECT_FLOAT_EQ(ImmediateModeTracker::normalize(static_cast<GLshort>(32767)), 1.0f);
+    EXPECT_FLOAT_EQ(ImmediateModeTracker::normalize(static_cast<GLint>(-2147483647 - 1)), -1.0f);
+}
+} // namespace
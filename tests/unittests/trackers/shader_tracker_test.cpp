@@ -73,3 +73,30 @@ TEST(ShaderPArser, Lexing) {
     EXPECT_TOKENS("vec4 pos = vec4(aPos, 1.0);", "vec4","pos","=","vec4","(","aPos",",","1.0",")", ";")
 }
 }
+
+#include "trackers/shader_tracker.hpp"
+
+TEST(ShaderProgram, SamplerUnits) {
+    hi::trackers::ShaderProgram program;
+    auto& samplers = program.m_InjectorUniforms.layeredSamplers;
+    samplers.resize(3);
+    samplers[0].sampler = 4;
+    samplers[1].sampler = 7;
+    samplers[2].sampler = -1;
+    program.m_LayeredSamplerUnits = { 0, 0, 0 };
+
+    // glUniform1i
+    const GLint unit = 5;
+    program.setSamplerUnits(4, 1, &unit);
+    EXPECT_EQ(program.m_LayeredSamplerUnits, std::vector<GLint>({ 5, 0, 0 }));
+
+    // glUniform1iv, covering both samplers
+    const GLint units[] = { 1, 2, 3, 4 };
+    program.setSamplerUnits(4, 4, units);
+    EXPECT_EQ(program.m_LayeredSamplerUnits, std::vector<GLint>({ 1, 4, 0 }));
+
+    // Other uniforms don't change samplers
+    program.setSamplerUnits(8, 1, &unit);
+    program.setSamplerUnits(-1, 1, &unit);
+    EXPECT_EQ(program.m_LayeredSamplerUnits, std::vector<GLint>({ 1, 4, 0 }));
+}
@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include "trackers/state_tracker.hpp"
+#include "trackers/texture_tracker.hpp"
+
+using namespace hi;
+using namespace hi::trackers;
+
+namespace {
+TEST(StateTracker, Buffers) {
+    StateTracker st;
+    EXPECT_EQ(st.getBoundBuffer(GL_UNIFORM_BUFFER), 0);
+
+    st.bindBuffer(GL_UNIFORM_BUFFER, 1);
+    st.bindBuffer(GL_ARRAY_BUFFER, 2);
+    EXPECT_EQ(st.getBoundBuffer(GL_UNIFORM_BUFFER), 1);
+    EXPECT_EQ(st.getBoundBuffer(GL_ARRAY_BUFFER), 2);
+
+    /*
+     * Deleted buffer is unbound from all targets
+     */
+    st.bindBuffer(GL_COPY_READ_BUFFER, 1);
+    st.deleteBuffer(1);
+    EXPECT_EQ(st.getBoundBuffer(GL_UNIFORM_BUFFER), 0);
+    EXPECT_EQ(st.getBoundBuffer(GL_COPY_READ_BUFFER), 0);
+    EXPECT_EQ(st.getBoundBuffer(GL_ARRAY_BUFFER), 2);
+}
+
+TEST(StateTracker, Capabilities) {
+    StateTracker st;
+    EXPECT_FALSE(st.isEnabled(GL_DEPTH_TEST));
+    st.setCapability(GL_DEPTH_TEST, true);
+    st.setCapability(GL_STENCIL_TEST, true);
+    EXPECT_TRUE(st.isEnabled(GL_DEPTH_TEST));
+    EXPECT_TRUE(st.isEnabled(GL_STENCIL_TEST));
+    st.setCapability(GL_DEPTH_TEST, false);
+    EXPECT_FALSE(st.isEnabled(GL_DEPTH_TEST));
+    EXPECT_TRUE(st.isEnabled(GL_STENCIL_TEST));
+}
+
+TEST(StateTracker, IndexedCapabilities) {
+    StateTracker st;
+    // glIsEnabled() returns state of index 0
+    st.setCapability(GL_BLEND, 1, true);
+    EXPECT_FALSE(st.isEnabled(GL_BLEND));
+    st.setCapability(GL_BLEND, 0, true);
+    EXPECT_TRUE(st.isEnabled(GL_BLEND));
+    st.setCapability(GL_SCISSOR_TEST, 0, true);
+    st.setCapability(GL_SCISSOR_TEST, 0, false);
+    EXPECT_FALSE(st.isEnabled(GL_SCISSOR_TEST));
+}
+
+TEST(StateTracker, AttributeStack) {
+    StateTracker st;
+    st.setCapability(GL_DEPTH_TEST, true);
+    st.pushAttributes(GL_ENABLE_BIT);
+    st.pushAttributes(GL_COLOR_BUFFER_BIT);
+    st.setCapability(GL_BLEND, true);
+    st.setCapability(GL_DEPTH_TEST, false);
+    st.setCapability(GL_PRIMITIVE_RESTART, true);
+
+    // Only capabilities of popped group are restored
+    st.popAttributes();
+    EXPECT_FALSE(st.isEnabled(GL_BLEND));
+    EXPECT_FALSE(st.isEnabled(GL_DEPTH_TEST));
+    st.popAttributes();
+    EXPECT_TRUE(st.isEnabled(GL_DEPTH_TEST));
+    // Client state isn't part of attribute groups
+    EXPECT_TRUE(st.isEnabled(GL_PRIMITIVE_RESTART));
+
+    // Unmatched pop is ignored
+    st.popAttributes();
+    EXPECT_TRUE(st.isEnabled(GL_DEPTH_TEST));
+}
+
+TEST(StateTracker, VertexArrays) {
+    StateTracker st;
+    EXPECT_FALSE(st.hasInstancedAttributes());
+
+    st.bindVertexArray(1);
+    st.setBindingDivisor(1, 3, 1);
+    st.setBindingDivisor(2, 0, 1);
+    EXPECT_EQ(st.getBoundVertexArray(), 1);
+    EXPECT_TRUE(st.hasInstancedAttributes());
+
+    // Divisors are per VAO
+    st.bindVertexArray(3);
+    EXPECT_FALSE(st.hasInstancedAttributes());
+    st.bindVertexArray(2);
+    EXPECT_TRUE(st.hasInstancedAttributes());
+    st.setBindingDivisor(2, 0, 0);
+    EXPECT_FALSE(st.hasInstancedAttributes());
+
+    // Deleted VAO is unbound and forgotten
+    st.bindVertexArray(1);
+    st.deleteVertexArray(1);
+    EXPECT_EQ(st.getBoundVertexArray(), 0);
+    st.bindVertexArray(1);
+    EXPECT_FALSE(st.hasInstancedAttributes());
+}
+
+TEST(StateTracker, Lists) {
+    StateTracker st;
+    EXPECT_FALSE(st.isCompilingList());
+    st.beginList(4);
+    EXPECT_TRUE(st.isCompilingList());
+    st.endList();
+    EXPECT_FALSE(st.isCompilingList());
+}
+
+TEST(StateTracker, ClientActiveTexture) {
+    StateTracker st;
+    EXPECT_EQ(st.getClientActiveTexture(), GL_TEXTURE0);
+    st.setClientActiveTexture(GL_TEXTURE2);
+    EXPECT_EQ(st.getClientActiveTexture(), GL_TEXTURE2);
+
+    // Restored only by client vertex array group
+    st.pushClientAttributes(GL_CLIENT_VERTEX_ARRAY_BIT);
+    st.pushClientAttributes(GL_CLIENT_PIXEL_STORE_BIT);
+    st.setClientActiveTexture(GL_TEXTURE1);
+    st.popClientAttributes();
+    EXPECT_EQ(st.getClientActiveTexture(), GL_TEXTURE1);
+    st.popClientAttributes();
+    EXPECT_EQ(st.getClientActiveTexture(), GL_TEXTURE2);
+
+    // Unbalanced pop is ignored
+    st.popClientAttributes();
+    EXPECT_EQ(st.getClientActiveTexture(), GL_TEXTURE2);
+}
+
+TEST(StateTracker, TextureUnits) {
+    TextureTracker tt;
+    tt.add(1, std::make_shared<TextureMetadata>(1));
+    tt.add(2, std::make_shared<TextureMetadata>(2));
+
+    auto& units = tt.getTextureUnits();
+    EXPECT_EQ(units.getActiveUnit(), 0);
+    EXPECT_EQ(units.getBoundTexture(GL_TEXTURE_2D), nullptr);
+
+    tt.bind(GL_TEXTURE_2D, 1);
+    tt.activate(3);
+    tt.bind(GL_TEXTURE_CUBE_MAP, 2);
+    EXPECT_EQ(units.getActiveUnit(), 3);
+    EXPECT_EQ(units.getBoundTexture(GL_TEXTURE_2D), nullptr);
+    // Cube map faces are resolved to cube map binding
+    ASSERT_NE(units.getBoundTexture(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z), nullptr);
+    EXPECT_EQ(units.getBoundTexture(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)->getID(), 2);
+
+    tt.activate(0);
+    ASSERT_NE(units.getBoundTexture(GL_TEXTURE_2D), nullptr);
+    EXPECT_EQ(units.getBoundTexture(GL_TEXTURE_2D)->getID(), 1);
+    EXPECT_FALSE(units.hasShadowedTextureBinded());
+
+    tt.bind(GL_TEXTURE_2D, 0);
+    EXPECT_EQ(units.getBoundTexture(GL_TEXTURE_2D), nullptr);
+}
+}
@@ -0,0 +1,116 @@
+#include "binary_logger.hpp"
+#include "gtest/gtest.h"
+#include "logger.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace hi;
+
+namespace {
+std::string getTemporaryPath()
+{
+    return ::testing::TempDir() + "binary_logger_test.bin";
+}
+
+/// Decode file and strip [Repeater][T<id>][<time>] banners
+std::vector<std::string> decodeMessages(const std::string& path)
+{
+    std::ifstream input(path, std::ios::binary);
+    std::stringstream output;
+    EXPECT_TRUE(BinaryLogger::decode(input, output));
+
+    std::vector<std::string> messages;
+    std::string line;
+    while (std::getline(output, line))
+    {
+        size_t position = 0;
+        for (size_t i = 0; i < 3; i++)
+            position = line.find(']', position) + 1;
+        messages.push_back(line.substr(position));
+    }
+    return messages;
+}
+
+TEST(BinaryLogger, Roundtrip) {
+    const auto path = getTemporaryPath();
+    {
+        BinaryLogger logger(path);
+        ASSERT_TRUE(logger.isOpen());
+        logger.write(Logger::INFO_LOG, [](BinaryLogger::Encoder& encoder) {
+            encoder.addLiteral("literal");
+            encoder.addInt(-42);
+            encoder.addUInt(42);
+            encoder.addDouble(0.5);
+            encoder.addString("copied string", 13);
+            encoder.addPosition("file.cpp", 10);
+        });
+        logger.write(Logger::DEBUG_LOG, [](BinaryLogger::Encoder& encoder) {
+            encoder.addLiteral("literal");
+        });
+    }
+    const auto messages = decodeMessages(path);
+    ASSERT_EQ(messages.size(), 2);
+    EXPECT_EQ(messages[0], "literal -42 42 0.500000 copied string file.cpp:10 ");
+    EXPECT_EQ(messages[1], "Debug: literal ");
+    std::remove(path.c_str());
+}
+
+TEST(BinaryLogger, TruncatesLongStrings) {
+    const auto path = getTemporaryPath();
+    const std::string longString(1000, 'x');
+    {
+        BinaryLogger logger(path);
+        logger.write(Logger::INFO_LOG, [&](BinaryLogger::Encoder& encoder) {
+            encoder.addLiteral("long");
+            encoder.addString(longString.data(), longString.size());
+            encoder.addInt(1);
+        });
+    }
+    const auto messages = decodeMessages(path);
+    ASSERT_EQ(messages.size(), 1);
+    const auto storedBytes = (BinaryLogger::maxSlots - 2) * sizeof(uint64_t);
+    EXPECT_EQ(messages[0], "long " + longString.substr(0, storedBytes) + " ...");
+    std::remove(path.c_str());
+}
+
+TEST(BinaryLogger, MultipleThreads) {
+    const auto path = getTemporaryPath();
+    const size_t threadCount = 4;
+    const size_t recordsPerThread = 100;
+    {
+        BinaryLogger logger(path);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&logger, t]() {
+                for (size_t i = 0; i < recordsPerThread; i++)
+                {
+                    logger.write(Logger::INFO_LOG, [&](BinaryLogger::Encoder& encoder) {
+                        encoder.addUInt(t);
+                        encoder.addUInt(i);
+                    });
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    }
+    EXPECT_EQ(decodeMessages(path).size(), threadCount * recordsPerThread);
+    std::remove(path.c_str());
+}
+
+TEST(BinaryLogger, LoggerBackend) {
+    const auto path = getTemporaryPath();
+    auto& logger = Logger::getInstance();
+    logger.setBinaryOutput(path);
+    Logger::log("Value", 42, std::string("string"), []() { return 7; });
+    logger.setBinaryOutput("");
+
+    const auto messages = decodeMessages(path);
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_EQ(messages[0], Logger::ToStringVariadic("Value", 42, std::string("string"), 7));
+    std::remove(path.c_str());
+}
+}
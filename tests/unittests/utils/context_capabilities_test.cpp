@@ -0,0 +1,35 @@
+#include "gtest/gtest.h"
+#include "utils/context_capabilities.hpp"
+
+using namespace hi;
+using namespace hi::utils;
+
+namespace {
+TEST(ContextCapabilities, ParseVersion) {
+    using Version = std::pair<int, int>;
+    EXPECT_EQ(ContextCapabilities::parseVersion("4.6.0 NVIDIA 535.54.03"), Version(4, 6));
+    EXPECT_EQ(ContextCapabilities::parseVersion("2.1 Mesa 20.0.8"), Version(2, 1));
+    // GLES prefixes version with API name
+    EXPECT_EQ(ContextCapabilities::parseVersion("OpenGL ES 3.2 Mesa 21.2.6"), Version(3, 2));
+
+    EXPECT_EQ(ContextCapabilities::parseVersion(""), Version(0, 0));
+    EXPECT_EQ(ContextCapabilities::parseVersion("garbage"), Version(0, 0));
+    EXPECT_EQ(ContextCapabilities::parseVersion("4"), Version(0, 0));
+}
+
+TEST(ContextCapabilities, ParseExtensions) {
+    const auto extensions = ContextCapabilities::parseExtensions("GL_ARB_multitexture  GL_ARB_buffer_storage GL_EXT_texture3D ");
+    EXPECT_EQ(extensions.size(), 3);
+    EXPECT_EQ(extensions.count("GL_ARB_buffer_storage"), 1);
+    EXPECT_EQ(extensions.count("GL_ARB_buffer"), 0);
+
+    EXPECT_TRUE(ContextCapabilities::parseExtensions("").empty());
+}
+
+TEST(ContextCapabilities, DefaultsWithoutQuery) {
+    ContextCapabilities capabilities;
+    EXPECT_FALSE(capabilities.isVersionAtLeast(1, 0));
+    EXPECT_FALSE(capabilities.hasExtension("GL_ARB_buffer_storage"));
+    EXPECT_TRUE(capabilities.isCompatibilityProfile());
+}
+} // namespace
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+#include "utils/context_tracker.hpp"
+
+#include <memory>
+#include <set>
+
+namespace {
+TEST(ContextTracker, Basics) {
+    ContextTracker<int> tracker;
+    ASSERT_FALSE(tracker.has(1));
+    tracker.add(1, 10);
+    tracker.add(2, 20);
+    ASSERT_TRUE(tracker.has(1));
+    ASSERT_EQ(tracker.get(2), 20);
+    ASSERT_EQ(tracker.size(), 2);
+
+    tracker.add(2, 21);
+    ASSERT_EQ(tracker.get(2), 21);
+    ASSERT_EQ(tracker.size(), 2);
+
+    tracker.remove(1);
+    tracker.remove(1);
+    ASSERT_FALSE(tracker.has(1));
+    ASSERT_EQ(tracker.size(), 1);
+}
+
+TEST(ContextTracker, SparseKeys) {
+    // GLenum-like keys must not allocate dense slots up to their value
+    ContextTracker<int> tracker;
+    tracker.add(0x8CE0, 1);
+    tracker.add(0x8D00, 2);
+    tracker.add(3, 3);
+    ASSERT_EQ(tracker.get(0x8CE0), 1);
+    ASSERT_EQ(tracker.get(0x8D00), 2);
+    ASSERT_EQ(tracker.get(3), 3);
+
+    std::set<size_t> ids;
+    for (auto& [id, value] : tracker.getMap())
+    {
+        ids.insert(id);
+        value++;
+    }
+    ASSERT_EQ(ids, (std::set<size_t> { 3, 0x8CE0, 0x8D00 }));
+    ASSERT_EQ(tracker.getConstMap().at(3), 4);
+    ASSERT_EQ(tracker.getMap().size(), 3);
+
+    // Growing dense range takes over sparse keys
+    for (size_t id = 4; id < 0x9000; id++)
+    {
+        if (id != 0x8CE0 && id != 0x8D00)
+            tracker.add(id, 0);
+    }
+    ASSERT_EQ(tracker.get(0x8CE0), 2);
+    ASSERT_EQ(tracker.get(0x8D00), 3);
+    ASSERT_EQ(tracker.size(), 0x9000 - 3);
+}
+
+TEST(ContextTracker, Handles) {
+    BindableContextTracker<std::shared_ptr<int>> tracker;
+    tracker.add(5, std::make_shared<int>(5));
+    auto handle = tracker.getHandle(5);
+    ASSERT_TRUE(tracker.isValid(handle));
+
+    tracker.bind(5);
+    tracker.remove(5);
+    ASSERT_FALSE(tracker.hasBounded());
+    ASSERT_FALSE(tracker.isValid(handle));
+
+    // Reused name doesn't revive old handle
+    tracker.add(5, std::make_shared<int>(6));
+    ASSERT_FALSE(tracker.isValid(handle));
+    ASSERT_TRUE(tracker.isValid(tracker.getHandle(5)));
+}
+
+TEST(ContextTracker, SharedStorage) {
+    BindableContextTracker<int> first;
+    BindableContextTracker<int> second;
+    first.add(1, 10);
+    second.shareWith(first);
+    ASSERT_TRUE(first.isShared());
+    ASSERT_EQ(second.get(1), 10);
+
+    // Objects are shared, bindings aren't
+    second.add(2, 20);
+    second.bind(2);
+    ASSERT_EQ(first.get(2), 20);
+    ASSERT_FALSE(first.hasBounded());
+
+    // Copy doesn't share storage
+    auto copy = first;
+    copy.add(3, 30);
+    ASSERT_FALSE(first.has(3));
+    ASSERT_EQ(copy.size(), 3);
+
+    second = BindableContextTracker<int>();
+    ASSERT_FALSE(first.isShared());
+    ASSERT_EQ(first.size(), 2);
+}
+} //namespace
@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+#include "logger.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace hi;
+
+namespace {
+TEST(Logger, LazyArgumentsOfDisabledLevel) {
+    auto& logger = Logger::getInstance();
+    const auto originalLevel = logger.getMaximumLevel();
+
+    size_t evaluations = 0;
+    const auto lazyArgument = [&]() -> std::string {
+        evaluations++;
+        return "lazy";
+    };
+
+    logger.setMaximumLevel(Logger::INFO_LOG);
+    EXPECT_FALSE(Logger::isLevelEnabled(Logger::DEBUG_LOG));
+    Logger::logDebug("not printed", lazyArgument);
+    Logger::logDebugPerFrame("not printed", lazyArgument);
+    EXPECT_EQ(evaluations, 0);
+
+    logger.setMaximumLevel(Logger::DEBUG_LOG);
+    EXPECT_TRUE(Logger::isLevelEnabled(Logger::DEBUG_LOG));
+    Logger::logDebug("printed", lazyArgument);
+    EXPECT_EQ(evaluations, 1);
+
+    logger.setMaximumLevel(originalLevel);
+}
+
+TEST(Logger, ToString) {
+    EXPECT_EQ(Logger::ToString([]() { return 42; }), "42");
+    EXPECT_EQ(Logger::ToString(LogPosition { "file.cpp", 10 }), "file.cpp:10");
+    EXPECT_EQ(Logger::ToStringVariadic("a", 1, std::string("b")), "a 1 b ");
+}
+
+TEST(Logger, BinaryOutputCopiesCharArrays) {
+    const auto path = ::testing::TempDir() + "logger_test.bin";
+    Logger::getInstance().setBinaryOutput(path);
+    {
+        // Stack buffer is overwritten before the record is drained
+        char buffer[64] = "stack buffer";
+        Logger::log(HI_LITERAL("literal"), buffer);
+        std::strcpy(buffer, "overwritten");
+    }
+    Logger::getInstance().setBinaryOutput("");
+
+    std::ifstream input(path, std::ios::binary);
+    std::stringstream output;
+    ASSERT_TRUE(BinaryLogger::decode(input, output));
+    EXPECT_NE(output.str().find("literal stack buffer"), std::string::npos);
+    std::remove(path.c_str());
+}
+}
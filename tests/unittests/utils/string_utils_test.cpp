@@ -33,4 +33,25 @@ TEST(StringUtils, BasicII) {
     });
     ASSERT_EQ(newStr, "romen man men man en man");
 }
+
+TEST(StringUtils, ReplaceIdentifiers) {
+    std::string str = "varying vec2 uv; // uv\n/* uv */ uv_2 = uv + 1.0uv; a.uv=uv;";
+    auto newStr = replace_identifiers(str, { { "uv", "injector_uv" }, { "varying", "in" } });
+    ASSERT_EQ(newStr, "in vec2 injector_uv; // uv\n/* uv */ uv_2 = injector_uv + 1.0uv; a.injector_uv=injector_uv;");
+
+    ASSERT_EQ(replace_identifiers("", { { "a", "b" } }), "");
+    ASSERT_EQ(replace_identifiers("a/b /* unterminated a", { { "a", "c" } }), "c/b /* unterminated a");
+}
+
+TEST(StringUtils, StableKey) {
+    ASSERT_EQ(toHex(0), "0000000000000000");
+    ASSERT_EQ(toHex(0xabcull), "0000000000000abc");
+    ASSERT_EQ(toHex(0xfedcba9876543210ull), "fedcba9876543210");
+
+    const auto key = computeStableKey("material");
+    ASSERT_EQ(key.size(), 32);
+    ASSERT_EQ(key.substr(0, 16), toHex(computeStableHash("material")));
+    ASSERT_EQ(key, computeStableKey("material"));
+    ASSERT_NE(key, computeStableKey("material2"));
 }
+} //namespace
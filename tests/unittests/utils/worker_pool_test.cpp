@@ -0,0 +1,49 @@
+#include "gtest/gtest.h"
+#include "utils/worker_pool.hpp"
+
+#include <atomic>
+#include <string>
+
+using namespace hi::utils;
+
+namespace {
+TEST(WorkerPool, Results) {
+    WorkerPool pool(4);
+    std::vector<std::future<size_t>> results;
+    for (size_t i = 0; i < 100; i++)
+        results.push_back(pool.submit([i] { return i * i; }));
+    for (size_t i = 0; i < 100; i++)
+        ASSERT_EQ(results[i].get(), i * i);
+}
+
+TEST(WorkerPool, ChainedTasks) {
+    // Task may wait for result of previously submitted task
+    WorkerPool pool(1);
+    auto first = pool.submit([] { return std::string("first"); }).share();
+    auto second = pool.submit([first] { return first.get() + " second"; });
+    ASSERT_EQ(second.get(), "first second");
+}
+
+TEST(WorkerPool, Wait) {
+    std::atomic<size_t> counter = 0;
+    WorkerPool pool(3);
+    for (size_t i = 0; i < 50; i++)
+        pool.submit([&counter] { counter++; });
+    pool.wait();
+    ASSERT_EQ(counter, 50);
+}
+
+TEST(WorkerPool, Synchronous) {
+    WorkerPool pool(0);
+    size_t value = 0;
+    pool.submit([&value] { value = 1; });
+    ASSERT_EQ(value, 1);
+    pool.wait();
+}
+
+TEST(WorkerPool, Exception) {
+    WorkerPool pool(2);
+    auto result = pool.submit([]() -> int { throw std::runtime_error("failed"); });
+    ASSERT_THROW(result.get(), std::runtime_error);
+}
+} //namespace